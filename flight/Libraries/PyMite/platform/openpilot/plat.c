@@ -27,6 +27,48 @@
 
 int pylinenum;
 
+/* Bytecode budget, see plat_setBytecodeBudget() */
+int32_t plat_bytecodeBudget = INT32_MAX;
+static int32_t budgetBytecodes = 0;
+static portTickType budgetPeriod = 0;
+static portTickType budgetPeriodStart = 0;
+
+/*
+ * Allows the script to run at most bytecodes bytecodes every periodMs ms.
+ * Once the budget is used up the VM task sleeps until the end of the
+ * period, so that a busy script can not starve lower priority tasks.
+ * A budget of zero disables the limit.
+ */
+void plat_setBytecodeBudget(uint16_t bytecodes, uint16_t periodMs)
+{
+    budgetBytecodes = bytecodes;
+    budgetPeriod = MS2TICKS(periodMs);
+    if (budgetPeriod == 0)
+        budgetPeriod = 1;
+    plat_refillBytecodeBudget();
+}
+
+/*
+ * Starts a new period with a full budget. Called whenever the script
+ * sleeps on its own, which is how a well behaved script ends a period.
+ */
+void plat_refillBytecodeBudget(void)
+{
+    budgetPeriodStart = xTaskGetTickCount();
+    plat_bytecodeBudget = (budgetBytecodes > 0) ? budgetBytecodes : INT32_MAX;
+}
+
+void plat_budgetExhausted(void)
+{
+    if (budgetBytecodes > 0) {
+        portTickType elapsed = xTaskGetTickCount() - budgetPeriodStart;
+
+        /* Always give way for at least a tick, even if the period is already over */
+        vTaskDelay((elapsed < budgetPeriod) ? (budgetPeriod - elapsed) : 1);
+    }
+    plat_refillBytecodeBudget();
+}
+
 PmReturn_t plat_init(void)
 {
     return PM_RET_OK;
@@ -28,4 +28,12 @@
 #define PM_HEAP_SIZE 0x2000
 #define PM_FLOAT_LITTLE_ENDIAN
 
+/* Bytecodes left before the script has to give way to other tasks */
+extern int32_t plat_bytecodeBudget;
+extern void plat_budgetExhausted(void);
+extern void plat_setBytecodeBudget(uint16_t bytecodes, uint16_t periodMs);
+extern void plat_refillBytecodeBudget(void);
+
+#define PM_PLAT_BYTECODE_HOOK() do { if (--plat_bytecodeBudget < 0) plat_budgetExhausted(); } while (0)
+
 #endif /* _PLAT_H_ */
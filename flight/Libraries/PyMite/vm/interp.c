@@ -71,6 +71,9 @@ interpret(const uint8_t returnOnNoThreads)
             PM_BREAK_IF_ERROR(retval);
         }
 
+        /* Let the platform account for the bytecode */
+        PM_PLAT_BYTECODE_HOOK();
+
         /* Get byte; the func post-incrs PM_IP */
         bc = mem_getByte(PM_FP->fo_memspace, &PM_IP);
         switch (bc)
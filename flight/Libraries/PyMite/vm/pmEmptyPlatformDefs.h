@@ -35,4 +35,13 @@
 #define PM_PLAT_HEAP_ATTR
 #endif
 
+/**
+ * Called by the interpreter before every bytecode, so that a platform can
+ * limit how much CPU a script takes before it has to give way to other tasks.
+ * If not defined, make it empty.
+ */
+#if !defined(PM_PLAT_BYTECODE_HOOK) || defined(__DOXYGEN__)
+#define PM_PLAT_BYTECODE_HOOK()
+#endif
+
 #endif /* __PM_EMPTY_PLATFORM_DEFS_H__ */
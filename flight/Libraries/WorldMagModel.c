@@ -54,6 +54,7 @@
 
 #include "WorldMagModel.h"
 #include "WMMInternal.h"
+#include "wmm_tile.h"
 
 #define MALLOC(x) pvPortMalloc(x)
 #define FREE(x) vPortFree(x)
@@ -63,10 +64,34 @@
 // const should hopefully keep them in the flash region
 static const float CoeffFile[91][6] = COEFFS_FROM_NASA;
 
-static WMMtype_Ellipsoid        *Ellip = NULL;
-static WMMtype_MagneticModel    *MagneticModel = NULL;
+static WMMtype_Ellipsoid        Ellip_storage;
+static WMMtype_MagneticModel    MagneticModel_storage;
+static WMMtype_Ellipsoid        * const Ellip = &Ellip_storage;
+static WMMtype_MagneticModel    * const MagneticModel = &MagneticModel_storage;
 static float                    decimal_date;
 
+//! Size of the interpolation tile in degrees
+#define WMM_TILE_STEP_DEG      1.0f
+//! Altitude change in m before the tile corners are recomputed
+#define WMM_TILE_ALT_THRESHOLD 500.0f
+
+/**
+ * State kept between calls of WMM_GetMagVectorTracked. The Legendre functions
+ * only depend on the geocentric latitude, so they are kept for the next
+ * corner on the same row of the tile.
+ */
+struct wmm_tracker {
+	WMMtype_LegendreFunction legendre;
+	float legendre_phig;
+	bool legendre_valid;
+	float date;
+	struct wmm_tile tile;
+};
+
+static struct wmm_tracker *tracker;
+
+static int wmm_tracker_eval(void *ctx, float lat, float lon, float alt, float B[3]);
+
 /**************************************************************************************
 *   Example use - very simple - only two exposed functions
 *
@@ -76,15 +101,15 @@ static float                    decimal_date;
 *	e.g. Iceland in may of 2012 = WMM_GetMagVector(65.0, -20.0, 0.0, 5, 5, 2012, B);
 *	Alt is above the WGS-84 Ellipsoid
 *	B is the NED (XYZ) magnetic vector in nTesla
+*
+*	WMM_GetMagVectorTracked() takes the same arguments but interpolates over a
+*	cached tile, for calling continuously as the vehicle moves
 **************************************************************************************/
 
 int WMM_Initialize()
 //      Sets default values for WMM subroutines.
 //      UPDATES : Ellip and MagneticModel
-{	
-	if (!Ellip) return -1;          // invalid pointer
-	if (!MagneticModel) return -2;  // invalid pointer
-	
+{
 	// Sets WGS-84 parameters
 	Ellip->a     = WGS84_A;               // semi-major axis of the ellipsoid in km
 	Ellip->b     = WGS84_B;               // semi-minor axis of the ellipsoid in km
@@ -125,21 +150,12 @@ int WMM_GetMagVector(float Lat, float Lon, float AltEllipsoid, uint16_t Month, u
     // ***********
     // allocated required memory
 
-//    Ellip = NULL;
-//    MagneticModel = NULL;
-
-//    MagneticModel = NULL;
-//    CoordGeodetic = NULL;
-//    GeoMagneticElements = NULL;
-
-    Ellip = (WMMtype_Ellipsoid *) MALLOC(sizeof(WMMtype_Ellipsoid));
-    MagneticModel = (WMMtype_MagneticModel *) MALLOC(sizeof(WMMtype_MagneticModel));
-
     WMMtype_CoordSpherical *CoordSpherical = (WMMtype_CoordSpherical *) MALLOC(sizeof(WMMtype_CoordSpherical));
     WMMtype_CoordGeodetic *CoordGeodetic = (WMMtype_CoordGeodetic *) MALLOC(sizeof(WMMtype_CoordGeodetic));
     WMMtype_GeoMagneticElements *GeoMagneticElements = (WMMtype_GeoMagneticElements *) MALLOC(sizeof(WMMtype_GeoMagneticElements));
+    WMMtype_LegendreFunction *LegendreFunction = (WMMtype_LegendreFunction *) MALLOC(sizeof(WMMtype_LegendreFunction));
 
-    if (!Ellip || !MagneticModel || !CoordSpherical || !CoordGeodetic || !GeoMagneticElements)
+    if (!CoordSpherical || !CoordGeodetic || !GeoMagneticElements || !LegendreFunction)
         returned = -5;  // error
 
     // ***********
@@ -168,22 +184,31 @@ int WMM_GetMagVector(float Lat, float Lon, float AltEllipsoid, uint16_t Month, u
             returned = -8;  // error
     }
 
+    if (returned >= 0)
+    {   // Compute ALF
+        if (WMM_AssociatedLegendreFunction(CoordSpherical, MagneticModel->nMax, LegendreFunction) < 0)
+            returned = -10;  // error
+    }
+
     if (returned >= 0)
     {
         // Compute the geoMagnetic field elements and their time change
-        if (WMM_Geomag(CoordSpherical, CoordGeodetic, GeoMagneticElements) < 0)
+        if (WMM_Geomag(CoordSpherical, CoordGeodetic, LegendreFunction, GeoMagneticElements) < 0)
             returned = -9;  // error
         else
         {   // set the returned values
-            B[0] = GeoMagneticElements->X;
-            B[1] = GeoMagneticElements->Y;
-            B[2] = GeoMagneticElements->Z;
+            B[0] = GeoMagneticElements->X * 1e-2f;
+            B[1] = GeoMagneticElements->Y * 1e-2f;
+            B[2] = GeoMagneticElements->Z * 1e-2f;
         }
     }
 
    // ***********
    // free allocated memory
 
+    if (LegendreFunction)
+        FREE(LegendreFunction);
+
     if (GeoMagneticElements)
         FREE(GeoMagneticElements);
 
@@ -193,26 +218,102 @@ int WMM_GetMagVector(float Lat, float Lon, float AltEllipsoid, uint16_t Month, u
     if (CoordSpherical)
         FREE(CoordSpherical);
 
-    if (MagneticModel)
-    {
-       FREE(MagneticModel);
-       MagneticModel = NULL;
-    }
+    return returned;
+}
 
-    if (Ellip)
-    {
-        FREE(Ellip);
-        Ellip = NULL;
-    }
+/**
+ * Get the magnetic field at a location that changes over time, e.g. the
+ * current vehicle position. The full model is only evaluated at the corners
+ * of a WMM_TILE_STEP_DEG tile around the location and interpolated inside it,
+ * so most calls cost a handful of multiplies. The corners are recomputed when
+ * the location leaves the tile, the altitude changes by more than
+ * WMM_TILE_ALT_THRESHOLD or the date changes.
+ *
+ * The interpolation error over a one degree tile is well under 1% of the field
+ * away from the poles. Use WMM_GetMagVector for a one off exact value.
+ *
+ * Not reentrant, the cache is shared by all callers.
+ *
+ * @param[in] Lat latitude in degrees
+ * @param[in] Lon longitude in degrees
+ * @param[in] AltEllipsoid altitude above the WGS-84 ellipsoid in m
+ * @param[out] B the NED magnetic vector, in the units of WMM_GetMagVector
+ * @returns 0 if successful, < 0 otherwise
+ */
+int WMM_GetMagVectorTracked(float Lat, float Lon, float AltEllipsoid, uint16_t Month, uint16_t Day, uint16_t Year, float B[3])
+{
+	if (Lat <  -90) return -1;  // error
+	if (Lat >   90) return -2;  // error
 
-	B[0] = GeoMagneticElements->X * 1e-2f;
-	B[1] = GeoMagneticElements->Y * 1e-2f;
-	B[2] = GeoMagneticElements->Z * 1e-2f;
+	if (Lon < -180) return -3;  // error
+	if (Lon >  180) return -4;  // error
 
-    return returned;
+	if (tracker == NULL) {
+		tracker = (struct wmm_tracker *) MALLOC(sizeof(*tracker));
+		if (tracker == NULL)
+			return -5;  // error
+
+		tracker->legendre_valid = false;
+		tracker->date = 0;
+		wmm_tile_init(&tracker->tile, WMM_TILE_STEP_DEG, WMM_TILE_ALT_THRESHOLD);
+	}
+
+	if (WMM_Initialize() < 0)
+		return -6;  // error
+
+	if (WMM_DateToYear(Month, Day, Year) < 0)
+		return -8;  // error
+
+	if (decimal_date != tracker->date) {
+		tracker->date = decimal_date;
+		wmm_tile_invalidate(&tracker->tile);
+	}
+
+	if (wmm_tile_get(&tracker->tile, wmm_tracker_eval, tracker, Lat, Lon, AltEllipsoid, B) < 0)
+		return -9;  // error
+
+	return 0;
 }
 
-int WMM_Geomag(WMMtype_CoordSpherical * CoordSpherical, WMMtype_CoordGeodetic * CoordGeodetic, WMMtype_GeoMagneticElements * GeoMagneticElements)
+/**
+ * Evaluate the full model at a tile corner, reusing the Legendre functions
+ * from the previous corner when the geocentric latitude is the same
+ */
+static int wmm_tracker_eval(void *ctx, float lat, float lon, float alt, float B[3])
+{
+	struct wmm_tracker *t = (struct wmm_tracker *) ctx;
+
+	WMMtype_CoordSpherical CoordSpherical;
+	WMMtype_CoordGeodetic CoordGeodetic;
+	WMMtype_GeoMagneticElements GeoMagneticElements;
+
+	CoordGeodetic.lambda = lon;
+	CoordGeodetic.phi = lat;
+	CoordGeodetic.HeightAboveEllipsoid = alt / 1000.0f; // convert to km
+
+	if (WMM_GeodeticToSpherical(&CoordGeodetic, &CoordSpherical) < 0)
+		return -1;
+
+	if (!t->legendre_valid || CoordSpherical.phig != t->legendre_phig) {
+		t->legendre_valid = false;
+		if (WMM_AssociatedLegendreFunction(&CoordSpherical, MagneticModel->nMax, &t->legendre) < 0)
+			return -2;
+		t->legendre_phig = CoordSpherical.phig;
+		t->legendre_valid = true;
+	}
+
+	if (WMM_Geomag(&CoordSpherical, &CoordGeodetic, &t->legendre, &GeoMagneticElements) < 0)
+		return -3;
+
+	B[0] = GeoMagneticElements.X * 1e-2f;
+	B[1] = GeoMagneticElements.Y * 1e-2f;
+	B[2] = GeoMagneticElements.Z * 1e-2f;
+
+	return 0;
+}
+
+int WMM_Geomag(WMMtype_CoordSpherical * CoordSpherical, WMMtype_CoordGeodetic * CoordGeodetic,
+               WMMtype_LegendreFunction * LegendreFunction, WMMtype_GeoMagneticElements * GeoMagneticElements)
    /*
       The main subroutine that calls a sequence of WMM sub-functions to calculate the magnetic field elements for a single point.
       The function expects the model coefficients and point coordinates as input and returns the magnetic field elements and
@@ -222,12 +323,12 @@ int WMM_Geomag(WMMtype_CoordSpherical * CoordSpherical, WMMtype_CoordGeodetic *
       INPUT: Ellip
       CoordSpherical
       CoordGeodetic
+      LegendreFunction (from WMM_AssociatedLegendreFunction, only depends on CoordSpherical->phig)
       TimedMagneticModel
 
       OUTPUT : GeoMagneticElements
 
       CALLS:    WMM_ComputeSphericalHarmonicVariables( Ellip, CoordSpherical, TimedMagneticModel->nMax, &SphVariables); (Compute Spherical Harmonic variables  )
-      WMM_AssociatedLegendreFunction(CoordSpherical, TimedMagneticModel->nMax, LegendreFunction);       Compute ALF
       WMM_Summation(LegendreFunction, TimedMagneticModel, SphVariables, CoordSpherical, &MagneticResultsSph);  Accumulate the spherical harmonic coefficients
       WMM_SecVarSummation(LegendreFunction, TimedMagneticModel, SphVariables, CoordSpherical, &MagneticResultsSphVar); Sum the Secular Variation Coefficients
       WMM_RotateMagneticVector(CoordSpherical, CoordGeodetic, MagneticResultsSph, &MagneticResultsGeo); Map the computed Magnetic fields to Geodeitic coordinates
@@ -247,10 +348,9 @@ int WMM_Geomag(WMMtype_CoordSpherical * CoordSpherical, WMMtype_CoordGeodetic *
     // ********
     // allocate required memory
 
-    WMMtype_LegendreFunction            *LegendreFunction = (WMMtype_LegendreFunction *) MALLOC(sizeof(WMMtype_LegendreFunction));
     WMMtype_SphericalHarmonicVariables  *SphVariables = (WMMtype_SphericalHarmonicVariables *) MALLOC(sizeof(WMMtype_SphericalHarmonicVariables));
 
-    if (!LegendreFunction || !SphVariables)
+    if (!SphVariables)
         returned = -1;  // memory allocation error
 
     // ********
@@ -261,12 +361,6 @@ int WMM_Geomag(WMMtype_CoordSpherical * CoordSpherical, WMMtype_CoordGeodetic *
             returned = -2;  // error
     }
 
-    if (returned >= 0)
-    {   // Compute ALF
-        if (WMM_AssociatedLegendreFunction(CoordSpherical, MagneticModel->nMax, LegendreFunction) < 0)
-            returned = -3;  // error
-    }
-
     if (returned >= 0)
     {   // Accumulate the spherical harmonic coefficients
         if (WMM_Summation(LegendreFunction, SphVariables, CoordSpherical, &MagneticResultsSph) < 0)
@@ -309,9 +403,6 @@ int WMM_Geomag(WMMtype_CoordSpherical * CoordSpherical, WMMtype_CoordGeodetic *
     if (SphVariables)
         FREE(SphVariables);
 
-    if (LegendreFunction)
-        FREE(LegendreFunction);
-
     // ********
 
     return returned;
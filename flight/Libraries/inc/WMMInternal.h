@@ -123,7 +123,8 @@ void WMM_Set_Coeff_Array();
 int WMM_GeodeticToSpherical(WMMtype_CoordGeodetic * CoordGeodetic, WMMtype_CoordSpherical * CoordSpherical);
 int WMM_DateToYear(uint16_t month, uint16_t day, uint16_t year);
 int WMM_Geomag(WMMtype_CoordSpherical * CoordSpherical,
-		    WMMtype_CoordGeodetic * CoordGeodetic, WMMtype_GeoMagneticElements * GeoMagneticElements);
+		    WMMtype_CoordGeodetic * CoordGeodetic, WMMtype_LegendreFunction * LegendreFunction,
+		    WMMtype_GeoMagneticElements * GeoMagneticElements);
 
 int WMM_AssociatedLegendreFunction(WMMtype_CoordSpherical * CoordSpherical, uint16_t nMax, WMMtype_LegendreFunction * LegendreFunction);
 
@@ -32,6 +32,7 @@
 	//  Exposed Function Prototypes
 int WMM_Initialize();
 int WMM_GetMagVector(float Lat, float Lon, float AltEllipsoid, uint16_t Month, uint16_t Day, uint16_t Year, float B[3]);
+int WMM_GetMagVectorTracked(float Lat, float Lon, float AltEllipsoid, uint16_t Month, uint16_t Day, uint16_t Year, float B[3]);
 
 #endif /* WORLDMAGMODEL_H_ */
 
@@ -41,7 +41,25 @@ struct path_status {
 	float path_direction[2];
 };
 
-void path_progress(PathDesiredData *pathDesired, float * cur_point, struct path_status * status);
+//! A PathDesired with the geometry which does not depend on the location precomputed
+struct path_segment {
+	uint8_t mode;
+	float start[2];
+	float end[2];
+	float parameter;     //!< PathDesired.ModeParameters
+	float path[2];       //!< From start to end
+	float dist_path;     //!< Length of path
+	float direction[2];  //!< Unit vector along path, 0 for a degenerate path
+	float normal[2];     //!< Unit normal to path, 0 for a degenerate path
+	float center[2];     //!< Center of the curve or circle
+	float radius;        //!< Radius of the curve or circle
+	bool clockwise;
+	bool valid;          //!< Set once prepared, a zeroed segment is computed on first use
+};
+
+void path_progress(PathDesiredData *pathDesired, struct path_segment *segment, float * cur_point, struct path_status * status);
+void path_segment_prepare(const PathDesiredData *pathDesired, struct path_segment *segment);
+void path_segment_progress(const struct path_segment *segment, const float *cur_point, struct path_status *status);
 
 #endif /* PATHS_H_ */
 
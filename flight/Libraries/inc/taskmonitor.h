@@ -33,6 +33,7 @@ int32_t TaskMonitorInitialize(void);
 int32_t TaskMonitorAdd(TaskInfoRunningElem task, xTaskHandle handle);
 int32_t TaskMonitorRemove(TaskInfoRunningElem task);
 bool TaskMonitorQueryRunning(TaskInfoRunningElem task);
+void TaskMonitorLoop(TaskInfoRunningElem task);
 void TaskMonitorUpdateAll(void);
 
 #endif // TASKMONITOR_H
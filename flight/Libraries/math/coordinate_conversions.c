@@ -35,6 +35,7 @@
 #include <math.h>
 #include <stdint.h>
 #include "coordinate_conversions.h"
+#include "fast_math.h"
 #include "physical_constants.h"
 
 // ****** find ECEF to NED rotation matrix ********
@@ -73,9 +74,9 @@ void Quaternion2RPY(const float q[4], float rpy[3])
 	R23 = 2.0f * (q[2] * q[3] + q[0] * q[1]);
 	R33 = q0s - q1s - q2s + q3s;
 
-	rpy[1] = RAD2DEG * asinf(-R13);	// pitch always between -pi/2 to pi/2
-	rpy[2] = RAD2DEG * atan2f(R12, R11);
-	rpy[0] = RAD2DEG * atan2f(R23, R33);
+	rpy[1] = RAD2DEG * fast_asinf(-R13);	// pitch always between -pi/2 to pi/2
+	rpy[2] = RAD2DEG * fast_atan2f(R12, R11);
+	rpy[0] = RAD2DEG * fast_atan2f(R23, R33);
 
 	//TODO: consider the cases where |R13| ~= 1, |pitch| ~= pi/2
 }
@@ -89,12 +90,9 @@ void RPY2Quaternion(const float rpy[3], float q[4])
 	phi = DEG2RAD * rpy[0] / 2;
 	theta = DEG2RAD * rpy[1] / 2;
 	psi = DEG2RAD * rpy[2] / 2;
-	cphi = cosf(phi);
-	sphi = sinf(phi);
-	ctheta = cosf(theta);
-	stheta = sinf(theta);
-	cpsi = cosf(psi);
-	spsi = sinf(psi);
+	fast_sincosf(phi, &sphi, &cphi);
+	fast_sincosf(theta, &stheta, &ctheta);
+	fast_sincosf(psi, &spsi, &cpsi);
 
 	q[0] = cphi * ctheta * cpsi + sphi * stheta * spsi;
 	q[1] = sphi * ctheta * cpsi - cphi * stheta * spsi;
@@ -131,9 +129,10 @@ void Quaternion2R(float q[4], float Rbe[3][3])
 void Euler2R(float rpy[3], float Rbe[3][3])
 {
 	
-	float sF = sinf(rpy[0]), cF = cosf(rpy[0]);
-	float sT = sinf(rpy[1]), cT = cosf(rpy[1]);
-	float sP = sinf(rpy[2]), cP = cosf(rpy[2]);
+	float sF, cF, sT, cT, sP, cP;
+	fast_sincosf(rpy[0], &sF, &cF);
+	fast_sincosf(rpy[1], &sT, &cT);
+	fast_sincosf(rpy[2], &sP, &cP);
 	
 	Rbe[0][0] = cT*cP;
 	Rbe[0][1] = cT*sP;
@@ -0,0 +1,210 @@
+/**
+ ******************************************************************************
+ * @addtogroup TauLabsLibraries Tau Labs Libraries
+ * @{
+ * @addtogroup TauLabsMath Tau Labs math support libraries
+ * @{
+ *
+ * @file       fast_math.c
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2013
+ * @brief      Polynomial approximations of the trigonometric functions
+ *
+ * The polynomials are the single precision minimax approximations from the
+ * Cephes library. Each kernel only works over a small interval, so the
+ * argument is first reduced to it using the symmetries of the function.
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "fast_math.h"
+
+#if defined(FAST_MATH)
+
+#include <stdint.h>
+
+#define PI_F		3.14159265358979f
+#define PI_2_F		1.57079632679490f
+#define PI_4_F		0.78539816339745f
+#define TWO_OVER_PI_F	0.63661977236758f
+#define TAN_PI_8_F	0.41421356237310f
+
+/* pi/2 split in three parts, the first two with few enough significant bits
+ * that k * PIO2_1 and k * PIO2_2 are exact for |k| < 2048, which keeps the
+ * reduced argument accurate up to |x| of about 3000 rad */
+#define PIO2_1		1.5703125f
+#define PIO2_2		4.8375129699707031e-4f
+#define PIO2_3		7.5497899548918822e-8f
+
+/**
+ * sin(x) and cos(x) for |x| <= pi/4
+ */
+static inline void sincos_kernel(float x, float *s, float *c)
+{
+	float z = x * x;
+
+	*s = x + x * z * ((-1.9515295891e-4f * z + 8.3321608736e-3f) * z - 1.6666654611e-1f);
+	*c = 1.0f - 0.5f * z + z * z * ((2.443315711809948e-5f * z - 1.388731625493765e-3f) * z + 4.166664568298827e-2f);
+}
+
+/**
+ * Compute sin(x) and cos(x) together, sharing the argument reduction
+ * @param[in] x angle in radians
+ * @param[out] s sin(x)
+ * @param[out] c cos(x)
+ */
+void fast_sincosf(float x, float *s, float *c)
+{
+	// Nearest multiple of pi/2, the rest is within [-pi/4, pi/4]
+	int32_t k = (int32_t) (x * TWO_OVER_PI_F + (x >= 0 ? 0.5f : -0.5f));
+	float r = ((x - k * PIO2_1) - k * PIO2_2) - k * PIO2_3;
+
+	float sr, cr;
+	sincos_kernel(r, &sr, &cr);
+
+	switch (k & 3) {
+	case 0:
+		*s = sr;
+		*c = cr;
+		break;
+	case 1:
+		*s = cr;
+		*c = -sr;
+		break;
+	case 2:
+		*s = -sr;
+		*c = -cr;
+		break;
+	default:
+		*s = -cr;
+		*c = sr;
+		break;
+	}
+}
+
+/**
+ * @param[in] x angle in radians
+ * @returns sin(x)
+ */
+float fast_sinf(float x)
+{
+	float s, c;
+	fast_sincosf(x, &s, &c);
+	return s;
+}
+
+/**
+ * @param[in] x angle in radians
+ * @returns cos(x)
+ */
+float fast_cosf(float x)
+{
+	float s, c;
+	fast_sincosf(x, &s, &c);
+	return c;
+}
+
+/**
+ * Four quadrant arc tangent, with a single division
+ * @returns atan2(y, x) in radians, 0 when both are 0
+ */
+float fast_atan2f(float y, float x)
+{
+	float ax = fabsf(x);
+	float ay = fabsf(y);
+	float base, t;
+
+	if (ax == 0 && ay == 0)
+		return 0;
+
+	// Reduce to atan(t) with |t| <= tan(pi/8) around 0, pi/4 or pi/2
+	if (ay <= TAN_PI_8_F * ax) {
+		base = 0;
+		t = ay / ax;
+	} else if (ax <= TAN_PI_8_F * ay) {
+		base = PI_2_F;
+		t = -ax / ay;
+	} else {
+		base = PI_4_F;
+		t = (ay - ax) / (ay + ax);
+	}
+
+	float z = t * t;
+	float a = base + t + t * z * (((8.05374449538e-2f * z - 1.38776856032e-1f) * z + 1.99777106478e-1f) * z - 3.33329491539e-1f);
+
+	if (x < 0)
+		a = PI_F - a;
+	if (y < 0)
+		a = -a;
+
+	return a;
+}
+
+/**
+ * @param[in] x sine of the angle, NaN is returned outside of [-1, 1]
+ * @returns asin(x) in radians
+ */
+float fast_asinf(float x)
+{
+	float a = fabsf(x);
+	float z, s, r;
+
+	if (a > 0.5f) {
+		// asin(a) = pi/2 - 2 asin(sqrt((1 - a) / 2))
+		z = 0.5f * (1.0f - a);
+		s = sqrtf(z);
+	} else {
+		z = a * a;
+		s = a;
+	}
+
+	r = s + s * z * ((((4.2163199048e-2f * z + 2.4181311049e-2f) * z + 4.5470025998e-2f) * z + 7.4953002686e-2f) * z + 1.6666752422e-1f);
+
+	if (a > 0.5f)
+		r = PI_2_F - 2.0f * r;
+
+	return (x < 0) ? -r : r;
+}
+
+/**
+ * Inverse square root from the floating point representation and two Newton
+ * iterations, for normalizing vectors and quaternions
+ * @returns 1 / sqrt(x)
+ */
+float fast_invsqrtf(float x)
+{
+	union {
+		float f;
+		uint32_t i;
+	} u = { .f = x };
+
+	u.i = 0x5f3759df - (u.i >> 1);
+
+	float y = u.f;
+	y = y * (1.5f - 0.5f * x * y * y);
+	y = y * (1.5f - 0.5f * x * y * y);
+
+	return y;
+}
+
+#endif /* FAST_MATH */
+
+/**
+ * @}
+ * @}
+ */
@@ -0,0 +1,95 @@
+/**
+ ******************************************************************************
+ * @addtogroup TauLabsLibraries Tau Labs Libraries
+ * @{
+ * @addtogroup TauLabsMath Tau Labs math support libraries
+ * @{
+ *
+ * @file       fast_math.h
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2013
+ * @brief      Polynomial approximations of the trigonometric functions
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef FAST_MATH_H
+#define FAST_MATH_H
+
+#include <math.h>
+
+/*
+ * When FAST_MATH is defined these are minimax polynomial kernels, otherwise
+ * they are the libm functions. The kernels have a bounded error over the
+ * whole input range:
+ *
+ *   fast_sinf, fast_cosf, fast_sincosf  < 1e-6 absolute for |x| < 1000 rad
+ *   fast_atan2f                         < 1e-6 rad
+ *   fast_asinf                          < 1e-6 rad
+ *   fast_invsqrtf                       < 5e-6 relative
+ */
+#if defined(FAST_MATH)
+
+float fast_sinf(float x);
+float fast_cosf(float x);
+void fast_sincosf(float x, float *s, float *c);
+float fast_atan2f(float y, float x);
+float fast_asinf(float x);
+float fast_invsqrtf(float x);
+
+#else
+
+static inline float fast_sinf(float x)
+{
+	return sinf(x);
+}
+
+static inline float fast_cosf(float x)
+{
+	return cosf(x);
+}
+
+static inline void fast_sincosf(float x, float *s, float *c)
+{
+	*s = sinf(x);
+	*c = cosf(x);
+}
+
+static inline float fast_atan2f(float y, float x)
+{
+	return atan2f(y, x);
+}
+
+static inline float fast_asinf(float x)
+{
+	return asinf(x);
+}
+
+static inline float fast_invsqrtf(float x)
+{
+	return 1.0f / sqrtf(x);
+}
+
+#endif /* FAST_MATH */
+
+#endif /* FAST_MATH_H */
+
+/**
+ * @}
+ * @}
+ */
@@ -40,83 +40,182 @@
 #include "pathdesired.h"
 
 // private functions
-static void path_endpoint( float * start_point, float * end_point, float * cur_point, struct path_status * status);
-static void path_vector( float * start_point, float * end_point, float * cur_point, struct path_status * status);
-static void path_circle(float * center_point, float radius, float * cur_point, struct path_status * status, bool clockwise);
-static void path_curve(float * start_point, float * end_point, float radius, float * cur_point, struct path_status * status, bool clockwise);
+static void path_endpoint(const struct path_segment *segment, const float *cur_point, struct path_status *status);
+static void path_vector(const struct path_segment *segment, const float *cur_point, struct path_status *status);
+static void path_circle(const struct path_segment *segment, const float *cur_point, struct path_status *status);
+static void path_curve(const struct path_segment *segment, const float *cur_point, struct path_status *status);
 
 /**
  * @brief Compute progress along path and deviation from it
- * @param[in] start_point Starting point
- * @param[in] end_point Ending point
+ * @param[in] pathDesired The path to follow
+ * @param[in,out] segment The caller's segment for this path, zero it before the first call
  * @param[in] cur_point Current location
- * @param[in] mode Path following mode
  * @param[out] status Structure containing progress along path and deviation
+ *
+ * The geometry which does not depend on the current location is only
+ * computed again when the path changes.
  */
 void path_progress(PathDesiredData *pathDesired,
+	               struct path_segment *segment,
 	               float *cur_point,
 	               struct path_status *status)
 {
-	uint8_t mode = pathDesired->Mode;
-	float start_point[2] = {pathDesired->Start[0],pathDesired->Start[1]};
-	float end_point[2] = {pathDesired->End[0],pathDesired->End[1]};
+	if (!segment->valid ||
+			segment->mode != pathDesired->Mode ||
+			segment->start[0] != pathDesired->Start[0] ||
+			segment->start[1] != pathDesired->Start[1] ||
+			segment->end[0] != pathDesired->End[0] ||
+			segment->end[1] != pathDesired->End[1] ||
+			segment->parameter != pathDesired->ModeParameters) {
+		path_segment_prepare(pathDesired, segment);
+	}
+
+	path_segment_progress(segment, cur_point, status);
+}
+
+/**
+ * @brief Precompute the geometry of a path segment
+ * @param[in] pathDesired The path
+ * @param[out] segment The segment to pass to @ref path_segment_progress
+ */
+void path_segment_prepare(const PathDesiredData *pathDesired, struct path_segment *segment)
+{
+	segment->mode = pathDesired->Mode;
+	segment->start[0] = pathDesired->Start[0];
+	segment->start[1] = pathDesired->Start[1];
+	segment->end[0] = pathDesired->End[0];
+	segment->end[1] = pathDesired->End[1];
+	segment->parameter = pathDesired->ModeParameters;
+	segment->valid = true;
+
+	// Distance to go
+	segment->path[0] = segment->end[0] - segment->start[0];
+	segment->path[1] = segment->end[1] - segment->start[1];
+	segment->dist_path = sqrtf(segment->path[0] * segment->path[0] + segment->path[1] * segment->path[1]);
+
+	segment->direction[0] = segment->direction[1] = 0;
+	segment->normal[0] = segment->normal[1] = 0;
+	if (segment->dist_path >= 1e-6f) {
+		// Direction to travel and the normal to the path
+		segment->direction[0] = segment->path[0] / segment->dist_path;
+		segment->direction[1] = segment->path[1] / segment->dist_path;
+		segment->normal[0] = -segment->path[1] / segment->dist_path;
+		segment->normal[1] = segment->path[0] / segment->dist_path;
+	}
 
-	switch(mode) {
+	switch (segment->mode) {
+	case PATHDESIRED_MODE_FLYCIRCLERIGHT:
+	case PATHDESIRED_MODE_DRIVECIRCLERIGHT:
+	case PATHDESIRED_MODE_FLYCIRCLELEFT:
+	case PATHDESIRED_MODE_DRIVECIRCLELEFT:
+	{
+		segment->clockwise = segment->mode == PATHDESIRED_MODE_FLYCIRCLERIGHT ||
+			segment->mode == PATHDESIRED_MODE_DRIVECIRCLERIGHT;
+
+		// Compute the center of the circle connecting the two points as the intersection of two circles
+		// around the two points from
+		// http://www.mathworks.com/matlabcentral/newsreader/view_thread/255121
+		float m_n, m_e, p_n, p_e, d;
+		float radius = segment->parameter;
+
+		// Center between start and end
+		m_n = (segment->start[0] + segment->end[0]) / 2;
+		m_e = (segment->start[1] + segment->end[1]) / 2;
+
+		// Normal vector the line between start and end.
+		if (segment->clockwise) {
+			p_n = -(segment->end[1] - segment->start[1]);
+			p_e = (segment->end[0] - segment->start[0]);
+		} else {
+			p_n = (segment->end[1] - segment->start[1]);
+			p_e = -(segment->end[0] - segment->start[0]);
+		}
+
+		// Work out how far to go along the perpendicular bisector
+		d = sqrtf(radius * radius / (p_n * p_n + p_e * p_e) - 0.25f);
+
+		float radius_sign = (radius > 0) ? 1 : -1;
+		segment->radius = fabs(radius);
+
+		if (fabs(p_n) < 1e-3 && fabs(p_e) < 1e-3) {
+			segment->center[0] = m_n;
+			segment->center[1] = m_e;
+		} else {
+			segment->center[0] = m_n + p_n * d * radius_sign;
+			segment->center[1] = m_e + p_e * d * radius_sign;
+		}
+		break;
+	}
+	case PATHDESIRED_MODE_CIRCLEPOSITIONLEFT:
+	case PATHDESIRED_MODE_CIRCLEPOSITIONRIGHT:
+		segment->clockwise = segment->mode == PATHDESIRED_MODE_CIRCLEPOSITIONRIGHT;
+		segment->center[0] = segment->end[0];
+		segment->center[1] = segment->end[1];
+		segment->radius = segment->parameter;
+		break;
+	default:
+		segment->clockwise = false;
+		segment->center[0] = segment->center[1] = 0;
+		segment->radius = 0;
+		break;
+	}
+}
+
+/**
+ * @brief Compute progress along a prepared segment and deviation from it
+ * @param[in] segment Segment from @ref path_segment_prepare
+ * @param[in] cur_point Current location
+ * @param[out] status Structure containing progress along path and deviation
+ */
+void path_segment_progress(const struct path_segment *segment,
+	                       const float *cur_point,
+	                       struct path_status *status)
+{
+	switch(segment->mode) {
 		case PATHDESIRED_MODE_FLYVECTOR:
 		case PATHDESIRED_MODE_DRIVEVECTOR:
-			return path_vector(start_point, end_point, cur_point, status);
+			return path_vector(segment, cur_point, status);
 			break;
 		case PATHDESIRED_MODE_FLYCIRCLERIGHT:
 		case PATHDESIRED_MODE_DRIVECIRCLERIGHT:
-			return path_curve(start_point, end_point, pathDesired->ModeParameters, cur_point, status, 1);
-			break;
 		case PATHDESIRED_MODE_FLYCIRCLELEFT:
 		case PATHDESIRED_MODE_DRIVECIRCLELEFT:
-			return path_curve(start_point, end_point, pathDesired->ModeParameters, cur_point, status, 0);
+			return path_curve(segment, cur_point, status);
 			break;
 		case PATHDESIRED_MODE_CIRCLEPOSITIONLEFT:
-			return path_circle(end_point, pathDesired->ModeParameters, cur_point, status, 0);
-			break;
 		case PATHDESIRED_MODE_CIRCLEPOSITIONRIGHT:
-			return path_circle(end_point, pathDesired->ModeParameters, cur_point, status, 1);
+			return path_circle(segment, cur_point, status);
 			break;
 		case PATHDESIRED_MODE_FLYENDPOINT:
 		case PATHDESIRED_MODE_DRIVEENDPOINT:
 		default:
 			// use the endpoint as default failsafe if called in unknown modes
-			return path_endpoint(start_point, end_point, cur_point, status);
+			return path_endpoint(segment, cur_point, status);
 			break;
 	}
 }
 
 /**
  * @brief Compute progress towards endpoint. Deviation equals distance
- * @param[in] start_point Starting point
- * @param[in] end_point Ending point
+ * @param[in] segment The path segment
  * @param[in] cur_point Current location
  * @param[out] status Structure containing progress along path and deviation
  */
-static void path_endpoint(float *start_point,
-	                      float *end_point,
-	                      float *cur_point,
+static void path_endpoint(const struct path_segment *segment,
+	                      const float *cur_point,
 	                      struct path_status *status)
 {
-	float path_north, path_east, diff_north, diff_east;
-	float dist_path, dist_diff;
+	float diff_north, diff_east;
+	float dist_diff;
 
 	// we do not correct in this mode
 	status->correction_direction[0] = status->correction_direction[1] = 0;
 
-	// Distance to go
-	path_north = end_point[0] - start_point[0];
-	path_east = end_point[1] - start_point[1];
-
 	// Current progress location relative to end
-	diff_north = end_point[0] - cur_point[0];
-	diff_east = end_point[1] - cur_point[1];
+	diff_north = segment->end[0] - cur_point[0];
+	diff_east = segment->end[1] - cur_point[1];
 
 	dist_diff = sqrtf( diff_north * diff_north + diff_east * diff_east );
-	dist_path = sqrtf( path_north * path_north + path_east * path_east );
 
 	if(dist_diff < 1e-6f ) {
 		status->fractional_progress = 1;
@@ -125,7 +224,7 @@ static void path_endpoint(float *start_point,
 		return;
 	}
 
-	status->fractional_progress = 1 - dist_diff / (1 + dist_path);
+	status->fractional_progress = 1 - dist_diff / (1 + segment->dist_path);
 	status->error = dist_diff;
 
 	// Compute direction to travel
@@ -136,88 +235,72 @@ static void path_endpoint(float *start_point,
 
 /**
  * @brief Compute progress along path and deviation from it
- * @param[in] start_point Starting point
- * @param[in] end_point Ending point
+ * @param[in] segment The path segment
  * @param[in] cur_point Current location
  * @param[out] status Structure containing progress along path and deviation
  */
-static void path_vector(float *start_point,
-	                    float *end_point,
-	                    float *cur_point,
+static void path_vector(const struct path_segment *segment,
+	                    const float *cur_point,
 	                    struct path_status *status)
 {
-	float path_north, path_east, diff_north, diff_east;
-	float dist_path;
+	float diff_north, diff_east;
 	float dot;
-	float normal[2];
 
-	// Distance to go
-	path_north = end_point[0] - start_point[0];
-	path_east = end_point[1] - start_point[1];
-
-	// Current progress location relative to start
-	diff_north = cur_point[0] - start_point[0];
-	diff_east = cur_point[1] - start_point[1];
-
-	dot = path_north * diff_north + path_east * diff_east;
-	dist_path = sqrtf( path_north * path_north + path_east * path_east );
-
-	if(dist_path < 1e-6f) {
+	if(segment->dist_path < 1e-6f) {
 		// if the path is too short, we cannot determine vector direction.
 		// Fly towards the endpoint to prevent flying away,
 		// but assume progress=1 either way.
-		path_endpoint( start_point, end_point, cur_point, status );
+		path_endpoint( segment, cur_point, status );
 		status->fractional_progress = 1;
 		return;
 	}
 
-	// Compute the normal to the path
-	normal[0] = -path_east / dist_path;
-	normal[1] = path_north / dist_path;
+	// Current progress location relative to start
+	diff_north = cur_point[0] - segment->start[0];
+	diff_east = cur_point[1] - segment->start[1];
+
+	dot = segment->path[0] * diff_north + segment->path[1] * diff_east;
 
-	status->fractional_progress = dot / (dist_path * dist_path);
-	status->error = normal[0] * diff_north + normal[1] * diff_east;
+	status->fractional_progress = dot / (segment->dist_path * segment->dist_path);
+	status->error = segment->normal[0] * diff_north + segment->normal[1] * diff_east;
 
 	// Compute direction to correct error
-	status->correction_direction[0] = (status->error > 0) ? -normal[0] : normal[0];
-	status->correction_direction[1] = (status->error > 0) ? -normal[1] : normal[1];
+	status->correction_direction[0] = (status->error > 0) ? -segment->normal[0] : segment->normal[0];
+	status->correction_direction[1] = (status->error > 0) ? -segment->normal[1] : segment->normal[1];
 	
 	// Now just want magnitude of error
 	status->error = fabs(status->error);
 
 	// Compute direction to travel
-	status->path_direction[0] = path_north / dist_path;
-	status->path_direction[1] = path_east / dist_path;
+	status->path_direction[0] = segment->direction[0];
+	status->path_direction[1] = segment->direction[1];
 
 }
 
 /**
  * @brief Circle location continuously
- * @param[in] start_point Starting point
- * @param[in] end_point Center point
+ * @param[in] segment The path segment, centered on its end point
  * @param[in] cur_point Current location
  * @param[out] status Structure containing progress along path and deviation
  */
-static void path_circle(float * center_point,
-                        float radius,
-                        float * cur_point,
-                        struct path_status * status, 
-                        bool clockwise)
+static void path_circle(const struct path_segment *segment,
+                        const float * cur_point,
+                        struct path_status * status)
 {
 	float diff_north, diff_east;
 	float cradius;
 	float normal[2];
 
 	// Current location relative to center
-	diff_north = cur_point[0] - center_point[0];
-	diff_east = cur_point[1] - center_point[1];
+	diff_north = cur_point[0] - segment->center[0];
+	diff_east = cur_point[1] - segment->center[1];
 
 	cradius = sqrtf(  diff_north * diff_north   +   diff_east * diff_east );
 
 	if (cradius < 1e-6f) {
 		// cradius is zero, just fly somewhere and make sure correction is still a normal
 		status->fractional_progress = 1;
-		status->error = radius;
+		status->error = segment->radius;
 		status->correction_direction[0] = 0;
 		status->correction_direction[1] = 1;
 		status->path_direction[0] = 1;
@@ -225,7 +308,7 @@ static void path_circle(float * center_point,
 		return;
 	}
 
-	if (clockwise) {
+	if (segment->clockwise) {
 		// Compute the normal to the radius clockwise
 		normal[0] = -diff_east / cradius;
 		normal[1] = diff_north / cradius;
@@ -238,7 +321,7 @@ static void path_circle(float * center_point,
 	status->fractional_progress = 0;
 
 	// error is current radius minus wanted radius - positive if too close
-	status->error = radius - cradius;
+	status->error = segment->radius - cradius;
 
 	// Compute direction to correct error
 	status->correction_direction[0] = (status->error>0?1:-1) * diff_north / cradius;
@@ -253,71 +336,33 @@ static void path_circle(float * center_point,
 
 /**
  * @brief Compute progress along circular path and deviation from it
- * @param[in] start_point Starting point
- * @param[in] end_point Ending point
- * @param[in] radius Radius of the curve segment
+ * @param[in] segment The path segment with the center of its arc
  * @param[in] cur_point Current location
  * @param[out] status Structure containing progress along path and deviation
  */
-static void path_curve(float * start_point,
-	                   float * end_point,
-	                   float radius,
-	                   float * cur_point,
-	                   struct path_status *status,
-	                   bool clockwise)
+static void path_curve(const struct path_segment *segment,
+	                   const float * cur_point,
+	                   struct path_status *status)
 {
 	float diff_north, diff_east;
-	float path_north, path_east;
 	float cradius;
 	float normal[2];	
 
-	// Compute the center of the circle connecting the two points as the intersection of two circles
-	// around the two points from
-	// http://www.mathworks.com/matlabcentral/newsreader/view_thread/255121
-	float m_n, m_e, p_n, p_e, d, center[2];
-
-	// Center between start and end
-	m_n = (start_point[0] + end_point[0]) / 2;
-	m_e = (start_point[1] + end_point[1]) / 2;
-
-	// Normal vector the line between start and end.
-	if (clockwise) {
-		p_n = -(end_point[1] - start_point[1]);
-		p_e = (end_point[0] - start_point[0]);
-	} else {
-		p_n = (end_point[1] - start_point[1]);
-		p_e = -(end_point[0] - start_point[0]);		
-	}
-
-	// Work out how far to go along the perpendicular bisector
-	d = sqrtf(radius * radius / (p_n * p_n + p_e * p_e) - 0.25f);
-
-	float radius_sign = (radius > 0) ? 1 : -1;
-	radius = fabs(radius);
-
-	if (fabs(p_n) < 1e-3 && fabs(p_e) < 1e-3) {
-		center[0] = m_n;
-		center[1] = m_e;
-	} else {
-		center[0] = m_n + p_n * d * radius_sign;
-		center[1] = m_e + p_e * d * radius_sign;
-	}
-
 	// Current location relative to center
-	diff_north = cur_point[0] - center[0];
-	diff_east = cur_point[1] - center[1];
+	diff_north = cur_point[0] - segment->center[0];
+	diff_east = cur_point[1] - segment->center[1];
 
 	// Compute current radius from the center
 	cradius = sqrtf(  diff_north * diff_north   +   diff_east * diff_east );
 
 	// Compute error in terms of meters from the curve (the distance projected
 	// normal onto the path i.e. cross-track distance)
-	status->error = radius - cradius;
+	status->error = segment->radius - cradius;
 
 	if (cradius < 1e-6f) {
 		// cradius is zero, just fly somewhere and make sure correction is still a normal
 		status->fractional_progress = 1;
-		status->error = radius;
+		status->error = segment->radius;
 		status->correction_direction[0] = 0;
 		status->correction_direction[1] = 1;
 		status->path_direction[0] = 1;
@@ -325,7 +370,7 @@ static void path_curve(float * start_point,
 		return;
 	}
 
-	if (clockwise) {
+	if (segment->clockwise) {
 		// Compute the normal to the radius clockwise
 		normal[0] = -diff_east / cradius;
 		normal[1] = diff_north / cradius;
@@ -343,14 +388,11 @@ static void path_curve(float * start_point,
 	status->path_direction[0] = normal[0];
 	status->path_direction[1] = normal[1];
 
-	path_north = end_point[0] - start_point[0];
-	path_east = end_point[1] - start_point[1];
-	diff_north = cur_point[0] - start_point[0];
-	diff_east = cur_point[1] - start_point[1];
-	float dist_path = sqrtf( path_north * path_north + path_east * path_east );
-	float dot = path_north * diff_north + path_east * diff_east;
+	diff_north = cur_point[0] - segment->start[0];
+	diff_east = cur_point[1] - segment->start[1];
+	float dot = segment->path[0] * diff_north + segment->path[1] * diff_east;
 
-	status->fractional_progress = dot / (dist_path * dist_path);
+	status->fractional_progress = dot / (segment->dist_path * segment->dist_path);
 
 	status->error = fabs(status->error);
 }
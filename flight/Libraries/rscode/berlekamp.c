@@ -35,50 +35,61 @@
  *
  */
 
-#include <stdio.h>
 #include "ecc.h"
 
-/* The Error Locator Polynomial, also known as Lambda or Sigma. Lambda[0] == 1 */
-static int Lambda[MAXDEG];
+/* Working state of one correction. It lives on the stack of the caller,
+   so that several links can correct errors at the same time. */
+struct rs_decoder {
+  /* The Error Locator Polynomial, also known as Lambda or Sigma. Lambda[0] == 1 */
+  int Lambda[MAXDEG];
 
-/* The Error Evaluator Polynomial */
-static int Omega[MAXDEG];
+  /* The Error Evaluator Polynomial */
+  int Omega[MAXDEG];
+
+  /* The syndromes, as a polynomial */
+  int S[MAXDEG];
+
+  /* error locations found using Chien's search */
+  int ErrorLocs[MAXDEG];
+  int NErrors;
+
+  /* erasure flags */
+  int *ErasureLocs;
+  int NErasures;
+};
 
 /* local ANSI declarations */
 static int compute_discrepancy(int lambda[], int S[], int L, int n);
-static void init_gamma(int gamma[]);
-static void compute_modified_omega (void);
+static void init_gamma(struct rs_decoder *dec, int gamma[]);
+static void compute_modified_omega (struct rs_decoder *dec);
 static void mul_z_poly (int src[]);
-
-/* error locations found using Chien's search*/
-static int ErrorLocs[256];
-static int NErrors;
-
-/* erasure flags */
-static int ErasureLocs[256];
-static int NErasures;
+static void mult_polys(int dst[], int p1[], int p2[]);
+static void add_polys(int dst[], int src[]);
+static void scale_poly(int k, int poly[]);
+static void copy_poly(int dst[], int src[]);
+static void zero_poly(int poly[]);
 
 /* From  Cain, Clark, "Error-Correction Coding For Digital Communications", pp. 216. */
-void
-Modified_Berlekamp_Massey (void)
+static void
+Modified_Berlekamp_Massey (struct rs_decoder *dec)
 {	
   int n, L, L2, k, d, i;
   int psi[MAXDEG], psi2[MAXDEG], D[MAXDEG];
   int gamma[MAXDEG];
 	
   /* initialize Gamma, the erasure locator polynomial */
-  init_gamma(gamma);
+  init_gamma(dec, gamma);
 
   /* initialize to z */
   copy_poly(D, gamma);
   mul_z_poly(D);
 	
   copy_poly(psi, gamma);	
-  k = -1; L = NErasures;
+  k = -1; L = dec->NErasures;
 	
-  for (n = NErasures; n < RS_ECC_NPARITY; n++) {
+  for (n = dec->NErasures; n < RS_ECC_NPARITY; n++) {
 	
-    d = compute_discrepancy(psi, synBytes, L, n);
+    d = compute_discrepancy(psi, dec->S, L, n);
 		
     if (d != 0) {
 		
@@ -101,8 +112,8 @@ Modified_Berlekamp_Massey (void)
     mul_z_poly(D);
   }
 	
-  for(i = 0; i < MAXDEG; i++) Lambda[i] = psi[i];
-  compute_modified_omega();
+  for(i = 0; i < MAXDEG; i++) dec->Lambda[i] = psi[i];
+  compute_modified_omega(dec);
 
 	
 }
@@ -111,46 +122,38 @@ Modified_Berlekamp_Massey (void)
    compute the combined erasure/error evaluator polynomial as 
    Psi*S mod z^4
   */
-void
-compute_modified_omega ()
+static void
+compute_modified_omega (struct rs_decoder *dec)
 {
   int i;
   int product[MAXDEG*2];
 	
-  mult_polys(product, Lambda, synBytes);	
-  zero_poly(Omega);
-  for(i = 0; i < RS_ECC_NPARITY; i++) Omega[i] = product[i];
+  mult_polys(product, dec->Lambda, dec->S);	
+  zero_poly(dec->Omega);
+  for(i = 0; i < RS_ECC_NPARITY; i++) dec->Omega[i] = product[i];
 
 }
 
 /* polynomial multiplication */
-void
+static void
 mult_polys (int dst[], int p1[], int p2[])
 {
   int i, j;
-  int tmp1[MAXDEG*2];
 	
   for (i=0; i < (MAXDEG*2); i++) dst[i] = 0;
 	
   for (i = 0; i < MAXDEG; i++) {
-    for(j=MAXDEG; j<(MAXDEG*2); j++) tmp1[j]=0;
-		
-    /* scale tmp1 by p1[i] */
-    for(j=0; j<MAXDEG; j++) tmp1[j]=gmult(p2[j], p1[i]);
-    /* and mult (shift) tmp1 right by i */
-    for (j = (MAXDEG*2)-1; j >= i; j--) tmp1[j] = tmp1[j-i];
-    for (j = 0; j < i; j++) tmp1[j] = 0;
-		
-    /* add into partial product */
-    for(j=0; j < (MAXDEG*2); j++) dst[j] ^= tmp1[j];
+    if (p1[i] == 0) continue;
+
+    /* scale p2 by p1[i], shifted right by i, into the partial product */
+    for (j = 0; j < MAXDEG; j++) dst[i+j] ^= gmult(p2[j], p1[i]);
   }
 }
 
 
-	
 /* gamma = product (1-z*a^Ij) for erasure locs Ij */
-void
-init_gamma (int gamma[])
+static void
+init_gamma (struct rs_decoder *dec, int gamma[])
 {
   int e, tmp[MAXDEG];
 	
@@ -158,28 +161,16 @@ init_gamma (int gamma[])
   zero_poly(tmp);
   gamma[0] = 1;
 	
-  for (e = 0; e < NErasures; e++) {
+  for (e = 0; e < dec->NErasures; e++) {
     copy_poly(tmp, gamma);
-    scale_poly(gexp[ErasureLocs[e]], tmp);
+    scale_poly(gexp[dec->ErasureLocs[e]], tmp);
     mul_z_poly(tmp);
     add_polys(gamma, tmp);
   }
 }
 	
 	
-	
-void 
-compute_next_omega (int d, int A[], int dst[], int src[])
-{
-  int i;
-  for ( i = 0; i < MAXDEG;  i++) {
-    dst[i] = src[i] ^ gmult(d, A[i]);
-  }
-}
-	
-
-
-int
+static int
 compute_discrepancy (int lambda[], int S[], int L, int n)
 {
   int i, sum=0;
@@ -191,26 +182,26 @@ compute_discrepancy (int lambda[], int S[], int L, int n)
 
 /********** polynomial arithmetic *******************/
 
-void add_polys (int dst[], int src[]) 
+static void add_polys (int dst[], int src[]) 
 {
   int i;
   for (i = 0; i < MAXDEG; i++) dst[i] ^= src[i];
 }
 
-void copy_poly (int dst[], int src[]) 
+static void copy_poly (int dst[], int src[]) 
 {
   int i;
   for (i = 0; i < MAXDEG; i++) dst[i] = src[i];
 }
 
-void scale_poly (int k, int poly[]) 
+static void scale_poly (int k, int poly[]) 
 {	
   int i;
   for (i = 0; i < MAXDEG; i++) poly[i] = gmult(k, poly[i]);
 }
 
 
-void zero_poly (int poly[]) 
+static void zero_poly (int poly[]) 
 {
   int i;
   for (i = 0; i < MAXDEG; i++) poly[i] = 0;
@@ -226,31 +217,42 @@ static void mul_z_poly (int src[])
 }
 
 
-/* Finds all the roots of an error-locator polynomial with coefficients
- * Lambda[j] by evaluating Lambda at successive values of alpha. 
- * 
- * This can be tested with the decoder's equations case.
+/* Finds all the roots of an error-locator polynomial with brute force
+ * trial, Chien's search algorithm. Each term of Lambda is multiplied by
+ * its own power of a when moving to the next trial, instead of being
+ * recomputed from scratch.
+ *
+ * Returns FALSE if there are more roots than can be stored, in which
+ * case the codeword cannot be corrected anyway.
  */
-
-
-void 
-Find_Roots (void)
+static int
+Find_Roots (struct rs_decoder *dec)
 {
   int sum, r, k;	
-  NErrors = 0;
+  int termLog[RS_ECC_NPARITY+1];
+
+  dec->NErrors = 0;
+
+  for (k = 0; k < RS_ECC_NPARITY+1; k++)
+    termLog[k] = dec->Lambda[k] ? glog[dec->Lambda[k]] : -1;
   
   for (r = 1; r < 256; r++) {
     sum = 0;
     /* evaluate lambda at r */
     for (k = 0; k < RS_ECC_NPARITY+1; k++) {
-      sum ^= gmult(gexp[(k*r)%255], Lambda[k]);
+      if (termLog[k] < 0) continue;
+      termLog[k] += k;
+      if (termLog[k] >= 255) termLog[k] -= 255;
+      sum ^= gexp[termLog[k]];
     }
     if (sum == 0) 
       { 
-	ErrorLocs[NErrors] = (255-r); NErrors++; 
-	//if (DEBUG) fprintf(stderr, "Root found at r = %d, (255-r) = %d\n", r, (255-r));
+	if (dec->NErrors == MAXDEG) return (FALSE);
+	dec->ErrorLocs[dec->NErrors] = (255-r); dec->NErrors++; 
       }
   }
+
+  return (TRUE);
 }
 
 /* Combined Erasure And Error Magnitude Computation 
@@ -267,58 +269,59 @@ Find_Roots (void)
  */
 
 int
-correct_errors_erasures (unsigned char codeword[], 
+correct_errors_erasures (struct rs_ecc *rs,
+			 unsigned char codeword[], 
 			 int csize,
 			 int nerasures,
 			 int erasures[])
 {
   int r, i, j, err;
+  struct rs_decoder dec;
 
   /* If you want to take advantage of erasure correction, be sure to
      set NErasures and ErasureLocs[] with the locations of erasures. 
      */
-  NErasures = nerasures;
-  for (i = 0; i < NErasures; i++) ErasureLocs[i] = erasures[i];
+  if (nerasures > RS_ECC_NPARITY) return(0);
+  dec.NErasures = nerasures;
+  dec.ErasureLocs = erasures;
+
+  for (i = 0; i < MAXDEG; i++) dec.S[i] = rs->synBytes[i];
 
-  Modified_Berlekamp_Massey();
-  Find_Roots();
+  Modified_Berlekamp_Massey(&dec);
+  if (!Find_Roots(&dec)) return(0);
   
 
-  if ((NErrors <= RS_ECC_NPARITY) && NErrors > 0) { 
+  if ((dec.NErrors <= RS_ECC_NPARITY) && dec.NErrors > 0) { 
 
     /* first check for illegal error locs */
-    for (r = 0; r < NErrors; r++) {
-      if (ErrorLocs[r] >= csize) {
-				//if (DEBUG) fprintf(stderr, "Error loc i=%d outside of codeword length %d\n", i, csize);
+    for (r = 0; r < dec.NErrors; r++) {
+      if (dec.ErrorLocs[r] >= csize) {
 	return(0);
       }
     }
 
-    for (r = 0; r < NErrors; r++) {
+    for (r = 0; r < dec.NErrors; r++) {
       int num, denom;
-      i = ErrorLocs[r];
+      i = dec.ErrorLocs[r];
       /* evaluate Omega at alpha^(-i) */
 
       num = 0;
       for (j = 0; j < MAXDEG; j++) 
-	num ^= gmult(Omega[j], gexp[((255-i)*j)%255]);
+	num ^= gmult(dec.Omega[j], gexp[((255-i)*j)%255]);
       
       /* evaluate Lambda' (derivative) at alpha^(-i) ; all odd powers disappear */
       denom = 0;
       for (j = 1; j < MAXDEG; j += 2) {
-	denom ^= gmult(Lambda[j], gexp[((255-i)*(j-1)) % 255]);
+	denom ^= gmult(dec.Lambda[j], gexp[((255-i)*(j-1)) % 255]);
       }
       
       err = gmult(num, ginv(denom));
-      //if (DEBUG) fprintf(stderr, "Error magnitude %#x at loc %d\n", err, csize-i);
       
       codeword[csize-i-1] ^= err;
     }
     return(1);
   }
   else {
-    //if (DEBUG && NErrors) fprintf(stderr, "Uncorrectable codeword\n");
     return(0);
   }
 }
-
@@ -26,24 +26,22 @@
 
 /****************************************************************
   
-  Below is NPAR, the only compile-time parameter you should have to
-  modify.
-  
-  It is the number of parity bytes which will be appended to
-  your data to create a codeword.
+  RS_ECC_NPARITY, the number of parity bytes which will be appended
+  to your data to create a codeword, is set by the board
+  configuration.
 
   Note that the maximum codeword size is 255, so the
   sum of your message length plus parity should be less than
   or equal to this maximum limit.
 
-  In practice, you will get slooow error correction and decoding
-  if you use more than a reasonably small number of parity bytes.
-  (say, 10 or 20)
+  All of the tables are constant, and the decoder state lives in a
+  struct rs_ecc owned by the caller, so several links can encode and
+  decode at the same time.
 
   ****************************************************************/
 
 /****************************************************************/
-
+
 
 #include <openpilot.h>
 
@@ -59,40 +57,39 @@ typedef unsigned short BIT16;
 #define MAXDEG (RS_ECC_NPARITY*2)
 
 /*************************************/
-/* Encoder parity bytes */
-extern int pBytes[MAXDEG];
-
-/* Decoder syndrome bytes */
-extern int synBytes[MAXDEG];
+/* Decoder state of one link */
+struct rs_ecc {
+  /* Remainder of the last codeword divided by the generator */
+  unsigned char remainder[RS_ECC_NPARITY];
 
-/* print debugging info */
-extern int DEBUG;
+  /* Syndrome bytes, only computed when the remainder is not zero */
+  unsigned char synBytes[MAXDEG];
+};
 
 /* Reed Solomon encode/decode routines */
-void initialize_ecc (void);
-int check_syndrome (void);
-void decode_data (unsigned char data[], int nbytes);
-void encode_data (unsigned char msg[], int nbytes, unsigned char dst[]);
+void encode_data (const unsigned char msg[], int nbytes, unsigned char dst[]);
+int decode_data (struct rs_ecc *rs, const unsigned char data[], int nbytes);
+int check_syndrome (const struct rs_ecc *rs);
 
 /* CRC-CCITT checksum generator */
 BIT16 crc_ccitt(unsigned char *msg, int len);
 
-/* galois arithmetic tables */
-extern const int gexp[];
-extern const int glog[];
+/* galois arithmetic tables, gexp is doubled so that the sum of two logs
+   never has to be reduced modulo 255 */
+extern const unsigned char gexp[512];
+extern const unsigned char glog[256];
 
-void init_galois_tables (void);
-int ginv(int elt); 
-int gmult(int a, int b);
+static inline int gmult(int a, int b)
+{
+  if (a == 0 || b == 0) return (0);
+  return (gexp[glog[a] + glog[b]]);
+}
 
+static inline int ginv(int elt)
+{
+  return (gexp[255 - glog[elt]]);
+}
 
-/* Error location routines */
-int correct_errors_erasures (unsigned char codeword[], int csize,int nerasures, int erasures[]);
-
-/* polynomial arithmetic */
-void add_polys(int dst[], int src[]) ;
-void scale_poly(int k, int poly[]);
-void mult_polys(int dst[], int p1[], int p2[]);
 
-void copy_poly(int dst[], int src[]);
-void zero_poly(int poly[]);
+/* Error location routines */
+int correct_errors_erasures (struct rs_ecc *rs, unsigned char codeword[], int csize, int nerasures, int erasures[]);
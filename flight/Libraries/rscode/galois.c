@@ -31,8 +31,6 @@
  ******************************/
  
  
-#include <stdio.h>
-#include <stdlib.h>
 #include "ecc.h"
 
 /* This is one of 14 irreducible polynomials
@@ -42,7 +40,7 @@
 #define PPOLY 0x1D 
 
 
-const int gexp[512] = {
+const unsigned char gexp[512] = {
 	  1,   2,   4,   8,  16,  32,  64, 128,  29,  58, 116, 232, 205, 135,  19,  38, 
 	 76, 152,  45,  90, 180, 117, 234, 201, 143,   3,   6,  12,  24,  48,  96, 192, 
 	157,  39,  78, 156,  37,  74, 148,  53, 106, 212, 181, 119, 238, 193, 159,  35, 
@@ -76,7 +74,7 @@ const int gexp[512] = {
 	 36,  72, 144,  61, 122, 244, 245, 247, 243, 251, 235, 203, 139,  11,  22,  44, 
 	 88, 176, 125, 250, 233, 207, 131,  27,  54, 108, 216, 173,  71, 142,   1,   0, 
 };
-const int glog[256] = {
+const unsigned char glog[256] = {
 	  0,   0,   1,  25,   2,  50,  26, 198,   3, 223,  51, 238,  27, 104, 199,  75, 
 	  4, 100, 224,  14,  52, 141, 239, 129,  28, 193, 105, 248, 200,   8,  76, 113, 
 	  5, 138, 101,  47, 225,  36,  15,  33,  53, 147, 142, 218, 240,  18, 130,  69, 
@@ -94,71 +92,3 @@ const int glog[256] = {
 	203,  89,  95, 176, 156, 169, 160,  81,  11, 245,  22, 235, 122, 117,  44, 215, 
 	 79, 174, 213, 233, 230, 231, 173, 232, 116, 214, 244, 234, 168,  80,  88, 175, 
 };
-
-
-//static void init_exp_table (void);
-
-
-void
-init_galois_tables (void)
-{	
-  /* initialize the table of powers of alpha */
-  //init_exp_table();
-}
-
-
-#ifdef NEVER
-static void
-init_exp_table (void)
-{
-  int i, z;
-  int pinit,p1,p2,p3,p4,p5,p6,p7,p8;
-
-  pinit = p2 = p3 = p4 = p5 = p6 = p7 = p8 = 0;
-  p1 = 1;
-	
-  gexp[0] = 1;
-  gexp[255] = gexp[0];
-  glog[0] = 0;			/* shouldn't log[0] be an error? */
-	
-  for (i = 1; i < 256; i++) {
-    pinit = p8;
-    p8 = p7;
-    p7 = p6;
-    p6 = p5;
-    p5 = p4 ^ pinit;
-    p4 = p3 ^ pinit;
-    p3 = p2 ^ pinit;
-    p2 = p1;
-    p1 = pinit;
-    gexp[i] = p1 + p2*2 + p3*4 + p4*8 + p5*16 + p6*32 + p7*64 + p8*128;
-    gexp[i+255] = gexp[i];
-  }
-	
-  for (i = 1; i < 256; i++) {
-    for (z = 0; z < 256; z++) {
-      if (gexp[z] == i) {
-	glog[i] = z;
-	break;
-      }
-    }
-  }
-}
-#endif
-
-/* multiplication using logarithms */
-int gmult(int a, int b)
-{
-  int i,j;
-  if (a==0 || b == 0) return (0);
-  i = glog[a];
-  j = glog[b];
-  return (gexp[i+j]);
-}
-		
-
-int ginv (int elt) 
-{ 
-  return (gexp[255-glog[elt]]);
-}
-
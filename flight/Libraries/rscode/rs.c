@@ -25,183 +25,106 @@
  * Source code is available at http://rscode.sourceforge.net
  */
 
-#include <stdio.h>
-#include <ctype.h>
 #include "ecc.h"
 
-/* Encoder parity bytes */
-int pBytes[MAXDEG];
-
-/* Decoder syndrome bytes */
-int synBytes[MAXDEG];
-
-/* generator polynomial */
-int genPoly[MAXDEG*2];
-
-int DEBUG = FALSE;
+/* Logs of the coefficients of the generator polynomial, the product of
+   (x + a^n) for n = 1 to RS_ECC_NPARITY, lowest degree first. The
+   polynomial is monic, so the x^RS_ECC_NPARITY term is left out. */
+#if RS_ECC_NPARITY == 2
+static const unsigned char genPolyLog[RS_ECC_NPARITY] = { 3, 26 };
+#elif RS_ECC_NPARITY == 4
+static const unsigned char genPolyLog[RS_ECC_NPARITY] = { 10, 81, 251, 76 };
+#elif RS_ECC_NPARITY == 8
+static const unsigned char genPolyLog[RS_ECC_NPARITY] = {
+  36, 203, 3, 220, 253, 211, 240, 176 };
+#elif RS_ECC_NPARITY == 16
+static const unsigned char genPolyLog[RS_ECC_NPARITY] = {
+  136, 240, 208, 195, 181, 158, 201, 100, 11, 83, 167, 107, 113, 110, 106, 121 };
+#else
+#error "No generator polynomial for this RS_ECC_NPARITY"
+#endif
 
+/* Computes data(x) * x^RS_ECC_NPARITY modulo the generator polynomial */
 static void
-compute_genpoly (int nbytes, int genpoly[]);
-
-/* Initialize lookup tables, polynomials, etc. */
-void
-initialize_ecc ()
+compute_remainder (const unsigned char data[], int nbytes, unsigned char LFSR[])
 {
-  /* Initialize the galois field arithmetic tables */
-    init_galois_tables();
+  int i, j, dbyte, dlog;
 
-    /* Compute the encoder generator polynomial */
-    compute_genpoly(RS_ECC_NPARITY, genPoly);
-}
+  for (i = 0; i < RS_ECC_NPARITY; i++) LFSR[i] = 0;
 
-void
-zero_fill_from (unsigned char buf[], int from, int to)
-{
-  int i;
-  for (i = from; i < to; i++) buf[i] = 0;
-}
+  for (i = 0; i < nbytes; i++) {
+    dbyte = data[i] ^ LFSR[RS_ECC_NPARITY-1];
+    if (dbyte == 0) {
+      for (j = RS_ECC_NPARITY-1; j > 0; j--) LFSR[j] = LFSR[j-1];
+      LFSR[0] = 0;
+      continue;
+    }
 
-/* debugging routines */
-void
-print_parity (void)
-{
-#ifdef NEVER
-  int i;
-  printf("Parity Bytes: ");
-  for (i = 0; i < RS_ECC_NPARITY; i++) 
-    printf("[%d]:%x, ",i,pBytes[i]);
-  printf("\n");
-#endif
+    dlog = glog[dbyte];
+    for (j = RS_ECC_NPARITY-1; j > 0; j--) {
+      LFSR[j] = LFSR[j-1] ^ gexp[dlog + genPolyLog[j]];
+    }
+    LFSR[0] = gexp[dlog + genPolyLog[0]];
+  }
 }
 
 
 void
-print_syndrome (void)
+encode_data (const unsigned char msg[], int nbytes, unsigned char dst[])
 {
-#ifdef NEVER
   int i;
-  printf("Syndrome Bytes: ");
-  for (i = 0; i < RS_ECC_NPARITY; i++) 
-    printf("[%d]:%x, ",i,synBytes[i]);
-  printf("\n");
-#endif
-}
+  unsigned char LFSR[RS_ECC_NPARITY];
+
+  compute_remainder(msg, nbytes, LFSR);
+
+  if (dst != msg)
+    for (i = 0; i < nbytes; i++) dst[i] = msg[i];
 
-/* Append the parity bytes onto the end of the message */
-void
-build_codeword (unsigned char msg[], int nbytes, unsigned char dst[])
-{
-  int i;
-	
-  for (i = 0; i < nbytes; i++) dst[i] = msg[i];
-	
   for (i = 0; i < RS_ECC_NPARITY; i++) {
-    dst[i+nbytes] = pBytes[RS_ECC_NPARITY-1-i];
-  }
-}
-	
-/**********************************************************
- * Reed Solomon Decoder 
- *
- * Computes the syndrome of a codeword. Puts the results
- * into the synBytes[] array.
- */
- 
-void
-decode_data(unsigned char data[], int nbytes)
-{
-  int i, j, sum;
-  for (j = 0; j < RS_ECC_NPARITY;  j++) {
-    sum	= 0;
-    for (i = 0; i < nbytes; i++) {
-      sum = data[i] ^ gmult(gexp[j+1], sum);
-    }
-    synBytes[j]  = sum;
+    dst[i+nbytes] = LFSR[RS_ECC_NPARITY-1-i];
   }
 }
 
 
-/* Check if the syndrome is zero */
+/* Computes the syndromes of a codeword. The codeword is a multiple of
+   the generator polynomial when it has no errors, so the syndromes are
+   all zero exactly when the remainder is, and decoding stops there.
+   Otherwise they are evaluated on the remainder rather than on the
+   whole codeword. The remainder was multiplied by x^RS_ECC_NPARITY, so
+   syndrome j is divided by a^((j+1)*RS_ECC_NPARITY).
+   Returns nonzero when the codeword has errors. */
 int
-check_syndrome (void)
+decode_data (struct rs_ecc *rs, const unsigned char data[], int nbytes)
 {
- int i, nz = 0;
- for (i =0 ; i < RS_ECC_NPARITY; i++) {
-  if (synBytes[i] != 0) {
-      nz = 1;
-      break;
-  }
- }
- return nz;
-}
-
+  int i, j, sum;
 
-void
-debug_check_syndrome (void)
-{	
-#ifdef NEVER
-  int i;
-	
-  for (i = 0; i < 3; i++) {
-    printf(" inv log S[%d]/S[%d] = %d\n", i, i+1, 
-	   glog[gmult(synBytes[i], ginv(synBytes[i+1]))]);
-  }
-#endif
-}
+  compute_remainder(data, nbytes, rs->remainder);
 
+  for (i = 0; i < MAXDEG; i++) rs->synBytes[i] = 0;
 
-/* Create a generator polynomial for an n byte RS code. 
- * The coefficients are returned in the genPoly arg.
- * Make sure that the genPoly array which is passed in is 
- * at least n+1 bytes long.
- */
+  if (check_syndrome(rs) == 0)
+    return 0;
 
-static void
-compute_genpoly (int nbytes, int genpoly[])
-{
-  int i, tp[MAXDEG], tp1[MAXDEG];
-	
-  /* multiply (x + a^n) for n = 1 to nbytes */
-
-  zero_poly(tp1);
-  tp1[0] = 1;
-
-  for (i = 1; i <= nbytes; i++) {
-    zero_poly(tp);
-    tp[0] = gexp[i];		/* set up x+a^n */
-    tp[1] = 1;
-	  
-    mult_polys(genpoly, tp, tp1);
-    copy_poly(tp1, genpoly);
+  for (j = 0; j < RS_ECC_NPARITY; j++) {
+    sum = 0;
+    for (i = RS_ECC_NPARITY-1; i >= 0; i--) {
+      sum = rs->remainder[i] ^ (sum ? gexp[glog[sum] + j + 1] : 0);
+    }
+    if (sum != 0)
+      sum = gexp[(glog[sum] + 255 - ((j+1)*RS_ECC_NPARITY) % 255) % 255];
+    rs->synBytes[j] = sum;
   }
+
+  return 1;
 }
 
-/* Simulate a LFSR with generator polynomial for n byte RS code. 
- * Pass in a pointer to the data array, and amount of data. 
- *
- * The parity bytes are deposited into pBytes[], and the whole message
- * and parity are copied to dest to make a codeword.
- * 
- */
 
-void
-encode_data (unsigned char msg[], int nbytes, unsigned char dst[])
+int
+check_syndrome (const struct rs_ecc *rs)
 {
-  int i, LFSR[RS_ECC_NPARITY+1],dbyte, j;
-	
-  for(i=0; i < RS_ECC_NPARITY+1; i++) LFSR[i]=0;
-
-  for (i = 0; i < nbytes; i++) {
-    dbyte = msg[i] ^ LFSR[RS_ECC_NPARITY-1];
-    for (j = RS_ECC_NPARITY-1; j > 0; j--) {
-      LFSR[j] = LFSR[j-1] ^ gmult(genPoly[j], dbyte);
-    }
-    LFSR[0] = gmult(genPoly[0], dbyte);
-  }
-
-  for (i = 0; i < RS_ECC_NPARITY; i++) 
-    pBytes[i] = LFSR[i];
-	
-  build_codeword(msg, nbytes, dst);
+ int i;
+ for (i = 0; i < RS_ECC_NPARITY; i++) {
+  if (rs->remainder[i] != 0) return 1;
+ }
+ return 0;
 }
-
@@ -27,17 +27,46 @@
 
 #include "openpilot.h"
 //#include "taskmonitor.h"
+#if defined(DIAG_TASKS)
+#include "taskprofile.h"
+#include "taskloopprofile.h"
+#include "irqprofile.h"
+#endif
 
 // Private constants
+#define LOOP_HISTOGRAM_BUCKETS 60
 
 // Private types
 
+/**
+ * Loop period statistics of one task since the last update. The histogram
+ * bins are quarter octaves of the period in us, so the reported p99 is at
+ * most 25% above the true value.
+ */
+struct loop_stats {
+	uint32_t lastTime;
+	uint32_t count;
+	uint32_t sum;
+	uint16_t min;
+	uint16_t max;
+	uint16_t histogram[LOOP_HISTOGRAM_BUCKETS];
+};
+
 // Private variables
 static xSemaphoreHandle lock;
 static xTaskHandle handles[TASKINFO_RUNNING_NUMELEM];
 static uint32_t lastMonitorTime;
+#if defined(DIAG_TASKS)
+static struct loop_stats *loopStats[TASKINFO_RUNNING_NUMELEM];
+static uint32_t lastIrqCycles[PIOS_IRQ_PROFILE_NUM];
+#endif
 
 // Private functions
+#if defined(DIAG_TASKS)
+static uint8_t loopBucket(uint16_t period);
+static uint16_t loopBucketTop(uint8_t bucket);
+static void updateLoopProfile(TaskLoopProfileData *profile);
+#endif
 
 /**
  * Initialize library
@@ -99,6 +128,49 @@ bool TaskMonitorQueryRunning(TaskInfoRunningElem task)
 	return false;
 }
 
+/**
+ * Record one iteration of the main loop of a task. Call this once per
+ * iteration, at the same point of the loop, to profile its period.
+ */
+void TaskMonitorLoop(TaskInfoRunningElem task)
+{
+#if defined(DIAG_TASKS)
+	if (task >= TASKINFO_RUNNING_NUMELEM)
+		return;
+
+	struct loop_stats *stats = loopStats[task];
+	if (stats == NULL) {
+		// First iteration, there is no period to record yet
+		stats = pvPortMalloc(sizeof(*stats));
+		if (stats == NULL)
+			return;
+		memset(stats, 0, sizeof(*stats));
+		stats->min = UINT16_MAX;
+		stats->lastTime = PIOS_DELAY_GetRaw();
+		loopStats[task] = stats;
+		return;
+	}
+
+	uint32_t period = PIOS_DELAY_DiffuS(stats->lastTime);
+	stats->lastTime = PIOS_DELAY_GetRaw();
+	if (period > UINT16_MAX)
+		period = UINT16_MAX;
+
+	uint8_t bucket = loopBucket(period);
+
+	portENTER_CRITICAL();
+	stats->count++;
+	stats->sum += period;
+	if (period < stats->min)
+		stats->min = period;
+	if (period > stats->max)
+		stats->max = period;
+	if (stats->histogram[bucket] < UINT16_MAX)
+		stats->histogram[bucket]++;
+	portEXIT_CRITICAL();
+#endif
+}
+
 /**
  * Update the status of all tasks
  */
@@ -106,23 +178,44 @@ void TaskMonitorUpdateAll(void)
 {
 #if defined(DIAG_TASKS)
 	TaskInfoData data;
+	TaskProfileData profile;
+	TaskLoopProfileData loopProfile;
+	IRQProfileData irqProfile;
 	int n;
 
+	memset(&profile, 0, sizeof(profile));
+	memset(&loopProfile, 0, sizeof(loopProfile));
+	memset(&irqProfile, 0, sizeof(irqProfile));
+
 	// Lock
 	xSemaphoreTakeRecursive(lock, portMAX_DELAY);
 
 #if ( configGENERATE_RUN_TIME_STATS == 1 )
 	uint32_t currentTime;
 	uint32_t deltaTime;
+	uint32_t profileDeltaTime;
 	
 	/*
 	 * Calculate the amount of elapsed run time between the last time we
 	 * measured and now. Scale so that we can convert task run times
-	 * directly to percentages.
+	 * directly to percentages, and to hundredths of a percent for the
+	 * profile.
 	 */
 	currentTime = portGET_RUN_TIME_COUNTER_VALUE();
 	deltaTime = ((currentTime - lastMonitorTime) / 100) ? : 1; /* avoid divide-by-zero if the interval is too small */
+	profileDeltaTime = ((currentTime - lastMonitorTime) / 10000) ? : 1;
 	lastMonitorTime = currentTime;			
+
+	/*
+	 * The interrupt handlers count PIOS_DELAY_GetRaw() cycles, which is the
+	 * same cycle counter as the run time stats on all the STM32 targets.
+	 */
+	for (n = 0; n < PIOS_IRQ_PROFILE_NUM; ++n)
+	{
+		uint32_t cycles = pios_irq_profile_cycles[n];
+		irqProfile.Time[n] = (cycles - lastIrqCycles[n]) / profileDeltaTime;
+		lastIrqCycles[n] = cycles;
+	}
 #endif
 	
 	// Update all task information
@@ -137,8 +230,10 @@ void TaskMonitorUpdateAll(void)
 			data.StackRemaining[n] = uxTaskGetStackHighWaterMark(handles[n]) * 4;
 #endif
 #if ( configGENERATE_RUN_TIME_STATS == 1 )
-			/* Generate run time stats */
-			data.RunningTime[n] = uxTaskGetRunTime(handles[n]) / deltaTime;
+			/* Generate run time stats, this resets the task run time */
+			uint32_t runTime = uxTaskGetRunTime(handles[n]);
+			data.RunningTime[n] = runTime / deltaTime;
+			profile.RunTime[n] = runTime / profileDeltaTime;
 #endif
 			
 		}
@@ -150,14 +245,90 @@ void TaskMonitorUpdateAll(void)
 		}
 	}
 
-	// Update object
+	updateLoopProfile(&loopProfile);
+
+	// Update objects
 	TaskInfoSet(&data);
+	TaskProfileSet(&profile);
+	TaskLoopProfileSet(&loopProfile);
+	IRQProfileSet(&irqProfile);
 
 	// Done
 	xSemaphoreGiveRecursive(lock);
 #endif
 }
 
+#if defined(DIAG_TASKS)
+/**
+ * Fill in the loop period profile and restart the statistics
+ */
+static void updateLoopProfile(TaskLoopProfileData *profile)
+{
+	struct loop_stats stats;
+
+	for (int n = 0; n < TASKINFO_RUNNING_NUMELEM; ++n)
+	{
+		if (loopStats[n] == NULL)
+			continue;
+
+		portENTER_CRITICAL();
+		stats = *loopStats[n];
+		loopStats[n]->count = 0;
+		loopStats[n]->sum = 0;
+		loopStats[n]->min = UINT16_MAX;
+		loopStats[n]->max = 0;
+		memset(loopStats[n]->histogram, 0, sizeof(loopStats[n]->histogram));
+		portEXIT_CRITICAL();
+
+		if (stats.count == 0)
+			continue;
+
+		profile->LoopPeriodMin[n] = stats.min;
+		profile->LoopPeriodMean[n] = stats.sum / stats.count;
+		profile->LoopPeriodMax[n] = stats.max;
+
+		/* The p99 is the top of the bucket holding the 99th percentile */
+		profile->LoopPeriodP99[n] = stats.max;
+		uint32_t rank = stats.count - stats.count / 100;
+		uint32_t seen = 0;
+		for (uint8_t bucket = 0; bucket < LOOP_HISTOGRAM_BUCKETS; ++bucket) {
+			seen += stats.histogram[bucket];
+			if (seen >= rank) {
+				uint16_t top = loopBucketTop(bucket);
+				profile->LoopPeriodP99[n] = (top < stats.max) ? top : stats.max;
+				break;
+			}
+		}
+	}
+}
+
+/**
+ * Histogram bucket of a loop period. Periods below 4us get a bucket each,
+ * above that there are four buckets per power of two.
+ */
+static uint8_t loopBucket(uint16_t period)
+{
+	if (period < 4)
+		return period;
+
+	uint8_t exponent = 31 - __builtin_clz(period);
+	return 4 * (exponent - 1) + ((period >> (exponent - 2)) & 3);
+}
+
+/**
+ * Longest period which falls in a histogram bucket
+ */
+static uint16_t loopBucketTop(uint8_t bucket)
+{
+	if (bucket < 4)
+		return bucket;
+
+	uint8_t exponent = bucket / 4 + 1;
+	uint32_t top = ((uint32_t) (bucket % 4 + 5) << (exponent - 2)) - 1;
+	return (top > UINT16_MAX) ? UINT16_MAX : top;
+}
+#endif
+
 /**
  * @}
  */
\ No newline at end of file
@@ -69,10 +69,6 @@ static xTaskHandle taskHandle;
 
 static float lastResult[MAX_MIX_ACTUATORS]={0,0,0,0,0,0,0,0};
 static float filterAccumulator[MAX_MIX_ACTUATORS]={0,0,0,0,0,0,0,0};
-// used to inform the actuator thread that actuator update rate is changed
-static volatile bool actuator_settings_updated;
-// used to inform the actuator thread that mixer settings are changed
-static volatile bool mixer_settings_updated;
 
 // Private functions
 static void actuatorTask(void* parameters);
@@ -81,8 +77,6 @@ static void setFailsafe(const ActuatorSettingsData * actuatorSettings, const Mix
 static float MixerCurve(const float throttle, const float* curve, uint8_t elements);
 static bool set_channel(uint8_t mixer_channel, uint16_t value, const ActuatorSettingsData * actuatorSettings);
 static void actuator_update_rate_if_changed(const ActuatorSettingsData * actuatorSettings, bool force_update);
-static void MixerSettingsUpdatedCb(UAVObjEvent * ev);
-static void ActuatorSettingsUpdatedCb(UAVObjEvent * ev);
 float ProcessMixer(const int index, const float curve1, const float curve2,
 		   const MixerSettingsData* mixerSettings, ActuatorDesiredData* desired,
 		   const float period);
@@ -113,13 +107,9 @@ int32_t ActuatorStart()
  */
 int32_t ActuatorInitialize()
 {
-	// Register for notification of changes to ActuatorSettings
+	// Settings, polled by the task for changes
 	ActuatorSettingsInitialize();
-	ActuatorSettingsConnectCallback(ActuatorSettingsUpdatedCb);
-
-	// Register for notification of changes to MixerSettings
 	MixerSettingsInitialize();
-	MixerSettingsConnectCallback(MixerSettingsUpdatedCb);
 
 	// Listen for ActuatorDesired updates (Primary input to this module)
 	ActuatorDesiredInitialize();
@@ -165,13 +155,13 @@ static void actuatorTask(void* parameters)
 
 	/* Read initial values of ActuatorSettings */
 	ActuatorSettingsData actuatorSettings;
-	actuator_settings_updated = false;
-	ActuatorSettingsGet(&actuatorSettings);
+	uint16_t actuatorSettingsEpoch = 0;
+	ActuatorSettingsGetIfChanged(&actuatorSettings, &actuatorSettingsEpoch);
 
 	/* Read initial values of MixerSettings */
 	MixerSettingsData mixerSettings;
-	mixer_settings_updated = false;
-	MixerSettingsGet(&mixerSettings);
+	uint16_t mixerSettingsEpoch = 0;
+	MixerSettingsGetIfChanged(&mixerSettings, &mixerSettingsEpoch);
 
 	/* Force an initial configuration of the actuator update rates */
 	actuator_update_rate_if_changed(&actuatorSettings, true);
@@ -184,20 +174,16 @@ static void actuatorTask(void* parameters)
 	while (1)
 	{
 		PIOS_WDG_UpdateFlag(PIOS_WDG_ACTUATOR);
+		TaskMonitorLoop(TASKINFO_RUNNING_ACTUATOR);
 
 		// Wait until the ActuatorDesired object is updated
 		uint8_t rc = xQueueReceive(queue, &ev, MS2TICKS(FAILSAFE_TIMEOUT_MS));
 
-		/* Process settings updated events even in timeout case so we always act on the latest settings */
-		if (actuator_settings_updated) {
-			actuator_settings_updated = false;
-			ActuatorSettingsGet (&actuatorSettings);
+		/* Check the settings even in timeout case so we always act on the latest settings */
+		if (ActuatorSettingsGetIfChanged(&actuatorSettings, &actuatorSettingsEpoch) > 0) {
 			actuator_update_rate_if_changed (&actuatorSettings, false);
 		}
-		if (mixer_settings_updated) {
-			mixer_settings_updated = false;
-			MixerSettingsGet (&mixerSettings);
-		}
+		MixerSettingsGetIfChanged(&mixerSettings, &mixerSettingsEpoch);
 
 		if (rc != pdTRUE) {
 			/* Update of ActuatorDesired timed out.  Go to failsafe */
@@ -720,16 +706,6 @@ static void actuator_update_rate_if_changed(const ActuatorSettingsData * actuato
 	}
 }
 
-static void ActuatorSettingsUpdatedCb(UAVObjEvent * ev)
-{
-	actuator_settings_updated = true;
-}
-
-static void MixerSettingsUpdatedCb(UAVObjEvent * ev)
-{
-	mixer_settings_updated = true;
-}
-
 /**
  * @}
  * @}
@@ -71,11 +71,11 @@
 static xTaskHandle altitudeHoldTaskHandle;
 static xQueueHandle queue;
 static AltitudeHoldSettingsData altitudeHoldSettings;
+static uint16_t altitudeHoldSettingsEpoch;
 static bool module_enabled;
 
 // Private functions
 static void altitudeHoldTask(void *parameters);
-static void SettingsUpdatedCb(UAVObjEvent * ev);
 
 /**
  * Initialise the module, called on startup
@@ -119,8 +119,6 @@ int32_t AltitudeHoldInitialize()
 		// Create object queue
 		queue = xQueueCreate(MAX_QUEUE_SIZE, sizeof(UAVObjEvent));
 
-		AltitudeHoldSettingsConnectCallback(&SettingsUpdatedCb);
-
 		return 0;
 	}
 
@@ -151,8 +149,8 @@ static void altitudeHoldTask(void *parameters)
 	portTickType last_update_time_ms = TICKS2MS(xTaskGetTickCount());
 	UAVObjEvent ev;
 
-	// Force update of the settings
-	SettingsUpdatedCb(&ev);
+	// Load the settings, after this they are only copied again when changed
+	AltitudeHoldSettingsGetIfChanged(&altitudeHoldSettings, &altitudeHoldSettingsEpoch);
 
 	// Listen for updates.
 	AltitudeHoldDesiredConnectQueue(queue);
@@ -175,7 +173,11 @@ static void altitudeHoldTask(void *parameters)
 
 			// Todo: Add alarm if it should be running
 			continue;
-		} else if (ev.obj == BaroAltitudeHandle()) {
+		}
+
+		AltitudeHoldSettingsGetIfChanged(&altitudeHoldSettings, &altitudeHoldSettingsEpoch);
+
+		if (ev.obj == BaroAltitudeHandle()) {
 			baro_updated = true;
 
 			init = (init == WAITING_BARO) ? WAITIING_INIT : init;
@@ -407,8 +409,3 @@ static void altitudeHoldTask(void *parameters)
 
 	}
 }
-
-static void SettingsUpdatedCb(UAVObjEvent * ev)
-{
-	AltitudeHoldSettingsGet(&altitudeHoldSettings);
-}
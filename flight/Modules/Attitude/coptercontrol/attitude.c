@@ -46,6 +46,7 @@
 #include "flightstatus.h"
 #include "manualcontrolcommand.h"
 #include "coordinate_conversions.h"
+#include "fast_math.h"
 #include <pios_board_info.h>
  
 // Private constants
@@ -277,6 +278,7 @@ static void AttitudeTask(void *parameters)
 		}
 		
 		PIOS_WDG_UpdateFlag(PIOS_WDG_ATTITUDE);
+		TaskMonitorLoop(TASKINFO_RUNNING_ATTITUDE);
 
 		AccelsData accels;
 		GyrosData gyros;
@@ -658,15 +660,16 @@ static void updateAttitude(AccelsData * accelsData, GyrosData * gyrosData)
 	}
 	
 	// Renomalize
-	float qmag = sqrtf(q[0]*q[0] + q[1]*q[1] + q[2]*q[2] + q[3]*q[3]);
-	q[0] = q[0] / qmag;
-	q[1] = q[1] / qmag;
-	q[2] = q[2] / qmag;
-	q[3] = q[3] / qmag;
+	float qmag_sq = q[0]*q[0] + q[1]*q[1] + q[2]*q[2] + q[3]*q[3];
+	float qmag_inv = fast_invsqrtf(qmag_sq);
+	q[0] = q[0] * qmag_inv;
+	q[1] = q[1] * qmag_inv;
+	q[2] = q[2] * qmag_inv;
+	q[3] = q[3] * qmag_inv;
 	
 	// If quaternion has become inappropriately short or is nan reinit.
 	// THIS SHOULD NEVER ACTUALLY HAPPEN
-	if((fabs(qmag) < 1e-3) || (qmag != qmag)) {
+	if((qmag_sq < 1e-6f) || (qmag_sq != qmag_sq)) {
 		q[0] = 1;
 		q[1] = 0;
 		q[2] = 0;
@@ -794,8 +797,8 @@ static void settingsUpdatedCb(UAVObjEvent * objEv) {
 
 		psi = attitudeSettings.BoardRotation[ATTITUDESETTINGS_BOARDROTATION_YAW] * DEG2RAD / 100.0f;
 
-		float cP = cosf(psi);
-		float sP = sinf(psi);
+		float cP, sP;
+		fast_sincosf(psi, &sP, &cP);
 
 		// In case psi is too small, we have to use a different equation to solve for theta
 		if (fabsf(psi) > PI / 2)
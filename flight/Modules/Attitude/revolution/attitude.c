@@ -69,6 +69,7 @@
 #include "systemalarms.h"
 #include "velocityactual.h"
 #include "coordinate_conversions.h"
+#include "fast_math.h"
 
 // Private constants
 #define STACK_SIZE_BYTES 2448
@@ -349,6 +350,7 @@ static void AttitudeTask(void *parameters)
 			first_run = false;
 
 		PIOS_WDG_UpdateFlag(PIOS_WDG_ATTITUDE);
+		TaskMonitorLoop(TASKINFO_RUNNING_ATTITUDE);
 	}
 }
 
@@ -616,16 +618,16 @@ static int32_t updateAttitudeComplementary(bool first_run, bool secondary)
 	}
 
 	// Renomalize
-	float qmag;
-	qmag = sqrtf(cf_q[0]*cf_q[0] + cf_q[1]*cf_q[1] + cf_q[2]*cf_q[2] + cf_q[3]*cf_q[3]);
-	cf_q[0] = cf_q[0] / qmag;
-	cf_q[1] = cf_q[1] / qmag;
-	cf_q[2] = cf_q[2] / qmag;
-	cf_q[3] = cf_q[3] / qmag;
+	float qmag_sq = cf_q[0]*cf_q[0] + cf_q[1]*cf_q[1] + cf_q[2]*cf_q[2] + cf_q[3]*cf_q[3];
+	float qmag_inv = fast_invsqrtf(qmag_sq);
+	cf_q[0] = cf_q[0] * qmag_inv;
+	cf_q[1] = cf_q[1] * qmag_inv;
+	cf_q[2] = cf_q[2] * qmag_inv;
+	cf_q[3] = cf_q[3] * qmag_inv;
 
 	// If quaternion has become inappropriately short or is nan reinit.
 	// THIS SHOULD NEVER ACTUALLY HAPPEN
-	if((fabsf(qmag) < 1.0e-3f) || (qmag != qmag)) {
+	if((qmag_sq < 1.0e-6f) || (qmag_sq != qmag_sq)) {
 		cf_q[0] = 1;
 		cf_q[1] = 0;
 		cf_q[2] = 0;
@@ -762,6 +764,7 @@ static void accumulate_gyro(GyrosData *gyrosData)
 
 #include "insgps.h"
 static bool home_location_updated;
+static bool home_be_updated;
 /**
  * @brief Use the INSGPS fusion algorithm in either indoor or outdoor mode (use GPS)
  * @params[in] first_run This is the first run so trigger reinitialization
@@ -945,6 +948,12 @@ static int32_t updateAttitudeINSGPS(bool first_run, bool outdoor_mode)
 	if (!inited)
 		return 0;
 
+	// Only the magnetic field moved, which does not need a reinit
+	if (home_be_updated) {
+		home_be_updated = false;
+		INSSetMagNorth(homeLocation.Be);
+	}
+
 	// Have a minimum requirement for gps usage a little more liberal than initialization
 	gps_updated &= (gpsData.Satellites >= 6) && (gpsData.PDOP <= 4.0f) && (homeLocation.Set == HOMELOCATION_SET_TRUE);
 
@@ -1161,11 +1170,22 @@ static void settingsUpdatedCb(UAVObjEvent * ev)
 		uint8_t armed;
 		FlightStatusArmedGet(&armed);
 
-		// Do not update the home location while armed as this can blow up the 
-		// filter.  This will need to be overhauled to handle long distance
-		// flights
-		if (armed == FLIGHTSTATUS_ARMED_DISARMED) {
-			HomeLocationGet(&homeLocation);
+		HomeLocationData newHome;
+		HomeLocationGet(&newHome);
+
+		// Compare every field but Be
+		HomeLocationData sameBe = newHome;
+		memcpy(sameBe.Be, homeLocation.Be, sizeof(sameBe.Be));
+
+		if (ev != NULL && memcmp(&sameBe, &homeLocation, sizeof(sameBe)) == 0) {
+			// Only Be changed, as the GPS module does when tracking the field
+			// along the flight. This is safe to apply while armed.
+			memcpy(homeLocation.Be, newHome.Be, sizeof(homeLocation.Be));
+			home_be_updated = true;
+		} else if (armed == FLIGHTSTATUS_ARMED_DISARMED) {
+			// Do not update the home location while armed as this can blow up the
+			// filter.
+			homeLocation = newHome;
 			// Compute matrix to convert deltaLLA to NED
 			float lat, alt;
 			lat = homeLocation.Latitude / 10.0e6f * DEG2RAD;
@@ -36,7 +36,6 @@
 #include "flightstatus.h"
 #include "modulesettings.h"
 #include "manualcontrolcommand.h"
-#include "manualcontrolsettings.h"
 #include "relaytuning.h"
 #include "relaytuningsettings.h"
 #include "stabilizationdesired.h"
@@ -113,6 +112,12 @@ static void AutotuneTask(void *parameters)
 
 	portTickType lastUpdateTime = xTaskGetTickCount();
 
+	// Settings are only copied again when they change
+	StabilizationSettingsData stabSettings;
+	uint16_t stabSettingsEpoch = 0;
+	RelayTuningSettingsData relaySettings;
+	uint16_t relaySettingsEpoch = 0;
+
 	while(1) {
 
 		PIOS_WDG_UpdateFlag(PIOS_WDG_AUTOTUNE);
@@ -138,17 +143,12 @@ static void AutotuneTask(void *parameters)
 		StabilizationDesiredData stabDesired;
 		StabilizationDesiredGet(&stabDesired);
 
-		StabilizationSettingsData stabSettings;
-		StabilizationSettingsGet(&stabSettings);
-
-		ManualControlSettingsData manualSettings;
-		ManualControlSettingsGet(&manualSettings);
+		StabilizationSettingsGetIfChanged(&stabSettings, &stabSettingsEpoch);
 
 		ManualControlCommandData manualControl;
 		ManualControlCommandGet(&manualControl);
 
-		RelayTuningSettingsData relaySettings;
-		RelayTuningSettingsGet(&relaySettings);
+		RelayTuningSettingsGetIfChanged(&relaySettings, &relaySettingsEpoch);
 
 		bool rate = relaySettings.Mode == RELAYTUNINGSETTINGS_MODE_RATE;
 
@@ -81,6 +81,7 @@
 static bool module_enabled = false;
 static xTaskHandle pathfollowerTaskHandle;
 static PathDesiredData pathDesired;
+static struct path_segment pathSegment;
 static PathStatusData pathStatus;
 static FixedWingPathFollowerSettingsData fixedwingpathfollowerSettings;
 static FixedWingAirspeedsData fixedWingAirspeeds;
@@ -272,7 +273,7 @@ static void updatePathVelocity()
 	float cur[3] = {positionActual.North, positionActual.East, positionActual.Down};
 	struct path_status progress;
 
-	path_progress(&pathDesired, cur, &progress);
+	path_progress(&pathDesired, &pathSegment, cur, &progress);
 	
 	float groundspeed = 0;
 	float altitudeSetpoint = 0;
@@ -34,21 +34,37 @@
 #include "flightplanstatus.h"
 #include "flightplancontrol.h"
 #include "flightplansettings.h"
+#include "pios_flashfs.h"
 
 // Private constants
 #define STACK_SIZE_BYTES 1500
 #define TASK_PRIORITY (tskIDLE_PRIORITY+1)
 #define MAX_QUEUE_SIZE 2
 
+/* Plan images in the settings flash are stored with this object id, the    */
+/* instance id is the chunk number. Instance 0 holds the image length.      */
+#define PLAN_IMAGE_OBJ_ID     0xF1A9B7E0
+#define PLAN_IMAGE_CHUNK_SIZE 128
+#define PLAN_IMAGE_MAX_SIZE   2048
+#define PLAN_IMAGE_FILE       "flightplan.img"
+
 // Private types
 
 // Private variables
 static xTaskHandle taskHandle;
 static xQueueHandle queue;
+static bool vmReady;
+static uint8_t vmPlan;
+static uint8_t *planImage;
 
 // Private functions
 static void flightPlanTask(void *parameters);
 static void objectUpdatedCb(UAVObjEvent * ev);
+static int32_t vmInit(uint8_t plan);
+static int32_t loadPlanImage(uint8_t plan);
+static void vmReset(void);
+
+extern uintptr_t pios_uavo_settings_fs_id;
 
 // External variables (temporary, TODO: this will be loaded from the SD card)
 extern unsigned char usrlib_img[];
@@ -73,6 +89,8 @@ int32_t FlightPlanStart()
 int32_t FlightPlanInitialize()
 {
 	taskHandle = NULL;
+	vmReady = false;
+	planImage = NULL;
 	
 	FlightPlanStatusInitialize();
 	FlightPlanControlInitialize();
@@ -99,6 +117,7 @@ static void flightPlanTask(void *parameters)
 	PmReturn_t retval;
 	FlightPlanStatusData status;
 	FlightPlanControlData control;
+	FlightPlanSettingsData settings;
 
 	// Setup status object
 	status.Status = FLIGHTPLANSTATUS_STATUS_STOPPED;
@@ -119,16 +138,28 @@ static void flightPlanTask(void *parameters)
 		FlightPlanControlGet(&control);
 		if ( control.Command == FLIGHTPLANCONTROL_COMMAND_START )
 		{
-			// Init PyMite
-			retval = pm_init(MEMSPACE_PROG, usrlib_img);
-			if (retval == PM_RET_OK)
+			FlightPlanSettingsGet(&settings);
+
+			// The VM and its images are kept loaded between runs, they are
+			// only reloaded after a failure or when another plan is selected
+			if (!vmReady || vmPlan != settings.Plan)
+				vmInit(settings.Plan);
+
+			if (vmReady)
 			{
 				// Update status
 				FlightPlanStatusGet(&status);
 				status.Status = FLIGHTPLANSTATUS_STATUS_RUNNING;
 				FlightPlanStatusSet(&status);
-				// Run the test script (TODO: load from SD card)
-				retval = pm_run((uint8_t *)"test");
+				// Run the selected script within its bytecode budget
+				plat_setBytecodeBudget(settings.InstructionBudget, settings.Period);
+				if (settings.Plan == FLIGHTPLANSETTINGS_PLAN_BUILTIN)
+					retval = pm_run((uint8_t *)"test");
+				else if (settings.Plan == FLIGHTPLANSETTINGS_PLAN_BENCHMARK)
+					retval = pm_run((uint8_t *)"benchmark");
+				else
+					retval = pm_run((uint8_t *)"plan");
+				plat_setBytecodeBudget(0, 0);
 				// Check if an error or exception was thrown
 				if (retval == PM_RET_OK || retval == PM_RET_EX_EXIT)
 				{
@@ -223,6 +254,14 @@ static void flightPlanTask(void *parameters)
 				// Get file ID and line number of error (if one)
 				status.ErrorFileID = gVmGlobal.errFileId;
 				status.ErrorLineNum = gVmGlobal.errLineNum;
+
+				// Python exceptions leave the VM usable, anything else
+				// may have left the heap in an unknown state
+				if (retval == PM_RET_OK || (retval >= PM_RET_EX && retval <= PM_RET_EX_WARN &&
+						retval != PM_RET_EX_MEM && retval != PM_RET_EX_SYS))
+					vmReset();
+				else
+					vmReady = false;
 			}
 			else
 			{
@@ -236,6 +275,95 @@ static void flightPlanTask(void *parameters)
 	}
 }
 
+/**
+ * Initialize the VM and add the image holding the selected plan to its path
+ * @param[in] plan One of FLIGHTPLANSETTINGS_PLAN_*
+ * @return 0 if the VM is ready, -1 otherwise
+ */
+static int32_t vmInit(uint8_t plan)
+{
+	vmReady = false;
+
+	if (pm_init(MEMSPACE_PROG, usrlib_img) != PM_RET_OK)
+		return -1;
+
+	if (plan == FLIGHTPLANSETTINGS_PLAN_SETTINGSFLASH || plan == FLIGHTPLANSETTINGS_PLAN_SDCARD) {
+		if (loadPlanImage(plan) != 0)
+			return -1;
+		if (img_appendToPath(MEMSPACE_RAM, planImage) != PM_RET_OK)
+			return -1;
+	}
+
+	vmPlan = plan;
+	vmReady = true;
+
+	return 0;
+}
+
+/**
+ * Prepare the VM for the next run. The thread of a script which ended with an
+ * exception is still in the thread list, and the objects created by the last
+ * run are only released by the garbage collector.
+ */
+static void vmReset(void)
+{
+	list_clear((pPmObj_t)gVmGlobal.threadList);
+	gVmGlobal.pthread = C_NULL;
+	heap_gcRun();
+}
+
+/**
+ * Load a plan image from the settings flash or the SD card into RAM. The
+ * buffer is allocated on first use and kept, as the VM reads the code objects
+ * in place.
+ * @param[in] plan FLIGHTPLANSETTINGS_PLAN_SETTINGSFLASH or FLIGHTPLANSETTINGS_PLAN_SDCARD
+ * @return 0 on success, -1 otherwise
+ */
+static int32_t loadPlanImage(uint8_t plan)
+{
+	if (planImage == NULL) {
+		planImage = pvPortMalloc(PLAN_IMAGE_MAX_SIZE);
+		if (planImage == NULL)
+			return -1;
+	}
+
+	if (plan == FLIGHTPLANSETTINGS_PLAN_SETTINGSFLASH) {
+		uint32_t length;
+
+		if (PIOS_FLASHFS_ObjLoad(pios_uavo_settings_fs_id, PLAN_IMAGE_OBJ_ID, 0,
+				(uint8_t *) &length, sizeof(length)) != 0)
+			return -1;
+		if (length == 0 || length > PLAN_IMAGE_MAX_SIZE)
+			return -1;
+
+		// Chunks are always stored whole, the last one is padded
+		for (uint32_t i = 0; i * PLAN_IMAGE_CHUNK_SIZE < length; i++) {
+			if (PIOS_FLASHFS_ObjLoad(pios_uavo_settings_fs_id, PLAN_IMAGE_OBJ_ID, i + 1,
+					&planImage[i * PLAN_IMAGE_CHUNK_SIZE], PLAN_IMAGE_CHUNK_SIZE) != 0)
+				return -1;
+		}
+
+		return 0;
+	}
+
+#if defined(SIM_POSIX)
+	if (plan == FLIGHTPLANSETTINGS_PLAN_SDCARD) {
+		FILE *file = fopen(PLAN_IMAGE_FILE, "r");
+		size_t length;
+
+		if (file == NULL)
+			return -1;
+		length = fread(planImage, 1, PLAN_IMAGE_MAX_SIZE, file);
+		fclose(file);
+
+		return (length > 0) ? 0 : -1;
+	}
+#endif /* SIM_POSIX */
+
+	/* SD card images are only read on the simulator for now */
+	return -1;
+}
+
 /**
  * Function called in response to object updates.
  * Used to force kill the VM thread.
@@ -270,6 +398,8 @@ static void objectUpdatedCb(UAVObjEvent * ev)
 				TaskMonitorRemove(TASKINFO_RUNNING_FLIGHTPLAN);
 				vTaskDelete(taskHandle);
 				taskHandle = NULL;
+				// The VM was stopped in the middle of a bytecode
+				vmReady = false;
 				// Update status object
 				statusData.Status = FLIGHTPLANSTATUS_STATUS_STOPPED;
 				statusData.ErrorFileID = 0;
@@ -0,0 +1,32 @@
+import sys
+import openpilot
+import flightplanstatus
+
+# Compares the cost of updating one field through a full object read and
+# write with the single field accessors. The results are left in
+# FlightPlanStatus.Debug, in CPU cycles per iteration (microseconds on the
+# simulator).
+
+ITERATIONS = 100
+
+fpStatus = flightplanstatus.FlightPlanStatus()
+
+n = 0
+start = openpilot.cycles()
+while n < ITERATIONS:
+	n = n+1
+	fpStatus.read()
+	fpStatus.Debug.value[0] = n
+	fpStatus.write()
+wholeObject = (openpilot.cycles() - start) / ITERATIONS
+
+n = 0
+start = openpilot.cycles()
+while n < ITERATIONS:
+	n = n+1
+	fpStatus.get(fpStatus.Debug, 0)
+	fpStatus.set(fpStatus.Debug, 0, n)
+singleField = (openpilot.cycles() - start) / ITERATIONS
+
+openpilot.debug(wholeObject, singleField)
+sys.exit()
@@ -59,6 +59,9 @@ def delay(timeToDelayMs):
 	 
 	// Delay
 	vTaskDelay(timeToDelayTicks);
+
+	// The script gave way on its own, start a new budget period
+	plat_refillBytecodeBudget();
  
 	return PM_RET_OK;
 	"""
@@ -113,6 +116,9 @@ def delayUntil(lastWakeTimeMs, timeToDelayMs):
 	// Delay
 	vTaskDelayUntil(&lastWakeTimeTicks, timeToDelayTicks);
 
+	// The script gave way on its own, start a new budget period
+	plat_refillBytecodeBudget();
+
   // Return an int object with the time value */
 	retval = int_new(TICKS2MS((int32_t) lastWakeTimeTicks), &pobjret);
   NATIVE_SET_TOS(pobjret);
@@ -120,6 +126,19 @@ def delayUntil(lastWakeTimeMs, timeToDelayMs):
 	"""
 	pass
 
+# Returns a free running counter, in CPU cycles on the STM32 targets and in
+# microseconds on the simulator. Used to benchmark scripts.
+def cycles():
+	"""__NATIVE__
+	pPmObj_t pobjret;
+	PmReturn_t retval;
+
+	retval = int_new((int32_t)PIOS_DELAY_GetRaw(), &pobjret);
+	NATIVE_SET_TOS(pobjret);
+	return retval;
+	"""
+	pass
+
 # Update FlightPlanStatus debug fields
 def debug(val1, val2):
 	"""__NATIVE__
@@ -36,10 +36,205 @@
 #define TYPE_FLOAT32 6
 #define TYPE_ENUM 7
 
+// Size in bytes of each field type
+static const uint8_t typeSizes[] = { 1, 2, 4, 1, 2, 4, 4, 1 };
+
+// Direct mapped cache of the objects used through getValue and setValue,
+// so that scripts do not search the object list on every access
+#define HANDLE_CACHE_SIZE 8
+static struct {
+	uint32_t objId;
+	UAVObjHandle handle;
+} handleCache[HANDLE_CACHE_SIZE];
+
+static UAVObjHandle getCachedHandle(uint32_t objId)
+{
+	uint32_t slot = objId % HANDLE_CACHE_SIZE;
+
+	if (handleCache[slot].handle == NULL || handleCache[slot].objId != objId)
+	{
+		handleCache[slot].handle = UAVObjGetByID(objId);
+		handleCache[slot].objId = objId;
+	}
+	return handleCache[slot].handle;
+}
+
 """
 
 from list import append
 
+# Reads a single field element straight from the object, without converting
+# the whole object like UAVObject.read(). The byte offset of each field is
+# generated into the object classes.
+def getValue(objId, instId, ftype, offset, numElements, index):
+	"""__NATIVE__
+	pPmObj_t args[6];
+	pPmObj_t value;
+	PmReturn_t retval;
+	UAVObjHandle objHandle;
+	uint32_t type;
+	uint8_t data[4];
+	uint8_t i;
+
+	if (NATIVE_GET_NUM_ARGS() != 6)
+	{
+		PM_RAISE(retval, PM_RET_EX_TYPE);
+		return retval;
+	}
+	for (i = 0; i < 6; ++i)
+	{
+		args[i] = NATIVE_GET_LOCAL(i);
+		if (OBJ_GET_TYPE(args[i]) != OBJ_TYPE_INT)
+		{
+			PM_RAISE(retval, PM_RET_EX_TYPE);
+			return retval;
+		}
+	}
+	type = ((pPmInt_t) args[2])->val;
+	if (type > TYPE_ENUM)
+	{
+		PM_RAISE(retval, PM_RET_EX_TYPE);
+		return retval;
+	}
+
+	// The offset only stays within the field for a valid element index
+	if (((pPmInt_t) args[5])->val < 0 ||
+		((pPmInt_t) args[5])->val >= ((pPmInt_t) args[4])->val)
+	{
+		PM_RAISE(retval, PM_RET_EX_INDX);
+		return retval;
+	}
+
+	objHandle = getCachedHandle(((pPmInt_t) args[0])->val);
+	if (objHandle == NULL)
+	{
+		PM_RAISE(retval, PM_RET_EX_VAL);
+		return retval;
+	}
+
+	if (UAVObjGetInstanceDataField(objHandle, ((pPmInt_t) args[1])->val, data,
+			((pPmInt_t) args[3])->val + ((pPmInt_t) args[5])->val * typeSizes[type],
+			typeSizes[type]) != 0)
+	{
+		PM_RAISE(retval, PM_RET_EX_INDX);
+		return retval;
+	}
+
+	switch (type)
+	{
+		case TYPE_INT8:
+			retval = int_new(*(int8_t *)data, &value);
+			break;
+		case TYPE_UINT8:
+		case TYPE_ENUM:
+			retval = int_new(data[0], &value);
+			break;
+		case TYPE_INT16:
+			retval = int_new(*(int16_t *)data, &value);
+			break;
+		case TYPE_UINT16:
+			retval = int_new(*(uint16_t *)data, &value);
+			break;
+		case TYPE_FLOAT32:
+			retval = float_new(*(float *)data, &value);
+			break;
+		default:
+			retval = int_new(*(int32_t *)data, &value);
+			break;
+	}
+	PM_RETURN_IF_ERROR(retval);
+
+	NATIVE_SET_TOS(value);
+	return PM_RET_OK;
+	"""
+	pass
+
+# Writes a single field element straight into the object
+def setValue(objId, instId, ftype, offset, numElements, index, value):
+	"""__NATIVE__
+	pPmObj_t args[6];
+	pPmObj_t value;
+	PmReturn_t retval;
+	UAVObjHandle objHandle;
+	uint32_t type;
+	int32_t intValue;
+	float floatValue;
+	uint8_t data[4];
+	uint8_t i;
+
+	if (NATIVE_GET_NUM_ARGS() != 7)
+	{
+		PM_RAISE(retval, PM_RET_EX_TYPE);
+		return retval;
+	}
+	for (i = 0; i < 6; ++i)
+	{
+		args[i] = NATIVE_GET_LOCAL(i);
+		if (OBJ_GET_TYPE(args[i]) != OBJ_TYPE_INT)
+		{
+			PM_RAISE(retval, PM_RET_EX_TYPE);
+			return retval;
+		}
+	}
+	type = ((pPmInt_t) args[2])->val;
+	if (type > TYPE_ENUM)
+	{
+		PM_RAISE(retval, PM_RET_EX_TYPE);
+		return retval;
+	}
+
+	// The offset only stays within the field for a valid element index
+	if (((pPmInt_t) args[5])->val < 0 ||
+		((pPmInt_t) args[5])->val >= ((pPmInt_t) args[4])->val)
+	{
+		PM_RAISE(retval, PM_RET_EX_INDX);
+		return retval;
+	}
+
+	// Accept both ints and floats, like UAVObject.write()
+	value = NATIVE_GET_LOCAL(6);
+	if (OBJ_GET_TYPE(value) == OBJ_TYPE_INT)
+	{
+		intValue = ((pPmInt_t) value)->val;
+		floatValue = (float) intValue;
+	}
+	else if (OBJ_GET_TYPE(value) == OBJ_TYPE_FLT)
+	{
+		floatValue = ((pPmFloat_t) value)->val;
+		intValue = (int32_t) floatValue;
+	}
+	else
+	{
+		PM_RAISE(retval, PM_RET_EX_TYPE);
+		return retval;
+	}
+
+	objHandle = getCachedHandle(((pPmInt_t) args[0])->val);
+	if (objHandle == NULL)
+	{
+		PM_RAISE(retval, PM_RET_EX_VAL);
+		return retval;
+	}
+
+	// Little endian targets only, the lowest bytes hold the narrower types
+	if (type == TYPE_FLOAT32)
+		memcpy(data, &floatValue, 4);
+	else
+		memcpy(data, &intValue, 4);
+
+	if (UAVObjSetInstanceDataField(objHandle, ((pPmInt_t) args[1])->val, data,
+			((pPmInt_t) args[3])->val + ((pPmInt_t) args[5])->val * typeSizes[type],
+			typeSizes[type]) != 0)
+	{
+		PM_RAISE(retval, PM_RET_EX_INDX);
+		return retval;
+	}
+
+	NATIVE_SET_TOS(PM_NONE);
+	return PM_RET_OK;
+	"""
+	pass
+
 class UAVObjectMetadata:
 	class UpdateMode:
 		PERIODIC = 0 
@@ -82,9 +277,10 @@ class UAVObjectField:
 		FLOAT32 = 6
 		ENUM = 7
 		 
-	def __init__(self, ftype, numElements):
+	def __init__(self, ftype, numElements, offset=0):
 		self.ftype = ftype
 		self.numElements = numElements
+		self.offset = offset
 		if ftype == UAVObjectField.FType.FLOAT32:
 			if numElements == 1:
 				self.value = 0.0
@@ -109,6 +305,14 @@ class UAVObject:
 
 	def addField(self, field):
 		append(self.fields, field)
+
+	# Reads one element of a field directly from the object
+	def get(self, field, index=0):
+		return getValue(self.objId, self.instId, field.ftype, field.offset, field.numElements, index)
+
+	# Writes one element of a field directly to the object
+	def set(self, field, index, value):
+		setValue(self.objId, self.instId, field.ftype, field.offset, field.numElements, index, value)
 	'''
 	#
 	# Support for getName was removed from embedded UAVO database to save RAM + Flash
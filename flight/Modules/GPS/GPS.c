@@ -59,6 +59,7 @@ static void updateSettings();
 
 #ifdef PIOS_GPS_SETS_HOMELOCATION
 static void setHomeLocation(GPSPositionData * gpsData);
+static void trackMagneticField(GPSPositionData * gpsData, HomeLocationData * home);
 #endif
 
 // ****************
@@ -67,6 +68,9 @@ static void setHomeLocation(GPSPositionData * gpsData);
 #define GPS_TIMEOUT_MS                  500
 #define GPS_COM_TIMEOUT_MS              100
 
+//! Fraction of the field strength Be must move by before HomeLocation is updated
+#define MAG_FIELD_UPDATE_FRACTION       0.005f
+
 
 #ifdef PIOS_GPS_SETS_HOMELOCATION
 // Unfortunately need a good size stack for the WMM calculation
@@ -265,8 +269,15 @@ static void gpsTask(void *parameters)
 				HomeLocationData home;
 				HomeLocationGet(&home);
 
-				if (home.Set == HOMELOCATION_SET_FALSE)
+				if (home.Set == HOMELOCATION_SET_FALSE) {
 					setHomeLocation(&gpsposition);
+				} else {
+					// Read on every fix so the setting applies without a reboot
+					uint8_t magTracking;
+					ModuleSettingsGPSMagneticFieldTrackingGet(&magTracking);
+					if (magTracking == MODULESETTINGS_GPSMAGNETICFIELDTRACKING_ENABLED)
+						trackMagneticField(&gpsposition, &home);
+				}
 #endif
 			} else if (gpsposition.Status == GPSPOSITION_STATUS_FIX3D)
 						AlarmsSet(SYSTEMALARMS_ALARM_GPS, SYSTEMALARMS_ALARM_WARNING);
@@ -310,6 +321,40 @@ static void setHomeLocation(GPSPositionData * gpsData)
 		}
 	}
 }
+
+/**
+ * Keep HomeLocation.Be following the field at the current position, for
+ * flights long enough for it to change noticeably. The field is interpolated
+ * from a cached tile so this is cheap enough to run on every fix. The
+ * object is only written when the field moved by more than
+ * MAG_FIELD_UPDATE_FRACTION, to spare the telemetry and the filters.
+ */
+static void trackMagneticField(GPSPositionData * gpsData, HomeLocationData * home)
+{
+	GPSTimeData gps;
+	GPSTimeGet(&gps);
+
+	if (gps.Year < 2000)
+		return;
+
+	float Be[3];
+	if (WMM_GetMagVectorTracked(gpsData->Latitude / 10e6f, gpsData->Longitude / 10e6f, gpsData->Altitude,
+			gps.Month, gps.Day, gps.Year, Be) < 0)
+		return;
+
+	float diff_sq = 0;
+	float norm_sq = 0;
+	for (uint8_t i = 0; i < 3; i++) {
+		diff_sq += (Be[i] - home->Be[i]) * (Be[i] - home->Be[i]);
+		norm_sq += Be[i] * Be[i];
+	}
+
+	if (diff_sq > MAG_FIELD_UPDATE_FRACTION * MAG_FIELD_UPDATE_FRACTION * norm_sq) {
+		for (uint8_t i = 0; i < 3; i++)
+			home->Be[i] = Be[i];
+		HomeLocationBeSet(home->Be);
+	}
+}
 #endif
 
 /**
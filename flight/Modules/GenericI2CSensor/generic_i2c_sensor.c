@@ -33,8 +33,7 @@
 
 #include "i2cvm.h"	   /* UAV Object (VM register file outputs) */
 #include "i2cvmuserprogram.h"	/* UAV Object (bytecode to run) */
-
-extern bool i2c_vm_run (const uint32_t * code, uint8_t code_len, uintptr_t i2c_adapter);
+#include "i2c_vm.h"
 
 // Private constants
 #define STACK_SIZE_BYTES 370
@@ -47,8 +46,8 @@ static bool module_enabled = false;
 // Private functions
 static void GenericI2CSensorTask(void *parameters);
 
-static const uint32_t * i2cvm_program = NULL; /* bytecode to run in the VM */
-static uint16_t i2cvm_program_len = 0;	/* number of instructions in the program */
+static struct i2c_vm_insn * i2cvm_program = NULL; /* decoded program to run in the VM */
+static bool i2cvm_program_loaded = false; /* the program decoded without errors */
 
 /**
 * Start the module, called on startup
@@ -86,44 +85,41 @@ static int32_t GenericI2CSensorInitialize(void)
 		return -1;
 
 	/* Module is enabled, determine which program to run (if any) */
+	const uint32_t * code = NULL;
+	uint8_t code_len = 0;
+	uint32_t user_program[I2CVMUSERPROGRAM_PROGRAM_NUMELEM];
 	uint8_t selected_program;
 	ModuleSettingsI2CVMProgramSelectGet(&selected_program);
 
 	switch (selected_program) {
 	case MODULESETTINGS_I2CVMPROGRAMSELECT_USER:
 		I2CVMUserProgramInitialize();
-		uint32_t * user_program;
-		user_program = pvPortMalloc(sizeof(((I2CVMUserProgramData *)0)->Program));
-		if (!user_program) {
-			/* Failed to allocate sufficient memory for the user program */
-			return -1;
-		}
 		I2CVMUserProgramProgramGet(user_program);
-		i2cvm_program = user_program;
-		i2cvm_program_len = I2CVMUSERPROGRAM_PROGRAM_NUMELEM;
+		code = user_program;
+		code_len = I2CVMUSERPROGRAM_PROGRAM_NUMELEM;
 		break;
 	case MODULESETTINGS_I2CVMPROGRAMSELECT_OPBAROALTIMETER:
 		{
 		extern const uint32_t vmprog_op_mag_baro[];
 		extern const uint32_t vmprog_op_mag_baro_len;
-		i2cvm_program = vmprog_op_mag_baro;
-		i2cvm_program_len = vmprog_op_mag_baro_len;
+		code = vmprog_op_mag_baro;
+		code_len = vmprog_op_mag_baro_len;
 		}
 		break;
 	case MODULESETTINGS_I2CVMPROGRAMSELECT_ENDIANTEST:
 		{
 		extern const uint32_t vmprog_endiantest[];
 		extern const uint32_t vmprog_endiantest_len;
-		i2cvm_program = vmprog_endiantest;
-		i2cvm_program_len = vmprog_endiantest_len;
+		code = vmprog_endiantest;
+		code_len = vmprog_endiantest_len;
 		}
 		break;
 	case MODULESETTINGS_I2CVMPROGRAMSELECT_MATHTEST:
 		{
 		extern const uint32_t vmprog_mathtest[];
 		extern const uint32_t vmprog_mathtest_len;
-		i2cvm_program = vmprog_mathtest;
-		i2cvm_program_len = vmprog_mathtest_len;
+		code = vmprog_mathtest;
+		code_len = vmprog_mathtest_len;
 		}
 		break;
 	case MODULESETTINGS_I2CVMPROGRAMSELECT_NONE:
@@ -133,11 +129,20 @@ static int32_t GenericI2CSensorInitialize(void)
 	}
 
 	/* Make sure we have something to run */
-	if ((i2cvm_program == NULL) || (i2cvm_program_len == 0)) {
+	if ((code == NULL) || (code_len == 0)) {
 		module_enabled = false;
 		return -1;
 	}
 
+	/* Decode the program once, the task only ever runs the decoded form */
+	i2cvm_program = pvPortMalloc(I2C_VM_PROGRAM_LEN(code_len) * sizeof(*i2cvm_program));
+	if (!i2cvm_program) {
+		/* Failed to allocate sufficient memory for the program */
+		module_enabled = false;
+		return -1;
+	}
+	i2cvm_program_loaded = i2c_vm_load(i2cvm_program, code, code_len);
+
 	I2CVMInitialize();
 
 	return 0;
@@ -148,10 +153,19 @@ MODULE_INITCALL(GenericI2CSensorInitialize, GenericI2CSensorStart)
 
 static void GenericI2CSensorTask(void *parameters)
 {
+	/* A program which could not be decoded is never run */
+	if (!i2cvm_program_loaded) {
+		AlarmsSet(SYSTEMALARMS_ALARM_I2C, SYSTEMALARMS_ALARM_ERROR);
+		while (1)
+			vTaskDelay(MS2TICKS(1000));
+	}
+
+	AlarmsClear(SYSTEMALARMS_ALARM_I2C);
+
 	// Main task loop
 	while (1) {
 		/* Run the selected program */
-		if (i2c_vm_run(i2cvm_program, i2cvm_program_len, PIOS_I2C_MAIN_ADAPTER)) {
+		if (i2c_vm_exec(i2cvm_program, PIOS_I2C_MAIN_ADAPTER)) {
 			/* Program ran to completion. This could be because the program is 
 			 * empty or does not infinitely loop.
 			 * Delay in order to prevent these programs from consuming all CPU.
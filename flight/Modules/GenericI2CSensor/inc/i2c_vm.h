@@ -0,0 +1,68 @@
+/**
+ ******************************************************************************
+ * @addtogroup TauLabsModules Tau Labs Modules
+ * @{
+ * @addtogroup GenericI2CSensor Generic I2C sensor interface
+ * @{
+ *
+ * @file       i2c_vm.h
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2013
+ * @brief      The virtual machine for I2C sensors
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef I2C_VM_H
+#define I2C_VM_H
+
+#include <stdint.h>	/* uint8_t, uint32_t, etc */
+#include <stdbool.h>	/* bool */
+
+struct i2c_vm_regs;
+struct i2c_vm_insn;
+
+/* Executes one instruction and returns the next one, or NULL when the VM stops */
+typedef const struct i2c_vm_insn * (*i2c_vm_handler) (struct i2c_vm_regs * vm_state, const struct i2c_vm_insn * insn);
+
+/* A decoded instruction. Operands are checked when the program is loaded, so
+ * that the handlers can index the register file and RAM directly.
+ */
+struct i2c_vm_insn {
+	i2c_vm_handler handler;
+	uint8_t a;		/* rd, ra, value, or RAM address */
+	uint8_t b;		/* ra, RAM address or length */
+	union {
+		uint8_t  c;		/* rb or rd */
+		int16_t  simm;		/* short immediate data */
+		uint16_t target;	/* branch destination, as an instruction index */
+	};
+};
+
+/* A decoded program holds two extra instructions past the end of the code,
+ * one to stop the VM and one to fault it.
+ */
+#define I2C_VM_PROGRAM_LEN(code_len) ((code_len) + 2)
+
+extern bool i2c_vm_load (struct i2c_vm_insn * program, const uint32_t * code, uint8_t code_len);
+extern bool i2c_vm_exec (const struct i2c_vm_insn * program, uintptr_t i2c_adapter);
+extern bool i2c_vm_run (const uint32_t * code, uint8_t code_len, uintptr_t i2c_adapter);
+
+#endif /* I2C_VM_H */
+
+/**
+ * @}
+ * @}
+ */
@@ -75,6 +75,7 @@
 // Private variables
 static xTaskHandle pathfollowerTaskHandle;
 static PathDesiredData pathDesired;
+static struct path_segment pathSegment;
 static GroundPathFollowerSettingsData guidanceSettings;
 
 // Private functions
@@ -256,7 +257,7 @@ static void updatePathVelocity()
 	float cur[3] = {positionActual.North, positionActual.East, positionActual.Down};
 	struct path_status progress;
 
-	path_progress(&pathDesired, cur, &progress);
+	path_progress(&pathDesired, &pathSegment, cur, &progress);
 
 	// Update the path status UAVO
 	PathStatusData pathStatus;
@@ -30,7 +30,7 @@
 int32_t pathplanner_load_path(uint32_t path_id);
 
 //! Save a specified path id to flash
-int32_t pathplanner_save_path(uint32_t path_id);
+int32_t pathplanner_save_path(uint32_t path_id, float fillet_radius);
 
 /**
  * @}
@@ -0,0 +1,77 @@
+/**
+ ******************************************************************************
+ * @addtogroup TauLabsModules Tau Labs Modules
+ * @{
+ * @addtogroup PathPlannerModule Path Planner Module
+ * @{
+ *
+ * @file       path_store.h
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2013
+ * @brief      Compact storage of paths which are streamed from flash
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef PATH_STORE_H
+#define PATH_STORE_H
+
+#include "waypoint.h"
+
+/* A stored segment keeps the position at full precision, but rounds the */
+/* velocity to PATH_STORE_VELOCITY_STEP and the mode parameter to        */
+/* PATH_STORE_PARAMETER_STEP. Waypoints outside of the range of these    */
+/* fields are refused by path_store_check and path_store_write.          */
+#define PATH_STORE_VELOCITY_STEP    0.25f
+#define PATH_STORE_MAX_VELOCITY     (UINT8_MAX * PATH_STORE_VELOCITY_STEP)
+#define PATH_STORE_PARAMETER_STEP   0.1f
+#define PATH_STORE_MAX_PARAMETER    (INT16_MAX * PATH_STORE_PARAMETER_STEP)
+
+//! Initialize the path store
+int32_t path_store_initialize();
+
+//! Select a stored path to stream segments from
+int32_t path_store_open(uint32_t path_id);
+
+//! Stop streaming the stored path
+void path_store_close();
+
+//! Number of segments of the open path, negative if none is open
+int32_t path_store_num_segments();
+
+//! Get a segment of the open path
+int32_t path_store_get(uint16_t idx, WaypointData *waypoint);
+
+//! Bring the block holding a segment into RAM ahead of its use
+void path_store_prefetch(uint16_t idx);
+
+//! Whether a waypoint is within the range of a stored segment
+bool path_store_check(const WaypointData *waypoint);
+
+//! Start writing a path, replacing the one stored with that id
+int32_t path_store_write_begin(uint32_t path_id);
+
+//! Append a segment to the path being written
+int32_t path_store_write(const WaypointData *waypoint);
+
+//! Complete the path being written
+int32_t path_store_write_end();
+
+#endif /* PATH_STORE_H */
+
+/**
+ * @}
+ * @}
+ */
@@ -28,6 +28,10 @@
 #include "pios.h"
 #include "openpilot.h"
 #include "pios_flashfs.h"
+#include "path_fillet.h"
+#include "path_saving.h"
+#include "path_store.h"
+#include "flightstatus.h"
 #include "waypoint.h"
 
 extern uintptr_t pios_waypoints_settings_fs_id;
@@ -35,46 +39,135 @@ extern uintptr_t pios_waypoints_settings_fs_id;
 /* Note: this system uses the flashfs in a slightly different way  */
 /* the flashfs saves entries with an object and instance id. in    */
 /* this code the object id is used to indicate the path id and the */
-/* instance id is the waypoint number                              */
+/* instance id is the waypoint number. Paths are now saved by      */
+/* path_store.c, this layout is only read for older paths          */
+
+//! Whether the corner at a waypoint of this mode can be filleted
+static bool waypoint_filletable(uint8_t mode)
+{
+	return mode == WAYPOINT_MODE_FLYVECTOR ||
+	       mode == WAYPOINT_MODE_FLYCIRCLERIGHT ||
+	       mode == WAYPOINT_MODE_FLYCIRCLELEFT;
+}
+
+static void waypoint_to_fillet_point(const WaypointData *waypoint, struct path_fillet_point *point)
+{
+	for (int32_t i = 0; i < 3; i++)
+		point->position[i] = waypoint->Position[i];
+	point->velocity = waypoint->Velocity;
+
+	point->curvature = 0;
+	if (waypoint->ModeParameters != 0) {
+		if (waypoint->Mode == WAYPOINT_MODE_FLYCIRCLERIGHT)
+			point->curvature = 1.0f / waypoint->ModeParameters;
+		else if (waypoint->Mode == WAYPOINT_MODE_FLYCIRCLELEFT)
+			point->curvature = -1.0f / waypoint->ModeParameters;
+	}
+}
 
 /**
- * Save the in memory waypoints to the waypoint filesystem
- * @param[in] id The path id to save as
+ * Save the in memory waypoints to the waypoint filesystem in the compact
+ * format of path_store.c. The corners between flown vectors and arcs are
+ * rounded on the way, waypoint by waypoint, so that only the waypoint ahead
+ * and the last segment written are held in memory.
+ * @param[in] path_id The path id to save as
+ * @param[in] fillet_radius Radius of the fillets in m, 0 to store the path as it is
+ * @return -30 waypoint object not registered
+ * @return -32 a path is being flown
+ * @return -33 a waypoint or the fillet radius is out of the range of the stored path
+ * @return other indicates FlashFS error
  */
-int32_t pathplanner_save_path(uint32_t path_id)
+int32_t pathplanner_save_path(uint32_t path_id, float fillet_radius)
 {
-	WaypointData waypoint;
+	WaypointData current;
+	WaypointData next;
+	struct path_fillet_point prev_point;
+	struct path_fillet_point current_point;
+	struct path_fillet_point next_point;
+	struct path_fillet_point out[PATH_FILLET_MAX_POINTS];
 
 	if (WaypointHandle() == 0)
 		return -30; // leave room for flashfs error codes
 
-	uint16_t num_waypoints = WaypointGetNumInstances();
-	uint32_t  waypoint_size = WaypointGetNumBytes();
-	int32_t  erase_retval  = 0;
-	int32_t  last_save_id  = -1;
-	int32_t  retval        = 0;
+	// Writing the path being flown would restart it, and replace it part way
+	FlightStatusData flightStatus;
+	FlightStatusGet(&flightStatus);
+	if (flightStatus.FlightMode == FLIGHTSTATUS_FLIGHTMODE_PATHPLANNER)
+		return -32;
+
+	// The fillets get the velocity of their waypoint and at most this radius
+	if (!(fillet_radius >= 0 && fillet_radius <= PATH_STORE_MAX_PARAMETER))
+		return -33;
+
+	// Stop saving when get to invalid waypoint.  Nothing after or including is valid.
+	// Check the others before the stored path is replaced, rather than clip them.
+	uint16_t num_waypoints;
+	for (num_waypoints = 0; num_waypoints < WaypointGetNumInstances(); num_waypoints++) {
+		WaypointInstGet(num_waypoints, &next);
+		if (next.Mode == WAYPOINT_MODE_INVALID || next.Mode == WAYPOINT_MODE_STOP)
+			break;
+		if (!path_store_check(&next))
+			return -33;
+	}
+
+	int32_t retval = path_store_write_begin(path_id);
+
+	if (num_waypoints > 0)
+		WaypointInstGet(0, &next);
 
-	// Save all elements
 	for (int32_t i = 0; i < num_waypoints && retval == 0; i++) {
-		WaypointInstGet(i, &waypoint);
+		current = next;
 
-		// Stop saving when get to invalid waypoint.  Nothing after or including is valid
-		if (waypoint.Mode == WAYPOINT_MODE_INVALID || waypoint.Mode == WAYPOINT_MODE_STOP)
-			break;
+		bool has_next = i + 1 < num_waypoints;
+		if (has_next)
+			WaypointInstGet(i + 1, &next);
+
+		waypoint_to_fillet_point(&current, &current_point);
 
-		retval = PIOS_FLASHFS_ObjSave(pios_waypoints_settings_fs_id, path_id, i, (uint8_t *) &waypoint, waypoint_size);
-		last_save_id = i; // Track the last valid waypoint id
+		int32_t num_points = 1;
+		out[0] = current_point;
+		if (has_next && waypoint_filletable(current.Mode) && waypoint_filletable(next.Mode)) {
+			waypoint_to_fillet_point(&next, &next_point);
+			num_points = path_fillet_waypoint(fillet_radius, i > 0 ? &prev_point : NULL,
+			                                  &current_point, &next_point, out);
+		}
+
+		for (int32_t j = 0; j < num_points && retval == 0; j++) {
+			WaypointData segment = current;
+
+			for (int32_t k = 0; k < 3; k++)
+				segment.Position[k] = out[j].position[k];
+			segment.Velocity = out[j].velocity;
+
+			// The first point keeps the mode of the waypoint, the fillets are arcs
+			if (j > 0) {
+				if (out[j].curvature > 0) {
+					segment.Mode = WAYPOINT_MODE_FLYCIRCLERIGHT;
+					segment.ModeParameters = 1.0f / out[j].curvature;
+				} else if (out[j].curvature < 0) {
+					segment.Mode = WAYPOINT_MODE_FLYCIRCLELEFT;
+					segment.ModeParameters = -1.0f / out[j].curvature;
+				} else {
+					segment.Mode = WAYPOINT_MODE_FLYVECTOR;
+					segment.ModeParameters = 0;
+				}
+			}
+
+			retval = path_store_write(&segment);
+		}
+
+		prev_point = out[num_points - 1];
 	}
 
-	// Use an explicit indication of the end of path
-	waypoint.Mode = WAYPOINT_MODE_STOP;
-	retval = PIOS_FLASHFS_ObjSave(pios_waypoints_settings_fs_id, path_id, ++last_save_id,
-	                              (uint8_t *) &waypoint, waypoint_size);
+	if (retval == 0)
+		retval = path_store_write_end();
 
-	// Check for any waypoints after the saved end of the path and erase them
-	for (int32_t i = last_save_id + 1; erase_retval == 0; i++) {
-		erase_retval = PIOS_FLASHFS_ObjLoad(pios_waypoints_settings_fs_id, path_id, i, (uint8_t *) &waypoint, waypoint_size);
-		if (erase_retval == 0) {
+	// The path no longer needs to be stored one waypoint per object
+	if (retval == 0) {
+		uint32_t waypoint_size = WaypointGetNumBytes();
+		for (int32_t i = 0; ; i++) {
+			if (PIOS_FLASHFS_ObjLoad(pios_waypoints_settings_fs_id, path_id, i, (uint8_t *) &current, waypoint_size) != 0)
+				break;
 			PIOS_FLASHFS_ObjDelete(pios_waypoints_settings_fs_id, path_id, i);
 		}
 	}
@@ -83,7 +176,9 @@ int32_t pathplanner_save_path(uint32_t path_id)
 }
 
 /**
- * Load a path from the waypoint filesystem into memory
+ * Load a path from the waypoint filesystem. A path in the compact format is
+ * selected to be streamed by the path planner, one saved per waypoint is
+ * loaded into the Waypoint objects.
  * @param[in] id The path id to load
  * @return -30 waypoint object not registered
  * @return -31 could not allocate waypoint in ram
@@ -96,6 +191,9 @@ int32_t pathplanner_load_path(uint32_t path_id)
 	if (WaypointHandle() == 0)
 		return -30; // leave room for flashfs error codes
 
+	if (path_store_open(path_id) >= 0)
+		return 0;
+
 	uint32_t  waypoint_size = WaypointGetNumBytes();
 	int32_t  retval = 0;
 
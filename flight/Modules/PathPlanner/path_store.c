@@ -0,0 +1,371 @@
+/**
+ ******************************************************************************
+ * @addtogroup TauLabsModules Tau Labs Modules
+ * @{
+ * @addtogroup PathPlannerModule Path Planner Module
+ * @{
+ *
+ * @file       path_store.c
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2013
+ * @brief      Compact storage of paths which are streamed from flash
+ *
+ * A stored path is a header and a sequence of blocks of 16 byte segments in
+ * the waypoint filesystem. Each block fills one filesystem slot, so a path
+ * takes a fraction of the space of one Waypoint object per slot. While a
+ * path is flown only a window of two blocks is kept in RAM: the block of
+ * the active segment and the one after it, which the path planner task
+ * prefetches so that switching segments does not wait for the flash.
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "pios.h"
+#include "openpilot.h"
+#include "pios_flashfs.h"
+#include "misc_math.h"
+#include "path_store.h"
+
+extern uintptr_t pios_waypoints_settings_fs_id;
+
+/* The object id of a stored path is PATH_STORE_OBJ_ID(path id), which   */
+/* keeps it apart from the per waypoint objects of path_saving.c. The    */
+/* header is instance 0 and block n is instance n + 1.                   */
+#define PATH_STORE_OBJ_ID(path_id)  (0x50544800 + (path_id))
+#define PATH_STORE_MAGIC            0x31485450 // "PTH1"
+
+//! Most segments in a block, the slot size of the filesystem may allow fewer
+#define PATH_STORE_BLOCK_SEGMENTS   15
+
+//! Blocks held in RAM while streaming
+#define PATH_STORE_WINDOW           2
+
+struct path_store_header {
+	uint32_t magic;
+	uint16_t num_segments;
+	uint8_t segments_per_block;
+	uint8_t reserved;
+} __attribute__((packed));
+
+struct path_store_segment {
+	float end[3];         //!< Waypoint.Position
+	int16_t parameter;    //!< Waypoint.ModeParameters, PATH_STORE_PARAMETER_STEP
+	uint8_t velocity;     //!< Waypoint.Velocity, PATH_STORE_VELOCITY_STEP m/s
+	uint8_t mode;         //!< Waypoint.Mode
+} __attribute__((packed));
+
+struct path_store_block {
+	int32_t index;        //!< Block held, -1 if none
+	struct path_store_segment segments[PATH_STORE_BLOCK_SEGMENTS];
+};
+
+// Private variables
+static xSemaphoreHandle lock;
+static struct path_store_block window[PATH_STORE_WINDOW];
+static uint32_t open_path_id;
+static int32_t open_num_segments = -1;
+static uint8_t open_segments_per_block;
+
+static struct path_store_segment write_block[PATH_STORE_BLOCK_SEGMENTS];
+static uint32_t write_path_id;
+static uint16_t write_num_segments;
+static uint8_t write_segments_per_block;
+
+// Private functions
+static struct path_store_block * path_store_load(int32_t block_idx);
+static int32_t path_store_flush();
+static void path_store_encode(const WaypointData *waypoint, struct path_store_segment *segment);
+static void path_store_decode(const struct path_store_segment *segment, WaypointData *waypoint);
+
+/**
+ * Initialize the path store
+ * @return 0 if successful, -1 if the lock could not be created
+ */
+int32_t path_store_initialize()
+{
+	lock = xSemaphoreCreateRecursiveMutex();
+	if (lock == NULL)
+		return -1;
+
+	open_num_segments = -1;
+	for (int32_t i = 0; i < PATH_STORE_WINDOW; i++)
+		window[i].index = -1;
+
+	return 0;
+}
+
+/**
+ * Select a stored path to stream segments from
+ * @param[in] path_id The path id it was saved as
+ * @return the number of segments of the path
+ * @return -1 if there is no path stored in the compact format with that id
+ * @return -2 if the stored header is not valid
+ */
+int32_t path_store_open(uint32_t path_id)
+{
+	struct path_store_header header;
+
+	if (PIOS_FLASHFS_ObjLoad(pios_waypoints_settings_fs_id, PATH_STORE_OBJ_ID(path_id), 0,
+	                         (uint8_t *) &header, sizeof(header)) != 0)
+		return -1;
+
+	if (header.magic != PATH_STORE_MAGIC || header.segments_per_block == 0 ||
+	    header.segments_per_block > PATH_STORE_BLOCK_SEGMENTS)
+		return -2;
+
+	xSemaphoreTakeRecursive(lock, portMAX_DELAY);
+
+	open_path_id = path_id;
+	open_num_segments = header.num_segments;
+	open_segments_per_block = header.segments_per_block;
+	for (int32_t i = 0; i < PATH_STORE_WINDOW; i++)
+		window[i].index = -1;
+
+	xSemaphoreGiveRecursive(lock);
+
+	return header.num_segments;
+}
+
+/**
+ * Stop streaming the stored path
+ */
+void path_store_close()
+{
+	xSemaphoreTakeRecursive(lock, portMAX_DELAY);
+	open_num_segments = -1;
+	xSemaphoreGiveRecursive(lock);
+}
+
+/**
+ * Number of segments of the open path
+ * @return the number of segments, negative if no stored path is open
+ */
+int32_t path_store_num_segments()
+{
+	return open_num_segments;
+}
+
+/**
+ * Get a segment of the open path. This only reads from the flash if the
+ * segment is outside the window, which does not happen while the planner
+ * advances through the path normally.
+ * @param[in] idx The segment
+ * @param[out] waypoint The segment as a waypoint to fly to
+ * @return 0 if successful, -1 if the segment is not part of the open path,
+ * -2 if it could not be read
+ */
+int32_t path_store_get(uint16_t idx, WaypointData *waypoint)
+{
+	int32_t retval = -1;
+
+	xSemaphoreTakeRecursive(lock, portMAX_DELAY);
+
+	if (idx < open_num_segments) {
+		struct path_store_block *block = path_store_load(idx / open_segments_per_block);
+		if (block != NULL) {
+			path_store_decode(&block->segments[idx % open_segments_per_block], waypoint);
+			retval = 0;
+		} else {
+			retval = -2;
+		}
+	}
+
+	xSemaphoreGiveRecursive(lock);
+
+	return retval;
+}
+
+/**
+ * Bring the block holding a segment into the window
+ * @param[in] idx The segment
+ */
+void path_store_prefetch(uint16_t idx)
+{
+	xSemaphoreTakeRecursive(lock, portMAX_DELAY);
+
+	if (idx < open_num_segments)
+		path_store_load(idx / open_segments_per_block);
+
+	xSemaphoreGiveRecursive(lock);
+}
+
+/**
+ * Check that a waypoint can be stored without its velocity or mode
+ * parameter being clipped
+ * @param[in] waypoint The waypoint
+ * @return true if it is within the range of a stored segment
+ */
+bool path_store_check(const WaypointData *waypoint)
+{
+	return waypoint->Velocity >= 0 && waypoint->Velocity <= PATH_STORE_MAX_VELOCITY &&
+	       fabsf(waypoint->ModeParameters) <= PATH_STORE_MAX_PARAMETER;
+}
+
+/**
+ * Start writing a path. The header of a path with the same id is removed
+ * first, so that a partially written path is never opened.
+ * @param[in] path_id The path id to save as
+ * @return 0 if successful, -1 if the filesystem slots are too small
+ */
+int32_t path_store_write_begin(uint32_t path_id)
+{
+	int32_t max_size = PIOS_FLASHFS_MaxObjSize(pios_waypoints_settings_fs_id);
+	if (max_size < (int32_t) sizeof(struct path_store_segment) ||
+	    max_size < (int32_t) sizeof(struct path_store_header))
+		return -1;
+
+	write_segments_per_block = MIN(PATH_STORE_BLOCK_SEGMENTS, max_size / sizeof(struct path_store_segment));
+	write_path_id = path_id;
+	write_num_segments = 0;
+	memset(write_block, 0, sizeof(write_block));
+
+	PIOS_FLASHFS_ObjDelete(pios_waypoints_settings_fs_id, PATH_STORE_OBJ_ID(path_id), 0);
+
+	return 0;
+}
+
+/**
+ * Append a segment to the path being written
+ * @param[in] waypoint The segment
+ * @return 0 if successful, -1 if the path is too long, -2 if the segment is
+ * out of range (see @ref path_store_check), other indicates FlashFS error
+ */
+int32_t path_store_write(const WaypointData *waypoint)
+{
+	if (write_num_segments == UINT16_MAX)
+		return -1;
+
+	if (!path_store_check(waypoint))
+		return -2;
+
+	path_store_encode(waypoint, &write_block[write_num_segments % write_segments_per_block]);
+	write_num_segments++;
+
+	if (write_num_segments % write_segments_per_block == 0)
+		return path_store_flush();
+
+	return 0;
+}
+
+/**
+ * Complete the path being written, writing its header and removing the
+ * blocks left over from a longer path with the same id
+ * @return 0 if successful, other indicates FlashFS error
+ */
+int32_t path_store_write_end()
+{
+	int32_t retval = 0;
+
+	if (write_num_segments % write_segments_per_block != 0)
+		retval = path_store_flush();
+	if (retval != 0)
+		return retval;
+
+	struct path_store_header header = {
+		.magic = PATH_STORE_MAGIC,
+		.num_segments = write_num_segments,
+		.segments_per_block = write_segments_per_block,
+	};
+	retval = PIOS_FLASHFS_ObjSave(pios_waypoints_settings_fs_id, PATH_STORE_OBJ_ID(write_path_id), 0,
+	                              (uint8_t *) &header, sizeof(header));
+	if (retval != 0)
+		return retval;
+
+	// Check for any blocks after the end of the path and erase them
+	uint16_t block_size = write_segments_per_block * sizeof(struct path_store_segment);
+	int32_t num_blocks = (write_num_segments + write_segments_per_block - 1) / write_segments_per_block;
+	for (int32_t i = num_blocks + 1; ; i++) {
+		if (PIOS_FLASHFS_ObjLoad(pios_waypoints_settings_fs_id, PATH_STORE_OBJ_ID(write_path_id), i,
+		                         (uint8_t *) write_block, block_size) != 0)
+			break;
+		PIOS_FLASHFS_ObjDelete(pios_waypoints_settings_fs_id, PATH_STORE_OBJ_ID(write_path_id), i);
+	}
+
+	// An open path which was written again drops the blocks it held
+	xSemaphoreTakeRecursive(lock, portMAX_DELAY);
+	if (open_num_segments >= 0 && open_path_id == write_path_id)
+		path_store_open(write_path_id);
+	xSemaphoreGiveRecursive(lock);
+
+	return 0;
+}
+
+/**
+ * Get a block of the open path into the window, reading it if necessary.
+ * Consecutive blocks go to different entries so the next block can be read
+ * while the current one is in use. Must be called with the lock held.
+ * @param[in] block_idx The block
+ * @return the entry of the window, NULL if the block could not be read
+ */
+static struct path_store_block * path_store_load(int32_t block_idx)
+{
+	struct path_store_block *block = &window[block_idx % PATH_STORE_WINDOW];
+
+	if (block->index == block_idx)
+		return block;
+
+	block->index = -1;
+	if (PIOS_FLASHFS_ObjLoad(pios_waypoints_settings_fs_id, PATH_STORE_OBJ_ID(open_path_id), block_idx + 1,
+	                         (uint8_t *) block->segments,
+	                         open_segments_per_block * sizeof(struct path_store_segment)) != 0)
+		return NULL;
+
+	block->index = block_idx;
+	return block;
+}
+
+/**
+ * Write the block of the path being written which was just completed
+ */
+static int32_t path_store_flush()
+{
+	int32_t block_idx = (write_num_segments - 1) / write_segments_per_block;
+	int32_t retval = PIOS_FLASHFS_ObjSave(pios_waypoints_settings_fs_id, PATH_STORE_OBJ_ID(write_path_id),
+	                                      block_idx + 1, (uint8_t *) write_block,
+	                                      write_segments_per_block * sizeof(struct path_store_segment));
+
+	memset(write_block, 0, sizeof(write_block));
+
+	return retval;
+}
+
+static void path_store_encode(const WaypointData *waypoint, struct path_store_segment *segment)
+{
+	for (int32_t i = 0; i < 3; i++)
+		segment->end[i] = waypoint->Position[i];
+
+	float parameter = bound_sym(waypoint->ModeParameters / PATH_STORE_PARAMETER_STEP, INT16_MAX);
+	segment->parameter = (int16_t) (parameter + (parameter < 0 ? -0.5f : 0.5f));
+
+	float velocity = bound_min_max(waypoint->Velocity / PATH_STORE_VELOCITY_STEP, 0, UINT8_MAX);
+	segment->velocity = (uint8_t) (velocity + 0.5f);
+
+	segment->mode = waypoint->Mode;
+}
+
+static void path_store_decode(const struct path_store_segment *segment, WaypointData *waypoint)
+{
+	for (int32_t i = 0; i < 3; i++)
+		waypoint->Position[i] = segment->end[i];
+
+	waypoint->ModeParameters = segment->parameter * PATH_STORE_PARAMETER_STEP;
+	waypoint->Velocity = segment->velocity * PATH_STORE_VELOCITY_STEP;
+	waypoint->Mode = segment->mode;
+}
+
+/**
+ * @}
+ * @}
+ */
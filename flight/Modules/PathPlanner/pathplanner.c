@@ -29,6 +29,7 @@
 #include "physical_constants.h"
 #include "paths.h"
 #include "path_saving.h"
+#include "path_store.h"
 
 #include "flightstatus.h"
 #include "pathdesired.h"
@@ -66,6 +67,8 @@ static void waypointsUpdated(UAVObjEvent * ev);
 static void pathStatusUpdated(UAVObjEvent * ev);
 static void createPathBox();
 static void createPathLogo();
+static int32_t numWaypoints();
+static bool getWaypoint(int32_t idx, WaypointData *waypoint);
 
 static bool module_enabled;
 
@@ -73,6 +76,8 @@ static bool module_enabled;
 static int32_t active_waypoint = -1;
 //! Store the previous waypoint which is used to determine the path trajectory
 static int32_t previous_waypoint = -1;
+//! Which waypoint is held in waypoint
+static int32_t loaded_waypoint = -1;
 /**
  * Module initialization
  */
@@ -114,6 +119,9 @@ int32_t PathPlannerInitialize()
 		WaypointInitialize();
 		WaypointActiveInitialize();
 
+		if (path_store_initialize() != 0)
+			return -1;
+
 		// Create object queue
 		queue = xQueueCreate(MAX_QUEUE_SIZE, sizeof(UAVObjEvent));
 
@@ -169,6 +177,7 @@ static void pathPlannerTask(void *parameters)
 			// Note: this needs to be done before the callback is triggered!
 			active_waypoint = -1;
 			previous_waypoint = -1;
+			loaded_waypoint = -1;
 
 			// This triggers callback to update variable
 			WaypointActiveGet(&waypointActive);
@@ -184,6 +193,11 @@ static void pathPlannerTask(void *parameters)
 		if (path_status_updated)
 			checkTerminationCondition();
 
+		/* Read the segment after the active one of a stored path from flash */
+		/* now, so that activating it does not have to wait for it           */
+		if (active_waypoint >= 0 && path_store_num_segments() >= 0)
+			path_store_prefetch(active_waypoint + 1);
+
 		/* If advance waypoint takes a long time to calculate then it should */
 		/* be called from here when the active_waypoints does not equal the  */
 		/* WaypointActive.Index                                              */
@@ -198,6 +212,12 @@ static void pathPlannerTask(void *parameters)
  */
 static void waypointsUpdated(UAVObjEvent * ev)
 {
+	// Changed waypoints take over from a stored path
+	if (ev->obj == WaypointHandle() && (ev->event == EV_UPDATED || ev->event == EV_UNPACKED)) {
+		path_store_close();
+		loaded_waypoint = -1;
+	}
+
 	FlightStatusData flightStatus;
 	FlightStatusGet(&flightStatus);
 	if (flightStatus.FlightMode != FLIGHTSTATUS_FLIGHTMODE_PATHPLANNER)
@@ -265,7 +285,7 @@ static void advanceWaypoint()
 	// to ensure all possible paths are valid.
 	waypointActive.Index++;
 
-	if (waypointActive.Index >= UAVObjGetNumInstances(WaypointHandle())) {
+	if (waypointActive.Index >= numWaypoints()) {
 		holdCurrentPosition();
 
 		// Do not reset path_status_updated here to avoid this method constantly being called
@@ -290,15 +310,19 @@ static void activateWaypoint(int idx)
 {
 	active_waypoint = idx;
 
-	if (idx >= UAVObjGetNumInstances(WaypointHandle())) {
+	// The previous waypoint is usually the one activated last
+	WaypointData waypointPrev = waypoint;
+	bool havePrev = previous_waypoint >= 0 && previous_waypoint == loaded_waypoint;
+
+	// Get the activated waypoint
+	if (!getWaypoint(idx, &waypoint)) {
 		// Attempting to access invalid waypoint.  Fall back to position hold at current location
+		loaded_waypoint = -1;
 		AlarmsSet(SYSTEMALARMS_ALARM_PATHPLANNER, SYSTEMALARMS_ALARM_ERROR);
 		holdCurrentPosition();
 		return;
 	}
-
-	// Get the activated waypoint
-	WaypointInstGet(idx, &waypoint);
+	loaded_waypoint = idx;
 
 	PathDesiredData pathDesired;
 
@@ -341,8 +365,11 @@ static void activateWaypoint(int idx)
 		pathDesired.StartingVelocity = waypoint.Velocity;
 	} else {
 		// Get previous waypoint as start point
-		WaypointData waypointPrev;
-		WaypointInstGet(previous_waypoint, &waypointPrev);
+		if (!havePrev && !getWaypoint(previous_waypoint, &waypointPrev)) {
+			AlarmsSet(SYSTEMALARMS_ALARM_PATHPLANNER, SYSTEMALARMS_ALARM_ERROR);
+			holdCurrentPosition();
+			return;
+		}
 
 		pathDesired.Start[PATHDESIRED_END_NORTH] = waypointPrev.Position[WAYPOINT_POSITION_NORTH];
 		pathDesired.Start[PATHDESIRED_END_EAST] = waypointPrev.Position[WAYPOINT_POSITION_EAST];
@@ -358,6 +385,35 @@ static void activateWaypoint(int idx)
 	AlarmsClear(SYSTEMALARMS_ALARM_PATHPLANNER);
 }
 
+/**
+ * Number of waypoints of the path being flown, the open stored path or
+ * the Waypoint objects
+ */
+static int32_t numWaypoints()
+{
+	int32_t num_segments = path_store_num_segments();
+	if (num_segments >= 0)
+		return num_segments;
+
+	return UAVObjGetNumInstances(WaypointHandle());
+}
+
+/**
+ * Get a waypoint of the path being flown
+ * @return true if successful, false if it does not exist
+ */
+static bool getWaypoint(int32_t idx, WaypointData *waypoint)
+{
+	if (idx < 0 || idx >= numWaypoints())
+		return false;
+
+	if (path_store_num_segments() >= 0)
+		return path_store_get(idx, waypoint) == 0;
+
+	WaypointInstGet(idx, waypoint);
+	return true;
+}
+
 void settingsUpdated(UAVObjEvent * ev) {
 	uint8_t preprogrammedPath = pathPlannerSettings.PreprogrammedPath;
 	int32_t retval = 0;
@@ -386,27 +442,31 @@ void settingsUpdated(UAVObjEvent * ev) {
 		operation = true;
 		break;
 	case PATHPLANNERSETTINGS_FLASHOPERATION_SAVE1:
-		retval = pathplanner_save_path(1);
+		retval = pathplanner_save_path(1, pathPlannerSettings.FilletRadius);
 		operation = true;
 		break;
 	case PATHPLANNERSETTINGS_FLASHOPERATION_SAVE2:
-		retval = pathplanner_save_path(2);
+		retval = pathplanner_save_path(2, pathPlannerSettings.FilletRadius);
 		operation = true;
 		break;
 	case PATHPLANNERSETTINGS_FLASHOPERATION_SAVE3:
-		retval = pathplanner_save_path(3);
+		retval = pathplanner_save_path(3, pathPlannerSettings.FilletRadius);
 		operation = true;
 		break;
 	case PATHPLANNERSETTINGS_FLASHOPERATION_SAVE4:
-		retval = pathplanner_save_path(4);
+		retval = pathplanner_save_path(4, pathPlannerSettings.FilletRadius);
 		operation = true;
 		break;
 	case PATHPLANNERSETTINGS_FLASHOPERATION_SAVE5:
-		retval = pathplanner_save_path(5);
+		retval = pathplanner_save_path(5, pathPlannerSettings.FilletRadius);
 		operation = true;
 		break;
 	}
 
+	// The path being flown may have been replaced
+	if (operation)
+		loaded_waypoint = -1;
+
 	if (pathPlannerSettings.PreprogrammedPath != preprogrammedPath &&
 	    pathPlannerSettings.FlashOperation == PATHPLANNERSETTINGS_FLASHOPERATION_NONE) {
 		switch(pathPlannerSettings.PreprogrammedPath) {
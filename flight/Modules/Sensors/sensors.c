@@ -215,6 +215,7 @@ static void SensorsTask(void *parameters)
 		else
 			good_runs++;
 		PIOS_WDG_UpdateFlag(PIOS_WDG_SENSORS);
+		TaskMonitorLoop(TASKINFO_RUNNING_SENSORS);
 
 		// Check total time to get the sensors wasn't over the limit
 		uint32_t dT_us = PIOS_DELAY_DiffuS(timeval);
@@ -32,8 +32,15 @@
 #include "pios.h"
 #include "openpilot.h"
 #include "physical_constants.h"
+#include "hitl_bridge.h"
+
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <signal.h>
+#include <unistd.h>
 
 #include "accels.h"
+#include "actuatorcommand.h"
 #include "actuatordesired.h"
 #include "airspeedactual.h"
 #include "attitudeactual.h"
@@ -50,6 +57,7 @@
 #include "magnetometer.h"
 #include "magbias.h"
 #include "ratedesired.h"
+#include "simulationsettings.h"
 #include "systemsettings.h"
 
 #include "coordinate_conversions.h"
@@ -58,6 +66,8 @@
 #define STACK_SIZE_BYTES 1540
 #define TASK_PRIORITY (tskIDLE_PRIORITY+3)
 #define SENSOR_PERIOD 2
+#define BRIDGE_STACK_SIZE_BYTES 1024
+#define BRIDGE_TASK_PRIORITY (tskIDLE_PRIORITY+2)
 
 // Private types
 
@@ -73,10 +83,32 @@ static void simulateModelAirplane();
 static void simulateModelCar();
 
 static void magOffsetEstimation(MagnetometerData *mag);
+static void simulationSettingsUpdated(UAVObjEvent * ev);
+static void simulationSettingsLoad();
+static void simulateWind(float wind[3]);
+static void hitlBridgeInitialize();
+static void hitlBridgeRxTask(void *parameters);
+static bool hitlBridgeUpdate();
+static void hitlBridgeStep(const struct hitl_bridge_sensors *sensors, const struct sockaddr_in *peer);
 
 static float accel_bias[3];
+static SimulationSettingsData simulationSettings;
+static volatile bool simulationSettingsChanged;
+
+//! A sensor packet and where to answer it
+struct hitl_bridge_rx {
+	struct hitl_bridge_sensors sensors;
+	struct sockaddr_in peer;
+};
+
+static int bridge_socket = -1;
+static xTaskHandle bridgeTaskHandle;
+static xQueueHandle bridge_rx_queue;
+static xQueueHandle bridge_queue;
+static bool bridge_active;
 
 static float rand_gauss();
+static float unit_gauss();
 
 enum sensor_sim_type {CONSTANT, MODEL_AGNOSTIC, MODEL_QUADCOPTER, MODEL_AIRPLANE, MODEL_CAR} sensor_sim_type;
 
@@ -86,6 +118,9 @@ enum sensor_sim_type {CONSTANT, MODEL_AGNOSTIC, MODEL_QUADCOPTER, MODEL_AIRPLANE
  */
 int32_t SensorsInitialize(void)
 {
+	SimulationSettingsInitialize();
+	SimulationSettingsConnectCallback(simulationSettingsUpdated);
+	simulationSettingsLoad();
 
 	accel_bias[0] = rand_gauss() / 10;
 	accel_bias[1] = rand_gauss() / 10;
@@ -102,6 +137,8 @@ int32_t SensorsInitialize(void)
 	MagnetometerInitialize();
 	MagBiasInitialize();
 
+	hitlBridgeInitialize();
+
 	return 0;
 }
 
@@ -145,6 +182,16 @@ static void SensorsTask(void *parameters)
 	while (1) {
 		PIOS_WDG_UpdateFlag(PIOS_WDG_SENSORS);
 
+		// The models read the settings, so only this task may copy them
+		if (simulationSettingsChanged) {
+			simulationSettingsChanged = false;
+			simulationSettingsLoad();
+		}
+
+		// While a simulator is sending sensor packets they replace the models
+		if (hitlBridgeUpdate())
+			continue;
+
 		SystemSettingsData systemSettings;
 		SystemSettingsGet(&systemSettings);
 
@@ -397,10 +444,8 @@ static void simulateModelQuadcopter()
 		AttitudeActualSet(&attitudeActual);
 	}
 	
-	static float wind[3] = {0,0,0};
-	wind[0] = wind[0] * 0.95 + rand_gauss() / 10.0;
-	wind[1] = wind[1] * 0.95 + rand_gauss() / 10.0;
-	wind[2] = wind[2] * 0.95 + rand_gauss() / 10.0;
+	float wind[3];
+	simulateWind(wind);
 	
 	Quaternion2R(q,Rbe);
 	// Make thrust negative as down is positive
@@ -650,13 +695,10 @@ static void simulateModelAirplane()
 	}
 	
 	/**** 2. Update position based on velocity ****/
-	static float wind[3] = {0,0,0};
-	wind[0] = wind[0] * 0.95 + rand_gauss() / 10.0;
-	wind[1] = wind[1] * 0.95 + rand_gauss() / 10.0;
-	wind[2] = wind[2] * 0.95 + rand_gauss() / 10.0;
-	wind[0] = 0;
-	wind[1] = 0;
-	wind[2] = 0;
+	// Only the steady wind, the airplane model does not handle gusts yet
+	float wind[3] = {simulationSettings.Wind[SIMULATIONSETTINGS_WIND_NORTH],
+		simulationSettings.Wind[SIMULATIONSETTINGS_WIND_EAST],
+		simulationSettings.Wind[SIMULATIONSETTINGS_WIND_DOWN]};
 	
 	// Rbe takes a vector from body to earth.  If we take (1,0,0)^T through this and then dot with airspeed
 	// we get forward airspeed		
@@ -1079,7 +1121,254 @@ static void simulateModelCar()
 }
 
 
+/**
+ * Open the UDP socket a simulator sends @ref hitl_bridge_sensors packets to,
+ * on HITL_BRIDGE_PORT moved by SIM_PORT_OFFSET like the telemetry ports.
+ * Only done when the simulator is started with SIM_HITL_BRIDGE set.
+ */
+static void hitlBridgeInitialize()
+{
+	if (getenv("SIM_HITL_BRIDGE") == NULL)
+		return;
+
+	uint16_t port = PIOS_SYS_SimPort(HITL_BRIDGE_PORT);
+
+	bridge_socket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	if (bridge_socket < 0)
+		return;
+
+	struct sockaddr_in addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_ANY);
+	addr.sin_port = htons(port);
+
+	if (bind(bridge_socket, (struct sockaddr *) &addr, sizeof(addr)) < 0) {
+		close(bridge_socket);
+		bridge_socket = -1;
+		return;
+	}
+
+	bridge_rx_queue = xQueueCreate(2, sizeof(struct hitl_bridge_rx));
+
+	// Tells the bridge when the control loop has answered a sensor packet.
+	// Only connected while a simulator is driving the sensors.
+	ActuatorCommandInitialize();
+	ActuatorDesiredInitialize();
+	bridge_queue = xQueueCreate(1, sizeof(UAVObjEvent));
+
+	xTaskCreate(hitlBridgeRxTask, (signed char *)"HitlBridge", BRIDGE_STACK_SIZE_BYTES/4, NULL, BRIDGE_TASK_PRIORITY, &bridgeTaskHandle);
+}
+
+/**
+ * Blocks on the bridge socket and passes the valid sensor packets to the
+ * sensors task, like the UDP driver receive thread
+ */
+static void hitlBridgeRxTask(void *parameters)
+{
+	/* needed because of FreeRTOS.posix scheduling */
+	sigset_t set;
+	sigfillset(&set);
+	sigprocmask(SIG_BLOCK, &set, NULL);
+
+	// One byte larger so that a longer datagram fails the size check
+	uint8_t buf[sizeof(struct hitl_bridge_sensors) + 1];
+	struct hitl_bridge_rx rx;
+
+	while (1) {
+		socklen_t peer_len = sizeof(rx.peer);
+		ssize_t len = recvfrom(bridge_socket, buf, sizeof(buf), 0, (struct sockaddr *) &rx.peer, &peer_len);
+		if (len < 0)
+			continue;
+
+		const struct hitl_bridge_sensors *sensors = hitl_bridge_sensors_check(buf, len);
+		if (sensors == NULL)
+			continue;
+
+		// The simulator resends when an answer is late, drop rather than queue up
+		rx.sensors = *sensors;
+		xQueueSendToBack(bridge_rx_queue, &rx, 0);
+	}
+}
+
+/**
+ * Handle the next sensor packet. While a simulator is connected this blocks
+ * until a packet arrives, and gives up after HITL_BRIDGE_TIMEOUT_MS.
+ * @returns true while a simulator is driving the sensors
+ */
+static bool hitlBridgeUpdate()
+{
+	if (bridge_socket < 0)
+		return false;
+
+	struct hitl_bridge_rx rx;
+	UAVObjEvent ev;
+
+	if (xQueueReceive(bridge_rx_queue, &rx, bridge_active ? MS2TICKS(HITL_BRIDGE_TIMEOUT_MS) : 0) != pdTRUE) {
+		if (bridge_active) {
+			// Simulator lost, back to the internal model
+			bridge_active = false;
+			UAVObjDisconnectQueue(ActuatorCommandHandle(), bridge_queue);
+			while (xQueueReceive(bridge_queue, &ev, 0) == pdTRUE);
+		}
+		return false;
+	}
+
+	if (!bridge_active) {
+		bridge_active = true;
+		ActuatorCommandConnectQueue(bridge_queue);
+	}
+
+	hitlBridgeStep(&rx.sensors, &rx.peer);
+
+	return true;
+}
+
+/**
+ * Write the sensor objects from one packet and answer with the actuators
+ * @param[in] sensors the packet
+ * @param[in] peer where to send the answer
+ */
+static void hitlBridgeStep(const struct hitl_bridge_sensors *sensors, const struct sockaddr_in *peer)
+{
+	uint32_t start = PIOS_DELAY_GetRaw();
+	bool lockstep = (sensors->flags & HITL_BRIDGE_LOCKSTEP) != 0;
+	UAVObjEvent ev;
+
+	// In lockstep only an update caused by this packet counts
+	if (lockstep)
+		while (xQueueReceive(bridge_queue, &ev, 0) == pdTRUE);
+
+	if (sensors->flags & HITL_BRIDGE_HAS_MAG) {
+		MagnetometerData mag;
+		mag.x = sensors->mag[0];
+		mag.y = sensors->mag[1];
+		mag.z = sensors->mag[2];
+		magOffsetEstimation(&mag);
+		MagnetometerSet(&mag);
+	}
+
+	if (sensors->flags & HITL_BRIDGE_HAS_BARO) {
+		BaroAltitudeData baroAltitude;
+		BaroAltitudeGet(&baroAltitude);
+		baroAltitude.Altitude = sensors->baro_altitude;
+		BaroAltitudeSet(&baroAltitude);
+	}
+
+	if (sensors->flags & HITL_BRIDGE_HAS_AIRSPEED) {
+		BaroAirspeedData baroAirspeed;
+		BaroAirspeedGet(&baroAirspeed);
+		baroAirspeed.BaroConnected = BAROAIRSPEED_BAROCONNECTED_TRUE;
+		baroAirspeed.CalibratedAirspeed = sensors->airspeed;
+		baroAirspeed.GPSAirspeed = sensors->airspeed;
+		baroAirspeed.TrueAirspeed = sensors->airspeed;
+		BaroAirspeedSet(&baroAirspeed);
+	}
+
+	if (sensors->flags & HITL_BRIDGE_HAS_GPS) {
+		GPSPositionData gpsPosition;
+		GPSPositionGet(&gpsPosition);
+		gpsPosition.Latitude = sensors->latitude;
+		gpsPosition.Longitude = sensors->longitude;
+		gpsPosition.Altitude = sensors->altitude;
+		gpsPosition.Groundspeed = sqrtf(sensors->velocity[0] * sensors->velocity[0] + sensors->velocity[1] * sensors->velocity[1]);
+		gpsPosition.Heading = RAD2DEG * atan2f(sensors->velocity[1], sensors->velocity[0]);
+		gpsPosition.Satellites = 7;
+		gpsPosition.PDOP = 1;
+		gpsPosition.Status = GPSPOSITION_STATUS_FIX3D;
+		GPSPositionSet(&gpsPosition);
+
+		GPSVelocityData gpsVelocity;
+		gpsVelocity.North = sensors->velocity[0];
+		gpsVelocity.East = sensors->velocity[1];
+		gpsVelocity.Down = sensors->velocity[2];
+		GPSVelocitySet(&gpsVelocity);
+	}
+
+	AccelsData accelsData;
+	accelsData.x = sensors->accel[0];
+	accelsData.y = sensors->accel[1];
+	accelsData.z = sensors->accel[2];
+	accelsData.temperature = 30;
+	AccelsSet(&accelsData);
+
+	// Gyros last, they trigger the attitude estimation
+	GyrosBiasData gyrosBias;
+	GyrosBiasGet(&gyrosBias);
+	GyrosData gyrosData;
+	gyrosData.x = sensors->gyro[0] + gyrosBias.x;
+	gyrosData.y = sensors->gyro[1] + gyrosBias.y;
+	gyrosData.z = sensors->gyro[2] + gyrosBias.z;
+	gyrosData.temperature = 30;
+	GyrosSet(&gyrosData);
+
+	bool fresh = xQueueReceive(bridge_queue, &ev,
+			lockstep ? MS2TICKS(HITL_BRIDGE_LOCKSTEP_TIMEOUT_MS) : 0) == pdTRUE;
+
+	struct hitl_bridge_actuators actuators;
+	actuators.magic = HITL_BRIDGE_ACTUATORS_MAGIC;
+	actuators.seq = sensors->seq;
+	actuators.fresh = fresh;
+
+	ActuatorDesiredData desired;
+	ActuatorDesiredGet(&desired);
+	actuators.desired[0] = desired.Roll;
+	actuators.desired[1] = desired.Pitch;
+	actuators.desired[2] = desired.Yaw;
+	actuators.desired[3] = desired.Throttle;
+
+	ActuatorCommandData command;
+	ActuatorCommandGet(&command);
+	for (int i = 0; i < HITL_BRIDGE_CHANNELS; i++)
+		actuators.channel[i] = (i < ACTUATORCOMMAND_CHANNEL_NUMELEM) ? command.Channel[i] : 0;
+
+	actuators.firmware_us = PIOS_DELAY_DiffuS(start);
+
+	sendto(bridge_socket, &actuators, sizeof(actuators), 0, (const struct sockaddr *) peer, sizeof(*peer));
+}
+
+/**
+ * Flag the settings for the sensors task to reload
+ */
+static void simulationSettingsUpdated(UAVObjEvent * ev)
+{
+	simulationSettingsChanged = true;
+}
+
+/**
+ * Reseed the noise and pick up the disturbance levels
+ */
+static void simulationSettingsLoad()
+{
+	SimulationSettingsGet(&simulationSettings);
+
+	// A fixed seed makes the noise sequence, and so the whole run, repeatable
+	if (simulationSettings.Seed != 0)
+		srand(simulationSettings.Seed);
+}
+
+/**
+ * Steady wind from the settings plus a random walk for the gusts
+ * @param[out] wind the wind velocity in NED (m/s)
+ */
+static void simulateWind(float wind[3])
+{
+	static float gust[3] = {0,0,0};
+
+	for (int i = 0; i < 3; i++) {
+		gust[i] = gust[i] * 0.95 + simulationSettings.Turbulence * unit_gauss() / 10.0;
+		wind[i] = simulationSettings.Wind[i] + gust[i];
+	}
+}
+
+/**
+ * Sensor noise, scaled by SimulationSettings.NoiseScale
+ */
 static float rand_gauss (void) {
+	return simulationSettings.NoiseScale * unit_gauss();
+}
+
+static float unit_gauss (void) {
 	float v1,v2,s;
 	
 	do {
@@ -93,6 +93,8 @@ enum {
 // Private variables
 static xTaskHandle taskHandle;
 static StabilizationSettingsData settings;
+static uint16_t settings_epoch;
+static uint16_t trim_settings_epoch;
 static TrimAnglesData trimAngles;
 static xQueueHandle queue;
 float gyro_alpha = 0;
@@ -108,7 +110,7 @@ struct pid pids[PID_MAX];
 // Private functions
 static void stabilizationTask(void* parameters);
 static void ZeroPids(void);
-static void SettingsUpdatedCb(UAVObjEvent * ev);
+static void update_settings(void);
 
 /**
  * Module initialization
@@ -122,10 +124,6 @@ int32_t StabilizationStart()
 	// Listen for updates.
 	//	AttitudeActualConnectQueue(queue);
 	GyrosConnectQueue(queue);
-	
-	// Connect settings callback
-	StabilizationSettingsConnectCallback(SettingsUpdatedCb);
-	TrimAnglesSettingsConnectCallback(SettingsUpdatedCb);
 
 	// Start main task
 	xTaskCreate(stabilizationTask, (signed char*)"Stabilization", STACK_SIZE_BYTES/4, NULL, TASK_PRIORITY, &taskHandle);
@@ -176,8 +174,8 @@ static void stabilizationTask(void* parameters)
 	float *actuatorDesiredAxis = &actuatorDesired.Roll;
 	float *rateDesiredAxis = &rateDesired.Roll;
 
-	// Force refresh of all settings immediately before entering main task loop
-	SettingsUpdatedCb((UAVObjEvent *) NULL);
+	// Load the settings before entering main task loop
+	update_settings();
 	
 	// Main task loop
 	ZeroPids();
@@ -185,6 +183,7 @@ static void stabilizationTask(void* parameters)
 		float dT;
 		
 		PIOS_WDG_UpdateFlag(PIOS_WDG_STABILIZATION);
+		TaskMonitorLoop(TASKINFO_RUNNING_STABILIZATION);
 		
 		// Wait until the AttitudeRaw object is updated, if a timeout then go to failsafe
 		if ( xQueueReceive(queue, &ev, MS2TICKS(FAILSAFE_TIMEOUT_MS)) != pdTRUE )
@@ -195,6 +194,8 @@ static void stabilizationTask(void* parameters)
 		
 		dT = PIOS_DELAY_DiffuS(timeval) * 1.0e-6f;
 		timeval = PIOS_DELAY_GetRaw();
+
+		update_settings();
 		
 		FlightStatusGet(&flightStatus);
 		StabilizationDesiredGet(&stabDesired);
@@ -565,14 +566,16 @@ static void ZeroPids(void)
 }
 
 
-static void SettingsUpdatedCb(UAVObjEvent * ev)
+/**
+ * Reload the settings which changed since the last loop, from the
+ * stabilization task so the controller never sees them half updated
+ */
+static void update_settings(void)
 {
-	if (ev == NULL || ev->obj == TrimAnglesSettingsHandle())
+	TrimAnglesSettingsData trimAnglesSettings;
+	if (TrimAnglesSettingsGetIfChanged(&trimAnglesSettings, &trim_settings_epoch) > 0)
 	{
-		TrimAnglesSettingsData trimAnglesSettings;
-
 		TrimAnglesGet(&trimAngles);
-		TrimAnglesSettingsGet(&trimAnglesSettings);
 
 		// Set the trim angles
 		trimAngles.Roll = trimAnglesSettings.Roll;
@@ -581,9 +584,8 @@ static void SettingsUpdatedCb(UAVObjEvent * ev)
 		TrimAnglesSet(&trimAngles);
 	}
 
-	if (ev == NULL || ev->obj == StabilizationSettingsHandle())
+	if (StabilizationSettingsGetIfChanged(&settings, &settings_epoch) > 0)
 	{
-		StabilizationSettingsGet(&settings);
 		// Set the roll rate PID constants
 		pid_configure(&pids[PID_RATE_ROLL],
 		              settings.RollRatePID[STABILIZATIONSETTINGS_ROLLRATEPID_KP],
@@ -38,6 +38,9 @@
 #include "systemstats.h"
 #include "systemsettings.h"
 #include "taskinfo.h"
+#include "taskprofile.h"
+#include "taskloopprofile.h"
+#include "irqprofile.h"
 #include "watchdogstatus.h"
 #include "taskmonitor.h"
 
@@ -119,6 +122,9 @@ int32_t SystemModInitialize(void)
 	ObjectPersistenceInitialize();
 #if defined(DIAG_TASKS)
 	TaskInfoInitialize();
+	TaskProfileInitialize();
+	TaskLoopProfileInitialize();
+	IRQProfileInitialize();
 #endif
 #if defined(WDG_STATS_DIAGNOSTICS)
 	WatchdogStatusInitialize();
@@ -32,6 +32,9 @@
 #include "flighttelemetrystats.h"
 #include "gcstelemetrystats.h"
 #include "modulesettings.h"
+#if defined(PIOS_TELEM_SCHEDULER)
+#include "telemetryrates.h"
+#endif
 
 // Private constants
 #define MAX_QUEUE_SIZE   TELEM_QUEUE_SIZE
@@ -44,8 +47,34 @@
 #define STATS_UPDATE_PERIOD_MS 4000
 #define CONNECTION_TIMEOUT_MS 8000
 
+#if defined(PIOS_TELEM_SCHEDULER)
+#define SCHEDULER_RETRY_MS 10        // How often due objects are reconsidered while the budget is exhausted
+#define SCHEDULER_BURST_MS 250       // Largest burst allowed by the budget, in ms worth of link time
+#define SCHEDULER_UTILIZATION 90     // Share of the nominal link rate the budget may use, in percent
+#define SCHEDULER_RECOVERY 16        // The budget grows back by this fraction of the nominal rate per stats update
+#define SCHEDULER_MIN_BUDGET 8       // The budget never drops below this fraction of the nominal rate
+#define UAVTALK_FRAME_OVERHEAD 9     // sync, type, size, object ID and checksum
+#define UAVTALK_INSTID_LENGTH 2
+#endif
+
 // Private types
 
+#if defined(PIOS_TELEM_SCHEDULER)
+/**
+ * A periodic object, as seen by the link scheduler. The periodic events from
+ * the event dispatcher only mark it due, the scheduler then sends due objects
+ * when the link budget allows, most overdue first.
+ */
+struct telemetry_stream {
+	UAVObjHandle obj;
+	uint32_t lastSent;  // ms
+	uint16_t period;    // ms, 0 while the object is not periodic
+	uint16_t sent;      // frames sent since the rates were last published
+	bool due;
+	struct telemetry_stream *next;
+};
+#endif
+
 // Private variables
 static uintptr_t telemetryPort;
 static xQueueHandle queue;
@@ -65,6 +94,16 @@ static uint32_t txRetries;
 static uint32_t timeOfLastObjectUpdate;
 static UAVTalkConnection uavTalkCon;
 
+#if defined(PIOS_TELEM_SCHEDULER)
+static struct telemetry_stream *streams;
+static uint32_t linkRate;         // nominal rate of the telemetry port in bytes/s
+static uint32_t budgetRate;       // rate the scheduler currently plans with in bytes/s
+static int32_t budgetBytes;       // bytes which can be sent right now, negative when in debt
+static uint32_t budgetRefillTime; // ms
+static uint32_t txBlockedTime;    // ms spent waiting for the port since the last stats update
+static uint32_t ratesPublishTime; // ms
+#endif
+
 // Private functions
 static void telemetryTxTask(void *parameters);
 static void telemetryRxTask(void *parameters);
@@ -77,6 +116,13 @@ static void updateTelemetryStats();
 static void gcsTelemetryStatsUpdated();
 static void updateSettings();
 static uintptr_t getComPort();
+#if defined(PIOS_TELEM_SCHEDULER)
+static void schedulerSetPeriod(UAVObjHandle obj, uint16_t period);
+static bool schedulerMarkDue(UAVObjHandle obj);
+static bool schedulerSendDue();
+static void schedulerUpdateBudget(uint32_t achievedRate);
+static void schedulerPublishRates();
+#endif
 
 /**
  * Initialise the telemetry module
@@ -118,6 +164,10 @@ int32_t TelemetryInitialize(void)
 	// Initialize vars
 	timeOfLastObjectUpdate = 0;
 
+#if defined(PIOS_TELEM_SCHEDULER)
+	TelemetryRatesInitialize();
+#endif
+
 	// Create object queues
 	queue = xQueueCreate(MAX_QUEUE_SIZE, sizeof(UAVObjEvent));
 #if defined(PIOS_TELEM_PRIORITY_QUEUE)
@@ -199,11 +249,19 @@ static void updateObject(UAVObjHandle obj, int32_t eventType)
 	UAVObjGetMetadata(obj, &metadata);
 	updateMode = UAVObjGetTelemetryUpdateMode(&metadata);
 
+#if defined(PIOS_TELEM_SCHEDULER)
+	// Only periodic objects are scheduled, the case below sets the period again
+	schedulerSetPeriod(obj, 0);
+#endif
+
 	// Setup object depending on update mode
 	switch (updateMode) {
 	case UPDATEMODE_PERIODIC:
 		// Set update period
 		setUpdatePeriod(obj, metadata.telemetryUpdatePeriod);
+#if defined(PIOS_TELEM_SCHEDULER)
+		schedulerSetPeriod(obj, metadata.telemetryUpdatePeriod);
+#endif
 		// Connect queue
 		eventMask = EV_UPDATED_PERIODIC | EV_UPDATED_MANUAL | EV_UPDATE_REQ;
 		UAVObjConnectQueue(obj, priorityQueue, eventMask);
@@ -272,7 +330,10 @@ static void processObjEvent(UAVObjEvent * ev)
 		// Act on event
 		retries = 0;
 		success = -1;
-		if (ev->event == EV_UPDATED || ev->event == EV_UPDATED_MANUAL || ((ev->event == EV_UPDATED_PERIODIC) && (updateMode != UPDATEMODE_THROTTLED))) {
+		if (ev->event == EV_UPDATED_PERIODIC && updateMode == UPDATEMODE_PERIODIC &&
+				UAVObjIsEmitOnChange(ev->obj) && !UAVObjTestAndClearDirty(ev->obj)) {
+			// Nothing changed since the last periodic send, don't spend link bandwidth on it
+		} else if (ev->event == EV_UPDATED || ev->event == EV_UPDATED_MANUAL || ((ev->event == EV_UPDATED_PERIODIC) && (updateMode != UPDATEMODE_THROTTLED))) {
 			// Send update to GCS (with retries)
 			while (retries < MAX_RETRIES && success == -1) {
 				success = UAVTalkSendObject(uavTalkCon, ev->obj, ev->instId, UAVObjGetTelemetryAcked(&metadata), REQ_TIMEOUT_MS);	// call blocks until ack is received or timeout
@@ -329,14 +390,29 @@ static void processObjEvent(UAVObjEvent * ev)
 static void telemetryTxTask(void *parameters)
 {
 	UAVObjEvent ev;
+#if defined(PIOS_TELEM_SCHEDULER)
+	bool pending = false;
+#endif
 
 	// Loop forever
 	while (1) {
+#if defined(PIOS_TELEM_SCHEDULER)
+		// Wait for queue message, or until the budget may allow the pending objects out
+		if (xQueueReceive(queue, &ev, pending ? MS2TICKS(SCHEDULER_RETRY_MS) : portMAX_DELAY) == pdTRUE) {
+			// Periodic updates only mark the object due, anything else goes out right away
+			if (ev.event != EV_UPDATED_PERIODIC || ev.obj == 0 || !schedulerMarkDue(ev.obj)) {
+				processObjEvent(&ev);
+			}
+		}
+
+		pending = schedulerSendDue();
+#else
 		// Wait for queue message
 		if (xQueueReceive(queue, &ev, portMAX_DELAY) == pdTRUE) {
 			// Process event
 			processObjEvent(&ev);
 		}
+#endif
 	}
 }
 
@@ -397,8 +473,24 @@ static int32_t transmitData(uint8_t * data, int32_t length)
 {
 	uintptr_t outputPort = getComPort();
 
-	if (outputPort)
+	if (outputPort) {
+#if defined(PIOS_TELEM_SCHEDULER)
+		portENTER_CRITICAL();
+		budgetBytes -= length;
+		portEXIT_CRITICAL();
+
+		// Time spent here beyond a tick means the port could not keep up
+		portTickType start = xTaskGetTickCount();
+		int32_t rc = PIOS_COM_SendBuffer(outputPort, data, length);
+		portTickType blocked = xTaskGetTickCount() - start;
+		if (blocked > 1) {
+			txBlockedTime += TICKS2MS(blocked);
+		}
+		return rc;
+#else
 		return PIOS_COM_SendBuffer(outputPort, data, length);
+#endif
+	}
 
 	return -1;
 }
@@ -457,6 +549,12 @@ static void updateTelemetryStats()
 	FlightTelemetryStatsGet(&flightStats);
 	GCSTelemetryStatsGet(&gcsStats);
 
+#if defined(PIOS_TELEM_SCHEDULER)
+	// Adapt the link budget to what actually went out, and report how each object fared
+	schedulerUpdateBudget(utalkStats.txBytes * 1000 / STATS_UPDATE_PERIOD_MS);
+	schedulerPublishRates();
+#endif
+
 	// Update stats object
 	if (flightStats.Status == FLIGHTTELEMETRYSTATS_STATUS_CONNECTED) {
 		flightStats.RxDataRate = (float)utalkStats.rxBytes / ((float)STATS_UPDATE_PERIOD_MS / 1000.0f);
@@ -543,29 +641,39 @@ static void updateSettings()
 		ModuleSettingsTelemetrySpeedGet(&speed);
 
 		// Set port speed
+		uint32_t baud = 0;
 		switch (speed) {
 		case MODULESETTINGS_TELEMETRYSPEED_2400:
-			PIOS_COM_ChangeBaud(telemetryPort, 2400);
+			baud = 2400;
 			break;
 		case MODULESETTINGS_TELEMETRYSPEED_4800:
-			PIOS_COM_ChangeBaud(telemetryPort, 4800);
+			baud = 4800;
 			break;
 		case MODULESETTINGS_TELEMETRYSPEED_9600:
-			PIOS_COM_ChangeBaud(telemetryPort, 9600);
+			baud = 9600;
 			break;
 		case MODULESETTINGS_TELEMETRYSPEED_19200:
-			PIOS_COM_ChangeBaud(telemetryPort, 19200);
+			baud = 19200;
 			break;
 		case MODULESETTINGS_TELEMETRYSPEED_38400:
-			PIOS_COM_ChangeBaud(telemetryPort, 38400);
+			baud = 38400;
 			break;
 		case MODULESETTINGS_TELEMETRYSPEED_57600:
-			PIOS_COM_ChangeBaud(telemetryPort, 57600);
+			baud = 57600;
 			break;
 		case MODULESETTINGS_TELEMETRYSPEED_115200:
-			PIOS_COM_ChangeBaud(telemetryPort, 115200);
+			baud = 115200;
 			break;
 		}
+
+		if (baud) {
+			PIOS_COM_ChangeBaud(telemetryPort, baud);
+#if defined(PIOS_TELEM_SCHEDULER)
+			// 8N1 framing, ten bits per byte
+			linkRate = baud / 10;
+			budgetRate = linkRate * SCHEDULER_UTILIZATION / 100;
+#endif
+		}
 	}
 }
 
@@ -584,6 +692,193 @@ static uintptr_t getComPort() {
 			return 0;
 }
 
+#if defined(PIOS_TELEM_SCHEDULER)
+/**
+ * Set the period the scheduler sends an object at
+ * \param[in] obj The object
+ * \param[in] period The requested period in ms, 0 to stop scheduling the object
+ */
+static void schedulerSetPeriod(UAVObjHandle obj, uint16_t period)
+{
+	struct telemetry_stream *stream;
+
+	LL_FOREACH(streams, stream) {
+		if (stream->obj == obj) {
+			stream->period = period;
+			stream->due &= (period != 0);
+			return;
+		}
+	}
+
+	if (period == 0)
+		return;
+
+	// Streams are never freed, the telemetry tasks walk the list without locking
+	stream = (struct telemetry_stream *) pvPortMalloc(sizeof(*stream));
+	if (stream == NULL)
+		return;
+
+	memset(stream, 0, sizeof(*stream));
+	stream->obj = obj;
+	stream->period = period;
+	LL_APPEND(streams, stream);
+}
+
+/**
+ * Mark an object due for its periodic update
+ * \return true if the scheduler will send it, false if it is not scheduled
+ */
+static bool schedulerMarkDue(UAVObjHandle obj)
+{
+	struct telemetry_stream *stream;
+
+	LL_FOREACH(streams, stream) {
+		if (stream->obj == obj && stream->period != 0) {
+			// If it is still due from the last period, that update is simply merged into this one
+			stream->due = true;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/**
+ * Size of the frames sent for a periodic update of an object
+ */
+static uint32_t schedulerFrameBytes(UAVObjHandle obj)
+{
+	if (UAVObjIsSingleInstance(obj))
+		return UAVTALK_FRAME_OVERHEAD + UAVObjGetNumBytes(obj);
+
+	return UAVObjGetNumInstances(obj) *
+		(UAVTALK_FRAME_OVERHEAD + UAVTALK_INSTID_LENGTH + UAVObjGetNumBytes(obj));
+}
+
+/**
+ * Send the due objects the link budget allows, most overdue relative to their period first,
+ * so that when the link is short every object slows down in proportion rather than some
+ * objects being dropped altogether.
+ * \return true if objects are still waiting for budget
+ */
+static bool schedulerSendDue()
+{
+	while (1) {
+		uint32_t now = TICKS2MS(xTaskGetTickCount());
+
+		// Refill the budget for the time elapsed, allowing bursts of up to SCHEDULER_BURST_MS
+		uint32_t elapsed = now - budgetRefillTime;
+		if (elapsed > SCHEDULER_BURST_MS)
+			elapsed = SCHEDULER_BURST_MS;
+		budgetRefillTime = now;
+
+		int32_t burst = budgetRate * SCHEDULER_BURST_MS / 1000;
+		portENTER_CRITICAL();
+		budgetBytes += budgetRate * elapsed / 1000;
+		if (budgetBytes > burst)
+			budgetBytes = burst;
+		portEXIT_CRITICAL();
+
+		// Pick the most overdue object
+		struct telemetry_stream *stream;
+		struct telemetry_stream *next = NULL;
+		uint32_t nextStaleness = 0;
+		LL_FOREACH(streams, stream) {
+			if (!stream->due || stream->period == 0)
+				continue;
+
+			// Staleness in 1/256th of the period
+			uint32_t age = now - stream->lastSent;
+			if (age > 0xFFFFFF)
+				age = 0xFFFFFF;
+			uint32_t staleness = (age << 8) / stream->period;
+			if (next == NULL || staleness > nextStaleness) {
+				next = stream;
+				nextStaleness = staleness;
+			}
+		}
+
+		if (next == NULL)
+			return false;
+
+		// USB and other ports without a nominal rate are not budgeted
+		if (getComPort() == telemetryPort && linkRate != 0 &&
+				budgetBytes < (int32_t) schedulerFrameBytes(next->obj))
+			return true;
+
+		next->due = false;
+		next->lastSent = now;
+		next->sent++;
+
+		UAVObjEvent ev = {
+			.obj    = next->obj,
+			.instId = UAVOBJ_ALL_INSTANCES,
+			.event  = EV_UPDATED_PERIODIC,
+		};
+		processObjEvent(&ev);
+	}
+}
+
+/**
+ * Adjust the link budget once per stats update. When the port pushed back the link
+ * carries less than its nominal rate (e.g. a slower radio behind the serial port),
+ * so the budget drops to what actually went out. Otherwise it grows back slowly.
+ * \param[in] achievedRate The bytes/s sent since the last stats update
+ */
+static void schedulerUpdateBudget(uint32_t achievedRate)
+{
+	uint32_t nominal = linkRate * SCHEDULER_UTILIZATION / 100;
+
+	if (txBlockedTime > STATS_UPDATE_PERIOD_MS / 20) {
+		budgetRate = achievedRate;
+	} else {
+		budgetRate += nominal / SCHEDULER_RECOVERY;
+	}
+
+	if (budgetRate > nominal)
+		budgetRate = nominal;
+	if (budgetRate < nominal / SCHEDULER_MIN_BUDGET)
+		budgetRate = nominal / SCHEDULER_MIN_BUDGET;
+
+	txBlockedTime = 0;
+}
+
+/**
+ * Publish the requested and achieved rate of each scheduled object in TelemetryRates,
+ * one instance per object in scheduling order
+ */
+static void schedulerPublishRates()
+{
+	uint32_t now = TICKS2MS(xTaskGetTickCount());
+	uint32_t window = now - ratesPublishTime;
+	ratesPublishTime = now;
+
+	if (window == 0)
+		return;
+
+	uint16_t instId = 0;
+	struct telemetry_stream *stream;
+	LL_FOREACH(streams, stream) {
+		if (stream->period == 0)
+			continue;
+
+		TelemetryRatesData rates = {
+			.ObjectID      = UAVObjGetID(stream->obj),
+			.RequestedRate = 1000.0f / stream->period,
+			.AchievedRate  = stream->sent * 1000.0f / window,
+		};
+		stream->sent = 0;
+
+		if (instId >= UAVObjGetNumInstances(TelemetryRatesHandle()) &&
+				TelemetryRatesCreateInstance() != instId)
+			return;
+
+		TelemetryRatesInstSet(instId, &rates);
+		instId++;
+	}
+}
+#endif /* PIOS_TELEM_SCHEDULER */
+
 /**
   * @}
   * @}
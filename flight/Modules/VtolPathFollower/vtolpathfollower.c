@@ -75,11 +75,16 @@
 // Private variables
 static xTaskHandle pathfollowerTaskHandle;
 static PathDesiredData pathDesired;
+static struct path_segment pathSegment;
+static uint16_t pathDesiredEpoch;
 static VtolPathFollowerSettingsData guidanceSettings;
+static uint16_t guidanceSettingsEpoch;
+static StabilizationSettingsData stabSettings;
+static uint16_t stabSettingsEpoch;
 
 // Private functions
 static void vtolPathFollowerTask(void *parameters);
-static void SettingsUpdatedCb(UAVObjEvent * ev);
+static void updateSettings();
 static void updateNedAccel();
 static void updatePathVelocity();
 static void updateEndpointVelocity();
@@ -145,16 +150,11 @@ static float throttleOffset = 0;
 static void vtolPathFollowerTask(void *parameters)
 {
 	SystemSettingsData systemSettings;
+	uint16_t systemSettingsEpoch = 0;
 	FlightStatusData flightStatus;
 
 	portTickType lastUpdateTime;
 	
-	VtolPathFollowerSettingsConnectCallback(SettingsUpdatedCb);
-	PathDesiredConnectCallback(SettingsUpdatedCb);
-	
-	VtolPathFollowerSettingsGet(&guidanceSettings);
-	PathDesiredGet(&pathDesired);
-	
 	// Main task loop
 	lastUpdateTime = xTaskGetTickCount();
 	while (1) {
@@ -164,7 +164,7 @@ static void vtolPathFollowerTask(void *parameters)
 		// 2. Flight mode is PositionHold and PathDesired.Mode is Endpoint  OR
 		//    FlightMode is PathPlanner and PathDesired.Mode is Endpoint or Path
 
-		SystemSettingsGet(&systemSettings);
+		SystemSettingsGetIfChanged(&systemSettings, &systemSettingsEpoch);
 		if ( (systemSettings.AirframeType != SYSTEMSETTINGS_AIRFRAMETYPE_VTOL) &&
 			(systemSettings.AirframeType != SYSTEMSETTINGS_AIRFRAMETYPE_QUADP) &&
 			(systemSettings.AirframeType != SYSTEMSETTINGS_AIRFRAMETYPE_QUADX) &&
@@ -182,6 +182,8 @@ static void vtolPathFollowerTask(void *parameters)
 			continue;
 		}
 
+		updateSettings();
+
 		// Continue collecting data if not enough time
 		vTaskDelayUntil(&lastUpdateTime, MS2TICKS(guidanceSettings.UpdatePeriod));
 
@@ -259,7 +261,7 @@ static void updatePathVelocity()
 	float cur[3] = {positionActual.North, positionActual.East, positionActual.Down};
 	struct path_status progress;
 	
-	path_progress(&pathDesired, cur, &progress);
+	path_progress(&pathDesired, &pathSegment, cur, &progress);
 	
 	// Update the path status UAVO
 	PathStatusData pathStatus;
@@ -381,7 +383,6 @@ static void updateVtolDesiredAttitude()
 	StabilizationDesiredData stabDesired;
 	AttitudeActualData attitudeActual;
 	NedAccelData nedAccel;
-	StabilizationSettingsData stabSettings;
 
 	float northError;
 	float northCommand;
@@ -391,15 +392,13 @@ static void updateVtolDesiredAttitude()
 
 	float downError;
 	float downCommand;
-		
-	VtolPathFollowerSettingsGet(&guidanceSettings);
-	
+
 	VelocityActualGet(&velocityActual);
 	VelocityDesiredGet(&velocityDesired);
 	StabilizationDesiredGet(&stabDesired);
 	VelocityDesiredGet(&velocityDesired);
 	AttitudeActualGet(&attitudeActual);
-	StabilizationSettingsGet(&stabSettings);
+	StabilizationSettingsGetIfChanged(&stabSettings, &stabSettingsEpoch);
 	NedAccelGet(&nedAccel);
 	
 	float northVel = velocityActual.North;
@@ -514,9 +513,16 @@ static void updateNedAccel()
 	NedAccelSet(&accelData);
 }
 
-static void SettingsUpdatedCb(UAVObjEvent * ev)
+/**
+ * Copy the settings and path which changed since the last update, and
+ * reconfigure the PID loops if the settings did
+ */
+static void updateSettings()
 {
-	VtolPathFollowerSettingsGet(&guidanceSettings);
+	PathDesiredGetIfChanged(&pathDesired, &pathDesiredEpoch);
+
+	if (VtolPathFollowerSettingsGetIfChanged(&guidanceSettings, &guidanceSettingsEpoch) <= 0)
+		return;
 
 	// Configure the velocity control PID loops
 	pid_configure(&vtol_pids[NORTH_VELOCITY], 
@@ -551,9 +557,6 @@ static void SettingsUpdatedCb(UAVObjEvent * ev)
 		guidanceSettings.VerticalPosPI[VTOLPATHFOLLOWERSETTINGS_VERTICALPOSPI_KI],
 		0,
 		guidanceSettings.VerticalPosPI[VTOLPATHFOLLOWERSETTINGS_VERTICALPOSPI_ILIMIT]);
-
-
-	PathDesiredGet(&pathDesired);
 }
 
 /**
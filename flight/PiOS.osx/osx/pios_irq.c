@@ -34,6 +34,11 @@
 
 #if defined(PIOS_INCLUDE_IRQ)
 
+#if defined(DIAG_TASKS)
+/* There are no interrupt handlers on the simulator, so these stay at zero */
+volatile uint32_t pios_irq_profile_cycles[PIOS_IRQ_PROFILE_NUM];
+#endif
+
 /* Private Function Prototypes */
 
 /**
@@ -35,4 +35,27 @@
 extern int32_t PIOS_IRQ_Disable(void);
 extern int32_t PIOS_IRQ_Enable(void);
 
+/* Interrupt handlers are profiled in groups, one per peripheral type. These match the IRQProfile elements. */
+enum pios_irq_profile_group {
+	PIOS_IRQ_PROFILE_EXTI,
+	PIOS_IRQ_PROFILE_TIM,
+	PIOS_IRQ_PROFILE_USART,
+	PIOS_IRQ_PROFILE_SPI,
+	PIOS_IRQ_PROFILE_I2C,
+	PIOS_IRQ_PROFILE_NUM,
+};
+
+#if defined(DIAG_TASKS)
+/* Running total of the PIOS_DELAY_GetRaw() cycles spent in each group */
+extern volatile uint32_t pios_irq_profile_cycles[PIOS_IRQ_PROFILE_NUM];
+
+/* Bracket the body of a handler. BEGIN declares a local so it must come first.
+ * END adds atomically, as a nested handler of the same group may preempt it. */
+#define PIOS_IRQ_PROFILE_BEGIN() uint32_t pios_irq_profile_start = PIOS_DELAY_GetRaw()
+#define PIOS_IRQ_PROFILE_END(group) __sync_fetch_and_add(&pios_irq_profile_cycles[(group)], PIOS_DELAY_GetRaw() - pios_irq_profile_start)
+#else
+#define PIOS_IRQ_PROFILE_BEGIN()
+#define PIOS_IRQ_PROFILE_END(group)
+#endif
+
 #endif /* PIOS_IRQ_H */
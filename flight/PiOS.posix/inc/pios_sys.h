@@ -41,6 +41,7 @@ extern int32_t PIOS_SYS_Reset(void);
 extern uint32_t PIOS_SYS_getCPUFlashSize(void);
 extern int32_t PIOS_SYS_SerialNumberGetBinary(uint8_t array[PIOS_SYS_SERIAL_NUM_BINARY_LEN]);
 extern int32_t PIOS_SYS_SerialNumberGet(char str[PIOS_SYS_SERIAL_NUM_ASCII_LEN+1]);
+extern uint16_t PIOS_SYS_SimPort(uint16_t port);
 
 #endif /* PIOS_SYS_H */
 
@@ -85,6 +85,14 @@ Preemption is done by the main scheduler thread which attempts to run a tick
 handler at accurate intervals using nanosleep and gettimeofday, which allows
 more accurate high frequency ticks than a timer signal handler.
 
+In virtual time mode (vPortEnableVirtualTime) the scheduler thread instead
+runs the tick handler as soon as the running task waits for time to pass:
+either the idle task is running, or a task is in vPortVirtualDelay. Time then
+advances as fast as the host allows, and the ticks always land at the same
+points of the task code, so that runs are reproducible. A task that keeps the
+CPU for more than portVIRTUAL_TIME_TIMEOUT_S seconds of wall time is preempted
+by a tick anyway, which is the only point where the host speed leaks in.
+
 All public functions in this port are protected by a safeguard mutex which
 assures priority access on all data objects
 
@@ -103,6 +111,7 @@ This approach is tested and works both on Linux and BSD style Unix (MAC OS X)
 #include <stdio.h>
 #include <unistd.h>
 #include <limits.h>
+#include <semaphore.h>
 
 /* Scheduler includes. */
 #include "FreeRTOS.h"
@@ -110,6 +119,7 @@ This approach is tested and works both on Linux and BSD style Unix (MAC OS X)
 /*-----------------------------------------------------------*/
 
 #define MAX_NUMBER_OF_TASKS 		( _POSIX_THREAD_THREADS_MAX )
+#define portVIRTUAL_TIME_TIMEOUT_S	( 1 )
 /*-----------------------------------------------------------*/
 
 #define PORT_PRINT(...) fprintf(stderr,__VA_ARGS__)
@@ -160,6 +170,21 @@ static volatile portBASE_TYPE xPendYield = pdFALSE;
 static volatile portLONG lIndexOfLastAddedTask = 0;
 /*-----------------------------------------------------------*/
 
+/* Virtual time is the time of the last tick plus the time spent in
+ * vPortVirtualDelay since then. */
+static volatile portBASE_TYPE xVirtualTime = pdFALSE;
+static volatile unsigned long long ullTickTimeUS = 0;
+static volatile unsigned long ulSubTickUS = 0;
+
+/* Ticks run by the supervisor, which can read this without a critical section */
+static volatile unsigned long ulVirtualTicks = 0;
+
+/* The task which asked for a tick, and the tick count when it did */
+static volatile xTaskHandle hWaitingTask = NULL;
+static volatile unsigned long ulWaitingTicks = 0;
+static sem_t xWaitingSemaphore;
+/*-----------------------------------------------------------*/
+
 /*
  * Setup the timer to generate the tick interrupts.
  */
@@ -172,6 +197,9 @@ static xThreadState* prvGetThreadHandleByThread( pthread_t hThread );
 static portLONG prvGetFreeThreadState( void );
 static void prvDeleteThread( void *xThreadId );
 static void prvPortYield();
+static portBASE_TYPE prvSystemTick( void );
+static void prvWaitForTickRequest( void );
+static void prvRequestTick( unsigned long ulTicks );
 /*-----------------------------------------------------------*/
 
 /*
@@ -291,6 +319,19 @@ portBASE_TYPE xPortStartScheduler( void )
 	/* Start the first task. This gives up the RunningThreadMutex*/
 	vPortStartFirstTask();
 
+	/**
+	 * Virtual time scheduling loop. Tick as soon as a task asks for it, and
+	 * retry until the tick handler finds the task in a state where it can
+	 * be preempted.
+	 */
+	while ( pdTRUE == xVirtualTime && pdTRUE != xSchedulerEnd )
+	{
+		prvWaitForTickRequest();
+
+		while ( pdTRUE != xSchedulerEnd && pdTRUE != prvSystemTick() )
+			sched_yield();
+	}
+
 	/**
 	 * Main scheduling loop. Call the tick handler every
 	 * portTICK_RATE_MICROSECONDS
@@ -452,6 +493,9 @@ void prvPortYield()
 	xTaskToResume = prvGetThreadHandle( xTaskGetCurrentTaskHandle() );
 	if ( xTaskToSuspend != xTaskToResume )
 	{
+		/* A tick request only holds while its task keeps running */
+		hWaitingTask = NULL;
+
 		/* Resume the other thread first */
 		prvResumeThread( xTaskToResume );
 
@@ -585,6 +629,16 @@ void vPortClearInterruptMask( portBASE_TYPE xMask )
  * the tick handler is just an ordinary function, called by the supervisor thread periodically
  */
 void vPortSystemTickHandler()
+{
+	(void) prvSystemTick();
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * run one tick
+ * \return pdFALSE if the running task could not be preempted, the tick is then pended
+ */
+static portBASE_TYPE prvSystemTick( void )
 {
 	/**
 	 * the problem with the tick handler is, that it runs outside of the schedulers domain - worse,
@@ -597,14 +651,14 @@ void vPortSystemTickHandler()
 	if ( prvGetThreadHandle(xTaskGetCurrentTaskHandle())->threadStatus!=THREAD_RUNNING ) {
 		xPendYield = pdTRUE;
 		PORT_UNLOCK( xGuardMutex );
-		return;
+		return pdFALSE;
 	}
 
 	/* interrupts MUST be enabled */
 	if ( xInterruptsEnabled != pdTRUE ) {
 		xPendYield = pdTRUE;
 		PORT_UNLOCK( xGuardMutex );
-		return;
+		return pdFALSE;
 	}
 
 	/* this should always be true, but it can't harm to check */
@@ -643,6 +697,17 @@ void vPortSystemTickHandler()
 	 * vTaskIncrementTick()...
 	 */
 
+	/**
+	 * advance virtual time, all tasks are halted so nobody sees it move
+	 */
+	if ( pdTRUE == xVirtualTime )
+	{
+		ullTickTimeUS += portTICK_RATE_MICROSECONDS;
+		ulSubTickUS = 0;
+		ulVirtualTicks++;
+		hWaitingTask = NULL;
+	}
+
 	/**
 	 * call tick handler
 	 */
@@ -670,6 +735,8 @@ void vPortSystemTickHandler()
 
 	/* finish up */
 	PORT_UNLOCK( xGuardMutex );
+
+	return pdTRUE;
 }
 /*-----------------------------------------------------------*/
 
@@ -1087,3 +1154,139 @@ struct tms xTimes;
 }
 /*-----------------------------------------------------------*/
 
+/**
+ * idle task hook
+ */
+void vPortIdle( void )
+{
+	if ( pdTRUE == xVirtualTime )
+	{
+		/* nothing to do until the next tick */
+		prvRequestTick( ulVirtualTicks );
+		return;
+	}
+
+	// call nanosleep for smalles sleep time possible
+	// (depending on kernel settings - around 100 microseconds)
+	// decreases idle thread CPU load from 100 to practically 0
+	struct timespec x;
+	x.tv_sec=1;
+	x.tv_nsec=0;
+	nanosleep(&x,NULL);
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * switch to virtual time, must be called before the scheduler starts
+ */
+void vPortEnableVirtualTime( void )
+{
+	PORT_ASSERT( pdFALSE == xSchedulerStarted );
+	PORT_ASSERT( 0 == sem_init( &xWaitingSemaphore, 0, 0 ) );
+	xVirtualTime = pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+portBASE_TYPE xPortVirtualTimeEnabled( void )
+{
+	return xVirtualTime;
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * \return virtual microseconds since the program started
+ */
+unsigned long long ullPortGetVirtualTimeUS( void )
+{
+	return ullTickTimeUS + ulSubTickUS;
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * busy wait in virtual time
+ * Waits shorter than what is left of the current tick return immediately, the
+ * task is simply considered to have used that much CPU time. Longer waits let
+ * the tick run, during which higher priority tasks may run as they would on
+ * the hardware. With interrupts disabled the tick can not come, the time
+ * passes without it like the hardware would lose the ticks.
+ */
+void vPortVirtualDelay( unsigned long ulMicroseconds )
+{
+	PORT_ASSERT( pdTRUE == xVirtualTime );
+
+	if ( pdTRUE != xSchedulerStarted || pdTRUE != xInterruptsEnabled )
+	{
+		/* there are no ticks yet, or they can not preempt us */
+		ullTickTimeUS += ulMicroseconds;
+		return;
+	}
+
+	while ( ulMicroseconds > 0 )
+	{
+		unsigned long ulTicks = ulVirtualTicks;
+		unsigned long ulTickLeftUS = portTICK_RATE_MICROSECONDS - ulSubTickUS;
+
+		if ( ulMicroseconds < ulTickLeftUS )
+		{
+			ulSubTickUS += ulMicroseconds;
+			return;
+		}
+
+		ulMicroseconds -= ulTickLeftUS;
+		while ( ulVirtualTicks == ulTicks )
+		{
+			prvRequestTick( ulTicks );
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * ask the supervisor for the tick which follows ulTicks, and yield the host
+ * CPU until it preempts this thread. There is no real time sleep here, the
+ * tick runs as soon as the supervisor gets scheduled.
+ */
+static void prvRequestTick( unsigned long ulTicks )
+{
+	ulWaitingTicks = ulTicks;
+	hWaitingTask = xTaskGetCurrentTaskHandle();
+	sem_post( &xWaitingSemaphore );
+
+	while ( ulVirtualTicks == ulTicks && pdTRUE != xSchedulerEnd )
+		sched_yield();
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * block the supervisor until the running task requests a tick, or until it
+ * has kept the CPU for too long
+ */
+static void prvWaitForTickRequest( void )
+{
+	static portBASE_TYPE xWarned = pdFALSE;
+	struct timespec xTimeout;
+
+	clock_gettime( CLOCK_REALTIME, &xTimeout );
+	xTimeout.tv_sec += portVIRTUAL_TIME_TIMEOUT_S;
+
+	while ( pdTRUE != xSchedulerEnd )
+	{
+		if ( 0 != sem_timedwait( &xWaitingSemaphore, &xTimeout ) )
+		{
+			if ( EINTR == errno )
+				continue;
+
+			if ( pdTRUE != xWarned )
+			{
+				PORT_PRINT( "A task kept the CPU for %d s, the virtual time run is not reproducible.\n", portVIRTUAL_TIME_TIMEOUT_S );
+				xWarned = pdTRUE;
+			}
+			return;
+		}
+
+		/* Stale requests are from tasks which have since moved on */
+		if ( hWaitingTask == xTaskGetCurrentTaskHandle() && ulWaitingTicks == ulVirtualTicks )
+			return;
+	}
+}
+/*-----------------------------------------------------------*/
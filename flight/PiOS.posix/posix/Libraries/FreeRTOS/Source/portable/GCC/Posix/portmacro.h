@@ -140,6 +140,15 @@ extern void vPortForciblyEndThread( void *pxTaskToDelete );
 extern void vPortAddTaskHandle( void *pxTaskHandle );
 #define traceTASK_CREATE( pxNewTCB )			vPortAddTaskHandle( pxNewTCB )
 
+/* Called by the idle task when there is nothing left to run. */
+extern void vPortIdle( void );
+
+/* Virtual time, where the tick runs as fast as the tasks allow. See port.c. */
+extern void vPortEnableVirtualTime( void );
+extern portBASE_TYPE xPortVirtualTimeEnabled( void );
+extern unsigned long long ullPortGetVirtualTimeUS( void );
+extern void vPortVirtualDelay( unsigned long ulMicroseconds );
+
 /* Posix Signal definitions that can be changed or read as appropriate. */
 #define SIG_SUSPEND					SIGUSR1
 
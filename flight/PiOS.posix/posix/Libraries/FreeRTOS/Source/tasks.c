@@ -1827,13 +1827,8 @@ static portTASK_FUNCTION( prvIdleTask, pvParameters )
 			vApplicationIdleHook();
 		}
 		#endif
-		// call nanosleep for smalles sleep time possible
-		// (depending on kernel settings - around 100 microseconds)
-		// decreases idle thread CPU load from 100 to practically 0
-		struct timespec x;
-		x.tv_sec=1;
-		x.tv_nsec=0;
-		nanosleep(&x,NULL);
+		// let the port sleep until the next tick
+		vPortIdle();
 	}
 } /*lint !e715 pvParameters is not accessed but all task functions require the same prototype. */
 
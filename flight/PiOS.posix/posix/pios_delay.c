@@ -65,6 +65,11 @@ int32_t PIOS_DELAY_Init(void)
 */
 int32_t PIOS_DELAY_WaituS(uint32_t uS)
 {
+	if (xPortVirtualTimeEnabled()) {
+		vPortVirtualDelay(uS);
+		return 0;
+	}
+
 	static struct timespec wait,rest;
 	wait.tv_sec=0;
 	wait.tv_nsec=1000*uS;
@@ -89,6 +94,11 @@ int32_t PIOS_DELAY_WaituS(uint32_t uS)
 */
 int32_t PIOS_DELAY_WaitmS(uint32_t mS)
 {
+	if (xPortVirtualTimeEnabled()) {
+		vPortVirtualDelay(mS * 1000);
+		return 0;
+	}
+
 	//for(int i = 0; i < mS; i++) {
 	//	PIOS_DELAY_WaituS(1000);
 	static struct timespec wait,rest;
@@ -105,10 +115,13 @@ int32_t PIOS_DELAY_WaitmS(uint32_t mS)
 
 /**
  * @brief Query the Delay timer for the current uS 
- * @return A microsecond value
+ * @return A microsecond value, of simulated time in the virtual time mode
  */
 uint32_t PIOS_DELAY_GetuS()
 {
+	if (xPortVirtualTimeEnabled())
+		return (uint32_t) ullPortGetVirtualTimeUS();
+
 	static struct timespec current;
 
 #ifdef __MACH__ // OS X does not have clock_gettime, use clock_get_time
@@ -74,6 +74,11 @@ void PIOS_SYS_Init(void)
 	assert(rc == 0);
 
 	feenableexcept(FE_DIVBYZERO | FE_UNDERFLOW | FE_OVERFLOW | FE_INVALID);
+
+	// Run on a simulated clock, as fast as the host allows and reproducibly
+	if (getenv("SIM_VIRTUAL_TIME") != NULL) {
+		vPortEnableVirtualTime();
+	}
 }
 
 /**
@@ -92,6 +97,21 @@ int32_t PIOS_SYS_Reset(void)
 	return -1;
 }
 
+/**
+* Moves a network port by SIM_PORT_OFFSET, so that several simulators can run
+* side by side
+* \param[in] port the default port
+* \return the port to use
+*/
+uint16_t PIOS_SYS_SimPort(uint16_t port)
+{
+	const char *offset = getenv("SIM_PORT_OFFSET");
+	if (offset != NULL)
+		port += atoi(offset);
+
+	return port;
+}
+
 /**
 * Returns the CPU's flash size (in bytes)
 */
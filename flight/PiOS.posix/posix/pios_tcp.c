@@ -174,7 +174,12 @@ int32_t PIOS_TCP_Init(uintptr_t *tcp_id, const struct pios_tcp_cfg * cfg)
 	memset(&tcp_dev->client,0,sizeof(tcp_dev->client));
 	tcp_dev->server.sin_family = AF_INET;
 	tcp_dev->server.sin_addr.s_addr = INADDR_ANY; //inet_addr(tcp_dev->cfg->ip);
-	tcp_dev->server.sin_port = htons(tcp_dev->cfg->port);
+	tcp_dev->server.sin_port = htons(PIOS_SYS_SimPort(tcp_dev->cfg->port));
+
+	/* A simulator restarted right after the previous one must be able to reuse the port */
+	int reuse = 1;
+	setsockopt(tcp_dev->socket, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
 	int res= bind(tcp_dev->socket, (struct sockaddr *)&tcp_dev->server,sizeof(tcp_dev->server));
 	if (res == -1) {
 		perror("Binding socket failed\n");
@@ -1043,6 +1043,23 @@ out_exit:
 	return rc;
 }
 
+/**
+ * @brief Largest object which fits in one slot of the filesystem
+ * @param[in] fs_id The filesystem to query
+ * @return the size in bytes or error code
+ * @retval -1 if fs_id is not a valid filesystem instance
+ */
+int32_t PIOS_FLASHFS_MaxObjSize(uintptr_t fs_id)
+{
+	struct logfs_state *logfs = (struct logfs_state *)fs_id;
+
+	if (!PIOS_FLASHFS_Logfs_validate(logfs)) {
+		return -1;
+	}
+
+	return logfs->cfg->slot_size - sizeof(struct slot_header);
+}
+
 /**
  * @brief Erases all filesystem arenas and activate the first arena
  * @param[in] fs_id The filesystem to use for this action
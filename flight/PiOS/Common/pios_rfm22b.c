@@ -598,9 +598,6 @@ int32_t PIOS_RFM22B_Init(uint32_t *rfm22b_id, uint32_t spi_id, uint32_t slave_nu
 	PIOS_WDG_RegisterFlag(PIOS_WDG_RFM22B);
 #endif /* PIOS_WDG_RFM22B */
 
-	// Initialize the ECC library.
-	initialize_ecc();
-
 	// Set the state to initializing.
 	rfm22b_dev->state = RFM22B_STATE_UNINITIALIZED;
 
@@ -1623,12 +1620,10 @@ static bool rfm22_receivePacket(struct pios_rfm22b_dev *rfm22b_dev, PHPacketHand
 {
 
 	// Attempt to correct any errors in the packet.
-	decode_data((unsigned char*)p, rx_len);
-
-	bool good_packet = check_syndrome() == 0;
+	bool good_packet = decode_data(&rfm22b_dev->rx_ecc, (unsigned char*)p, rx_len) == 0;
 	bool corrected_packet = false;
 	// We have an error.  Try to correct it.
-	if(!good_packet && (correct_errors_erasures((unsigned char*)p, rx_len, 0, 0) != 0))
+	if(!good_packet && (correct_errors_erasures(&rfm22b_dev->rx_ecc, (unsigned char*)p, rx_len, 0, 0) != 0))
 		// We corrected it
 		corrected_packet = true;
 
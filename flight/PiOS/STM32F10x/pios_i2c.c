@@ -947,6 +947,8 @@ int32_t PIOS_I2C_Transfer(uint32_t i2c_id, const struct pios_i2c_txn txn_list[],
 
 void PIOS_I2C_EV_IRQ_Handler(uint32_t i2c_id)
 {
+	PIOS_IRQ_PROFILE_BEGIN();
+
 	struct pios_i2c_adapter * i2c_adapter = (struct pios_i2c_adapter *)i2c_id;
 
 	bool valid = PIOS_I2C_validate(i2c_adapter);
@@ -1066,12 +1068,14 @@ void PIOS_I2C_EV_IRQ_Handler(uint32_t i2c_id)
 	}
 
 skip_event:
-	;
+	PIOS_IRQ_PROFILE_END(PIOS_IRQ_PROFILE_I2C);
 }
 
 
 void PIOS_I2C_ER_IRQ_Handler(uint32_t i2c_id)
 {
+	PIOS_IRQ_PROFILE_BEGIN();
+
 	struct pios_i2c_adapter * i2c_adapter = (struct pios_i2c_adapter *)i2c_id;
 
 	bool valid = PIOS_I2C_validate(i2c_adapter);
@@ -1098,7 +1102,9 @@ void PIOS_I2C_ER_IRQ_Handler(uint32_t i2c_id)
 #endif
 		/* Fail hard on any errors for now */
 		i2c_adapter_inject_event(i2c_adapter, I2C_EVENT_BUS_ERROR);
-	}	
+	}
+
+	PIOS_IRQ_PROFILE_END(PIOS_IRQ_PROFILE_I2C);
 }
 
 #endif
@@ -531,6 +531,8 @@ void PIOS_SPI_SetPrescalar(uint32_t spi_id, uint32_t prescaler)
 
 void PIOS_SPI_IRQ_Handler(uint32_t spi_id)
 {
+	PIOS_IRQ_PROFILE_BEGIN();
+
 	struct pios_spi_dev *spi_dev = (struct pios_spi_dev *)spi_id;
 
 	bool valid = PIOS_SPI_validate(spi_dev);
@@ -555,6 +557,8 @@ void PIOS_SPI_IRQ_Handler(uint32_t spi_id)
 		crc_val = SPI_GetCRC(spi_dev->cfg->regs, SPI_CRC_Rx);
 		spi_dev->callback(crc_ok, crc_val);
 	}
+
+	PIOS_IRQ_PROFILE_END(PIOS_IRQ_PROFILE_SPI);
 }
 
 #endif
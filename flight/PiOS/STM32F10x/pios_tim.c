@@ -160,6 +160,8 @@ out_fail:
 
 static void PIOS_TIM_generic_irq_handler(TIM_TypeDef * timer)
 {
+	PIOS_IRQ_PROFILE_BEGIN();
+
 	/* Iterate over all registered clients of the TIM layer to find channels on this timer */
 	for (uint8_t i = 0; i < pios_tim_num_devs; i++) {
 		const struct pios_tim_dev * tim_dev = &pios_tim_devs[i];
@@ -300,6 +302,8 @@ static void PIOS_TIM_generic_irq_handler(TIM_TypeDef * timer)
 			}
 		}
 	}
+
+	PIOS_IRQ_PROFILE_END(PIOS_IRQ_PROFILE_TIM);
 }
 #if 0
 	uint16_t val = 0;
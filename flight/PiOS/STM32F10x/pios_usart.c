@@ -256,6 +256,8 @@ static void PIOS_USART_RegisterTxCallback(uintptr_t usart_id, pios_com_callback
 
 static void PIOS_USART_generic_irq_handler(uintptr_t usart_id)
 {
+	PIOS_IRQ_PROFILE_BEGIN();
+
 	struct pios_usart_dev * usart_dev = (struct pios_usart_dev *)usart_id;
 
 	bool valid = PIOS_USART_validate(usart_dev);
@@ -304,6 +306,8 @@ static void PIOS_USART_generic_irq_handler(uintptr_t usart_id)
 #if defined(PIOS_INCLUDE_FREERTOS)
 	portEND_SWITCHING_ISR(rx_need_yield || tx_need_yield);
 #endif	/* PIOS_INCLUDE_FREERTOS */
+
+	PIOS_IRQ_PROFILE_END(PIOS_IRQ_PROFILE_USART);
 }
 
 #endif
@@ -34,6 +34,7 @@
 
 #include "physical_constants.h"
 #include "sin_lookup.h"
+#include "fast_math.h"
 #include "misc_math.h"
 
 /* Private Function Prototypes */
@@ -212,7 +213,7 @@ static int32_t PIOS_Brushless_SetPhase(uint32_t channel, float phase_deg)
 		while (phase_deg > 360)
 			phase_deg -= 360;
 
-		int32_t position = scales[channel] * (center + scale * sinf(phase_deg * DEG2RAD));
+		int32_t position = scales[channel] * (center + scale * fast_sinf(phase_deg * DEG2RAD));
 
 		/* Update the position */
 		const struct pios_tim_channel * chan = &brushless_cfg->channels[idx];
@@ -162,7 +162,12 @@ static bool PIOS_EXTI_generic_irq_handler(uint8_t line_index)
 	}
 
 	struct pios_exti_cfg * cfg = &__start__exti + cfg_index;
-	return cfg->vector();
+
+	PIOS_IRQ_PROFILE_BEGIN();
+	bool woken = cfg->vector();
+	PIOS_IRQ_PROFILE_END(PIOS_IRQ_PROFILE_EXTI);
+
+	return woken;
 }
 
 /* Bind Interrupt Handlers */
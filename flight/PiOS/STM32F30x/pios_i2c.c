@@ -646,6 +646,8 @@ int32_t PIOS_I2C_Transfer_Callback(uint32_t i2c_id, const struct pios_i2c_txn tx
 
 void PIOS_I2C_EV_IRQ_Handler(uint32_t i2c_id)
 {
+	PIOS_IRQ_PROFILE_BEGIN();
+
 	struct pios_i2c_adapter *i2c_adapter = (struct pios_i2c_adapter *)i2c_id;
 
 	bool valid = PIOS_I2C_validate(i2c_adapter);
@@ -702,11 +704,15 @@ void PIOS_I2C_EV_IRQ_Handler(uint32_t i2c_id)
 #ifdef USE_FREERTOS
 	portEND_SWITCHING_ISR(woken == true ? pdTRUE : pdFALSE);
 #endif
+
+	PIOS_IRQ_PROFILE_END(PIOS_IRQ_PROFILE_I2C);
 }
 
 
 void PIOS_I2C_ER_IRQ_Handler(uint32_t i2c_id)
 {
+	PIOS_IRQ_PROFILE_BEGIN();
+
 	struct pios_i2c_adapter *i2c_adapter = (struct pios_i2c_adapter *)i2c_id;
 
 	bool valid = PIOS_I2C_validate(i2c_adapter);
@@ -773,6 +779,8 @@ void PIOS_I2C_ER_IRQ_Handler(uint32_t i2c_id)
 #ifdef USE_FREERTOS
 	portEND_SWITCHING_ISR(woken == true ? pdTRUE : pdFALSE);
 #endif
+
+	PIOS_IRQ_PROFILE_END(PIOS_IRQ_PROFILE_I2C);
 }
 
 #endif
@@ -38,6 +38,11 @@
 
 #if defined(PIOS_INCLUDE_IRQ)
 
+#if defined(DIAG_TASKS)
+/* Updated by the handlers through PIOS_IRQ_PROFILE_END() */
+volatile uint32_t pios_irq_profile_cycles[PIOS_IRQ_PROFILE_NUM];
+#endif
+
 /* Private Function Prototypes */
 
 /* Local Variables */
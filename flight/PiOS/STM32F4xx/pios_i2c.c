@@ -998,6 +998,8 @@ int32_t PIOS_I2C_Transfer_Callback(uint32_t i2c_id, const struct pios_i2c_txn tx
 
 void PIOS_I2C_EV_IRQ_Handler(uint32_t i2c_id)
 {
+	PIOS_IRQ_PROFILE_BEGIN();
+
 	struct pios_i2c_adapter *i2c_adapter = (struct pios_i2c_adapter *)i2c_id;
 
 	bool valid = PIOS_I2C_validate(i2c_adapter);
@@ -1020,8 +1022,10 @@ void PIOS_I2C_EV_IRQ_Handler(uint32_t i2c_id)
 	// throw event depends on the current state.  However when accelerated (-Os)
 	// we definitely catch this event twice and there is no clean way to do deal
 	// with that in the FMS short of a special state for it
-	if (i2c_adapter->curr_state == I2C_STATE_STARTING && event == 0x70084)
+	if (i2c_adapter->curr_state == I2C_STATE_STARTING && event == 0x70084) {
+		PIOS_IRQ_PROFILE_END(PIOS_IRQ_PROFILE_I2C);
 		return;
+	}
 
 	switch (event) { /* Mask out all the bits we don't care about */
 	case (I2C_EVENT_MASTER_MODE_SELECT | 0x40):
@@ -1129,11 +1133,15 @@ skip_event:
 #ifdef USE_FREERTOS
 	portEND_SWITCHING_ISR(woken == true ? pdTRUE : pdFALSE);
 #endif
+
+	PIOS_IRQ_PROFILE_END(PIOS_IRQ_PROFILE_I2C);
 }
 
 
 void PIOS_I2C_ER_IRQ_Handler(uint32_t i2c_id)
 {
+	PIOS_IRQ_PROFILE_BEGIN();
+
 	struct pios_i2c_adapter *i2c_adapter = (struct pios_i2c_adapter *)i2c_id;
 
 	bool valid = PIOS_I2C_validate(i2c_adapter);
@@ -1167,6 +1175,8 @@ void PIOS_I2C_ER_IRQ_Handler(uint32_t i2c_id)
 #ifdef USE_FREERTOS
 	portEND_SWITCHING_ISR(woken == true ? pdTRUE : pdFALSE);
 #endif
+
+	PIOS_IRQ_PROFILE_END(PIOS_IRQ_PROFILE_I2C);
 }
 
 #endif
@@ -35,6 +35,7 @@
 #include <fifo_buffer.h>
 #include <uavobjectmanager.h>
 #include <oplinkstatus.h>
+#include <ecc.h>
 #include "pios_rfm22b.h"
 
 // ************************************
@@ -732,6 +733,8 @@ struct pios_rfm22b_dev {
 
 	// The rx data packet
 	PHPacket rx_packet;
+	// The Reed-Solomon decoder state for received packets
+	struct rs_ecc rx_ecc;
 	// The receive buffer write index
 	uint16_t rx_buffer_wr;
 	// The receive buffer write index
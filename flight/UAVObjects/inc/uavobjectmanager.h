@@ -141,8 +141,12 @@ typedef struct {
 int32_t UAVObjInitialize();
 void UAVObjGetStats(UAVObjStats* statsOut);
 void UAVObjClearStats();
+uint32_t UAVObjGetContention(UAVObjHandle obj);
+uint16_t UAVObjGetUpdateCount(UAVObjHandle obj);
+bool UAVObjTestAndClearDirty(UAVObjHandle obj);
 UAVObjHandle UAVObjRegister(uint32_t id,
-		int32_t isSingleInstance, int32_t isSettings, uint32_t numBytes, UAVObjInitializeCallback initCb);
+		int32_t isSingleInstance, int32_t isSettings, int32_t isEmitOnChange,
+		uint32_t numBytes, UAVObjInitializeCallback initCb);
 UAVObjHandle UAVObjGetByID(uint32_t id);
 uint32_t UAVObjGetID(UAVObjHandle obj);
 uint32_t UAVObjGetNumBytes(UAVObjHandle obj);
@@ -152,6 +156,7 @@ uint16_t UAVObjCreateInstance(UAVObjHandle obj_handle, UAVObjInitializeCallback
 bool UAVObjIsSingleInstance(UAVObjHandle obj);
 bool UAVObjIsMetaobject(UAVObjHandle obj);
 bool UAVObjIsSettings(UAVObjHandle obj);
+bool UAVObjIsEmitOnChange(UAVObjHandle obj);
 int32_t UAVObjUnpack(UAVObjHandle obj_handle, uint16_t instId, const uint8_t* dataIn);
 int32_t UAVObjPack(UAVObjHandle obj_handle, uint16_t instId, uint8_t* dataOut);
 int32_t UAVObjSave(UAVObjHandle obj_handle, uint16_t instId);
@@ -171,6 +176,7 @@ int32_t UAVObjSetData(UAVObjHandle obj_handle, const void* dataIn);
 int32_t UAVObjSetDataField(UAVObjHandle obj_handle, const void* dataIn, uint32_t offset, uint32_t size);
 int32_t UAVObjGetData(UAVObjHandle obj_handle, void* dataOut);
 int32_t UAVObjGetDataField(UAVObjHandle obj_handle, void* dataOut, uint32_t offset, uint32_t size);
+int32_t UAVObjGetDataIfChanged(UAVObjHandle obj_handle, void* dataOut, uint16_t *epoch);
 int32_t UAVObjSetInstanceData(UAVObjHandle obj_handle, uint16_t instId, const void* dataIn);
 int32_t UAVObjSetInstanceDataField(UAVObjHandle obj_handle, uint16_t instId, const void* dataIn, uint32_t offset, uint32_t size);
 int32_t UAVObjGetInstanceData(UAVObjHandle obj_handle, uint16_t instId, void* dataOut);
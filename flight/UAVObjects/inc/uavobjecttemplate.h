@@ -42,6 +42,7 @@
 #define $(NAMEUC)_OBJID $(OBJIDHEX)
 #define $(NAMEUC)_ISSINGLEINST $(ISSINGLEINST)
 #define $(NAMEUC)_ISSETTINGS $(ISSETTINGS)
+#define $(NAMEUC)_EMITONCHANGE $(EMITONCHANGE)
 #define $(NAMEUC)_NUMBYTES $(NUMBYTES)
 
 // Generic interface functions
@@ -64,6 +65,15 @@ static inline int32_t $(NAME)Get($(NAME)Data *dataOut) { return UAVObjGetData($(
 
 static inline int32_t $(NAME)Set(const $(NAME)Data *dataIn) { return UAVObjSetData($(NAME)Handle(), dataIn); }
 
+/**
+ * @function $(NAME)GetIfChanged(dataOut, epoch)
+ * @brief Populate a $(NAME)Data object if it changed since the copy at epoch
+ * @param[out] dataOut 
+ * @param[in,out] epoch update count of dataOut, start with 0
+ * @return 1 if dataOut was updated, 0 if unchanged
+ */
+static inline int32_t $(NAME)GetIfChanged($(NAME)Data *dataOut, uint16_t *epoch) { return UAVObjGetDataIfChanged($(NAME)Handle(), dataOut, epoch); }
+
 static inline int32_t $(NAME)InstGet(uint16_t instId, $(NAME)Data *dataOut) { return UAVObjGetInstanceData($(NAME)Handle(), instId, dataOut); }
 
 static inline int32_t $(NAME)InstSet(uint16_t instId, const $(NAME)Data *dataIn) { return UAVObjSetInstanceData($(NAME)Handle(), instId, dataIn); }
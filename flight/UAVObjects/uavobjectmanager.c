@@ -80,8 +80,21 @@ struct UAVOBase {
 		bool isMeta        : 1;
 		bool isSingle      : 1;
 		bool isSettings    : 1;
+		bool isEmitOnChange : 1;
 	} flags;
 
+	/* Sequence lock protecting the instance data, odd while a write is in progress */
+	volatile uint16_t seq;
+
+	/* Number of times a reader found a write in progress or had to copy again */
+	volatile uint32_t contention;
+
+	/* Set by every update which changed the data, cleared by UAVObjTestAndClearDirty */
+	volatile bool dirty;
+
+	/* Number of updates which changed the data, only written by the owning writer */
+	volatile uint16_t updates;
+
 } __attribute__((packed));
 
 /* Augmented type for Meta UAVO */
@@ -150,6 +163,11 @@ struct UAVOMulti {
 #define InstanceData(instance) (void*)instance
 
 // Private functions
+static void seqWriteBegin(struct UAVOBase * obj);
+static void seqWriteEnd(struct UAVOBase * obj, bool changed);
+static uint16_t seqReadBegin(struct UAVOBase * obj);
+static bool seqReadRetry(struct UAVOBase * obj, uint16_t seq);
+static void seqContended(struct UAVOBase * obj);
 static int32_t sendEvent(struct UAVOBase * obj, uint16_t instId,
 			UAVObjEventType event);
 static InstanceHandle createInstance(struct UAVOData * obj, uint16_t instId);
@@ -162,6 +180,7 @@ static int32_t disconnectObj(UAVObjHandle obj_handle, xQueueHandle queue,
 // Private variables
 static struct UAVOData * uavo_list;
 static xSemaphoreHandle mutex;
+static xSemaphoreHandle listener_mutex;
 static const UAVObjMetadata defMetadata = {
 	.flags = (ACCESS_READWRITE << UAVOBJ_ACCESS_SHIFT |
 		ACCESS_READWRITE << UAVOBJ_GCS_ACCESS_SHIFT |
@@ -192,6 +211,10 @@ int32_t UAVObjInitialize()
 	if (mutex == NULL)
 		return -1;
 
+	listener_mutex = xSemaphoreCreateRecursiveMutex();
+	if (listener_mutex == NULL)
+		return -1;
+
 	// Done
 	return 0;
 }
@@ -221,6 +244,51 @@ void UAVObjClearStats()
 	xSemaphoreGiveRecursive(mutex);
 }
 
+/**
+ * Get the number of times readers found a write in progress on an object
+ * or had to copy its data again
+ * \param[in] obj The object handle
+ * \return The contention counter
+ */
+uint32_t UAVObjGetContention(UAVObjHandle obj_handle)
+{
+	PIOS_Assert(obj_handle);
+
+	return ((struct UAVOBase *) obj_handle)->contention;
+}
+
+/**
+ * Get the number of updates which changed the data of an object
+ * \param[in] obj The object handle
+ * \return The update counter, wraps around
+ */
+uint16_t UAVObjGetUpdateCount(UAVObjHandle obj_handle)
+{
+	PIOS_Assert(obj_handle);
+
+	return ((struct UAVOBase *) obj_handle)->updates;
+}
+
+/**
+ * Check whether the data of an object changed since the last call, and clear the flag.
+ * The flag is shared by all the instances of the object and all the callers, it is
+ * meant for the single consumer which sends the object on (i.e. telemetry).
+ * \param[in] obj The object handle
+ * \return True if the data changed
+ */
+bool UAVObjTestAndClearDirty(UAVObjHandle obj_handle)
+{
+	PIOS_Assert(obj_handle);
+
+	struct UAVOBase * uavo_base = (struct UAVOBase *) obj_handle;
+
+	if (!uavo_base->dirty)
+		return false;
+
+	uavo_base->dirty = false;
+	return true;
+}
+
 /************************
  * Object Initialization
  ***********************/
@@ -297,6 +365,7 @@ static struct UAVOData * UAVObjAllocMulti(uint32_t num_bytes)
  * \param[in] id Unique object ID
  * \param[in] isSingleInstance Is this a single instance or multi-instance object
  * \param[in] isSettings Is this a settings object
+ * \param[in] isEmitOnChange Only send update events when the data changes
  * \param[in] numBytes Number of bytes of object data (for one instance)
  * \param[in] initCb Default field and metadata initialization function
  * \return Object handle, or NULL if failure.
@@ -304,7 +373,7 @@ static struct UAVOData * UAVObjAllocMulti(uint32_t num_bytes)
  */
 UAVObjHandle UAVObjRegister(uint32_t id, 
 			int32_t isSingleInstance, int32_t isSettings,
-			uint32_t num_bytes,
+			int32_t isEmitOnChange, uint32_t num_bytes,
 			UAVObjInitializeCallback initCb)
 {
 	struct UAVOData * uavo_data = NULL;
@@ -331,6 +400,16 @@ UAVObjHandle UAVObjRegister(uint32_t id,
 	if (isSettings) {
 		uavo_data->base.flags.isSettings = true;
 	}
+	if (isEmitOnChange) {
+		uavo_data->base.flags.isEmitOnChange = true;
+	}
+
+	/* Make sure the first periodic update goes out even if the defaults never change */
+	uavo_data->base.dirty = true;
+
+	/* Callers start with an epoch of 0, which must not match the defaults
+	 * even if setting them left the data unchanged */
+	uavo_data->base.updates = 1;
 
 	/* Initialize the embedded meta UAVO */
 	UAVObjInitMetaData (&uavo_data->metaObj);
@@ -349,12 +428,15 @@ UAVObjHandle UAVObjRegister(uint32_t id,
 	if (uavo_data->base.flags.isSettings)
 		UAVObjLoad((UAVObjHandle) uavo_data, 0);
 
-	// fire events for outer object and its embedded meta object
-	UAVObjInstanceUpdated((UAVObjHandle) uavo_data, 0);
-	UAVObjInstanceUpdated((UAVObjHandle) &(uavo_data->metaObj), 0);
-
 unlock_exit:
 	xSemaphoreGiveRecursive(mutex);
+
+	// fire events for outer object and its embedded meta object
+	if (uavo_data) {
+		UAVObjInstanceUpdated((UAVObjHandle) uavo_data, 0);
+		UAVObjInstanceUpdated((UAVObjHandle) &(uavo_data->metaObj), 0);
+	}
+
 	return (UAVObjHandle) uavo_data;
 }
 
@@ -521,6 +603,11 @@ uint16_t UAVObjCreateInstance(UAVObjHandle obj_handle,
 unlock_exit:
 	xSemaphoreGiveRecursive(mutex);
 
+	// Fire event
+	if (instEntry != NULL) {
+		UAVObjInstanceUpdated(obj_handle, instId);
+	}
+
 	return instId;
 }
 
@@ -569,6 +656,21 @@ bool UAVObjIsSettings(UAVObjHandle obj_handle)
 	return uavo_base->flags.isSettings;
 }
 
+/**
+ * Does this object only send update events when its data changes?
+ * \param[in] obj The object handle
+ * \return True (1) if unchanged updates are dropped
+ */
+bool UAVObjIsEmitOnChange(UAVObjHandle obj_handle)
+{
+	PIOS_Assert(obj_handle);
+
+	/* Recover the common object header */
+	struct UAVOBase * uavo_base = (struct UAVOBase *) obj_handle;
+
+	return uavo_base->flags.isEmitOnChange;
+}
+
 /**
  * Unpack an object from a byte array
  * \param[in] obj The object handle
@@ -581,44 +683,40 @@ int32_t UAVObjUnpack(UAVObjHandle obj_handle, uint16_t instId,
 {
 	PIOS_Assert(obj_handle);
 
-	// Lock
-	xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
-
-	int32_t rc = -1;
+	InstanceHandle instEntry = getInstance((struct UAVOData *) obj_handle, instId);
 
-	if (UAVObjIsMetaobject(obj_handle)) {
-		if (instId != 0) {
-			goto unlock_exit;
+	// If the instance does not exist create it and any other instances before it
+	if (instEntry == NULL) {
+		if (UAVObjIsMetaobject(obj_handle)) {
+			return -1;
 		}
-		memcpy(MetaDataPtr((struct UAVOMeta *)obj_handle), dataIn, MetaNumBytes);
-	} else {
-		struct UAVOData *obj;
-		InstanceHandle instEntry;
-
-		// Cast handle to object
-		obj = (struct UAVOData *) obj_handle;
 
-		// Get the instance
-		instEntry = getInstance(obj, instId);
+		// Creating instances changes the instance list, which is still under the global lock
+		xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+		uint16_t firstNew = UAVObjGetNumInstances(obj_handle);
+		instEntry = getInstance((struct UAVOData *) obj_handle, instId);
+		if (instEntry == NULL) {
+			instEntry = createInstance((struct UAVOData *) obj_handle, instId);
+		}
+		xSemaphoreGiveRecursive(mutex);
 
-		// If the instance does not exist create it and any other instances before it
 		if (instEntry == NULL) {
-			instEntry = createInstance(obj, instId);
-			if (instEntry == NULL) {
-				goto unlock_exit;
-			}
+			return -1;
+		}
+
+		for (uint16_t n = firstNew; n <= instId; n++) {
+			UAVObjInstanceUpdated(obj_handle, n);
 		}
-		// Set the data
-		memcpy(InstanceData(instEntry), dataIn, obj->instance_size);
 	}
 
+	// Set the data
+	seqWriteBegin((struct UAVOBase *) obj_handle);
+	memcpy(InstanceData(instEntry), dataIn, UAVObjGetNumBytes(obj_handle));
+	seqWriteEnd((struct UAVOBase *) obj_handle, true);
+
 	// Fire event
 	sendEvent((struct UAVOBase*)obj_handle, instId, EV_UNPACKED);
-	rc = 0;
-
-unlock_exit:
-	xSemaphoreGiveRecursive(mutex);
-	return rc;
+	return 0;
 }
 
 /**
@@ -632,48 +730,18 @@ int32_t UAVObjPack(UAVObjHandle obj_handle, uint16_t instId, uint8_t * dataOut)
 {
 	PIOS_Assert(obj_handle);
 
-	// Lock
-	xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
-
-	int32_t rc = -1;
-
-	if (UAVObjIsMetaobject(obj_handle)) {
-		if (instId != 0) {
-			goto unlock_exit;
-		}
-		memcpy(dataOut, MetaDataPtr((struct UAVOMeta *)obj_handle), MetaNumBytes);
-	} else {
-		struct UAVOData *obj;
-		InstanceHandle instEntry;
-
-		// Cast handle to object
-		obj = (struct UAVOData *) obj_handle;
-
-		// Get the instance
-		instEntry = getInstance(obj, instId);
-		if (instEntry == NULL) {
-			goto unlock_exit;
-		}
-		// Pack data
-		memcpy(dataOut, InstanceData(instEntry), obj->instance_size);
-	}
-
-	rc = 0;
-
-unlock_exit:
-	xSemaphoreGiveRecursive(mutex);
-	return rc;
+	return UAVObjGetInstanceData(obj_handle, instId, dataOut);
 }
 
-#if defined(PIOS_INCLUDE_FASTHEAP)
 /**
- * Trampoline buffer used for loads from the underlying filesystem.
- * This is required on platforms that store the UAVO data in non-DMA
- * RAM regions since the underlying flash driver may use DMA to transfer
- * the data into the buffer that we give it.
+ * Trampoline buffer used for saves to the underlying filesystem.
+ * The object data is copied into it through the sequence lock, so that a
+ * concurrent write cannot tear the saved copy. It is also required on
+ * platforms that store the UAVO data in non-DMA RAM regions since the
+ * underlying flash driver may use DMA to transfer the data from the buffer
+ * that we give it. Protected by the object manager mutex.
  */
 static uint8_t uavobj_save_trampoline[256] __attribute__((aligned(4)));
-#endif	/* PIOS_INCLUDE_FASTHEAP */
 
 /**
  * Save the data of the specified object to the file system (SD card).
@@ -689,77 +757,39 @@ int32_t UAVObjSave(UAVObjHandle obj_handle, uint16_t instId)
 {
 	PIOS_Assert(obj_handle);
 
-	if (UAVObjIsMetaobject(obj_handle)) {
-		if (instId != 0)
-			return -1;
+	uint32_t size = UAVObjGetNumBytes(obj_handle);
+	PIOS_Assert(size <= sizeof(uavobj_save_trampoline));
 
-		// Save the object to the filesystem
-		int32_t rc;
-#if defined(PIOS_INCLUDE_FASTHEAP)
-		memcpy(uavobj_save_trampoline,
-			MetaDataPtr((struct UAVOMeta *)obj_handle),
-			UAVObjGetNumBytes(obj_handle));
-
-		rc = PIOS_FLASHFS_ObjSave(pios_uavo_settings_fs_id,
-					UAVObjGetID(obj_handle),
-					instId,
-					uavobj_save_trampoline,
-					UAVObjGetNumBytes(obj_handle));
-#else /* PIOS_INCLUDE_FASTHEAP */
-		rc = PIOS_FLASHFS_ObjSave(pios_uavo_settings_fs_id,
-					UAVObjGetID(obj_handle),
-					instId,
-					(uint8_t*) MetaDataPtr((struct UAVOMeta *)obj_handle),
-					UAVObjGetNumBytes(obj_handle));
-#endif  /* PIOS_INCLUDE_FASTHEAP */
-
-		if (rc != 0)
-			return -1;
-	} else {
-		InstanceHandle instEntry = getInstance( (struct UAVOData *)obj_handle, instId);
-
-		if (instEntry == NULL)
-			return -1;
-
-		if (InstanceData(instEntry) == NULL)
-			return -1;
+	xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
 
-		// Save the object to the filesystem
-		int32_t rc;
-#if defined(PIOS_INCLUDE_FASTHEAP)
-		memcpy(uavobj_save_trampoline,
-			InstanceData(instEntry),
-			UAVObjGetNumBytes(obj_handle));
+	// Fails for an instance which does not exist
+	int32_t rc = UAVObjGetInstanceData(obj_handle, instId, uavobj_save_trampoline);
 
+	// Save the object to the filesystem
+	if (rc == 0)
 		rc = PIOS_FLASHFS_ObjSave(pios_uavo_settings_fs_id,
 					UAVObjGetID(obj_handle),
 					instId,
 					uavobj_save_trampoline,
-					UAVObjGetNumBytes(obj_handle));
-#else /* PIOS_INCLUDE_FASTHEAP */
-		rc = PIOS_FLASHFS_ObjSave(pios_uavo_settings_fs_id,
-					UAVObjGetID(obj_handle),
-					instId,
-					InstanceData(instEntry),
-					UAVObjGetNumBytes(obj_handle));
-#endif  /* PIOS_INCLUDE_FASTHEAP */
+					size);
 
-		if (rc != 0)
-			return -1;
-	}
+	xSemaphoreGiveRecursive(mutex);
+
+	if (rc != 0)
+		return -1;
 
 	return 0;
 }
 
-#if defined(PIOS_INCLUDE_FASTHEAP)
 /**
  * Trampoline buffer used for loads from the underlying filesystem.
- * This is required on platforms that store the UAVO data in non-DMA
- * RAM regions since the underlying flash driver may use DMA to transfer
- * the data into the buffer that we give it.
+ * The flash is read into it outside of the object write window, which
+ * only covers the copy into the object. It is also required on platforms
+ * that store the UAVO data in non-DMA RAM regions since the underlying
+ * flash driver may use DMA to transfer the data into the buffer that we
+ * give it. Protected by the object manager mutex.
  */
 static uint8_t uavobj_load_trampoline[256] __attribute__((aligned(4)));
-#endif	/* PIOS_INCLUDE_FASTHEAP */
 
 /**
  * Load an object from the file system (SD card).
@@ -773,33 +803,13 @@ int32_t UAVObjLoad(UAVObjHandle obj_handle, uint16_t instId)
 {
 	PIOS_Assert(obj_handle);
 
+	void *data;
+
 	if (UAVObjIsMetaobject(obj_handle)) {
 		if (instId != 0)
 			return -1;
 
-		// Load the object from the filesystem
-		int32_t rc;
-#if defined(PIOS_INCLUDE_FASTHEAP)
-		rc = PIOS_FLASHFS_ObjLoad(pios_uavo_settings_fs_id,
-					UAVObjGetID(obj_handle),
-					instId,
-					uavobj_load_trampoline,
-					UAVObjGetNumBytes(obj_handle));
-#else  /* PIOS_INCLUDE_FASTHEAP */
-		rc = PIOS_FLASHFS_ObjLoad(pios_uavo_settings_fs_id,
-					UAVObjGetID(obj_handle),
-					instId,
-					(uint8_t*)MetaDataPtr((struct UAVOMeta *)obj_handle),
-					UAVObjGetNumBytes(obj_handle));
-#endif  /* PIOS_INCLUDE_FASTHEAP */
-
-		if (rc != 0)
-			return -1;
-
-#if defined(PIOS_INCLUDE_FASTHEAP)
-		memcpy(MetaDataPtr((struct UAVOMeta *)obj_handle), uavobj_load_trampoline, UAVObjGetNumBytes(obj_handle));
-#endif  /* PIOS_INCLUDE_FASTHEAP */
-
+		data = MetaDataPtr((struct UAVOMeta *)obj_handle);
 	} else {
 
 		InstanceHandle instEntry = getInstance( (struct UAVOData *)obj_handle, instId);
@@ -807,31 +817,32 @@ int32_t UAVObjLoad(UAVObjHandle obj_handle, uint16_t instId)
 		if (instEntry == NULL)
 			return -1;
 
-		// Load the object from the filesystem
-		int32_t rc;
-#if defined(PIOS_INCLUDE_FASTHEAP)
-		rc = PIOS_FLASHFS_ObjLoad(pios_uavo_settings_fs_id,
-					UAVObjGetID(obj_handle),
-					instId,
-					uavobj_load_trampoline,
-					UAVObjGetNumBytes(obj_handle));
-#else  /* PIOS_INCLUDE_FASTHEAP */
-		rc = PIOS_FLASHFS_ObjLoad(pios_uavo_settings_fs_id,
-					UAVObjGetID(obj_handle),
-					instId,
-					InstanceData(instEntry),
-					UAVObjGetNumBytes(obj_handle));
-#endif  /* PIOS_INCLUDE_FASTHEAP */
+		data = InstanceData(instEntry);
+	}
 
-		if (rc != 0)
-			return -1;
+	uint32_t size = UAVObjGetNumBytes(obj_handle);
+	PIOS_Assert(size <= sizeof(uavobj_load_trampoline));
 
-#if defined(PIOS_INCLUDE_FASTHEAP)
-		memcpy(InstanceData(instEntry), uavobj_load_trampoline, UAVObjGetNumBytes(obj_handle));
-#endif  /* PIOS_INCLUDE_FASTHEAP */
+	xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
 
+	// Load the object from the filesystem
+	int32_t rc = PIOS_FLASHFS_ObjLoad(pios_uavo_settings_fs_id,
+				UAVObjGetID(obj_handle),
+				instId,
+				uavobj_load_trampoline,
+				size);
+
+	if (rc == 0) {
+		seqWriteBegin((struct UAVOBase *) obj_handle);
+		memcpy(data, uavobj_load_trampoline, size);
+		seqWriteEnd((struct UAVOBase *) obj_handle, true);
 	}
 
+	xSemaphoreGiveRecursive(mutex);
+
+	if (rc != 0)
+		return -1;
+
 	sendEvent((struct UAVOBase*)obj_handle, instId, EV_UNPACKED);
 	return 0;
 }
@@ -1077,54 +1088,43 @@ int32_t UAVObjGetDataField(UAVObjHandle obj_handle, void* dataOut, uint32_t offs
 }
 
 /**
- * Set the data of a specific object instance
+ * Get the object data, only if it changed since the caller last copied it.
+ * The epoch is the update count of the object (see UAVObjGetUpdateCount) at the
+ * time of the last copy, which lets a module keep its own copy of a settings
+ * object and poll it every loop for the price of a compare. Start with an epoch
+ * of 0, the update count of a registered object never is.
  * \param[in] obj The object handle
- * \param[in] instId The object instance ID
- * \param[in] dataIn The object's data structure
- * \return 0 if success or -1 if failure
+ * \param[out] dataOut The object's data structure, untouched if unchanged
+ * \param[in,out] epoch The update count of the data in dataOut
+ * \return 1 if the data was copied, 0 if it was unchanged or -1 if failure
  */
-int32_t UAVObjSetInstanceData(UAVObjHandle obj_handle, uint16_t instId,
-			const void *dataIn)
+int32_t UAVObjGetDataIfChanged(UAVObjHandle obj_handle, void* dataOut, uint16_t *epoch)
 {
 	PIOS_Assert(obj_handle);
+	PIOS_Assert(epoch);
 
-	// Lock
-	xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+	struct UAVOBase *obj = (struct UAVOBase *) obj_handle;
 
-	int32_t rc = -1;
-
-	if (UAVObjIsMetaobject(obj_handle)) {
-		if (instId != 0) {
-			goto unlock_exit;
-		}
-		memcpy(MetaDataPtr((struct UAVOMeta *)obj_handle), dataIn, MetaNumBytes);
-	} else {
-		struct UAVOData *obj;
-		InstanceHandle instEntry;
-
-		// Cast to object info
-		obj = (struct UAVOData *) obj_handle;
+	if (obj->updates == *epoch) {
+		return 0;
+	}
 
-		// Check access level
-		if (UAVObjReadOnly(obj_handle)) {
-			goto unlock_exit;
-		}
-		// Get instance information
-		instEntry = getInstance(obj, instId);
-		if (instEntry == NULL) {
-			goto unlock_exit;
-		}
-		// Set data
-		memcpy(InstanceData(instEntry), dataIn, obj->instance_size);
+	InstanceHandle instEntry = getInstance((struct UAVOData *) obj_handle, 0);
+	if (instEntry == NULL) {
+		return -1;
 	}
 
-	// Fire event
-	sendEvent((struct UAVOBase *)obj_handle, instId, EV_UPDATED);
-	rc = 0;
+	// Take the count inside the sequence lock so it matches the copy
+	uint16_t seq;
+	uint16_t updates;
+	do {
+		seq = seqReadBegin(obj);
+		updates = obj->updates;
+		memcpy(dataOut, InstanceData(instEntry), UAVObjGetNumBytes(obj_handle));
+	} while (seqReadRetry(obj, seq));
 
-unlock_exit:
-	xSemaphoreGiveRecursive(mutex);
-	return rc;
+	*epoch = updates;
+	return 1;
 }
 
 /**
@@ -1134,63 +1134,57 @@ unlock_exit:
  * \param[in] dataIn The object's data structure
  * \return 0 if success or -1 if failure
  */
-int32_t UAVObjSetInstanceDataField(UAVObjHandle obj_handle, uint16_t instId, const void* dataIn, uint32_t offset, uint32_t size)
+int32_t UAVObjSetInstanceData(UAVObjHandle obj_handle, uint16_t instId,
+			const void *dataIn)
 {
 	PIOS_Assert(obj_handle);
 
-	// Lock
-	xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
-
-	int32_t rc = -1;
-
-	if (UAVObjIsMetaobject(obj_handle)) {
-		// Get instance information
-		if (instId != 0) {
-			goto unlock_exit;
-		}
-
-		// Check for overrun
-		if ((size + offset) > MetaNumBytes) {
-			goto unlock_exit;
-		}
+	return UAVObjSetInstanceDataField(obj_handle, instId, dataIn, 0, UAVObjGetNumBytes(obj_handle));
+}
 
-		// Set data
-		memcpy(MetaDataPtr((struct UAVOMeta *)obj_handle) + offset, dataIn, size);
-	} else {
-		struct UAVOData * obj;
-		InstanceHandle instEntry;
+/**
+ * Set the data of a specific object instance
+ * \param[in] obj The object handle
+ * \param[in] instId The object instance ID
+ * \param[in] dataIn The object's data structure
+ * \return 0 if success or -1 if failure
+ */
+int32_t UAVObjSetInstanceDataField(UAVObjHandle obj_handle, uint16_t instId, const void* dataIn, uint32_t offset, uint32_t size)
+{
+	PIOS_Assert(obj_handle);
 
-		// Cast to object info
-		obj = (struct UAVOData *)obj_handle;
+	// Check access level
+	if (!UAVObjIsMetaobject(obj_handle) && UAVObjReadOnly(obj_handle)) {
+		return -1;
+	}
 
-		// Check access level
-		if (UAVObjReadOnly(obj_handle)) {
-			goto unlock_exit;
-		}
+	// Get instance information
+	InstanceHandle instEntry = getInstance((struct UAVOData *) obj_handle, instId);
+	if (instEntry == NULL) {
+		return -1;
+	}
 
-		// Get instance information
-		instEntry = getInstance(obj, instId);
-		if (instEntry == NULL) {
-			goto unlock_exit;
-		}
+	// Check for overrun
+	if ((size + offset) > UAVObjGetNumBytes(obj_handle)) {
+		return -1;
+	}
 
-		// Check for overrun
-		if ((size + offset) > obj->instance_size) {
-			goto unlock_exit;
-		}
+	struct UAVOBase *obj = (struct UAVOBase *) obj_handle;
+	uint8_t *data = (uint8_t *) InstanceData(instEntry) + offset;
 
-		// Set data
-		memcpy(InstanceData(instEntry) + offset, dataIn, size);
+	// Set data, unless it is unchanged and the object only wants to hear about changes
+	seqWriteBegin(obj);
+	bool changed = !obj->flags.isEmitOnChange || memcmp(data, dataIn, size) != 0;
+	if (changed) {
+		memcpy(data, dataIn, size);
 	}
-
+	seqWriteEnd(obj, changed);
 
 	// Fire event
-	sendEvent((struct UAVOBase *)obj_handle, instId, EV_UPDATED);
-	rc = 0;
-
-unlock_exit:
-	xSemaphoreGiveRecursive(mutex);
-	return rc;
+	if (changed) {
+		sendEvent(obj, instId, EV_UPDATED);
+	}
+	return 0;
 }
 
 /**
@@ -1205,39 +1199,7 @@ int32_t UAVObjGetInstanceData(UAVObjHandle obj_handle, uint16_t instId,
 {
 	PIOS_Assert(obj_handle);
 
-	// Lock
-	xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
-
-	int32_t rc = -1;
-
-	if (UAVObjIsMetaobject(obj_handle)) {
-		// Get instance information
-		if (instId != 0) {
-			goto unlock_exit;
-		}
-		// Set data
-		memcpy(dataOut, MetaDataPtr((struct UAVOMeta *)obj_handle), MetaNumBytes);
-	} else {
-		struct UAVOData *obj;
-		InstanceHandle instEntry;
-
-		// Cast to object info
-		obj = (struct UAVOData *) obj_handle;
-
-		// Get instance information
-		instEntry = getInstance(obj, instId);
-		if (instEntry == NULL) {
-			goto unlock_exit;
-		}
-		// Set data
-		memcpy(dataOut, InstanceData(instEntry), obj->instance_size);
-	}
-
-	rc = 0;
-
-unlock_exit:
-	xSemaphoreGiveRecursive(mutex);
-	return rc;
+	return UAVObjGetInstanceDataField(obj_handle, instId, dataOut, 0, UAVObjGetNumBytes(obj_handle));
 }
 
 /**
@@ -1251,51 +1213,25 @@ int32_t UAVObjGetInstanceDataField(UAVObjHandle obj_handle, uint16_t instId, voi
 {
 	PIOS_Assert(obj_handle);
 
-	// Lock
-	xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
-
-	int32_t rc = -1;
-
-	if (UAVObjIsMetaobject(obj_handle)) {
-		// Get instance information
-		if (instId != 0) {
-			goto unlock_exit;
-		}
-
-		// Check for overrun
-		if ((size + offset) > MetaNumBytes) {
-			goto unlock_exit;
-		}
-
-		// Set data
-		memcpy(dataOut, MetaDataPtr((struct UAVOMeta *)obj_handle) + offset, size);
-	} else {
-		struct UAVOData * obj;
-		InstanceHandle instEntry;
-
-		// Cast to object info
-		obj = (struct UAVOData *)obj_handle;
-
-		// Get instance information
-		instEntry = getInstance(obj, instId);
-		if (instEntry == NULL) {
-			goto unlock_exit;
-		}
+	// Get instance information
+	InstanceHandle instEntry = getInstance((struct UAVOData *) obj_handle, instId);
+	if (instEntry == NULL) {
+		return -1;
+	}
 
-		// Check for overrun
-		if ((size + offset) > obj->instance_size) {
-			goto unlock_exit;
-		}
-		
-		// Set data
-		memcpy(dataOut, InstanceData(instEntry) + offset, size);
+	// Check for overrun
+	if ((size + offset) > UAVObjGetNumBytes(obj_handle)) {
+		return -1;
 	}
 
-	rc = 0;
+	// Get data, copying it again if a writer got in the way
+	uint16_t seq;
+	do {
+		seq = seqReadBegin((struct UAVOBase *) obj_handle);
+		memcpy(dataOut, (uint8_t *) InstanceData(instEntry) + offset, size);
+	} while (seqReadRetry((struct UAVOBase *) obj_handle, seq));
 
-unlock_exit:
-	xSemaphoreGiveRecursive(mutex);
-	return rc;
+	return 0;
 }
 
 /**
@@ -1313,11 +1249,8 @@ int32_t UAVObjSetMetadata(UAVObjHandle obj_handle, const UAVObjMetadata * dataIn
 		return -1;
 	}
 
-	xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
-
 	UAVObjSetData((UAVObjHandle) MetaObjectPtr((struct UAVOData *)obj_handle), dataIn);
 
-	xSemaphoreGiveRecursive(mutex);
 	return 0;
 }
 
@@ -1331,9 +1264,6 @@ int32_t UAVObjGetMetadata(UAVObjHandle obj_handle, UAVObjMetadata * dataOut)
 {
 	PIOS_Assert(obj_handle);
 
-	// Lock
-	xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
-
 	// Get metadata
 	if (UAVObjIsMetaobject(obj_handle)) {
 		memcpy(dataOut, &defMetadata, sizeof(UAVObjMetadata));
@@ -1342,8 +1272,6 @@ int32_t UAVObjGetMetadata(UAVObjHandle obj_handle, UAVObjMetadata * dataOut)
 			dataOut);
 	}
 
-	// Unlock
-	xSemaphoreGiveRecursive(mutex);
 	return 0;
 }
 
@@ -1506,9 +1434,9 @@ int32_t UAVObjConnectQueue(UAVObjHandle obj_handle, xQueueHandle queue,
 	PIOS_Assert(obj_handle);
 	PIOS_Assert(queue);
 	int32_t res;
-	xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+	xSemaphoreTakeRecursive(listener_mutex, portMAX_DELAY);
 	res = connectObj(obj_handle, queue, 0, eventMask);
-	xSemaphoreGiveRecursive(mutex);
+	xSemaphoreGiveRecursive(listener_mutex);
 	return res;
 }
 
@@ -1523,9 +1451,9 @@ int32_t UAVObjDisconnectQueue(UAVObjHandle obj_handle, xQueueHandle queue)
 	PIOS_Assert(obj_handle);
 	PIOS_Assert(queue);
 	int32_t res;
-	xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+	xSemaphoreTakeRecursive(listener_mutex, portMAX_DELAY);
 	res = disconnectObj(obj_handle, queue, 0);
-	xSemaphoreGiveRecursive(mutex);
+	xSemaphoreGiveRecursive(listener_mutex);
 	return res;
 }
 
@@ -1542,9 +1470,9 @@ int32_t UAVObjConnectCallback(UAVObjHandle obj_handle, UAVObjEventCallback cb,
 {
 	PIOS_Assert(obj_handle);
 	int32_t res;
-	xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+	xSemaphoreTakeRecursive(listener_mutex, portMAX_DELAY);
 	res = connectObj(obj_handle, 0, cb, eventMask);
-	xSemaphoreGiveRecursive(mutex);
+	xSemaphoreGiveRecursive(listener_mutex);
 	return res;
 }
 
@@ -1558,9 +1486,9 @@ int32_t UAVObjDisconnectCallback(UAVObjHandle obj_handle, UAVObjEventCallback cb
 {
 	PIOS_Assert(obj_handle);
 	int32_t res;
-	xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+	xSemaphoreTakeRecursive(listener_mutex, portMAX_DELAY);
 	res = disconnectObj(obj_handle, 0, cb);
-	xSemaphoreGiveRecursive(mutex);
+	xSemaphoreGiveRecursive(listener_mutex);
 	return res;
 }
 
@@ -1583,9 +1511,7 @@ void UAVObjRequestUpdate(UAVObjHandle obj_handle)
 void UAVObjRequestInstanceUpdate(UAVObjHandle obj_handle, uint16_t instId)
 {
 	PIOS_Assert(obj_handle);
-	xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
 	sendEvent((struct UAVOBase *) obj_handle, instId, EV_UPDATE_REQ);
-	xSemaphoreGiveRecursive(mutex);
 }
 
 /**
@@ -1605,9 +1531,7 @@ void UAVObjUpdated(UAVObjHandle obj_handle)
 void UAVObjInstanceUpdated(UAVObjHandle obj_handle, uint16_t instId)
 {
 	PIOS_Assert(obj_handle);
-	xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
 	sendEvent((struct UAVOBase *) obj_handle, instId, EV_UPDATED_MANUAL);
-	xSemaphoreGiveRecursive(mutex);
 }
 
 /**
@@ -1633,8 +1557,92 @@ void UAVObjIterate(void (*iterator) (UAVObjHandle obj))
 	xSemaphoreGiveRecursive(mutex);
 }
 
+/**
+ * Start writing the instance data of an object.
+ * The write runs with interrupts and the scheduler disabled until seqWriteEnd,
+ * so it is never preempted and writers never wait for each other. Only memory
+ * copies and compares may be done in between, never anything which blocks.
+ * Readers never block the writer, they copy again if the data changed under them.
+ */
+static void seqWriteBegin(struct UAVOBase * obj)
+{
+	portENTER_CRITICAL();
+	obj->seq++;
+	__sync_synchronize();
+}
+
+/**
+ * Finish writing the instance data of an object
+ * \param[in] changed Whether the write changed the data
+ */
+static void seqWriteEnd(struct UAVOBase * obj, bool changed)
+{
+	// Never wrap back to 0, the epoch of callers which never copied the data
+	if (changed && ++obj->updates == 0) {
+		obj->updates = 1;
+	}
+
+	__sync_synchronize();
+	obj->seq++;
+	portEXIT_CRITICAL();
+
+	// Only flag the data once it is complete, so a consumer which clears the
+	// flag before reading can never miss an update
+	if (changed) {
+		obj->dirty = true;
+	}
+}
+
+/**
+ * Start reading the instance data of an object
+ * \return The sequence number to give to seqReadRetry once the copy is done
+ */
+static uint16_t seqReadBegin(struct UAVOBase * obj)
+{
+	uint16_t seq;
+
+	// A write in progress can only be seen from another core or an interrupt,
+	// and is a short copy which is never preempted: just spin
+	if ((seq = obj->seq) & 1) {
+		seqContended(obj);
+		while ((seq = obj->seq) & 1)
+			;
+	}
+
+	__sync_synchronize();
+	return seq;
+}
+
+/**
+ * Check whether the data read since seqReadBegin was changed by a writer
+ * \return true if the copy has to be done again
+ */
+static bool seqReadRetry(struct UAVOBase * obj, uint16_t seq)
+{
+	__sync_synchronize();
+
+	if (obj->seq == seq)
+		return false;
+
+	seqContended(obj);
+	return true;
+}
+
+/**
+ * Count a reader which found the data being written. The counter is shared by
+ * all the readers, so it is incremented in a critical section.
+ */
+static void seqContended(struct UAVOBase * obj)
+{
+	portENTER_CRITICAL();
+	obj->contention++;
+	portEXIT_CRITICAL();
+}
+
 /**
  * Send a triggered event to all event queues registered on the object.
+ * This is called without holding any lock. Listeners are never removed from
+ * the list, disconnectObj only clears them, so it is always safe to walk.
  */
 static int32_t sendEvent(struct UAVOBase * obj, uint16_t instId,
 			UAVObjEventType triggered_event)
@@ -1649,21 +1657,25 @@ static int32_t sendEvent(struct UAVOBase * obj, uint16_t instId,
 	// Go through each object and push the event message in the queue (if event is activated for the queue)
 	struct ObjectEventEntry *event;
 	LL_FOREACH(obj->next_event, event) {
+		// Entries may be disconnected under our feet, use a single read of each
+		xQueueHandle queue = event->queue;
+		UAVObjEventCallback cb = event->cb;
+
 		if (event->eventMask == 0
 			|| (event->eventMask & triggered_event) != 0) {
 			// Send to queue if a valid queue is registered
-			if (event->queue) {
+			if (queue) {
 				// will not block
-				if (xQueueSend(event->queue, &msg, 0) != pdTRUE) {
+				if (xQueueSend(queue, &msg, 0) != pdTRUE) {
 					stats.lastQueueErrorID = UAVObjGetID(obj);
 					++stats.eventQueueErrors;
 				}
 			}
 
 			// Invoke callback (from event task) if a valid one is registered
-			if (event->cb) {
+			if (cb) {
 				// invoke callback from the event task, will not block
-				if (EventCallbackDispatch(&msg, event->cb) != pdTRUE) {
+				if (EventCallbackDispatch(&msg, cb) != pdTRUE) {
 					++stats.eventCallbackErrors;
 					stats.lastCallbackErrorID = UAVObjGetID(obj);
 				}
@@ -1713,9 +1725,6 @@ static InstanceHandle createInstance(struct UAVOData * obj, uint16_t instId)
 
 	( (struct UAVOMulti*)obj )->num_instances++;
 
-	// Fire event
-	UAVObjInstanceUpdated((UAVObjHandle) obj, instId);
-
 	// Done
 	return InstanceDataOffset(instEntry);
 }
@@ -1789,6 +1798,17 @@ static int32_t connectObj(UAVObjHandle obj_handle, xQueueHandle queue,
 		}
 	}
 
+	// Reuse an entry left behind by disconnectObj
+	LL_FOREACH(obj->next_event, event) {
+		if (event->queue == NULL && event->cb == NULL) {
+			event->eventMask = eventMask;
+			__sync_synchronize();
+			event->queue = queue;
+			event->cb = cb;
+			return 0;
+		}
+	}
+
 	// Add queue to list
 	event =	(struct ObjectEventEntry *) PIOS_malloc_no_dma(sizeof(struct ObjectEventEntry));
 	if (event == NULL) {
@@ -1797,6 +1817,10 @@ static int32_t connectObj(UAVObjHandle obj_handle, xQueueHandle queue,
 	event->queue = queue;
 	event->cb = cb;
 	event->eventMask = eventMask;
+	event->next = NULL;
+
+	// The entry must be complete before sendEvent can see it
+	__sync_synchronize();
 	LL_APPEND(obj->next_event, event);
 
 	// Done
@@ -1816,13 +1840,13 @@ static int32_t disconnectObj(UAVObjHandle obj_handle, xQueueHandle queue,
 	struct ObjectEventEntry *event;
 	struct UAVOBase *obj;
 
-	// Find queue and remove it
+	// Find queue and clear it, the entry stays in the list as sendEvent may be walking it
 	obj = (struct UAVOBase *) obj_handle;
 	LL_FOREACH(obj->next_event, event) {
 		if ((event->queue == queue
 				&& event->cb == cb)) {
-			LL_DELETE(obj->next_event, event);
-			vPortFree(event);
+			event->queue = NULL;
+			event->cb = NULL;
 			return 0;
 		}
 	}
@@ -1846,6 +1870,7 @@ int32_t getEventMask(UAVObjHandle obj_handle, xQueueHandle queue)
 	int32_t eventMask = EV_MASK_ALL;
 
 	// Iterate over the event listeners, looking for the event matching the queue
+	xSemaphoreTakeRecursive(listener_mutex, portMAX_DELAY);
 	obj = (struct UAVOBase *) obj_handle;
 	LL_FOREACH(obj->next_event, event) {
 		if (event->queue == queue && event->cb == 0) {
@@ -1854,6 +1879,7 @@ int32_t getEventMask(UAVObjHandle obj_handle, xQueueHandle queue)
 			break;
 		}
 	}
+	xSemaphoreGiveRecursive(listener_mutex);
 
 	// Done
 	return eventMask;
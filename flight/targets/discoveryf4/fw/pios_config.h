@@ -84,6 +84,7 @@
 /* Flags that alter behaviors - mostly to lower resources for CC */
 #define PIOS_INCLUDE_INITCALL           /* Include init call structures */
 #define PIOS_TELEM_PRIORITY_QUEUE       /* Enable a priority queue in telemetry */
+#define PIOS_TELEM_SCHEDULER            /* Schedule periodic telemetry within the link budget */
 //#define PIOS_QUATERNION_STABILIZATION   /* Stabilization options HEAVILY BROKEN!! */
 //#define PIOS_GPS_SETS_HOMELOCATION      /* GPS options */
 
@@ -67,6 +67,7 @@
 
 #define TELEM_QUEUE_SIZE                20
 #define PIOS_TELEM_STACK_SIZE           2048
+#define PIOS_TELEM_SCHEDULER            /* Schedule periodic telemetry within the link budget */
 
 /* Stabilization options */
 #define PIOS_QUATERNION_STABILIZATION
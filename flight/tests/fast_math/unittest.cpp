@@ -0,0 +1,141 @@
+/**
+ ******************************************************************************
+ * @file       unittest.cpp
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2013
+ * @addtogroup UnitTests
+ * @{
+ * @addtogroup UnitTests
+ * @{
+ * @brief Unit test
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+/*
+ * NOTE: This program uses the Google Test infrastructure to drive the unit test
+ *
+ * Main site for Google Test: http://code.google.com/p/googletest/
+ * Documentation and examples: http://code.google.com/p/googletest/wiki/Documentation
+ */
+
+
+#include "gtest/gtest.h"
+
+#include <stdio.h>		/* printf */
+#include <stdlib.h>		/* abort */
+#include <string.h>		/* memset */
+#include <stdint.h>		/* uint*_t */
+
+extern "C" {
+
+#include "fast_math.h"		/* API for fast_math functions */
+
+}
+
+#include <math.h>		/* sinf/cosf/atan2f/asinf/sqrtf */
+
+#if !defined(FAST_MATH)
+#error The polynomial kernels are only built with FAST_MATH
+#endif
+
+// To use a test fixture, derive a class from testing::Test.
+class FastMath : public testing::Test {
+protected:
+  virtual void SetUp() {
+  }
+
+  virtual void TearDown() {
+  }
+};
+
+TEST_F(FastMath, SinCosSweep) {
+  float eps = 1e-6f;
+
+  for (float x = -1000.0f; x <= 1000.0f; x += .00137f) {
+    float s, c;
+    fast_sincosf(x, &s, &c);
+    ASSERT_NEAR(sinf(x), s, eps) << "x = " << x;
+    ASSERT_NEAR(cosf(x), c, eps) << "x = " << x;
+  }
+}
+
+TEST_F(FastMath, SinCosAgree) {
+  for (float x = -10.0f; x <= 10.0f; x += .001f) {
+    float s, c;
+    fast_sincosf(x, &s, &c);
+    ASSERT_EQ(s, fast_sinf(x));
+    ASSERT_EQ(c, fast_cosf(x));
+  }
+}
+
+TEST_F(FastMath, SinCosQuadrants) {
+  float eps = 1e-6f;
+
+  EXPECT_NEAR(0.0f, fast_sinf(0), eps);
+  EXPECT_NEAR(1.0f, fast_cosf(0), eps);
+  EXPECT_NEAR(1.0f, fast_sinf(M_PI_2), eps);
+  EXPECT_NEAR(0.0f, fast_cosf(M_PI_2), eps);
+  EXPECT_NEAR(0.0f, fast_sinf(M_PI), eps);
+  EXPECT_NEAR(-1.0f, fast_cosf(M_PI), eps);
+  EXPECT_NEAR(-1.0f, fast_sinf(-M_PI_2), eps);
+  EXPECT_NEAR(0.0f, fast_cosf(-M_PI_2), eps);
+}
+
+TEST_F(FastMath, Atan2Sweep) {
+  float eps = 1e-6f;
+
+  // Walk around circles of very different radii
+  for (float r = 1e-3f; r <= 1e4f; r *= 10.0f) {
+    for (float a = -M_PI; a <= M_PI; a += .0001f) {
+      float y = r * sinf(a);
+      float x = r * cosf(a);
+      ASSERT_NEAR(atan2f(y, x), fast_atan2f(y, x), eps) << "y = " << y << " x = " << x;
+    }
+  }
+}
+
+TEST_F(FastMath, Atan2Axes) {
+  float eps = 1e-6f;
+
+  EXPECT_EQ(0.0f, fast_atan2f(0, 0));
+  EXPECT_NEAR(0.0f, fast_atan2f(0, 1), eps);
+  EXPECT_NEAR(M_PI_2, fast_atan2f(1, 0), eps);
+  EXPECT_NEAR(-M_PI_2, fast_atan2f(-1, 0), eps);
+  EXPECT_NEAR(M_PI, fast_atan2f(0, -1), eps);
+  EXPECT_NEAR(M_PI_4, fast_atan2f(1, 1), eps);
+  EXPECT_NEAR(-3 * M_PI_4, fast_atan2f(-1, -1), eps);
+}
+
+TEST_F(FastMath, AsinSweep) {
+  float eps = 1e-6f;
+
+  for (float x = -1.0f; x <= 1.0f; x += .00001f) {
+    ASSERT_NEAR(asinf(x), fast_asinf(x), eps) << "x = " << x;
+  }
+
+  EXPECT_NEAR(M_PI_2, fast_asinf(1.0f), eps);
+  EXPECT_NEAR(-M_PI_2, fast_asinf(-1.0f), eps);
+  EXPECT_TRUE(isnan(fast_asinf(1.5f)));
+}
+
+TEST_F(FastMath, InvSqrtSweep) {
+  float eps = 5e-6f;
+
+  for (float x = 1e-6f; x <= 1e6f; x *= 1.001f) {
+    float expected = 1.0f / sqrtf(x);
+    ASSERT_NEAR(1.0f, fast_invsqrtf(x) / expected, eps) << "x = " << x;
+  }
+}
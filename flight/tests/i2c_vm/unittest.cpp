@@ -41,7 +41,7 @@
 extern "C" {
 
 #include "i2c_vm_asm.h"
-extern bool i2c_vm_run (const uint32_t * code, uint8_t code_len, uintptr_t i2c_adapter);
+#include "i2c_vm.h"
 
 #include "i2cvm.h"		// uavo_data
 
@@ -800,3 +800,36 @@ TEST_F(I2CVMTest, CleanReboot) {
 
   EXPECT_EQ(0, memcmp(ram2, uavo_data.ram, sizeof(ram)));
 }
+
+TEST_F(I2CVMTest, LoadOnceRunMany) {
+  const uint32_t program[] = {
+    I2C_VM_ASM_SET_IMM(VM_R0, 3),
+    I2C_VM_ASM_ADD_IMM(VM_R1, 2),
+    I2C_VM_ASM_ADD_IMM(VM_R0, -1),
+    I2C_VM_ASM_BNZ(VM_R0, -2),
+    I2C_VM_ASM_SEND_UAVO(),
+  };
+  struct i2c_vm_insn decoded[I2C_VM_PROGRAM_LEN(NELEMENTS(program))];
+
+  ASSERT_TRUE(i2c_vm_load (decoded, program, NELEMENTS(program)));
+
+  /* Every run starts from a freshly rebooted machine */
+  for (int i = 0; i < 3; i++) {
+    memset(&uavo_data, 0xFF, sizeof(uavo_data));
+    EXPECT_TRUE(i2c_vm_exec (decoded, 0));
+
+    EXPECT_EQ(4, uavo_data.pc);
+    EXPECT_EQ(0, uavo_data.r0);
+    EXPECT_EQ(6, uavo_data.r1);
+  }
+}
+
+TEST_F(I2CVMTest, BranchOutOfRangeFaultsOnlyWhenTaken) {
+  const uint32_t program[] = {
+    I2C_VM_ASM_BNZ(VM_R0, -10),
+    I2C_VM_ASM_SET_IMM(VM_R0, 1),
+    I2C_VM_ASM_BNZ(VM_R0, 10),
+  };
+
+  EXPECT_FALSE(i2c_vm_run (program, NELEMENTS(program), 0));
+}
@@ -0,0 +1,236 @@
+/**
+ ******************************************************************************
+ * @file       unittest.cpp
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2013
+ * @addtogroup UnitTests
+ * @{
+ * @addtogroup UnitTests
+ * @{
+ * @brief Unit test
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+/*
+ * NOTE: This program uses the Google Test infrastructure to drive the unit test
+ *
+ * Main site for Google Test: http://code.google.com/p/googletest/
+ * Documentation and examples: http://code.google.com/p/googletest/wiki/Documentation
+ */
+
+
+#include "gtest/gtest.h"
+
+#include <stdio.h>		/* printf */
+#include <stdlib.h>		/* abort */
+#include <string.h>		/* memset */
+#include <stdint.h>		/* uint*_t */
+#include <math.h>		/* fabsf */
+
+extern "C" {
+
+#include "path_fillet.h"	/* API for the fillet */
+
+}
+
+#define EPS 1e-4f
+
+// To use a test fixture, derive a class from testing::Test.
+class PathFillet : public testing::Test {
+protected:
+  virtual void SetUp() {
+    memset(out, 0, sizeof(out));
+  }
+
+  virtual void TearDown() {
+  }
+
+  static struct path_fillet_point point(float north, float east, float curvature = 0) {
+    struct path_fillet_point p = {{north, east, -10}, 5, curvature};
+    return p;
+  }
+
+  static void expect_point(const struct path_fillet_point &p, float north, float east, float curvature) {
+    EXPECT_NEAR(north, p.position[0], EPS);
+    EXPECT_NEAR(east, p.position[1], EPS);
+    EXPECT_NEAR(-10, p.position[2], EPS);
+    EXPECT_NEAR(5, p.velocity, EPS);
+    EXPECT_NEAR(curvature, p.curvature, EPS);
+  }
+
+  struct path_fillet_point out[PATH_FILLET_MAX_POINTS];
+};
+
+// Test fixture for the helpers
+class PathFilletHelpers : public PathFillet {
+};
+
+TEST_F(PathFilletHelpers, CircularModulus) {
+  EXPECT_NEAR(0, path_fillet_circular_modulus(0), EPS);
+  EXPECT_NEAR(PATH_FILLET_PI / 2, path_fillet_circular_modulus(PATH_FILLET_PI / 2), EPS);
+  EXPECT_NEAR(-PATH_FILLET_PI / 2, path_fillet_circular_modulus(3 * PATH_FILLET_PI / 2), EPS);
+  EXPECT_NEAR(PATH_FILLET_PI / 2, path_fillet_circular_modulus(-3 * PATH_FILLET_PI / 2), EPS);
+};
+
+TEST_F(PathFilletHelpers, AngleBetween) {
+  float north[2] = {1, 0};
+  float east[2] = {0, 1};
+
+  // Turning from north to east is clockwise
+  EXPECT_NEAR(PATH_FILLET_PI / 2, path_fillet_angle_between(north, east), EPS);
+  EXPECT_NEAR(-PATH_FILLET_PI / 2, path_fillet_angle_between(east, north), EPS);
+  EXPECT_NEAR(0, path_fillet_angle_between(north, north), EPS);
+};
+
+TEST_F(PathFilletHelpers, ArcCenter) {
+  float start[2] = {0, 0};
+  float end[2] = {20, 20};
+  float center[2];
+
+  EXPECT_EQ(PATH_FILLET_CENTER_FOUND, path_fillet_find_arc_center(start, end, 20, center, true, true));
+  EXPECT_NEAR(0, center[0], EPS);
+  EXPECT_NEAR(20, center[1], EPS);
+
+  EXPECT_EQ(PATH_FILLET_CENTER_FOUND, path_fillet_find_arc_center(start, end, 20, center, false, true));
+  EXPECT_NEAR(20, center[0], EPS);
+  EXPECT_NEAR(0, center[1], EPS);
+
+  EXPECT_EQ(PATH_FILLET_INSUFFICIENT_RADIUS, path_fillet_find_arc_center(start, end, 10, center, true, true));
+  EXPECT_EQ(PATH_FILLET_COINCIDENT_POINTS, path_fillet_find_arc_center(start, start, 10, center, true, true));
+};
+
+// Test fixture for filleting waypoints
+class PathFilletWaypoint : public PathFillet {
+};
+
+TEST_F(PathFilletWaypoint, EndsUnchanged) {
+  struct path_fillet_point prev = point(0, 0);
+  struct path_fillet_point current = point(100, 0);
+  struct path_fillet_point next = point(100, 100);
+
+  // Neither the first nor the last waypoint has a corner
+  ASSERT_EQ(1, path_fillet_waypoint(10, NULL, &current, &next, out));
+  expect_point(out[0], 100, 0, 0);
+
+  ASSERT_EQ(1, path_fillet_waypoint(10, &prev, &current, NULL, out));
+  expect_point(out[0], 100, 0, 0);
+};
+
+TEST_F(PathFilletWaypoint, ZeroRadiusKeepsWaypoint) {
+  struct path_fillet_point prev = point(0, 0);
+  struct path_fillet_point current = point(100, 0);
+  struct path_fillet_point next = point(100, 100);
+
+  ASSERT_EQ(1, path_fillet_waypoint(0, &prev, &current, &next, out));
+  expect_point(out[0], 100, 0, 0);
+};
+
+TEST_F(PathFilletWaypoint, RightTurn) {
+  struct path_fillet_point prev = point(0, 0);
+  struct path_fillet_point current = point(100, 0);
+  struct path_fillet_point next = point(100, 100);
+
+  // A line up to the fillet then a clockwise arc tangent to both segments
+  ASSERT_EQ(2, path_fillet_waypoint(10, &prev, &current, &next, out));
+  expect_point(out[0], 90, 0, 0);
+  expect_point(out[1], 100, 10, 0.1f);
+};
+
+TEST_F(PathFilletWaypoint, LeftTurn) {
+  struct path_fillet_point prev = point(0, 0);
+  struct path_fillet_point current = point(100, 0);
+  struct path_fillet_point next = point(100, -100);
+
+  ASSERT_EQ(2, path_fillet_waypoint(10, &prev, &current, &next, out));
+  expect_point(out[0], 90, 0, 0);
+  expect_point(out[1], 100, -10, -0.1f);
+};
+
+TEST_F(PathFilletWaypoint, ColinearUnchanged) {
+  struct path_fillet_point prev = point(0, 0);
+  struct path_fillet_point current = point(100, 0);
+  struct path_fillet_point next = point(200, 0);
+
+  ASSERT_EQ(1, path_fillet_waypoint(10, &prev, &current, &next, out));
+  expect_point(out[0], 100, 0, 0);
+};
+
+TEST_F(PathFilletWaypoint, ShortSegmentLimitsRadius) {
+  struct path_fillet_point prev = point(0, 0);
+  struct path_fillet_point current = point(5, 0);
+  struct path_fillet_point next = point(5, 100);
+
+  // The fillet has to start after the previous waypoint
+  ASSERT_EQ(2, path_fillet_waypoint(10, &prev, &current, &next, out));
+  expect_point(out[0], 0.1f, 0, 0);
+  expect_point(out[1], 5, 4.9f, 1 / 4.9f);
+};
+
+TEST_F(PathFilletWaypoint, AcuteCorner) {
+  struct path_fillet_point prev = point(0, 0);
+  struct path_fillet_point current = point(100, 0);
+  struct path_fillet_point next = point(0, 10);
+
+  // Flown around the outside with three arcs
+  ASSERT_EQ(5, path_fillet_waypoint(10, &prev, &current, &next, out));
+
+  float q_future[2] = {-100, 10};
+  float mag = sqrtf(q_future[0] * q_future[0] + q_future[1] * q_future[1]);
+
+  expect_point(out[0], 100 - 10 * PATH_FILLET_SQRT3, 0, 0);
+  EXPECT_NEAR(-0.1f, out[1].curvature, EPS);
+  EXPECT_NEAR(0.1f, out[2].curvature, EPS);
+  EXPECT_NEAR(0.1f, out[3].curvature, EPS);
+  expect_point(out[4], 100 + 10 * PATH_FILLET_SQRT3 * q_future[0] / mag,
+               10 * PATH_FILLET_SQRT3 * q_future[1] / mag, -0.1f);
+
+  // Halfway around the circle beyond the corner
+  expect_point(out[2], 110, 0, 0.1f);
+};
+
+TEST_F(PathFilletWaypoint, ArrivingOnArc) {
+  // A clockwise quarter circle from heading north to heading east
+  struct path_fillet_point prev = point(0, 0);
+  struct path_fillet_point current = point(20, 20, 1 / 20.0f);
+  struct path_fillet_point next = point(20, 100);
+
+  // The arc already ends heading along the next segment
+  ASSERT_EQ(1, path_fillet_waypoint(10, &prev, &current, &next, out));
+  expect_point(out[0], 20, 20, 1 / 20.0f);
+};
+
+TEST_F(PathFilletWaypoint, Path) {
+  // A 100 m box, every corner of which is replaced by a line and an arc
+  struct path_fillet_point waypoints[] = {
+    point(0, 0), point(100, 0), point(100, 100), point(0, 100), point(0, 0),
+  };
+  const int num_waypoints = sizeof(waypoints) / sizeof(waypoints[0]);
+
+  struct path_fillet_point prev;
+  int num_points = 0;
+
+  for (int i = 0; i < num_waypoints; i++) {
+    int points = path_fillet_waypoint(10, i > 0 ? &prev : NULL, &waypoints[i],
+                                      i < num_waypoints - 1 ? &waypoints[i + 1] : NULL, out);
+    for (int j = 0; j < points; j++)
+      EXPECT_GE(0.1f + EPS, out[j].curvature);
+    prev = out[points - 1];
+    num_points += points;
+  }
+
+  EXPECT_EQ(1 + 3 * 2 + 1, num_points);
+  expect_point(prev, 0, 0, 0);
+};
@@ -0,0 +1,2 @@
+/* The rscode library only needs the number of parity bytes from the board */
+#define RS_ECC_NPARITY 4
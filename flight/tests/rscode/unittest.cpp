@@ -0,0 +1,151 @@
+/**
+ ******************************************************************************
+ * @file       unittest.cpp
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2013
+ * @addtogroup UnitTests
+ * @{
+ * @addtogroup UnitTests
+ * @{
+ * @brief Unit test
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+/*
+ * NOTE: This program uses the Google Test infrastructure to drive the unit test
+ *
+ * Main site for Google Test: http://code.google.com/p/googletest/
+ * Documentation and examples: http://code.google.com/p/googletest/wiki/Documentation
+ */
+
+#include "gtest/gtest.h"
+
+#include <stdio.h>		/* printf */
+#include <string.h>		/* memcpy */
+#include <stdint.h>		/* uint*_t */
+
+extern "C" {
+
+#include "ecc.h"		/* API for the rscode library */
+
+}
+
+#define MSG_LEN 32
+#define CODE_LEN (MSG_LEN + RS_ECC_NPARITY)
+
+// To use a test fixture, derive a class from testing::Test.
+class RSCode : public testing::Test {
+protected:
+  virtual void SetUp() {
+    for (int i = 0; i < MSG_LEN; i++)
+      msg[i] = i * 37 + 11;
+    encode_data(msg, MSG_LEN, codeword);
+  }
+
+  virtual void TearDown() {
+  }
+
+  unsigned char msg[MSG_LEN];
+  unsigned char codeword[CODE_LEN];
+  struct rs_ecc rs;
+};
+
+TEST_F(RSCode, EncodeMatchesReference) {
+  // Parity computed by the original rscode implementation
+  const unsigned char parity[RS_ECC_NPARITY] = { 0x05, 0x10, 0x30, 0x5e };
+
+  EXPECT_EQ(0, memcmp(msg, codeword, MSG_LEN));
+  EXPECT_EQ(0, memcmp(parity, codeword + MSG_LEN, RS_ECC_NPARITY));
+};
+
+TEST_F(RSCode, EncodeInPlace) {
+  unsigned char buf[CODE_LEN];
+
+  memcpy(buf, msg, MSG_LEN);
+  encode_data(buf, MSG_LEN, buf);
+  EXPECT_EQ(0, memcmp(codeword, buf, CODE_LEN));
+};
+
+TEST_F(RSCode, CleanCodewordHasNoSyndrome) {
+  EXPECT_EQ(0, decode_data(&rs, codeword, CODE_LEN));
+  EXPECT_EQ(0, check_syndrome(&rs));
+  for (int i = 0; i < MAXDEG; i++)
+    EXPECT_EQ(0, rs.synBytes[i]);
+};
+
+TEST_F(RSCode, CorrectsUpToTwoErrors) {
+  for (int a = 0; a < CODE_LEN; a++) {
+    for (int b = a + 1; b < CODE_LEN; b += 5) {
+      unsigned char buf[CODE_LEN];
+
+      memcpy(buf, codeword, CODE_LEN);
+      buf[a] ^= 0x5a;
+      buf[b] ^= a + 1;
+
+      ASSERT_NE(0, decode_data(&rs, buf, CODE_LEN));
+      ASSERT_NE(0, check_syndrome(&rs));
+      ASSERT_EQ(1, correct_errors_erasures(&rs, buf, CODE_LEN, 0, NULL));
+      ASSERT_EQ(0, memcmp(codeword, buf, CODE_LEN)) << "errors at " << a << " and " << b;
+    }
+  }
+};
+
+TEST_F(RSCode, CorrectsErasures) {
+  unsigned char buf[CODE_LEN];
+  int erasures[2];
+
+  // One error at an unknown location and two erasures, which are
+  // indexed from the end of the codeword
+  memcpy(buf, codeword, CODE_LEN);
+  buf[2] ^= 0x35;
+  buf[16] = 0;
+  buf[18] = 0;
+  erasures[0] = CODE_LEN - 17;
+  erasures[1] = CODE_LEN - 19;
+
+  ASSERT_NE(0, decode_data(&rs, buf, CODE_LEN));
+  EXPECT_EQ(1, correct_errors_erasures(&rs, buf, CODE_LEN, 2, erasures));
+  EXPECT_EQ(0, memcmp(codeword, buf, CODE_LEN));
+};
+
+TEST_F(RSCode, IndependentContexts) {
+  struct rs_ecc other;
+  unsigned char bad[CODE_LEN];
+
+  // Decoding a second codeword must not disturb the first context
+  memcpy(bad, codeword, CODE_LEN);
+  bad[7] ^= 0xff;
+  ASSERT_NE(0, decode_data(&rs, bad, CODE_LEN));
+  ASSERT_EQ(0, decode_data(&other, codeword, CODE_LEN));
+  EXPECT_NE(0, check_syndrome(&rs));
+  EXPECT_EQ(1, correct_errors_erasures(&rs, bad, CODE_LEN, 0, NULL));
+  EXPECT_EQ(0, memcmp(codeword, bad, CODE_LEN));
+};
+
+TEST_F(RSCode, TooManyErrorsAreNotMiscorrectedIntoTheMessage) {
+  unsigned char buf[CODE_LEN];
+
+  memcpy(buf, codeword, CODE_LEN);
+  buf[1] ^= 0x11;
+  buf[9] ^= 0x22;
+  buf[20] ^= 0x33;
+
+  // Three errors are more than the parity can correct, the decoder must
+  // report the failure rather than hand back a wrong message
+  ASSERT_NE(0, decode_data(&rs, buf, CODE_LEN));
+  EXPECT_EQ(0, correct_errors_erasures(&rs, buf, CODE_LEN, 0, NULL));
+  EXPECT_NE(0, memcmp(codeword, buf, CODE_LEN));
+};
@@ -0,0 +1,5 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#define pvPortMalloc(xSize) (malloc(xSize))
+#define vPortFree(pv) (free(pv))
@@ -0,0 +1,254 @@
+/**
+ ******************************************************************************
+ * @file       unittest.cpp
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2013
+ * @addtogroup UnitTests
+ * @{
+ * @addtogroup UnitTests
+ * @{
+ * @brief Unit test
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+/*
+ * NOTE: This program uses the Google Test infrastructure to drive the unit test
+ *
+ * Main site for Google Test: http://code.google.com/p/googletest/
+ * Documentation and examples: http://code.google.com/p/googletest/wiki/Documentation
+ */
+
+
+#include "gtest/gtest.h"
+
+#include <stdio.h>		/* printf */
+#include <stdlib.h>		/* abort */
+#include <string.h>		/* memset */
+#include <stdint.h>		/* uint*_t */
+#include <math.h>		/* fabsf */
+
+extern "C" {
+
+#include "WorldMagModel.h"	/* API for the WMM */
+#include "wmm_tile.h"		/* API for the interpolation tile */
+
+}
+
+// To use a test fixture, derive a class from testing::Test.
+class WmmTile : public testing::Test {
+protected:
+  virtual void SetUp() {
+    wmm_tile_init(&tile, 1.0f, 100.0f);
+    calls = 0;
+    fail = false;
+    max_abs_lat = 0;
+  }
+
+  virtual void TearDown() {
+  }
+
+  // A field that bilinear interpolation reproduces exactly
+  static int bilinear_field(void *ctx, float lat, float lon, float alt, float B[3]) {
+    WmmTile *self = (WmmTile *) ctx;
+    if (self->fail)
+      return -1;
+    self->calls++;
+    if (fabsf(lat) > self->max_abs_lat)
+      self->max_abs_lat = fabsf(lat);
+    B[0] = 2.0f * lat + 3.0f * lon + 0.01f * alt;
+    B[1] = 0.5f * lat * lon;
+    B[2] = -lon + 7.0f;
+    return 0;
+  }
+
+  static void expected(float lat, float lon, float alt, float B[3]) {
+    B[0] = 2.0f * lat + 3.0f * lon + 0.01f * alt;
+    B[1] = 0.5f * lat * lon;
+    B[2] = -lon + 7.0f;
+  }
+
+  int get(float lat, float lon, float alt, float B[3]) {
+    return wmm_tile_get(&tile, bilinear_field, this, lat, lon, alt, B);
+  }
+
+  struct wmm_tile tile;
+  int calls;
+  bool fail;
+  float max_abs_lat;
+};
+
+TEST_F(WmmTile, ExactForBilinearField) {
+  float B[3], E[3];
+
+  const float points[][2] = {
+    { 47.25f, 8.5f }, { 47.9f, 8.1f }, { -33.3f, 151.2f }, { 0.0f, 0.0f }, { -0.5f, -179.9f },
+  };
+
+  for (uint32_t i = 0; i < sizeof(points) / sizeof(points[0]); i++) {
+    ASSERT_EQ(0, get(points[i][0], points[i][1], 0, B));
+    expected(points[i][0], points[i][1], tile.alt, E);
+    for (int k = 0; k < 3; k++)
+      EXPECT_NEAR(E[k], B[k], 1e-3f * (1.0f + fabsf(E[k])));
+  }
+};
+
+TEST_F(WmmTile, NoEvaluationInsideCell) {
+  float B[3];
+
+  ASSERT_EQ(0, get(47.1f, 8.1f, 400, B));
+  EXPECT_EQ(4, calls);
+
+  ASSERT_EQ(0, get(47.5f, 8.5f, 450, B));
+  ASSERT_EQ(0, get(47.9f, 8.9f, 350, B));
+  EXPECT_EQ(4, calls);
+  EXPECT_EQ((uint32_t) 4, tile.evaluations);
+};
+
+TEST_F(WmmTile, ReusesSharedCorners) {
+  float B[3];
+
+  ASSERT_EQ(0, get(47.5f, 8.5f, 0, B));
+  EXPECT_EQ(4, calls);
+
+  // East, the western corners are the old eastern ones
+  ASSERT_EQ(0, get(47.5f, 9.5f, 0, B));
+  EXPECT_EQ(6, calls);
+
+  // North east, only one corner is shared
+  ASSERT_EQ(0, get(48.5f, 10.5f, 0, B));
+  EXPECT_EQ(9, calls);
+
+  // Jump, nothing is shared
+  ASSERT_EQ(0, get(10.5f, 10.5f, 0, B));
+  EXPECT_EQ(13, calls);
+};
+
+TEST_F(WmmTile, AltitudeThreshold) {
+  float B[3], E[3];
+
+  ASSERT_EQ(0, get(47.5f, 8.5f, 0, B));
+  EXPECT_EQ(4, calls);
+
+  // Within the threshold the corners keep their altitude
+  ASSERT_EQ(0, get(47.5f, 8.5f, 90, B));
+  EXPECT_EQ(4, calls);
+  expected(47.5f, 8.5f, 0, E);
+  EXPECT_NEAR(E[0], B[0], 1e-3f);
+
+  // Past it all of them are recomputed, even when moving to a neighbour
+  ASSERT_EQ(0, get(47.5f, 9.5f, 150, B));
+  EXPECT_EQ(8, calls);
+  expected(47.5f, 9.5f, 150, E);
+  EXPECT_NEAR(E[0], B[0], 1e-3f);
+};
+
+TEST_F(WmmTile, FailureKeepsTile) {
+  float B[3], E[3];
+
+  ASSERT_EQ(0, get(47.5f, 8.5f, 0, B));
+
+  fail = true;
+  EXPECT_GT(0, get(12.5f, 8.5f, 0, B));
+  EXPECT_TRUE(tile.valid);
+  EXPECT_EQ(47 + 90, tile.row);
+
+  fail = false;
+  ASSERT_EQ(0, get(47.5f, 8.5f, 0, B));
+  EXPECT_EQ(4, calls);
+  expected(47.5f, 8.5f, 0, E);
+  EXPECT_NEAR(E[0], B[0], 1e-3f);
+};
+
+TEST_F(WmmTile, Edges) {
+  float B[3], E[3];
+
+  const float points[][2] = {
+    { 90.0f, 180.0f }, { -90.0f, -180.0f }, { 90.0f, -180.0f }, { -90.0f, 180.0f },
+  };
+
+  for (uint32_t i = 0; i < sizeof(points) / sizeof(points[0]); i++) {
+    ASSERT_EQ(0, get(points[i][0], points[i][1], 0, B));
+    expected(points[i][0], points[i][1], 0, E);
+    for (int k = 0; k < 3; k++)
+      EXPECT_NEAR(E[k], B[k], 1e-2f);
+  }
+
+  // The model is never evaluated exactly at a pole
+  EXPECT_GT(90.0f, max_abs_lat);
+};
+
+class WorldMagModel : public testing::Test {
+protected:
+  virtual void SetUp() {
+  }
+
+  virtual void TearDown() {
+  }
+
+  static float rel_error(const float a[3], const float b[3]) {
+    float d = 0, n = 0;
+    for (int k = 0; k < 3; k++) {
+      d += (a[k] - b[k]) * (a[k] - b[k]);
+      n += b[k] * b[k];
+    }
+    return sqrtf(d / n);
+  }
+};
+
+TEST_F(WorldMagModel, RangeChecks) {
+  float B[3];
+
+  EXPECT_GT(0, WMM_GetMagVector(91, 0, 0, 1, 1, 2013, B));
+  EXPECT_GT(0, WMM_GetMagVector(0, -181, 0, 1, 1, 2013, B));
+  EXPECT_GT(0, WMM_GetMagVector(0, 0, 0, 13, 1, 2013, B));
+  EXPECT_GT(0, WMM_GetMagVectorTracked(-91, 0, 0, 1, 1, 2013, B));
+  EXPECT_GT(0, WMM_GetMagVectorTracked(0, 181, 0, 1, 1, 2013, B));
+  EXPECT_GT(0, WMM_GetMagVectorTracked(0, 0, 0, 2, 30, 2013, B));
+};
+
+TEST_F(WorldMagModel, TrackedMatchesFullModel) {
+  float B[3], E[3];
+  float worst = 0;
+
+  // A long range flight, heading north east with a climb
+  for (int i = 0; i <= 200; i++) {
+    float lat = 40.0f + i * 0.0173f;
+    float lon = -5.0f + i * 0.0291f;
+    float alt = i * 15.0f;
+
+    ASSERT_EQ(0, WMM_GetMagVector(lat, lon, alt, 6, 15, 2013, E));
+    ASSERT_EQ(0, WMM_GetMagVectorTracked(lat, lon, alt, 6, 15, 2013, B));
+
+    float err = rel_error(B, E);
+    if (err > worst)
+      worst = err;
+  }
+
+  EXPECT_LT(worst, 2e-3f);
+};
+
+TEST_F(WorldMagModel, TrackedExactAtCorners) {
+  float B[3], E[3];
+
+  ASSERT_EQ(0, WMM_GetMagVector(-33.0f, 151.0f, 0, 3, 1, 2013, E));
+  ASSERT_EQ(0, WMM_GetMagVectorTracked(-33.0f, 151.0f, 0, 3, 1, 2013, B));
+  EXPECT_LT(rel_error(B, E), 1e-5f);
+
+  // A different date must not reuse the corners
+  ASSERT_EQ(0, WMM_GetMagVector(-33.0f, 151.0f, 0, 3, 1, 2014, E));
+  ASSERT_EQ(0, WMM_GetMagVectorTracked(-33.0f, 151.0f, 0, 3, 1, 2014, B));
+  EXPECT_LT(rel_error(B, E), 1e-5f);
+};
@@ -32,8 +32,8 @@
 namespace core {
     KiberTileCache::KiberTileCache()
     {
-        memoryCacheSize = 0;
         _MemoryCacheCapacity = 22;
+        cachequeue.setMaxCost(_MemoryCacheCapacity*1048576);
     }
 
     void KiberTileCache::setMemoryCacheCapacity(const int &value)
@@ -45,26 +45,38 @@ namespace core {
     int KiberTileCache::MemoryCacheCapacity()
     {
         kiberCacheLock.lockForRead();
-        return _MemoryCacheCapacity;
+        int value=_MemoryCacheCapacity;
         kiberCacheLock.unlock();
+        return value;
+    }
+
+    QByteArray KiberTileCache::Get(const RawTile &tile)
+    {
+        // Looking a tile up makes it the most recently used
+        QByteArray *pic=cachequeue.object(tile);
+        return pic ? *pic : QByteArray();
+    }
+
+    void KiberTileCache::Insert(const RawTile &tile, const QByteArray &pic)
+    {
+        RemoveMemoryOverload();
+        // The least recently used tiles are dropped to make room
+        cachequeue.insert(tile,new QByteArray(pic),pic.size());
     }
 
     void KiberTileCache::RemoveMemoryOverload()
     {
-        while(MemoryCacheSize()>MemoryCacheCapacity())
+        // QCache evicts on insert, so only a changed capacity has to be applied here
+        int capacity=qMin(MemoryCacheCapacity(),2047)*1048576;
+        if(cachequeue.maxCost()!=capacity)
         {
-            if(cachequeue.count()>0 && list.count()>0)
-            {
 #ifdef DEBUG_MEMORY_CACHE
-                qDebug()<<"Cleaning Memory cache="<<" started with "<<cachequeue.count()<<" tile "<<"ocupying "<<memoryCacheSize<<" bytes";
+            qDebug()<<"Cleaning Memory cache="<<" started with "<<cachequeue.count()<<" tile "<<"ocupying "<<cachequeue.totalCost()<<" bytes";
 #endif
-                RawTile first=list.dequeue();
-                memoryCacheSize-=cachequeue.value(first).size();
-                cachequeue.remove(first);
-            }
-        }
+            cachequeue.setMaxCost(capacity);
 #ifdef DEBUG_MEMORY_CACHE
-        qDebug()<<"Cleaning Memory cache="<<" ended with "<<cachequeue.count()<<" tile "<<"ocupying "<<memoryCacheSize<<" bytes";
+            qDebug()<<"Cleaning Memory cache="<<" ended with "<<cachequeue.count()<<" tile "<<"ocupying "<<cachequeue.totalCost()<<" bytes";
 #endif
+        }
     }
 }
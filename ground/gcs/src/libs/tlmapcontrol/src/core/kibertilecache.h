@@ -31,10 +31,15 @@
 #include "rawtile.h"
 #include <QMutex>
 #include <QReadWriteLock>
-#include <QQueue>
+#include <QCache>
 #include <QDebug>
 #include "debugheader.h"
 namespace core {
+    /**
+     * @brief Encoded tiles, kept in least recently used order. The cost of a
+     * tile is its size in bytes, so the capacity is a real memory budget.
+     * Not thread safe, callers hold MemoryCache::kiberCacheLock for writing.
+     */
     class KiberTileCache
     {
     public:
@@ -42,13 +47,13 @@ namespace core {
 
         void setMemoryCacheCapacity(const int &value);
         int MemoryCacheCapacity();
-        double MemoryCacheSize(){return memoryCacheSize/1048576.0;}
+        double MemoryCacheSize(){return cachequeue.totalCost()/1048576.0;}
         void RemoveMemoryOverload();
+        QByteArray Get(const RawTile &tile);
+        void Insert(const RawTile &tile, const QByteArray &pic);
         QReadWriteLock kiberCacheLock;
-        QHash <RawTile,QByteArray> cachequeue;
-        QQueue <RawTile> list;
-        long memoryCacheSize;
     private:
+        QCache <RawTile,QByteArray> cachequeue;
         int _MemoryCacheCapacity;
 
     };
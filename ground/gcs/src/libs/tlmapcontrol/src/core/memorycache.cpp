@@ -37,23 +37,20 @@ namespace core {
 
     QByteArray MemoryCache::GetTileFromMemoryCache(const RawTile &tile)
     {
-        kiberCacheLock.lockForRead();
+        // A lookup reorders the LRU list, so it needs the write lock too
+        kiberCacheLock.lockForWrite();
         QByteArray pic;
-        pic=TilesInMemory.cachequeue.value(tile);
-        // TilesInMemory.find(key,&pic);
+        pic=TilesInMemory.Get(tile);
         kiberCacheLock.unlock();
         return pic;
     }
     void MemoryCache::AddTileToMemoryCache(const RawTile &tile, const QByteArray &pic)
     {
         kiberCacheLock.lockForWrite();
-        // QPixmapCache::Key key=TilesInMemory.insert(pic);
-        TilesInMemory.memoryCacheSize +=pic.size();
+        TilesInMemory.Insert(tile,pic);
 #ifdef DEBUG_MEMORY_CACHE
-        qDebug()<<"Current memory="<<TilesInMemory.memoryCacheSize<<" in "<<TilesInMemory.cachequeue.count()<<" tiles";
+        qDebug()<<"Current memory="<<TilesInMemory.MemoryCacheSize()<<"MB";
 #endif
-        TilesInMemory.cachequeue.insert(tile,pic);
-        TilesInMemory.list.enqueue(tile);
 
         kiberCacheLock.unlock();
     }
@@ -32,9 +32,66 @@
 namespace core {
     qlonglong PureImageCache::ConnCounter=0;
 
-    PureImageCache::PureImageCache()
+    PureImageCacheConnection::PureImageCacheConnection(const QString &name, const QString &file, int generation):
+        name(name),generation(generation),open(false)
     {
+        db = QSqlDatabase::addDatabase("QSQLITE",name);
+        db.setDatabaseName(file);
+        if(!db.open())
+        {
+#ifdef DEBUG_PUREIMAGECACHE
+            qDebug()<<"PureImageCacheConnection: Unable to open "<<file<<db.lastError().driverText();
+#endif //DEBUG_PUREIMAGECACHE
+            return;
+        }
+        // Readers keep going while the cache thread writes, instead of
+        // waiting for the database lock
+        QSqlQuery pragma(db);
+        pragma.exec("PRAGMA journal_mode=WAL");
+        pragma.exec("PRAGMA synchronous=NORMAL");
 
+        selectTile=QSqlQuery(db);
+        insertTile=QSqlQuery(db);
+        insertTileData=QSqlQuery(db);
+        open=selectTile.prepare("SELECT Tile FROM TilesData WHERE id = (SELECT id FROM Tiles WHERE Type=? AND Zoom=? AND X=? AND Y=?)") &&
+                insertTile.prepare("INSERT INTO Tiles(X, Y, Zoom, Type,Date) VALUES(?, ?, ?, ?,?)") &&
+                insertTileData.prepare("INSERT INTO TilesData(id, Tile) VALUES(?, ?)");
+    }
+
+    PureImageCacheConnection::~PureImageCacheConnection()
+    {
+        // Every query and handle must be gone before the connection can be removed
+        selectTile=QSqlQuery();
+        insertTile=QSqlQuery();
+        insertTileData=QSqlQuery();
+        db.close();
+        db=QSqlDatabase();
+        QSqlDatabase::removeDatabase(name);
+    }
+
+    PureImageCache::PureImageCache():generation(0)
+    {
+
+    }
+
+    /**
+     * @brief PureImageCache::connection Returns the calling thread's connection,
+     * opening it on first use or after the cache location changed. Must be
+     * called with the lock held.
+     */
+    PureImageCacheConnection *PureImageCache::connection()
+    {
+        PureImageCacheConnection *cn=connections.localData();
+        if(cn && cn->generation==generation)
+            return cn;
+
+        Mcounter.lock();
+        qlonglong id=++ConnCounter;
+        Mcounter.unlock();
+        // Replacing the thread's local data deletes the old connection
+        cn=new PureImageCacheConnection(QString("PureImageCache%1").arg(id),gtilecache+"Data.qmdb",generation);
+        connections.setLocalData(cn);
+        return cn;
     }
 
     void PureImageCache::setGtileCache(const QString &value)
@@ -58,7 +115,10 @@ namespace core {
 #endif //DEBUG_PUREIMAGECACHE
                 CreateEmptyDB(db);
             }
+            else
+                UpgradeDB(db);
         }
+        ++generation;
         lock.unlock();
     }
     QString PureImageCache::GtileCache()
@@ -168,133 +228,151 @@ namespace core {
         }
         db.close();
         QSqlDatabase::removeDatabase(QLatin1String("CreateConn"));
-        return true;
+        return UpgradeDB(file);
+    }
+
+    /**
+     * @brief PureImageCache::UpgradeDB Adds what older databases lack: the
+     * tile lookup index, and write-ahead logging. Both persist in the file, so
+     * this only does real work the first time an old cache is opened.
+     */
+    bool PureImageCache::UpgradeDB(const QString &file)
+    {
+        bool ret;
+        {
+            QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE",QLatin1String("UpgradeConn"));
+            db.setDatabaseName(file);
+            ret=db.open();
+            if(ret)
+            {
+                QSqlQuery query(db);
+                query.exec("PRAGMA journal_mode=WAL");
+                // Covers the tile lookup, which then never touches the Tiles table itself
+                ret=query.exec("CREATE INDEX IF NOT EXISTS IndexOfTiles ON Tiles (Type, Zoom, X, Y)");
+#ifdef DEBUG_PUREIMAGECACHE
+                if(!ret)
+                    qDebug()<<"UpgradeDB: "<<query.lastError().driverText();
+#endif //DEBUG_PUREIMAGECACHE
+                db.close();
+            }
+        }
+        QSqlDatabase::removeDatabase(QLatin1String("UpgradeConn"));
+        return ret;
     }
     bool PureImageCache::PutImageToCache(const QByteArray &tile, const MapType::Types &type,const Point &pos,const int &zoom)
     {
+        QList<CacheItemQueue*> tiles;
+        CacheItemQueue item(type,pos,tile,zoom);
+        tiles.append(&item);
+        return PutImagesToCache(tiles);
+    }
+
+    /**
+     * @brief PureImageCache::PutImagesToCache Stores a batch of tiles in a
+     * single transaction, so the database is synced once per batch rather
+     * than once per tile
+     */
+    bool PureImageCache::PutImagesToCache(const QList<CacheItemQueue*> &tiles)
+    {
+        lock.lockForRead();
         if(gtilecache.isEmpty()|gtilecache.isNull())
+        {
+            lock.unlock();
             return false;
-        lock.lockForRead();
+        }
 #ifdef DEBUG_PUREIMAGECACHE
-        qDebug()<<"PutImageToCache Start:";//<<pos;
+        qDebug()<<"PutImagesToCache Start:"<<tiles.count();
 #endif //DEBUG_PUREIMAGECACHE
-        Mcounter.lock();
-        qlonglong id=++ConnCounter;
-        Mcounter.unlock();
+        PureImageCacheConnection *cn=connection();
+        bool ret=cn->isOpen() && cn->db.transaction();
+        if(ret)
         {
-            QSqlDatabase cn;
-            cn = QSqlDatabase::addDatabase("QSQLITE",QString::number(id));
-            QString db=gtilecache+"Data.qmdb";
-            cn.setDatabaseName(db);
-            cn.setConnectOptions("QSQLITE_ENABLE_SHARED_CACHE");
-            if(cn.open())
+            QString date=QDateTime::currentDateTime().toString();
+            foreach(CacheItemQueue *task,tiles)
             {
-                {
-                    QSqlQuery query(cn);
-                    query.prepare("INSERT INTO Tiles(X, Y, Zoom, Type,Date) VALUES(?, ?, ?, ?,?)");
-                    query.addBindValue(pos.X());
-                    query.addBindValue(pos.Y());
-                    query.addBindValue(zoom);
+                cn->insertTile.addBindValue(task->GetPosition().X());
+                cn->insertTile.addBindValue(task->GetPosition().Y());
+                cn->insertTile.addBindValue(task->GetZoom());
+                cn->insertTile.addBindValue((int)task->GetMapType());
+                cn->insertTile.addBindValue(date);
+                if(!cn->insertTile.exec())
+                    continue;
 
-                    query.addBindValue((int)type);
-                    query.addBindValue(QDateTime::currentDateTime().toString());
-                    query.exec();
-                }
-                {
-                    QSqlQuery query(cn);
-                    query.prepare("INSERT INTO TilesData(id, Tile) VALUES((SELECT last_insert_rowid()), ?)");
-                    query.addBindValue(tile);
-                    query.exec();
-                }
-                cn.close();
+                cn->insertTileData.addBindValue(cn->insertTile.lastInsertId());
+                cn->insertTileData.addBindValue(task->GetImg());
+                cn->insertTileData.exec();
             }
+            ret=cn->db.commit();
+#ifdef DEBUG_PUREIMAGECACHE
+            if(!ret)
+                qDebug()<<"PutImagesToCache: "<<cn->db.lastError().driverText();
+#endif //DEBUG_PUREIMAGECACHE
         }
-        QSqlDatabase::removeDatabase(QString::number(id));
         lock.unlock();
-        return true;
+        return ret;
     }
     QByteArray PureImageCache::GetImageFromCache(MapType::Types type, Point pos, int zoom)
     {
         lock.lockForRead();
         QByteArray ar;
         if(gtilecache.isEmpty()|gtilecache.isNull())
+        {
+            lock.unlock();
             return ar;
-        QString dir=gtilecache;
-        Mcounter.lock();
-        qlonglong id=++ConnCounter;
-        Mcounter.unlock();
+        }
 #ifdef DEBUG_PUREIMAGECACHE
-        qDebug()<<"Cache dir="<<dir<<" Try to GET:"<<pos.X()+","+pos.Y();
+        qDebug()<<"Cache dir="<<gtilecache<<" Try to GET:"<<pos.X()+","+pos.Y();
 #endif //DEBUG_PUREIMAGECACHE
 
+        PureImageCacheConnection *cn=connection();
+        if(cn->isOpen())
         {
-            QString db=dir+"Data.qmdb";
-            {
-                QSqlDatabase cn;
-
-                cn = QSqlDatabase::addDatabase("QSQLITE",QString::number(id));
-
-                cn.setDatabaseName(db);
-                cn.setConnectOptions("QSQLITE_ENABLE_SHARED_CACHE");
-                if(cn.open())
-                {
-                    {
-                        QSqlQuery query(cn);
-                        query.exec(QString("SELECT Tile FROM TilesData WHERE id = (SELECT id FROM Tiles WHERE X=%1 AND Y=%2 AND Zoom=%3 AND Type=%4)").arg(pos.X()).arg(pos.Y()).arg(zoom).arg((int) type));
-                        query.next();
-                        if(query.isValid())
-                        {
-                            ar=query.value(0).toByteArray();
-                        }
-                    }
-                    cn.close();
-                }
-            }
+            cn->selectTile.addBindValue((int) type);
+            cn->selectTile.addBindValue(zoom);
+            cn->selectTile.addBindValue(pos.X());
+            cn->selectTile.addBindValue(pos.Y());
+            if(cn->selectTile.exec() && cn->selectTile.next())
+                ar=cn->selectTile.value(0).toByteArray();
+            // Release the read cursor, so it doesn't hold back WAL checkpoints
+            cn->selectTile.finish();
         }
-        QSqlDatabase::removeDatabase(QString::number(id));
         lock.unlock();
         return ar;
     }
     void PureImageCache::deleteOlderTiles(int const& days)
     {
-        if(gtilecache.isEmpty()|gtilecache.isNull())
+        lock.lockForRead();
+        if(gtilecache.isEmpty()|gtilecache.isNull() || !QFileInfo(gtilecache+"Data.qmdb").exists())
+        {
+            lock.unlock();
             return;
-        QList<long> add;
-        bool ret=true;
-        QString dir=gtilecache;
+        }
+        QList<qlonglong> add;
+        PureImageCacheConnection *cn=connection();
+        if(cn->isOpen())
         {
-            QString db=dir+"Data.qmdb";
-            ret=QFileInfo(db).exists();
-            if(ret)
             {
-                QSqlDatabase cn;
-                Mcounter.lock();
-                qlonglong id=++ConnCounter;
-                Mcounter.unlock();
-                cn = QSqlDatabase::addDatabase("QSQLITE",QString::number(id));
-                cn.setDatabaseName(db);
-                cn.setConnectOptions("QSQLITE_ENABLE_SHARED_CACHE");
-                if(cn.open())
+                QSqlQuery query(cn->db);
+                query.exec(QString("SELECT id, Date FROM Tiles"));
+                while(query.next())
                 {
-                    {
-                        QSqlQuery query(cn);
-                        query.exec(QString("SELECT id, X, Y, Zoom, Type, Date FROM Tiles"));
-                        while(query.next())
-                        {
-                            if(QDateTime::fromString(query.value(5).toString()).daysTo(QDateTime::currentDateTime())>days)
-                                add.append(query.value(0).toLongLong());
-                        }
-                        foreach(long i,add)
-                        {
-                            query.exec(QString("DELETE FROM Tiles WHERE id = %1;").arg(i));
-                        }
-                    }
-
-                    cn.close();
+                    if(QDateTime::fromString(query.value(1).toString()).daysTo(QDateTime::currentDateTime())>days)
+                        add.append(query.value(0).toLongLong());
+                }
+            }
+            cn->db.transaction();
+            {
+                QSqlQuery query(cn->db);
+                query.prepare("DELETE FROM Tiles WHERE id = ?");
+                foreach(qlonglong i,add)
+                {
+                    query.addBindValue(i);
+                    query.exec();
                 }
-                QSqlDatabase::removeDatabase(QString::number(id));
             }
+            cn->db.commit();
         }
+        lock.unlock();
     }
     // PureImageCache::ExportMapDataToDB("C:/Users/Xapo/Documents/mapcontrol/debug/mapscache/data.qmdb","C:/Users/Xapo/Documents/mapcontrol/debug/mapscache/data2.qmdb");
     bool PureImageCache::ExportMapDataToDB(QString sourceFile, QString destFile)
@@ -43,7 +43,32 @@
 #include <QList>
 #include <QMutex>
 #include <QReadWriteLock>
+#include <QThreadStorage>
+#include "cacheitemqueue.h"
 namespace core {
+    /**
+     * @brief A database connection owned by one thread, with its statements
+     * prepared once. QSqlDatabase connections can only be used from the thread
+     * which created them, so each thread gets its own, and QThreadStorage
+     * closes it when the thread exits.
+     */
+    class PureImageCacheConnection
+    {
+    public:
+        PureImageCacheConnection(const QString &name, const QString &file, int generation);
+        ~PureImageCacheConnection();
+        bool isOpen() const {return open;}
+
+        QString name;
+        int generation;
+        QSqlDatabase db;
+        QSqlQuery selectTile;
+        QSqlQuery insertTile;
+        QSqlQuery insertTileData;
+    private:
+        bool open;
+    };
+
     class PureImageCache
     {
 
@@ -51,16 +76,21 @@ namespace core {
         PureImageCache();
         static bool CreateEmptyDB(const QString &file);
         bool PutImageToCache(const QByteArray &tile,const MapType::Types &type,const core::Point &pos, const int &zoom);
+        bool PutImagesToCache(const QList<CacheItemQueue*> &tiles);
         QByteArray GetImageFromCache(MapType::Types type, core::Point pos, int zoom);
         QString GtileCache();
         void setGtileCache(const QString &value);
         static bool ExportMapDataToDB(QString sourceFile, QString destFile);
         void deleteOlderTiles(int const& days);
     private:
+        static bool UpgradeDB(const QString &file);
+        PureImageCacheConnection *connection();
         QString gtilecache;
         QMutex Mcounter;
         QReadWriteLock lock;
         static qlonglong ConnCounter;
+        QThreadStorage<PureImageCacheConnection*> connections;
+        int generation;
 
     };
 
@@ -29,6 +29,9 @@
 
 
 //#define DEBUG_TILECACHEQUEUE
+
+// Most tiles written in one database transaction
+#define TILECACHEQUEUE_MAX_BATCH 64
  
 namespace core {
 TileCacheQueue::TileCacheQueue()
@@ -80,21 +83,22 @@ void TileCacheQueue::run()
 #endif //DEBUG_TILECACHEQUEUE
     while(true)
     {
-        CacheItemQueue *task;
+        QList<CacheItemQueue*> tasks;
 #ifdef DEBUG_TILECACHEQUEUE
         qDebug()<<"Cache";
 #endif //DEBUG_TILECACHEQUEUE
         if(tileCacheQueue.count()>0)
         {
+            // Take what has queued up, so it is committed in one transaction
             mutex.lock();
-            task=tileCacheQueue.dequeue();
+            while(tileCacheQueue.count()>0 && tasks.count()<TILECACHEQUEUE_MAX_BATCH)
+                tasks.append(tileCacheQueue.dequeue());
             mutex.unlock();
 #ifdef DEBUG_TILECACHEQUEUE
-            qDebug()<<"Cache engine Put:"<<task->GetPosition().X()<<","<<task->GetPosition().Y();
+            qDebug()<<"Cache engine Put:"<<tasks.count()<<"tiles";
 #endif //DEBUG_TILECACHEQUEUE
-            Cache::Instance()->ImageCache.PutImageToCache(task->GetImg(),task->GetMapType(),task->GetPosition(),task->GetZoom());
-            usleep(44);
-            delete task;
+            Cache::Instance()->ImageCache.PutImagesToCache(tasks);
+            qDeleteAll(tasks);
         }
 
         else
@@ -33,9 +33,15 @@ qlonglong internals::Core::debugcounter=0;
 
 using namespace projections;
 
+// Extra columns or rows of tiles loaded ahead of the map's motion
+#define PREFETCH_AHEAD 3
+// Most prefetch tasks queued at a time, the closest ones are kept
+#define PREFETCH_MAX_TASKS 48
+
 namespace internals {
     Core::Core():started(false),MouseWheelZooming(false),currentPosition(0,0),currentPositionPixel(0,0),LastLocationInBounds(-1,-1),sizeOfMapArea(0,0)
             ,minOfTiles(0,0),maxOfTiles(0,0),zoom(0),isDragging(false),TooltipTextPadding(10,10),mapType(MapType::None),loaderLimit(5),maxzoom(21),runningThreads(0)
+            ,prefetchCenter(0,0),prefetchDirectionX(0),prefetchDirectionY(0)
     {
         mousewheelzoomtype=MouseWheelZoomType::MousePositionAndCenter;
         SetProjection(new MercatorProjection());
@@ -49,6 +55,10 @@ namespace internals {
     }
     Core::~Core()
     {
+        // Only wait for the tiles being loaded, not for everything still queued
+        MtileLoadQueue.lock();
+        tileLoadQueue.clear();
+        MtileLoadQueue.unlock();
         ProcessLoadTaskCallback.waitForDone();
     }
 
@@ -87,9 +97,12 @@ namespace internals {
         if(task.HasValue())
             if(loaderLimit.tryAcquire(1,TLMaps::Instance()->Timeout))
             {
-            MtileToload.lock();
-            --tilesToload;
-            MtileToload.unlock();
+            if(!task.Prefetch)
+            {
+                MtileToload.lock();
+                --tilesToload;
+                MtileToload.unlock();
+            }
 #ifdef DEBUG_CORE
             qDebug()<<"loadLimit semaphore aquired "<<loaderLimit.available()<<" ID="<<debug<<" TASK="<<task.Pos.ToString()<<" "<<task.Zoom;
 #endif //DEBUG_CORE
@@ -102,7 +115,11 @@ namespace internals {
                 {
                     Tile* m = Matrix.TileAt(task.Pos);
 
-                    if(m==0 || m->Overlays.count() == 0)
+                    if(task.Prefetch)
+                    {
+                        PrefetchTile(task);
+                    }
+                    else if(m==0 || m->Overlays.count() == 0)
                     {
 #ifdef DEBUG_CORE
                         qDebug()<<"Fill empty TileMatrix: " + task.ToString()<<" ID="<<debug;;
@@ -643,17 +660,17 @@ namespace internals {
     {
         if(started)
         {
-            ProcessLoadTaskCallback.waitForDone();
+            // Empty the queue first, so only the tiles being loaded are waited for
             MtileLoadQueue.lock();
             {
                 tileLoadQueue.clear();
                 //tilesToload=0;
             }
             MtileLoadQueue.unlock();
+            ProcessLoadTaskCallback.waitForDone();
             MtileToload.lock();
             tilesToload=0;
             MtileToload.unlock();
-            //  ProcessLoadTaskCallback.waitForDone();
         }
     }
     void Core::UpdateBounds()
@@ -675,7 +692,8 @@ namespace internals {
                 {
                     MtileLoadQueue.lock();
                     {
-                        if(!tileLoadQueue.contains(task))
+                        int queued=tileLoadQueue.indexOf(task);
+                        if(queued<0)
                         {
                             MtileToload.lock();
                             ++tilesToload;
@@ -686,11 +704,39 @@ namespace internals {
 #endif //DEBUG_CORE
                             ProcessLoadTaskCallback.start(this);
                         }
+                        else if(tileLoadQueue.at(queued).Prefetch)
+                        {
+                            // Queued as a prefetch, but on screen now, so it has to reach the matrix
+                            tileLoadQueue[queued].Prefetch=false;
+                            MtileToload.lock();
+                            ++tilesToload;
+                            MtileToload.unlock();
+                        }
                     }
                     MtileLoadQueue.unlock();
                 }
 
             }
+
+            // Prefetches go after the visible tiles, so they only use otherwise idle loaders
+            QList<LoadTask> prefetch;
+            FindTilesToPrefetch(prefetch);
+            MtileLoadQueue.lock();
+            // Prefetches queued for an earlier view are of no use any more
+            for(int i = tileLoadQueue.count()-1; i >= 0; i--)
+            {
+                if(tileLoadQueue.at(i).Prefetch && !prefetch.contains(tileLoadQueue.at(i)))
+                    tileLoadQueue.removeAt(i);
+            }
+            foreach(LoadTask task,prefetch)
+            {
+                if(!tileLoadQueue.contains(task))
+                {
+                    tileLoadQueue.enqueue(task);
+                    ProcessLoadTaskCallback.start(this);
+                }
+            }
+            MtileLoadQueue.unlock();
         }
         MtileDrawingList.unlock();
         UpdateGroundResolution();
@@ -727,6 +773,110 @@ namespace internals {
         }
 
 
+    }
+    /**
+     * @brief Core::FindTilesToPrefetch Lists tiles which are likely to be needed
+     * next, so that they are already in the memory cache when they come into
+     * view: one ring around the visible area, a few more columns or rows in the
+     * direction the map last moved, whether panned or following the UAV, and
+     * the same area at the next zoom level in and out.
+     */
+    void Core::FindTilesToPrefetch(QList<LoadTask> &list)
+    {
+        list.clear();
+
+        // The direction only changes when the center does, so it survives resizes and redraws
+        int dx=centerTileXYLocation.X()-prefetchCenter.X();
+        int dy=centerTileXYLocation.Y()-prefetchCenter.Y();
+        if(dx!=0 || dy!=0)
+        {
+            prefetchDirectionX=(dx>0)-(dx<0);
+            prefetchDirectionY=(dy>0)-(dy<0);
+            prefetchCenter=centerTileXYLocation;
+        }
+
+        int width=sizeOfMapArea.Width();
+        int height=sizeOfMapArea.Height();
+
+        // Ring around the visible area
+        for(int i = -width-1; i <= width+1; i++)
+        {
+            AppendPrefetchTile(list,Point(centerTileXYLocation.X()+i,centerTileXYLocation.Y()-height-1),Zoom());
+            AppendPrefetchTile(list,Point(centerTileXYLocation.X()+i,centerTileXYLocation.Y()+height+1),Zoom());
+        }
+        for(int j = -height; j <= height; j++)
+        {
+            AppendPrefetchTile(list,Point(centerTileXYLocation.X()-width-1,centerTileXYLocation.Y()+j),Zoom());
+            AppendPrefetchTile(list,Point(centerTileXYLocation.X()+width+1,centerTileXYLocation.Y()+j),Zoom());
+        }
+
+        // Further out ahead of the motion
+        for(int k = 2; k <= PREFETCH_AHEAD+1; k++)
+        {
+            if(prefetchDirectionX!=0)
+            {
+                for(int j = -height-1; j <= height+1; j++)
+                    AppendPrefetchTile(list,Point(centerTileXYLocation.X()+prefetchDirectionX*(width+k),centerTileXYLocation.Y()+j),Zoom());
+            }
+            if(prefetchDirectionY!=0)
+            {
+                for(int i = -width-1; i <= width+1; i++)
+                    AppendPrefetchTile(list,Point(centerTileXYLocation.X()+i,centerTileXYLocation.Y()+prefetchDirectionY*(height+k)),Zoom());
+            }
+        }
+
+        // Zooming out: the parents of the visible tiles
+        if(Zoom()>0)
+        {
+            for(int i = -width; i <= width; i+=2)
+                for(int j = -height; j <= height; j+=2)
+                    AppendPrefetchTile(list,Point((centerTileXYLocation.X()+i)/2,(centerTileXYLocation.Y()+j)/2),Zoom()-1);
+        }
+
+        // Zooming in on the center: the children of the central half of the view
+        if(Zoom()<MaxZoom())
+        {
+            for(int i = -width/2; i <= width/2; i++)
+            {
+                for(int j = -height/2; j <= height/2; j++)
+                {
+                    Point parent(centerTileXYLocation.X()+i,centerTileXYLocation.Y()+j);
+                    for(int c = 0; c < 4; c++)
+                        AppendPrefetchTile(list,Point(parent.X()*2+(c&1),parent.Y()*2+(c>>1)),Zoom()+1);
+                }
+            }
+        }
+
+        // The list is ordered by how soon the tiles are likely to be needed
+        while(list.count() > PREFETCH_MAX_TASKS)
+            list.removeLast();
+    }
+    void Core::AppendPrefetchTile(QList<LoadTask> &list, Point const& p, int zoom)
+    {
+        Size min=Projection()->GetTileMatrixMinXY(zoom);
+        Size max=Projection()->GetTileMatrixMaxXY(zoom);
+        if(p.X() >= min.Width() && p.Y() >= min.Height() && p.X() <= max.Width() && p.Y() <= max.Height())
+        {
+            LoadTask task(p,zoom,true);
+            if(!list.contains(task))
+                list.append(task);
+        }
+    }
+    /**
+     * @brief Core::PrefetchTile Loads a tile's layers into the memory cache,
+     * without putting it in the tile matrix
+     */
+    void Core::PrefetchTile(LoadTask const& task)
+    {
+        QVector<MapType::Types> layers= TLMaps::Instance()->GetAllLayersOfType(GetMapType());
+        foreach(MapType::Types tl,layers)
+        {
+            // tile number inversion(BottomLeft -> TopLeft) for pergo maps
+            if(tl == MapType::PergoTurkeyMap)
+                TLMaps::Instance()->GetImageFromServer(tl, Point(task.Pos.X(), Projection()->GetTileMatrixMaxXY(task.Zoom).Height() - task.Pos.Y()), task.Zoom);
+            else if(tl != MapType::UserImage)
+                TLMaps::Instance()->GetImageFromServer(tl, task.Pos, task.Zoom);
+        }
     }
     void Core::UpdateGroundResolution()
     {
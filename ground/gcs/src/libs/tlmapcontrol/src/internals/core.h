@@ -189,6 +189,8 @@ namespace internals {
 
         void FindTilesAround(QList<core::Point> &list);
 
+        void FindTilesToPrefetch(QList<LoadTask> &list);
+
         void UpdateGroundResolution();
 
         TileMatrix Matrix;
@@ -244,6 +246,12 @@ namespace internals {
 
         QQueue<LoadTask> tileLoadQueue;
 
+        void PrefetchTile(LoadTask const& task);
+        void AppendPrefetchTile(QList<LoadTask> &list, core::Point const& p, int zoom);
+        core::Point prefetchCenter;
+        int prefetchDirectionX;
+        int prefetchDirectionY;
+
         int zoom;
 
         PureProjection* projection;
@@ -40,17 +40,20 @@ struct LoadTask
   public:
     core::Point Pos; //Tile position in quadtile format
     int Zoom;        //Number of zoom levels, in quadtile format
+    bool Prefetch;   //Only load the tile into the memory cache, it is not on screen
 
 
-    LoadTask(Point pos, int zoom)
+    LoadTask(Point pos, int zoom, bool prefetch=false)
      {
         Pos = pos;
         Zoom = zoom;
+        Prefetch = prefetch;
     }
     LoadTask()
     {
         Pos=core::Point(-1,-1);
         Zoom=-1;
+        Prefetch=false;
     }
     bool HasValue()
     {
@@ -45,6 +45,7 @@ void Tile::Clear()
         img.~QByteArray();
     }
     Overlays.clear();
+    Pixmaps.clear();
     mutex.unlock();
 }
 Tile::Tile():zoom(0),pos(0,0)
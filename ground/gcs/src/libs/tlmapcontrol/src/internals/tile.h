@@ -30,6 +30,7 @@
 
 #include "QList"
 #include <QImage>
+#include <QPixmap>
 #include "../core/point.h"
 #include <QMutex>
 #include <QDebug>
@@ -55,6 +56,8 @@ public:
     }
     bool HasValue(){return !(zoom==0);}
     QList<QByteArray> Overlays;
+    // Overlays decoded by the painter the first time the tile is drawn, GUI thread only
+    QList<QPixmap> Pixmaps;
 protected:
 
     QMutex mutex;
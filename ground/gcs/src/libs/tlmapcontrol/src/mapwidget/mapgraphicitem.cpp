@@ -366,14 +366,21 @@ namespace mapcontrol
                             //lock(t.Overlays)
                             if(t!=0)
                             {
-                                foreach(QByteArray img,t->Overlays)
+                                // Decode once, rather than on every repaint
+                                if(t->Pixmaps.count()!=t->Overlays.count())
                                 {
-                                    if(img.count()!=0)
+                                    t->Pixmaps.clear();
+                                    foreach(QByteArray img,t->Overlays)
+                                        t->Pixmaps.append(img.count()!=0 ? PureImageProxy::FromStream(img) : QPixmap());
+                                }
+                                foreach(const QPixmap &pixmap,t->Pixmaps)
+                                {
+                                    if(!pixmap.isNull())
                                     {
                                         if(!found)
                                             found = true;
                                         {
-                                            painter->drawPixmap(core->tileRect.X(),core->tileRect.Y(), core->tileRect.Width(), core->tileRect.Height(),PureImageProxy::FromStream(img));
+                                            painter->drawPixmap(core->tileRect.X(),core->tileRect.Y(), core->tileRect.Width(), core->tileRect.Height(),pixmap);
                                         }
                                     }
                                 }
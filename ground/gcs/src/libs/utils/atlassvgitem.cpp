@@ -0,0 +1,62 @@
+/**
+ ******************************************************************************
+ *
+ * @file       atlassvgitem.cpp
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2013
+ * @{
+ * @brief SVG item drawn from an element atlas
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+
+#include "atlassvgitem.h"
+#include "svgelementatlas.h"
+
+#include <QPainter>
+#include <QSvgRenderer>
+#include <qmath.h>
+
+AtlasSvgItem::AtlasSvgItem(QGraphicsItem * parent) :
+    QGraphicsSvgItem(parent)
+{
+    // The atlas is the cache
+    setCacheMode(NoCache);
+}
+
+void AtlasSvgItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
+{
+    QSvgRenderer *svg = renderer();
+    if (!svg || !svg->isValid())
+        return;
+
+    // Device pixels per item unit, which does not depend on the rotation
+    const QTransform &t = painter->worldTransform();
+    qreal scale = qMax(qSqrt(t.m11() * t.m11() + t.m12() * t.m12()),
+                       qSqrt(t.m21() * t.m21() + t.m22() * t.m22()));
+
+    const QImage *image;
+    QRectF source;
+    if (!SvgElementAtlas::forRenderer(svg)->lookup(elementId(), scale, &image, &source)) {
+        QGraphicsSvgItem::paint(painter, option, widget);
+        return;
+    }
+
+    painter->save();
+    painter->setRenderHint(QPainter::SmoothPixmapTransform);
+    painter->drawImage(boundingRect(), *image, source);
+    painter->restore();
+}
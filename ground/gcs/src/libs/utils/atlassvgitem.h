@@ -1,10 +1,10 @@
 /**
  ******************************************************************************
  *
- * @file       cachedsvgitem.h
- * @author     Dmytro Poplavskiy Copyright (C) 2011.
+ * @file       atlassvgitem.h
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2013
  * @{
- * @brief OpenGL texture cached SVG item
+ * @brief SVG item drawn from an element atlas
  *****************************************************************************/
 /*
  * This program is free software; you can redistribute it and/or modify
@@ -22,33 +22,26 @@
  * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
  */
 
-#ifndef CACHEDSVGITEM_H
-#define CACHEDSVGITEM_H
+
+#ifndef ATLASSVGITEM_H
+#define ATLASSVGITEM_H
 
 #include <QGraphicsSvgItem>
-#include <QGLContext>
 
 #include "utils_global.h"
 
-class QGLContext;
-
-//Cache Svg item as GL Texture.
-//Texture is regenerated each time item is scaled
-//but it's reused during rotation, unlike DeviceCoordinateCache mode
-class QTCREATOR_UTILS_EXPORT CachedSvgItem: public QGraphicsSvgItem
+/**
+ * Drop in replacement for QGraphicsSvgItem which draws its element from the
+ * SvgElementAtlas of its renderer. Moving, rotating or repainting the item
+ * does not rasterize the SVG again, only a change of the displayed size does.
+ */
+class QTCREATOR_UTILS_EXPORT AtlasSvgItem: public QGraphicsSvgItem
 {
     Q_OBJECT
 public:
-    CachedSvgItem(QGraphicsItem * parent = 0);
-    CachedSvgItem(const QString & fileName, QGraphicsItem * parent = 0);
-    ~CachedSvgItem();
+    AtlasSvgItem(QGraphicsItem * parent = 0);
 
     void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget);
-
-private:
-    QGLContext *m_context;
-    GLuint m_texture;
-    qreal m_scale;
 };
 
-#endif
+#endif // ATLASSVGITEM_H
@@ -0,0 +1,252 @@
+/**
+ ******************************************************************************
+ *
+ * @file       svgelementatlas.cpp
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2013
+ * @{
+ * @brief Rasterized SVG elements packed into shared images
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+
+#include "svgelementatlas.h"
+
+#include <QPainter>
+#include <QSvgRenderer>
+#include <qmath.h>
+
+//! Transparent border around each element so linear filtering does not
+//! bleed the neighbours in
+static const int PADDING = 1;
+
+//! Relative scale change below which the cached raster is still used
+static const qreal SCALE_TOLERANCE = 0.002;
+
+//! Scales within SCALE_TOLERANCE of each other share a raster
+static int scaleBucket(qreal scale)
+{
+    return qRound(qLn(scale) / SCALE_TOLERANCE);
+}
+
+static int nextPowerOfTwo(int size)
+{
+    int power = SvgElementAtlas::MIN_PAGE_SIZE;
+    while (power < size)
+        power *= 2;
+    return power;
+}
+
+QHash<QSvgRenderer *, SvgElementAtlas *> SvgElementAtlas::m_atlases;
+
+/**
+ * Get the atlas of a renderer, creating it on first use. The atlas is owned
+ * by the renderer and deleted with it.
+ */
+SvgElementAtlas *SvgElementAtlas::forRenderer(QSvgRenderer *renderer)
+{
+    SvgElementAtlas *atlas = m_atlases.value(renderer);
+    if (!atlas) {
+        atlas = new SvgElementAtlas(renderer);
+        m_atlases.insert(renderer, atlas);
+    }
+    return atlas;
+}
+
+SvgElementAtlas::SvgElementAtlas(QSvgRenderer *renderer) :
+    QObject(renderer),
+    m_renderer(renderer),
+    m_shelfX(0),
+    m_shelfY(0),
+    m_shelfHeight(0),
+    m_rasterizations(0)
+{
+    connect(renderer, SIGNAL(repaintNeeded()), this, SLOT(rendererChanged()));
+}
+
+SvgElementAtlas::~SvgElementAtlas()
+{
+    m_atlases.remove(m_renderer);
+}
+
+/**
+ * Get an element rasterized at a scale, rendering it if needed.
+ * @param elementId id of the element, empty for the whole document
+ * @param scale device pixels per document unit
+ * @param image set to the image holding the element
+ * @param source set to the area of the element in that image
+ * @return false if the element can not be drawn from the atlas
+ */
+bool SvgElementAtlas::lookup(const QString &elementId, qreal scale, const QImage **image, QRectF *source)
+{
+    if (!m_renderer->isValid() || scale <= 0)
+        return false;
+
+    QRectF bounds = elementBounds(elementId);
+    if (bounds.isEmpty())
+        return false;
+
+    // Huge zooms would take more than a page for a single element, they are
+    // rendered directly instead
+    qreal maxScale = (MAX_PAGE_SIZE - 2 * PADDING) / qMax(bounds.width(), bounds.height());
+    if (scale > maxScale)
+        return false;
+
+    // Items showing the same element at different sizes each get a raster
+    SlotKey key(elementId, scaleBucket(scale));
+    QHash<SlotKey, Slot>::const_iterator it = m_slots.constFind(key);
+    if (it == m_slots.constEnd()) {
+        QSize size(qCeil(bounds.width() * scale) + 2 * PADDING,
+                   qCeil(bounds.height() * scale) + 2 * PADDING);
+
+        Slot slot;
+        if (!allocate(size, &slot)) {
+            // Out of room, most of it is probably rasters at old scales
+            clear();
+            if (!allocate(size, &slot))
+                return false;
+        }
+        slot.scale = scale;
+
+        rasterize(elementId, bounds, slot);
+        it = m_slots.insert(key, slot);
+    }
+
+    const Slot &slot = it.value();
+    *image = &m_pages.at(slot.page);
+    *source = QRectF(slot.rect.x() + PADDING, slot.rect.y() + PADDING,
+                     bounds.width() * slot.scale, bounds.height() * slot.scale);
+
+    return true;
+}
+
+/**
+ * Drop all the rasters, they are rendered again when next used
+ */
+void SvgElementAtlas::clear()
+{
+    m_pages.clear();
+    m_slots.clear();
+    m_shelfX = 0;
+    m_shelfY = 0;
+    m_shelfHeight = 0;
+}
+
+void SvgElementAtlas::rendererChanged()
+{
+    clear();
+}
+
+QRectF SvgElementAtlas::elementBounds(const QString &elementId) const
+{
+    // Same geometry as QGraphicsSvgItem
+    if (elementId.isEmpty())
+        return QRectF(QPointF(0, 0), m_renderer->defaultSize());
+
+    return QRectF(QPointF(0, 0), m_renderer->boundsOnElement(elementId).size());
+}
+
+/**
+ * Find room for an element, filling the last page shelf by shelf and adding
+ * pages as needed up to MAX_PAGES. Shelves are laid out on a MAX_PAGE_SIZE
+ * square, the image only covers the part in use.
+ */
+bool SvgElementAtlas::allocate(const QSize &size, Slot *slot)
+{
+    if (size.width() > MAX_PAGE_SIZE || size.height() > MAX_PAGE_SIZE)
+        return false;
+
+    if (!m_pages.isEmpty()) {
+        // Next shelf if it does not fit on this one
+        if (m_shelfX + size.width() > MAX_PAGE_SIZE) {
+            m_shelfX = 0;
+            m_shelfY += m_shelfHeight;
+            m_shelfHeight = 0;
+        }
+        if (m_shelfY + size.height() <= MAX_PAGE_SIZE) {
+            slot->page = m_pages.count() - 1;
+            slot->rect = QRect(QPoint(m_shelfX, m_shelfY), size);
+            m_shelfX += size.width();
+            m_shelfHeight = qMax(m_shelfHeight, size.height());
+            grow(slot->page, slot->rect);
+            return true;
+        }
+    }
+
+    if (m_pages.count() >= MAX_PAGES)
+        return false;
+
+    m_pages.append(QImage());
+
+    slot->page = m_pages.count() - 1;
+    slot->rect = QRect(QPoint(0, 0), size);
+    m_shelfX = size.width();
+    m_shelfY = 0;
+    m_shelfHeight = size.height();
+    grow(slot->page, slot->rect);
+
+    return true;
+}
+
+/**
+ * Enlarge a page to the next power of two sizes holding a slot, keeping
+ * what is already rendered on it
+ */
+void SvgElementAtlas::grow(int page, const QRect &rect)
+{
+    QImage &image = m_pages[page];
+    if (image.rect().contains(rect))
+        return;
+
+    QImage grown(nextPowerOfTwo(qMax(image.width(), rect.right() + 1)),
+                 nextPowerOfTwo(qMax(image.height(), rect.bottom() + 1)),
+                 QImage::Format_ARGB32_Premultiplied);
+    grown.fill(Qt::transparent);
+
+    if (!image.isNull()) {
+        QPainter p(&grown);
+        p.setCompositionMode(QPainter::CompositionMode_Source);
+        p.drawImage(0, 0, image);
+    }
+
+    image = grown;
+}
+
+void SvgElementAtlas::rasterize(const QString &elementId, const QRectF &bounds, const Slot &slot)
+{
+    QImage &page = m_pages[slot.page];
+
+    QPainter p(&page);
+    p.setRenderHints(QPainter::Antialiasing | QPainter::TextAntialiasing | QPainter::SmoothPixmapTransform);
+
+    // Slots are never reused without a clear, but make sure of it
+    p.setCompositionMode(QPainter::CompositionMode_Source);
+    p.fillRect(slot.rect, Qt::transparent);
+    p.setCompositionMode(QPainter::CompositionMode_SourceOver);
+
+    p.setClipRect(slot.rect);
+    p.translate(slot.rect.x() + PADDING, slot.rect.y() + PADDING);
+    p.scale(slot.scale, slot.scale);
+
+    if (elementId.isEmpty())
+        m_renderer->render(&p, bounds);
+    else
+        m_renderer->render(&p, elementId, bounds);
+
+    p.end();
+
+    m_rasterizations++;
+}
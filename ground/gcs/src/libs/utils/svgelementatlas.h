@@ -0,0 +1,109 @@
+/**
+ ******************************************************************************
+ *
+ * @file       svgelementatlas.h
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2013
+ * @{
+ * @brief Rasterized SVG elements packed into shared images
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+
+#ifndef SVGELEMENTATLAS_H
+#define SVGELEMENTATLAS_H
+
+#include <QObject>
+#include <QHash>
+#include <QImage>
+#include <QList>
+#include <QPair>
+#include <QRect>
+#include <QString>
+
+#include "utils_global.h"
+
+class QSvgRenderer;
+
+/**
+ * Cache of the elements of an SVG document rasterized at the size they are
+ * displayed at.
+ *
+ * Each element is rendered once per display scale and packed with the others
+ * into a few shared images, so drawing it rotated or translated is a textured
+ * quad (the GL paint engine keeps the images as textures) instead of a new
+ * SVG rasterization. An element is only rendered again when it is displayed
+ * at a new scale, e.g. when the gadget is resized. The images grow with what
+ * they hold, and elements too large for one are not cached at all.
+ *
+ * There is one atlas per renderer, shared by all the items using it, which is
+ * cleared whenever the renderer loads a new document.
+ */
+class QTCREATOR_UTILS_EXPORT SvgElementAtlas : public QObject
+{
+    Q_OBJECT
+public:
+    static SvgElementAtlas *forRenderer(QSvgRenderer *renderer);
+    ~SvgElementAtlas();
+
+    bool lookup(const QString &elementId, qreal scale, const QImage **image, QRectF *source);
+    void clear();
+
+    int rasterizations() const { return m_rasterizations; }
+    int pageCount() const { return m_pages.count(); }
+
+    //! Largest size the images the elements are packed into grow to
+    static const int MAX_PAGE_SIZE = 2048;
+    //! Size the images start at
+    static const int MIN_PAGE_SIZE = 256;
+    //! Pages kept before the whole atlas is dropped and refilled
+    static const int MAX_PAGES = 4;
+
+private slots:
+    void rendererChanged();
+
+private:
+    explicit SvgElementAtlas(QSvgRenderer *renderer);
+
+    struct Slot {
+        int page;
+        QRect rect;
+        qreal scale;
+    };
+
+    // Element id and scale bucket
+    typedef QPair<QString, int> SlotKey;
+
+    QRectF elementBounds(const QString &elementId) const;
+    bool allocate(const QSize &size, Slot *slot);
+    void grow(int page, const QRect &rect);
+    void rasterize(const QString &elementId, const QRectF &bounds, const Slot &slot);
+
+    QSvgRenderer *m_renderer;
+    QList<QImage> m_pages;
+    QHash<SlotKey, Slot> m_slots;
+
+    // Shelf packing state of the last page
+    int m_shelfX;
+    int m_shelfY;
+    int m_shelfHeight;
+
+    int m_rasterizations;
+
+    static QHash<QSvgRenderer *, SvgElementAtlas *> m_atlases;
+};
+
+#endif // SVGELEMENTATLAS_H
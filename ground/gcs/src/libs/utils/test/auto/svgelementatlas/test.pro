@@ -0,0 +1,12 @@
+CONFIG += qtestlib
+TEMPLATE = app
+CONFIG -= app_bundle
+QT += svg
+
+include(../../../../../../gcs.pri)
+include(../../../utils.pri)
+
+# The instruments the benchmark draws
+DEFINES += GCS_SHARE_DIR=\\\"$$GCS_SOURCE_TREE/share/taulabs\\\"
+
+SOURCES += tst_svgelementatlas.cpp
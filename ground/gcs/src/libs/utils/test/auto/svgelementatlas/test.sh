@@ -0,0 +1,4 @@
+# -- run the atlas test from this directory, no display is needed
+
+export LD_LIBRARY_PATH=../../../../../../lib/taulabs:$LD_LIBRARY_PATH
+exec ./test "$@"
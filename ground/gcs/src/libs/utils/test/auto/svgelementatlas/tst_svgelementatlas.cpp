@@ -0,0 +1,285 @@
+/**
+ ******************************************************************************
+ *
+ * @file       tst_svgelementatlas.cpp
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2013
+ * @{
+ * @brief Tests and frame time benchmark of the SVG element atlas
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include <utils/svgelementatlas.h>
+#include <utils/atlassvgitem.h>
+
+#include <QtTest/QtTest>
+#include <QApplication>
+#include <QGraphicsScene>
+#include <QGraphicsSvgItem>
+#include <QPainter>
+#include <QSvgRenderer>
+
+static const char TEST_SVG[] =
+    "<svg xmlns='http://www.w3.org/2000/svg' width='200' height='200'>"
+    "<circle id='dial' cx='100' cy='100' r='90' fill='#203040' stroke='white' stroke-width='4'/>"
+    "<rect id='needle' x='96' y='20' width='8' height='80' fill='orange'/>"
+    "</svg>";
+
+static const char OTHER_SVG[] =
+    "<svg xmlns='http://www.w3.org/2000/svg' width='100' height='100'>"
+    "<rect id='dial' x='0' y='0' width='100' height='100' fill='red'/>"
+    "</svg>";
+
+class tst_SvgElementAtlas : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void matchesDirectRendering();
+    void noRasterizationWhenMoving();
+    void rasterizesAgainWhenResized();
+    void sameElementAtTwoScales();
+    void pagesSizedToContents();
+    void hugeZoomNotCached();
+    void clearedOnLoad();
+    void frameTime_data();
+    void frameTime();
+
+private:
+    static QGraphicsSvgItem *newItem(bool atlas);
+    static QImage render(QGraphicsScene *scene, const QSize &size);
+};
+
+QGraphicsSvgItem *tst_SvgElementAtlas::newItem(bool atlas)
+{
+    if (atlas)
+        return new AtlasSvgItem();
+    return new QGraphicsSvgItem();
+}
+
+QImage tst_SvgElementAtlas::render(QGraphicsScene *scene, const QSize &size)
+{
+    QImage image(size, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
+    QPainter p(&image);
+    p.setRenderHints(QPainter::Antialiasing | QPainter::SmoothPixmapTransform);
+    scene->render(&p, QRectF(QPointF(0, 0), size), scene->sceneRect());
+    p.end();
+    return image;
+}
+
+void tst_SvgElementAtlas::matchesDirectRendering()
+{
+    QSvgRenderer renderer(QByteArray(TEST_SVG));
+    QVERIFY(renderer.isValid());
+
+    QImage images[2];
+    for (int i = 0; i < 2; i++) {
+        QGraphicsScene scene(0, 0, 200, 200);
+        QGraphicsSvgItem *item = newItem(i == 1);
+        item->setSharedRenderer(&renderer);
+        item->setElementId("dial");
+        item->setPos(10, 10);
+        scene.addItem(item);
+        images[i] = render(&scene, QSize(400, 400));
+    }
+
+    // Resampling the raster may differ by a few levels on the edges
+    qint64 diff = 0;
+    for (int y = 0; y < 400; y++) {
+        const QRgb *a = reinterpret_cast<const QRgb *>(images[0].constScanLine(y));
+        const QRgb *b = reinterpret_cast<const QRgb *>(images[1].constScanLine(y));
+        for (int x = 0; x < 400; x++)
+            diff += qAbs(qRed(a[x]) - qRed(b[x])) + qAbs(qGreen(a[x]) - qGreen(b[x])) +
+                    qAbs(qBlue(a[x]) - qBlue(b[x])) + qAbs(qAlpha(a[x]) - qAlpha(b[x]));
+    }
+    double mean = double(diff) / (400 * 400 * 4);
+    QVERIFY2(mean < 2.0, qPrintable(QString("mean difference %1").arg(mean)));
+}
+
+void tst_SvgElementAtlas::noRasterizationWhenMoving()
+{
+    QSvgRenderer renderer(QByteArray(TEST_SVG));
+    SvgElementAtlas *atlas = SvgElementAtlas::forRenderer(&renderer);
+
+    QGraphicsScene scene(0, 0, 200, 200);
+    AtlasSvgItem *needle = new AtlasSvgItem();
+    needle->setSharedRenderer(&renderer);
+    needle->setElementId("needle");
+    needle->setTransformOriginPoint(4, 80);
+    scene.addItem(needle);
+
+    render(&scene, QSize(200, 200));
+    QCOMPARE(atlas->rasterizations(), 1);
+
+    for (int angle = 0; angle < 360; angle += 7) {
+        needle->setRotation(angle);
+        needle->setPos(angle / 10.0, 0);
+        render(&scene, QSize(200, 200));
+    }
+    QCOMPARE(atlas->rasterizations(), 1);
+}
+
+void tst_SvgElementAtlas::rasterizesAgainWhenResized()
+{
+    QSvgRenderer renderer(QByteArray(TEST_SVG));
+    SvgElementAtlas *atlas = SvgElementAtlas::forRenderer(&renderer);
+
+    QGraphicsScene scene(0, 0, 200, 200);
+    AtlasSvgItem *dial = new AtlasSvgItem();
+    dial->setSharedRenderer(&renderer);
+    dial->setElementId("dial");
+    scene.addItem(dial);
+
+    render(&scene, QSize(200, 200));
+    render(&scene, QSize(200, 200));
+    QCOMPARE(atlas->rasterizations(), 1);
+
+    render(&scene, QSize(300, 300));
+    QCOMPARE(atlas->rasterizations(), 2);
+}
+
+void tst_SvgElementAtlas::sameElementAtTwoScales()
+{
+    QSvgRenderer renderer(QByteArray(TEST_SVG));
+    SvgElementAtlas *atlas = SvgElementAtlas::forRenderer(&renderer);
+
+    QGraphicsScene scene(0, 0, 400, 200);
+    AtlasSvgItem *small = new AtlasSvgItem();
+    small->setSharedRenderer(&renderer);
+    small->setElementId("dial");
+    scene.addItem(small);
+    AtlasSvgItem *large = new AtlasSvgItem();
+    large->setSharedRenderer(&renderer);
+    large->setElementId("dial");
+    large->setPos(200, 0);
+    large->setScale(2);
+    scene.addItem(large);
+
+    for (int i = 0; i < 3; i++)
+        render(&scene, QSize(400, 200));
+    QCOMPARE(atlas->rasterizations(), 2);
+}
+
+void tst_SvgElementAtlas::pagesSizedToContents()
+{
+    QSvgRenderer renderer(QByteArray(TEST_SVG));
+    SvgElementAtlas *atlas = SvgElementAtlas::forRenderer(&renderer);
+
+    const QImage *image;
+    QRectF source;
+    QVERIFY(atlas->lookup("needle", 1.0, &image, &source));
+    QCOMPARE(image->size(), QSize(SvgElementAtlas::MIN_PAGE_SIZE, SvgElementAtlas::MIN_PAGE_SIZE));
+
+    // A page grows to hold more, and keeps what it held
+    QVERIFY(atlas->lookup("dial", 2.0, &image, &source));
+    QCOMPARE(atlas->pageCount(), 1);
+    QVERIFY(image->width() <= 512 && image->height() <= 512);
+    QVERIFY(qAlpha(image->pixel(1 + 4, 1 + 40)) > 0);
+}
+
+void tst_SvgElementAtlas::hugeZoomNotCached()
+{
+    QSvgRenderer renderer(QByteArray(TEST_SVG));
+    SvgElementAtlas *atlas = SvgElementAtlas::forRenderer(&renderer);
+
+    const QImage *image;
+    QRectF source;
+    QVERIFY(!atlas->lookup("dial", 50.0, &image, &source));
+    QCOMPARE(atlas->pageCount(), 0);
+}
+
+void tst_SvgElementAtlas::clearedOnLoad()
+{
+    QSvgRenderer renderer(QByteArray(TEST_SVG));
+    SvgElementAtlas *atlas = SvgElementAtlas::forRenderer(&renderer);
+
+    const QImage *image;
+    QRectF source;
+    QVERIFY(atlas->lookup("dial", 1.0, &image, &source));
+    QCOMPARE(atlas->pageCount(), 1);
+
+    renderer.load(QByteArray(OTHER_SVG));
+    QCOMPARE(atlas->pageCount(), 0);
+
+    QVERIFY(atlas->lookup("dial", 1.0, &image, &source));
+    QCOMPARE(source.size(), QSizeF(100, 100));
+}
+
+void tst_SvgElementAtlas::frameTime_data()
+{
+    QTest::addColumn<bool>("atlas");
+
+    QTest::newRow("QGraphicsSvgItem") << false;
+    QTest::newRow("AtlasSvgItem") << true;
+}
+
+/**
+ * Frame time of an animated PFD: the sky rotates and moves on every frame
+ * like during a flight
+ */
+void tst_SvgElementAtlas::frameTime()
+{
+    QFETCH(bool, atlas);
+
+    QSvgRenderer renderer(QString(GCS_SHARE_DIR "/pfd/default/pfd.svg"));
+    if (!renderer.isValid())
+        QSKIP("PFD artwork not found", SkipAll);
+
+    QGraphicsScene scene;
+    QGraphicsSvgItem *world = 0;
+
+    const char *elements[] = { "background", "world", "rollscale", "foreground", "compass" };
+    for (unsigned i = 0; i < sizeof(elements) / sizeof(elements[0]); i++) {
+        if (!renderer.elementExists(elements[i]))
+            continue;
+        QGraphicsSvgItem *item = newItem(atlas);
+        item->setSharedRenderer(&renderer);
+        item->setElementId(elements[i]);
+        QRectF bounds = renderer.matrixForElement(elements[i]).mapRect(renderer.boundsOnElement(elements[i]));
+        item->setPos(bounds.topLeft());
+        item->setZValue(i);
+        scene.addItem(item);
+        if (i == 1)
+            world = item;
+    }
+    QVERIFY(world);
+    world->setTransformOriginPoint(world->boundingRect().center());
+    scene.setSceneRect(QRectF(QPointF(0, 0), renderer.defaultSize()));
+
+    QImage image(600, 600, QImage::Format_ARGB32_Premultiplied);
+    int frame = 0;
+
+    QBENCHMARK {
+        world->setRotation((frame % 90) - 45);
+        world->setPos(world->pos().x(), world->pos().y() + ((frame % 20) < 10 ? 1 : -1));
+        frame++;
+
+        QPainter p(&image);
+        p.setRenderHints(QPainter::Antialiasing | QPainter::SmoothPixmapTransform);
+        scene.render(&p, image.rect(), scene.sceneRect());
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    // Everything is drawn into images, no display is needed
+    QApplication app(argc, argv, false);
+    tst_SvgElementAtlas tc;
+    return QTest::qExec(&tc, argc, argv);
+}
+
+#include "tst_svgelementatlas.moc"
@@ -52,7 +52,8 @@ SOURCES += reloadpromptutils.cpp \
     mytabbedstackwidget.cpp \
     mytabwidget.cpp \
     mylistwidget.cpp \
-    cachedsvgitem.cpp \
+    svgelementatlas.cpp \
+    atlassvgitem.cpp \
     svgimageprovider.cpp
 
 SOURCES += xmlconfig.cpp
@@ -109,7 +110,8 @@ HEADERS += utils_global.h \
     mytabbedstackwidget.h \
     mytabwidget.h \
     mylistwidget.h \
-    cachedsvgitem.h \
+    svgelementatlas.h \
+    atlassvgitem.h \
     svgimageprovider.h
 
 
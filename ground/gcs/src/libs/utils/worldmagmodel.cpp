@@ -61,6 +61,9 @@ namespace Utils {
     WorldMagModel::WorldMagModel()
     {
         Initialize();
+
+        wmm_tile_init(&tile, 1.0f, 500.0f);
+        tileDate[0] = tileDate[1] = tileDate[2] = 0;
     }
 
     int WorldMagModel::GetMagVector(double LLA[3], int Month, int Day, int Year, double Be[3])
@@ -110,6 +113,52 @@ namespace Utils {
         return 0;   // OK
     }
 
+    /**
+     * Same as GetMagVector but interpolated over a cached one degree tile, for
+     * following a vehicle without evaluating the full model on every update.
+     * Uses the same tile code as the flight side.
+     */
+    int WorldMagModel::GetMagVectorTracked(double LLA[3], int Month, int Day, int Year, double Be[3])
+    {
+        if (LLA[0] < -90 || LLA[0] > 90 || LLA[1] < -180 || LLA[1] > 180)
+            return -1;  // error
+
+        if (tileDate[0] != Year || tileDate[1] != Month || tileDate[2] != Day) {
+            tileDate[0] = Year;
+            tileDate[1] = Month;
+            tileDate[2] = Day;
+            wmm_tile_invalidate(&tile);
+        }
+
+        float B[3];
+        if (wmm_tile_get(&tile, &WorldMagModel::TileEval, this, LLA[0], LLA[1], LLA[2], B) < 0)
+            return -6;  // error
+
+        Be[0] = B[0];
+        Be[1] = B[1];
+        Be[2] = B[2];
+
+        return 0;   // OK
+    }
+
+    int WorldMagModel::TileEval(void *ctx, float lat, float lon, float alt, float B[3])
+    {
+        WorldMagModel *self = static_cast<WorldMagModel *>(ctx);
+
+        double LLA[3] = { lat, lon, alt };
+        double Be[3];
+
+        int ret = self->GetMagVector(LLA, self->tileDate[1], self->tileDate[2], self->tileDate[0], Be);
+        if (ret < 0)
+            return ret;
+
+        B[0] = Be[0];
+        B[1] = Be[1];
+        B[2] = Be[2];
+
+        return 0;
+    }
+
     void WorldMagModel::Initialize()
     {   //      Sets default values for WMM subroutines.
         //      UPDATES : Ellip and MagneticModel
@@ -30,6 +30,7 @@
 #define WORLDMAGMODEL_H
 
 #include "utils_global.h"
+#include "wmm_tile.h"
 
 // ******************************
 // internal structure definitions
@@ -136,6 +137,7 @@ namespace Utils {
             WorldMagModel();
 
             int GetMagVector(double LLA[3], int Month, int Day, int Year, double Be[3]);
+            int GetMagVectorTracked(double LLA[3], int Month, int Day, int Year, double Be[3]);
 
         private:
             WMMtype_Ellipsoid       Ellip;
@@ -143,6 +145,11 @@ namespace Utils {
 
             double                  decimal_date;
 
+            struct wmm_tile         tile;
+            int                     tileDate[3];
+
+            static int TileEval(void *ctx, float lat, float lon, float alt, float B[3]);
+
             void Initialize();
             int Geomag(WMMtype_CoordSpherical *CoordSpherical, WMMtype_CoordGeodetic *CoordGeodetic, WMMtype_GeoMagneticElements *GeoMagneticElements);
             void ComputeSphericalHarmonicVariables(WMMtype_CoordSpherical *CoordSpherical, int nMax, WMMtype_SphericalHarmonicVariables *SphVariables);
@@ -0,0 +1,91 @@
+/**
+ ******************************************************************************
+ *
+ * @file       animationclock.cpp
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2013
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup CorePlugin Core Plugin
+ * @{
+ * @brief The Core GCS plugin
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "animationclock.h"
+
+using namespace Core;
+
+//! One frame of a 60Hz display
+static const int DEFAULT_FRAME_INTERVAL_MS = 16;
+
+AnimationClock *AnimationClock::m_instance = 0;
+
+AnimationClock::AnimationClock(QObject *parent) : QObject(parent)
+{
+    m_instance = this;
+    m_timer.setInterval(DEFAULT_FRAME_INTERVAL_MS);
+    connect(&m_timer, SIGNAL(timeout()), this, SLOT(tick()));
+}
+
+AnimationClock::~AnimationClock()
+{
+    m_timer.stop();
+    m_instance = 0;
+}
+
+/**
+ * Have the client stepped from the next frame on, until it reports it
+ * has settled. Waking an awake client does nothing.
+ */
+void AnimationClock::wake(IAnimated *client)
+{
+    if (!m_active.contains(client))
+        m_active.append(client);
+
+    if (!m_timer.isActive()) {
+        m_elapsed.start();
+        m_timer.start();
+    }
+}
+
+/**
+ * Forget about a client, this must be called before it is destroyed
+ */
+void AnimationClock::remove(IAnimated *client)
+{
+    m_active.removeAll(client);
+
+    if (m_active.isEmpty())
+        m_timer.stop();
+}
+
+void AnimationClock::tick()
+{
+    qint64 elapsedMs = m_elapsed.restart();
+
+    // Work on a copy so clients can wake or remove others while stepping
+    QList<IAnimated *> clients = m_active;
+    foreach (IAnimated *client, clients) {
+        if (!m_active.contains(client))
+            continue;
+        if (!client->animationStep(elapsedMs))
+            m_active.removeAll(client);
+    }
+
+    if (m_active.isEmpty())
+        m_timer.stop();
+}
@@ -0,0 +1,108 @@
+/**
+ ******************************************************************************
+ *
+ * @file       animationclock.h
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2013
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup CorePlugin Core Plugin
+ * @{
+ * @brief The Core GCS plugin
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef ANIMATIONCLOCK_H
+#define ANIMATIONCLOCK_H
+
+#include "core_global.h"
+
+#include <QtCore/QObject>
+#include <QtCore/QTimer>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QList>
+#include <QtCore/qmath.h>
+
+namespace Core {
+
+/**
+ * Something which is animated by the AnimationClock, typically an instrument
+ * gadget moving its needles towards the last received value.
+ */
+class CORE_EXPORT IAnimated
+{
+public:
+    virtual ~IAnimated() {}
+
+    /**
+     * Advance the animation by one frame.
+     * @param elapsedMs time since the previous frame
+     * @return true while more frames are needed, false once settled
+     */
+    virtual bool animationStep(qint64 elapsedMs) = 0;
+
+    /**
+     * For animations which move a fixed fraction of the remaining distance on
+     * every step: the fraction to move in a frame of any length so the
+     * motion looks the same as with the original step period.
+     * @param perStep fraction moved on each original step
+     * @param elapsedMs length of this frame
+     * @param stepMs original step period
+     */
+    static qreal smoothingFactor(qreal perStep, qint64 elapsedMs, qint64 stepMs)
+    {
+        return 1 - qPow(1 - perStep, qreal(elapsedMs) / stepMs);
+    }
+};
+
+/**
+ * Application wide frame clock for the animated gadgets.
+ *
+ * Gadgets wake the clock when their target values change instead of running
+ * their own timers. On every frame all the awake gadgets are stepped
+ * together, so the scene changes they make are repainted in the same pass of
+ * the event loop, and gadgets which have settled are dropped until woken
+ * again. The clock stops when nothing is animating.
+ */
+class CORE_EXPORT AnimationClock : public QObject
+{
+    Q_OBJECT
+
+public:
+    AnimationClock(QObject *parent);
+    ~AnimationClock();
+
+    static AnimationClock* instance() { return m_instance; }
+
+    void wake(IAnimated *client);
+    void remove(IAnimated *client);
+
+    int frameInterval() const { return m_timer.interval(); }
+    void setFrameInterval(int ms) { m_timer.setInterval(ms); }
+
+private slots:
+    void tick();
+
+private:
+    QTimer m_timer;
+    QElapsedTimer m_elapsed;
+    QList<IAnimated *> m_active;
+    static AnimationClock *m_instance;
+};
+
+} // namespace Core
+
+#endif // ANIMATIONCLOCK_H
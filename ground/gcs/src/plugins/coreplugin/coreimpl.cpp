@@ -117,6 +117,11 @@ ThreadManager *CoreImpl::threadManager() const
     return m_mainwindow->threadManager();
 }
 
+AnimationClock *CoreImpl::animationClock() const
+{
+    return m_mainwindow->animationClock();
+}
+
 ModeManager *CoreImpl::modeManager() const
 {
     return m_mainwindow->modeManager();
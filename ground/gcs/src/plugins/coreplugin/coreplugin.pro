@@ -40,6 +40,7 @@ SOURCES += mainwindow.cpp \
     coreplugin.cpp \
     variablemanager.cpp \
     threadmanager.cpp \
+    animationclock.cpp \
     modemanager.cpp \
     coreimpl.cpp \
     plugindialog.cpp \
@@ -109,6 +110,7 @@ HEADERS += mainwindow.h \
     coreplugin.h \
     variablemanager.h \
     threadmanager.h \
+    animationclock.h \
     modemanager.h \
     coreimpl.h \
     plugindialog.h \
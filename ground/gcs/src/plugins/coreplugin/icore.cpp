@@ -156,6 +156,14 @@
     real time thread - anywhere in the application.
 */
 
+/*!
+    \fn AnimationClock *ICore::animationClock() const
+    \brief Returns the application's animation clock.
+
+    The animation clock steps all the animated gadgets together once per
+    display frame, instead of each of them running its own timer.
+*/
+
 /*!
     \fn ModeManager *ICore::modeManager() const
     \brief Returns the application's mode manager.
@@ -58,6 +58,7 @@
 #include "rightpane.h"
 #include "settingsdialog.h"
 #include "threadmanager.h"
+#include "animationclock.h"
 #include "uniqueidmanager.h"
 #include "variablemanager.h"
 #include "versiondialog.h"
@@ -114,6 +115,7 @@ MainWindow::MainWindow() :
     m_actionManager(new ActionManagerPrivate(this)),
     m_variableManager(new VariableManager(this)),
     m_threadManager(new ThreadManager(this)),
+    m_animationClock(new AnimationClock(this)),
     m_modeManager(0),
     m_connectionManager(0),
     m_boardManager(0),
@@ -983,6 +985,11 @@ ThreadManager *MainWindow::threadManager() const
      return m_threadManager;
 }
 
+AnimationClock *MainWindow::animationClock() const
+{
+     return m_animationClock;
+}
+
 ConnectionManager *MainWindow::connectionManager() const
 {
     return m_connectionManager;
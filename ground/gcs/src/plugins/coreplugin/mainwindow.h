@@ -63,6 +63,7 @@ class SettingsDatabase;
 class UniqueIDManager;
 class VariableManager;
 class ThreadManager;
+class AnimationClock;
 class ViewManagerInterface;
 class UAVGadgetManager;
 class UAVGadgetInstanceManager;
@@ -112,6 +113,7 @@ public:
     Core::BoardManager *boardManager() const;
     Core::VariableManager *variableManager() const;
     Core::ThreadManager *threadManager() const;
+    Core::AnimationClock *animationClock() const;
     Core::ModeManager *modeManager() const;
     Core::MimeDatabase *mimeDatabase() const;
     Internal::GeneralSettings *generalSettings() const;
@@ -189,6 +191,7 @@ private:
     GlobalMessaging * m_globalMessaging;
     VariableManager *m_variableManager;
     ThreadManager *m_threadManager;
+    AnimationClock *m_animationClock;
     ModeManager *m_modeManager;
     QList<UAVGadgetManager*> m_uavGadgetManagers;
     UAVGadgetInstanceManager *m_uavGadgetInstanceManager;
@@ -28,10 +28,14 @@
 
 #include "dialgadgetwidget.h"
 #include <utils/stylehelper.h>
+#include <utils/atlassvgitem.h>
 #include <iostream>
 #include <QtOpenGL/QGLWidget>
 #include <QDebug>
 
+//! The needles move a fifth of the remaining way on every step of this length
+static const qint64 NEEDLE_STEP_MS = 16;
+
 DialGadgetWidget::DialGadgetWidget(QWidget *parent) : QGraphicsView(parent)
 {
     // TODO: create a proper "needle" object instead of hardcoding all this
@@ -56,16 +60,43 @@ DialGadgetWidget::DialGadgetWidget(QWidget *parent) : QGraphicsView(parent)
     needle2Target = 0;
     needle3Target = 0;
 
+    frameMs = NEEDLE_STEP_MS;
+
 //	beSmooth = true;
 	beSmooth = false;
-
-    // This timer mechanism makes needles rotate smoothly
-    connect(&dialTimer, SIGNAL(timeout()), this, SLOT(rotateNeedles()));
 }
 
 DialGadgetWidget::~DialGadgetWidget()
 {
-   // Do nothing
+    if (Core::AnimationClock::instance())
+        Core::AnimationClock::instance()->remove(this);
+}
+
+/*!
+  \brief Have rotateNeedles called on every frame until the needles settle
+  */
+void DialGadgetWidget::startAnimation()
+{
+    if (Core::AnimationClock::instance())
+        Core::AnimationClock::instance()->wake(this);
+}
+
+/*!
+  \brief Called by the animation clock, makes needles rotate smoothly
+  */
+bool DialGadgetWidget::animationStep(qint64 elapsedMs)
+{
+    frameMs = elapsedMs;
+    return rotateNeedles();
+}
+
+/*!
+  \brief Fraction of the distance to the target to move in this frame, so the
+  needles move at the same speed whatever the frame rate of the animation clock
+  */
+qreal DialGadgetWidget::smoothing() const
+{
+    return Core::IAnimated::smoothingFactor(0.2, frameMs, NEEDLE_STEP_MS);
 }
 
 /*!
@@ -247,14 +278,14 @@ void DialGadgetWidget::setDialFile(QString dfn, QString bg, QString fg, QString
    if (QFile::exists(dfn) && m_renderer->load(dfn) && m_renderer->isValid())
    {
      l_scene->clear(); // This also deletes all items contained in the scene.
-     m_background = new QGraphicsSvgItem();
+     m_background = new AtlasSvgItem();
      // All other items will be clipped to the shape of the background
      m_background->setFlags(QGraphicsItem::ItemClipsChildrenToShape|
                             QGraphicsItem::ItemClipsToShape);
-     m_foreground = new QGraphicsSvgItem();
-     m_needle1 = new QGraphicsSvgItem();
-     m_needle2 = new QGraphicsSvgItem();
-     m_needle3 = new QGraphicsSvgItem();
+     m_foreground = new AtlasSvgItem();
+     m_needle1 = new AtlasSvgItem();
+     m_needle2 = new AtlasSvgItem();
+     m_needle3 = new AtlasSvgItem();
      m_needle1->setParentItem(m_background);
      m_needle2->setParentItem(m_background);
      m_needle3->setParentItem(m_background);
@@ -418,8 +449,7 @@ void DialGadgetWidget::setDialFile(QString dfn, QString bg, QString fg, QString
     needle1Value = 0;
     needle2Value = 0;
     needle3Value = 0;
-    if (!dialTimer.isActive())
-        dialTimer.start();
+    startAnimation();
     dialError = false;
    }
    else
@@ -427,7 +457,7 @@ void DialGadgetWidget::setDialFile(QString dfn, QString bg, QString fg, QString
        qDebug()<<"no file: display default background.";
        m_renderer->load(QString(":/dial/images/empty.svg"));
        l_scene->clear(); // This also deletes all items contained in the scene.
-       m_background = new QGraphicsSvgItem();
+       m_background = new AtlasSvgItem();
        m_background->setSharedRenderer(m_renderer);
        l_scene->addItem(m_background);
        m_text1 = NULL;
@@ -486,8 +516,7 @@ void DialGadgetWidget::setNeedle1(double value) {
     if (vertN1) {
         needle1Target = (value*n1Factor)/(n1MaxValue-n1MinValue);
     }
-    if (!dialTimer.isActive())
-        dialTimer.start();
+    startAnimation();
     if (m_text1) {
         QString s;
         s.sprintf("%.2f",value*n1Factor);
@@ -505,8 +534,7 @@ void DialGadgetWidget::setNeedle2(double value) {
     if (vertN2) {
         needle2Target = (value*n2Factor)/(n2MaxValue-n2MinValue);
     }
-    if (!dialTimer.isActive())
-        dialTimer.start();
+    startAnimation();
     if (m_text2) {
         QString s;
         s.sprintf("%.2f",value*n2Factor);
@@ -525,8 +553,7 @@ void DialGadgetWidget::setNeedle3(double value) {
     if (vertN3) {
         needle3Target = (value*n3Factor)/(n3MaxValue-n3MinValue);
     }
-    if (!dialTimer.isActive())
-        dialTimer.start();
+    startAnimation();
     if (m_text3) {
         QString s;
         s.sprintf("%.2f",value*n3Factor);
@@ -541,18 +568,19 @@ void DialGadgetWidget::setNeedle3(double value) {
 //
 // Note: this code is valid even if needle1 and needle2 point
 // to the same element.
-void DialGadgetWidget::rotateNeedles()
+//
+// Returns false once all needles have reached their target.
+bool DialGadgetWidget::rotateNeedles()
 {
     if (dialError) {
         // We get there in case the dial file is missing or corrupt.
-        dialTimer.stop();
-        return;
+        return false;
     }
     int dialRun = 3;
     if (n2enabled) {
         double needle2Diff;
 		if (abs((needle2Value-needle2Target)*10) > 5 && beSmooth) {
-            needle2Diff =(needle2Target - needle2Value)/5;
+            needle2Diff = (needle2Target - needle2Value) * smoothing();
         } else {
             needle2Diff = needle2Target - needle2Value;
             dialRun--;
@@ -584,7 +612,7 @@ void DialGadgetWidget::rotateNeedles()
     // We assume that needle1 always exists!
     double needle1Diff;
 	if ((abs((needle1Value-needle1Target)*10) > 5) && beSmooth) {
-        needle1Diff = (needle1Target - needle1Value)/5;
+        needle1Diff = (needle1Target - needle1Value) * smoothing();
     } else {
         needle1Diff = needle1Target - needle1Value;
         dialRun--;
@@ -608,7 +636,7 @@ void DialGadgetWidget::rotateNeedles()
    if (n3enabled) {
        double needle3Diff;
 	   if ((abs((needle3Value-needle3Target)*10) > 5) && beSmooth) {
-           needle3Diff = (needle3Target - needle3Value)/5;
+           needle3Diff = (needle3Target - needle3Value) * smoothing();
        } else {
            needle3Diff = needle3Target - needle3Value;
            dialRun--;
@@ -632,7 +660,7 @@ void DialGadgetWidget::rotateNeedles()
         dialRun--;
     }
 
-    // Now check: if dialRun is now zero, we should
-    // just stop the timer since all needles have finished moving
-    if (!dialRun) dialTimer.stop();
+    // Now check: if dialRun is now zero, all needles
+    // have finished moving and we can stop animating
+    return dialRun != 0;
 }
@@ -33,14 +33,14 @@
 #include "extensionsystem/pluginmanager.h"
 #include "uavobjectmanager.h"
 #include "uavobject.h"
+#include <coreplugin/animationclock.h>
 #include <QGraphicsView>
 #include <QtSvg/QSvgRenderer>
 #include <QtSvg/QGraphicsSvgItem>
 
 #include <QFile>
-#include <QTimer>
 
-class DialGadgetWidget : public QGraphicsView
+class DialGadgetWidget : public QGraphicsView, public Core::IAnimated
 {
     Q_OBJECT
 
@@ -52,8 +52,8 @@ public:
    void setDialFile(QString dfn, QString bg, QString fg, QString n1, QString n2, QString n3,
                     QString n1Move, QString n2Move, QString n3Move);
    void paint();
-    // setNeedle1 and setNeedle2 use a timer to simulate
-    // needle inertia
+    // setNeedle1 and setNeedle2 use the animation clock to
+    // simulate needle inertia
    void setNeedle1(double value);
    void setNeedle2(double value);
    void setNeedle3(double value);
@@ -72,6 +72,8 @@ public:
                        QString object3, QString field3);
    void setDialFont(QString fontProps);
 
+   bool animationStep(qint64 elapsedMs);
+
 public slots:
    void updateNeedle1(UAVObject *object1); // Called by the UAVObject
    void updateNeedle2(UAVObject *object2); // Called by the UAVObject
@@ -82,10 +84,11 @@ protected:
    void resizeEvent(QResizeEvent *event);
 
 
-private slots:
-   void rotateNeedles();
-
 private:
+   bool rotateNeedles();
+   void startAnimation();
+   qreal smoothing() const;
+
    QSvgRenderer *m_renderer;
    QGraphicsSvgItem *m_background;
    QGraphicsSvgItem *m_foreground;
@@ -145,9 +148,9 @@ private:
    QString subfield3;
    bool haveSubField3;
 
-   // Rotation timer
-   QTimer dialTimer;
-
    bool beSmooth;
+
+   // Length of the current animation frame
+   qint64 frameMs;
 };
 #endif /* DIALGADGETWIDGET_H_ */
@@ -0,0 +1,164 @@
+/**
+ ******************************************************************************
+ *
+ * @file       hitlbridge.cpp
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2013
+ *
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup HITLPlugin HITL Plugin
+ * @{
+ * @brief Sends the simulated sensors straight to a SIL firmware
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "hitlbridge.h"
+
+#include <cstring>
+
+#include "extensionsystem/pluginmanager.h"
+#include "uavobjectmanager.h"
+#include "actuatorcommand.h"
+#include "actuatordesired.h"
+
+HitlBridge::HitlBridge(const QString &address, quint16 port, bool lockstep, QObject *parent) :
+    QObject(parent),
+    socket(this),
+    address(address),
+    port(port),
+    lockstep(lockstep),
+    seq(0),
+    lastReportMs(0),
+    sent(0),
+    answered(0),
+    stale(0),
+    latencySumNs(0),
+    latencyMaxNs(0),
+    firmwareSumUs(0)
+{
+    ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
+    UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
+    actDesired = ActuatorDesired::GetInstance(objManager);
+    actCommand = ActuatorCommand::GetInstance(objManager);
+
+    memset(&packet, 0, sizeof(packet));
+    memset(sentNs, 0, sizeof(sentNs));
+
+    // Any local port, the firmware answers to the sender
+    socket.bind(QHostAddress::Any, 0);
+    connect(&socket, SIGNAL(readyRead()), this, SLOT(receive()), Qt::DirectConnection);
+
+    clock.start();
+}
+
+/**
+ * @brief HitlBridge::sendSensors Send the packet filled through sensors()
+ * @param simTimeUs simulation time of the step
+ */
+void HitlBridge::sendSensors(quint32 simTimeUs)
+{
+    packet.magic = HITL_BRIDGE_SENSORS_MAGIC;
+    packet.seq = ++seq;
+    packet.sim_time_us = simTimeUs;
+    if (lockstep)
+        packet.flags |= HITL_BRIDGE_LOCKSTEP;
+    else
+        packet.flags &= ~HITL_BRIDGE_LOCKSTEP;
+
+    sentNs[seq % IN_FLIGHT] = clock.nsecsElapsed();
+    socket.writeDatagram(reinterpret_cast<const char *>(&packet), sizeof(packet), address, port);
+    sent++;
+
+    if (clock.elapsed() - lastReportMs >= REPORT_PERIOD_MS)
+        report();
+}
+
+/**
+ * @brief HitlBridge::receive Copy the answers into the actuator objects
+ */
+void HitlBridge::receive()
+{
+    while (socket.hasPendingDatagrams()) {
+        // One byte larger so that a longer datagram fails the size check
+        char buf[sizeof(struct hitl_bridge_actuators) + 1];
+        qint64 len = socket.readDatagram(buf, sizeof(buf));
+
+        const struct hitl_bridge_actuators *actuators = hitl_bridge_actuators_check(buf, len);
+        if (actuators == NULL)
+            continue;
+
+        // Answers to packets older than the in flight window are not timed
+        if (seq - actuators->seq < (quint32) IN_FLIGHT) {
+            qint64 latency = clock.nsecsElapsed() - sentNs[actuators->seq % IN_FLIGHT];
+            latencySumNs += latency;
+            latencyMaxNs = qMax(latencyMaxNs, latency);
+            firmwareSumUs += actuators->firmware_us;
+            answered++;
+        }
+        if (!actuators->fresh)
+            stale++;
+
+        ActuatorDesired::DataFields desired = actDesired->getData();
+        desired.Roll = actuators->desired[0];
+        desired.Pitch = actuators->desired[1];
+        desired.Yaw = actuators->desired[2];
+        desired.Throttle = actuators->desired[3];
+        actDesired->setData(desired);
+
+        ActuatorCommand::DataFields command = actCommand->getData();
+        for (int i = 0; i < ActuatorCommand::CHANNEL_NUMELEM && i < HITL_BRIDGE_CHANNELS; i++)
+            command.Channel[i] = actuators->channel[i];
+        actCommand->setData(command);
+
+        // In lockstep only the answer to the latest step lets the simulator go on
+        if (!lockstep || actuators->seq == seq)
+            emit actuatorsReceived();
+    }
+}
+
+/**
+ * @brief HitlBridge::report Summarise the loop latency since the last report
+ */
+void HitlBridge::report()
+{
+    if (answered > 0) {
+        emit statusMessage(QString("Bridge: %1 steps, loop latency mean %2 ms max %3 ms "
+                                   "(firmware %4 ms), %5 unanswered, %6 stale")
+                           .arg(sent)
+                           .arg(latencySumNs / answered / 1.0e6, 0, 'f', 2)
+                           .arg(latencyMaxNs / 1.0e6, 0, 'f', 2)
+                           .arg(firmwareSumUs / answered / 1.0e3, 0, 'f', 2)
+                           .arg(sent > answered ? sent - answered : 0)
+                           .arg(stale));
+    } else if (sent > 0) {
+        emit statusMessage(QString("Bridge: %1 steps sent to %2:%3, no answer from the firmware")
+                           .arg(sent).arg(address.toString()).arg(port));
+    }
+
+    lastReportMs = clock.elapsed();
+    sent = 0;
+    answered = 0;
+    stale = 0;
+    latencySumNs = 0;
+    latencyMaxNs = 0;
+    firmwareSumUs = 0;
+}
+
+/**
+ * @}
+ * @}
+ */
@@ -0,0 +1,114 @@
+/**
+ ******************************************************************************
+ *
+ * @file       hitlbridge.h
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2013
+ *
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup HITLPlugin HITL Plugin
+ * @{
+ * @brief Sends the simulated sensors straight to a SIL firmware
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef HITLBRIDGE_H
+#define HITLBRIDGE_H
+
+#include <QObject>
+#include <QUdpSocket>
+#include <QHostAddress>
+#include <QElapsedTimer>
+
+#include "hitl_bridge.h"
+
+class ActuatorDesired;
+class ActuatorCommand;
+
+/**
+ * @brief Exchanges @ref hitl_bridge_sensors and @ref hitl_bridge_actuators
+ * packets with the simulated Sensors module of the POSIX firmware.
+ *
+ * The sensor packet is preallocated and filled in place every step, and
+ * the answer is written into ActuatorDesired and ActuatorCommand locally,
+ * so neither direction goes through telemetry or the GUI thread. The bridge
+ * lives in the thread of the Simulator which creates it.
+ *
+ * The time between a sensor packet and its answer is the loop latency seen
+ * by the simulator, it is summarised through statusMessage() every few
+ * seconds together with the share of it spent in the firmware.
+ */
+class HitlBridge : public QObject
+{
+    Q_OBJECT
+
+public:
+    HitlBridge(const QString &address, quint16 port, bool lockstep, QObject *parent = 0);
+
+    bool isLockstep() const { return lockstep; }
+
+    /**
+     * The packet of the next step. Fill in the fields and flags then call
+     * sendSensors(), the header is handled by the bridge.
+     */
+    struct hitl_bridge_sensors &sensors() { return packet; }
+    void sendSensors(quint32 simTimeUs);
+
+signals:
+    //! The firmware answered the last sensor packet
+    void actuatorsReceived();
+    void statusMessage(QString message);
+
+private slots:
+    void receive();
+
+private:
+    static const int IN_FLIGHT = 64;
+    static const int REPORT_PERIOD_MS = 5000;
+
+    void report();
+
+    QUdpSocket socket;
+    QHostAddress address;
+    quint16 port;
+    bool lockstep;
+
+    ActuatorDesired *actDesired;
+    ActuatorCommand *actCommand;
+
+    struct hitl_bridge_sensors packet;
+    quint32 seq;
+
+    //! Send times of the packets in flight, by seq % IN_FLIGHT
+    QElapsedTimer clock;
+    qint64 sentNs[IN_FLIGHT];
+
+    qint64 lastReportMs;
+    quint32 sent;
+    quint32 answered;
+    quint32 stale;
+    qint64 latencySumNs;
+    qint64 latencyMaxNs;
+    quint64 firmwareSumUs;
+};
+
+#endif // HITLBRIDGE_H
+
+/**
+ * @}
+ * @}
+ */
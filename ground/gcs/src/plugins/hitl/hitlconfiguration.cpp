@@ -68,6 +68,11 @@ HITLConfiguration::HITLConfiguration(QString classId, QSettings* qSettings, QObj
     settings.airspeedActualEnabled= false;
     settings.airspeedActualRate  = 100;
 
+    settings.bridgeEnabled       = false;
+    settings.bridgeLockstep      = false;
+    settings.bridgeAddress       = "127.0.0.1";
+    settings.bridgePort          = 9004;
+
 
     // if a saved configuration exists load it, and overwrite defaults
     if (qSettings != 0) {
@@ -124,6 +129,11 @@ HITLConfiguration::HITLConfiguration(QString classId, QSettings* qSettings, QObj
 
         settings.airspeedActualEnabled=qSettings->value("airspeedActualEnabled").toBool();
         settings.airspeedActualRate  = qSettings->value("airspeedActualRate").toInt();
+
+        settings.bridgeEnabled       = qSettings->value("bridgeEnabled", settings.bridgeEnabled).toBool();
+        settings.bridgeLockstep      = qSettings->value("bridgeLockstep", settings.bridgeLockstep).toBool();
+        settings.bridgeAddress       = qSettings->value("bridgeAddress", settings.bridgeAddress).toString();
+        settings.bridgePort          = qSettings->value("bridgePort", settings.bridgePort).toInt();
     }
 }
 
@@ -174,5 +184,10 @@ void HITLConfiguration::saveConfig(QSettings* qSettings) const {
 
     qSettings->setValue("airspeedActualEnabled", settings.airspeedActualEnabled);
     qSettings->setValue("airspeedActualRate", settings.airspeedActualRate);
+
+    qSettings->setValue("bridgeEnabled", settings.bridgeEnabled);
+    qSettings->setValue("bridgeLockstep", settings.bridgeLockstep);
+    qSettings->setValue("bridgeAddress", settings.bridgeAddress);
+    qSettings->setValue("bridgePort", settings.bridgePort);
 }
 
@@ -118,6 +118,11 @@ QWidget *HITLOptionsPage::createPage(QWidget *parent)
     m_optionsPage->airspeedActualCheckbox->setChecked(config->Settings().airspeedActualEnabled);
     m_optionsPage->airspeedRateSpinbox->setValue(config->Settings().airspeedActualRate);
 
+    m_optionsPage->bridgeCheckbox->setChecked(config->Settings().bridgeEnabled);
+    m_optionsPage->bridgeLockstep->setChecked(config->Settings().bridgeLockstep);
+    m_optionsPage->bridgeAddress->setText(config->Settings().bridgeAddress);
+    m_optionsPage->bridgePortSpinbox->setValue(config->Settings().bridgePort);
+
     return optionsPageWidget;
 }
 
@@ -168,6 +173,11 @@ void HITLOptionsPage::apply()
     settings.airspeedActualEnabled=m_optionsPage->airspeedActualCheckbox->isChecked();
     settings.airspeedActualRate=m_optionsPage->airspeedRateSpinbox->value();
 
+    settings.bridgeEnabled = m_optionsPage->bridgeCheckbox->isChecked();
+    settings.bridgeLockstep = m_optionsPage->bridgeLockstep->isChecked();
+    settings.bridgeAddress = m_optionsPage->bridgeAddress->text();
+    settings.bridgePort = m_optionsPage->bridgePortSpinbox->value();
+
     //Write settings to file
     config->setSimulatorSettings(settings);
 }
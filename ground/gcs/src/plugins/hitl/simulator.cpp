@@ -34,6 +34,8 @@
 #include "coreplugin/icore.h"
 #include "coreplugin/threadmanager.h"
 #include "hitlnoisegeneration.h"
+#include "hitlbridge.h"
+#include <QDate>
 
 volatile bool Simulator::isStarted = false;
 QMap<QString, UAVObject::Metadata> Simulator::originalMetaData;
@@ -50,6 +52,7 @@ Simulator::Simulator(const SimulatorSettings& params) :
 	simConnectionStatus(false),
 	txTimer(NULL),
 	simTimer(NULL),
+	bridge(NULL),
 	name("")
 {
 	// move to thread
@@ -101,6 +104,12 @@ Simulator::~Simulator()
 		delete simTimer;
 		simTimer = NULL;
 	}
+
+	if(bridge)
+	{
+		delete bridge;
+		bridge = NULL;
+	}
 	// NOTE: Does not currently work, may need to send control+c to through the terminal
 	if (simProcess != NULL)
 	{
@@ -195,7 +204,23 @@ void Simulator::onStart()
 	txTimer = new QTimer();
 	connect(txTimer, SIGNAL(timeout()), this, SLOT(transmitUpdate()),Qt::DirectConnection);
 	txTimer->setInterval(updatePeriod);
-	txTimer->start();
+
+	if (settings.bridgeEnabled) {
+		// Sensors go straight to the SIL firmware from this thread
+		bridge = new HitlBridge(settings.bridgeAddress, settings.bridgePort, settings.bridgeLockstep);
+		connect(bridge, SIGNAL(statusMessage(QString)), this, SIGNAL(processOutput(QString)));
+
+		emit processOutput("Sensor bridge to " + settings.bridgeAddress + ":" +
+		                   QString::number(settings.bridgePort) +
+		                   (settings.bridgeLockstep ? " in lockstep\n" : "\n"));
+	}
+
+	if (bridge && bridge->isLockstep()) {
+		// The simulator gets its controls as soon as the firmware answered the step
+		connect(bridge, SIGNAL(actuatorsReceived()), this, SLOT(transmitUpdate()),Qt::DirectConnection);
+	} else {
+		txTimer->start();
+	}
 	// Setup simulator connection timer
 	simTimer = new QTimer();
 	connect(simTimer, SIGNAL(timeout()), this, SLOT(onSimulatorConnectionTimeout()),Qt::DirectConnection);
@@ -273,7 +298,11 @@ void Simulator::setupUAVObjects()
 
     // Most simulators use the flight controller's ActuatorDesired UAVO
     // for control output...
-    if (settings.simulatorId == "FG"  ||
+    if (settings.bridgeEnabled)
+    {
+        // ...which the sensor bridge already returns with every step
+    }
+    else if (settings.simulatorId == "FG"  ||
              settings.simulatorId == "IL2" ||
              settings.simulatorId == "X-Plane")
     {
@@ -454,6 +483,11 @@ void Simulator::updateUAVOs(Output2Hardware out){
         homePositionSet=true;
     }
 
+    if (bridge) {
+        updateBridge(out);
+        return;
+    }
+
     /*******************************/
     //Copy everything to the ground truth object. GroundTruth is Noise-free.
     GroundTruth::DataFields groundTruthData;
@@ -786,6 +820,61 @@ void Simulator::updateUAVOs(Output2Hardware out){
     }
 }
 
+/**
+ * @brief Simulator::updateBridge Send one step of raw sensors through the
+ * sensor bridge instead of setting the UAVOs
+ * @param out
+ */
+void Simulator::updateBridge(const Output2Hardware &out)
+{
+    struct hitl_bridge_sensors &sensors = bridge->sensors();
+
+    Noise noise;
+    if (settings.addNoise)
+        noise = HitlNoiseGeneration().generateNoise();
+    else
+        memset(&noise, 0, sizeof(Noise));
+
+    sensors.flags = HITL_BRIDGE_HAS_MAG | HITL_BRIDGE_HAS_BARO | HITL_BRIDGE_HAS_GPS | HITL_BRIDGE_HAS_AIRSPEED;
+
+    sensors.gyro[0] = out.rollRate + noise.gyroData.x;
+    sensors.gyro[1] = out.pitchRate + noise.gyroData.y;
+    sensors.gyro[2] = out.yawRate + noise.gyroData.z;
+
+    sensors.accel[0] = out.accX + noise.accelData.x;
+    sensors.accel[1] = out.accY + noise.accelData.y;
+    sensors.accel[2] = out.accZ + noise.accelData.z;
+
+    sensors.baro_altitude = out.altitude + noise.baroAltData.Altitude;
+    sensors.airspeed = out.calibratedAirspeed + noise.airspeedActual.CalibratedAirspeed;
+
+    sensors.latitude = out.latitude;     //Already in *10^7 integer format
+    sensors.longitude = out.longitude;   //Already in *10^7 integer format
+    sensors.altitude = out.altitude;
+    sensors.velocity[0] = out.velNorth;
+    sensors.velocity[1] = out.velEast;
+    sensors.velocity[2] = out.velDown;
+
+    // None of the simulators provide a magnetometer, so rotate the earth field
+    // into the body frame. The model is only evaluated when leaving its tile.
+    double LLA[3] = { out.latitude / 1e7, out.longitude / 1e7, out.altitude };
+    double Be[3];
+    QDate date = QDate::currentDate();
+    if (magModel.GetMagVectorTracked(LLA, date.month(), date.day(), date.year(), Be) < 0) {
+        sensors.flags &= ~HITL_BRIDGE_HAS_MAG;
+    } else {
+        float rpy[3] = { out.roll, out.pitch, out.heading };
+        float q[4];
+        float Rbe[3][3];
+        Utils::CoordinateConversions().RPY2Quaternion(rpy, q);
+        Utils::CoordinateConversions().Quaternion2R(q, Rbe);
+        for (int i = 0; i < 3; i++)
+            sensors.mag[i] = Rbe[i][0] * Be[0] + Rbe[i][1] * Be[1] + Rbe[i][2] * Be[2];
+    }
+
+    bridge->sendSensors(quint32(time->elapsed()) * 1000);
+}
+
 /**
  * calculate air density from altitude. http://en.wikipedia.org/wiki/Density_of_air
  */
@@ -64,8 +64,11 @@
 #include "velocityactual.h"
 
 #include "utils/coordinateconversions.h"
+#include "utils/worldmagmodel.h"
 #include "physical_constants.h"
 
+class HitlBridge;
+
 /**
  * just imagine this was a class without methods and all public properties
  */
@@ -161,6 +164,11 @@ typedef struct _CONNECTION
     bool airspeedActualEnabled;
     quint16 airspeedActualRate;
 
+    bool bridgeEnabled;
+    bool bridgeLockstep;
+    QString bridgeAddress;
+    quint16 bridgePort;
+
 } SimulatorSettings;
 
 
@@ -246,6 +254,7 @@ public:
 
     void resetInitialHomePosition();
     void updateUAVOs(Output2Hardware out);
+    void updateBridge(const Output2Hardware &out);
 
     AirParameters getAirParameters();
     void setAirParameters(AirParameters airParameters);
@@ -323,6 +332,9 @@ private:
     QTime gcsRcvrTime;
     QTime airspeedActualTime;
 
+    HitlBridge* bridge;
+    Utils::WorldMagModel magModel;
+
     QString name;
     QString simulatorId;
     volatile static bool isStarted;
@@ -27,6 +27,7 @@
 
 #include "lineardialgadgetwidget.h"
 #include <utils/stylehelper.h>
+#include <utils/atlassvgitem.h>
 #include <QtGui/QFileDialog>
 #include <QtOpenGL/QGLWidget>
 #include <QDebug>
@@ -168,7 +169,7 @@ void LineardialGadgetWidget::setDialFile(QString dfn)
    {
           l_scene->clear(); // Beware: clear also deletes all objects
                             // which are currently in the scene
-          background = new QGraphicsSvgItem();
+          background = new AtlasSvgItem();
           background->setSharedRenderer(m_renderer);
           background->setElementId("background");
           background->setFlags(QGraphicsItem::ItemClipsChildrenToShape|
@@ -180,15 +181,15 @@ void LineardialGadgetWidget::setDialFile(QString dfn)
           if (m_renderer->elementExists("red")) {
               // Order is important: red, then yellow then green
               // overlayed on top of each other
-              red = new QGraphicsSvgItem();
+              red = new AtlasSvgItem();
               red->setSharedRenderer(m_renderer);
               red->setElementId("red");
               red->setParentItem(background);
-              yellow = new QGraphicsSvgItem();
+              yellow = new AtlasSvgItem();
               yellow->setSharedRenderer(m_renderer);
               yellow->setElementId("yellow");
               yellow->setParentItem(background);
-              green = new QGraphicsSvgItem();
+              green = new AtlasSvgItem();
               green->setSharedRenderer(m_renderer);
               green->setElementId("green");
               green->setParentItem(background);
@@ -266,7 +267,7 @@ void LineardialGadgetWidget::setDialFile(QString dfn)
               startY = nRect.y();
               QTransform matrix;
               matrix.translate(startX,startY);
-              index = new QGraphicsSvgItem();
+              index = new AtlasSvgItem();
               index->setSharedRenderer(m_renderer);
               index->setElementId("needle");
               index->setTransform(matrix,false);
@@ -319,7 +320,7 @@ void LineardialGadgetWidget::setDialFile(QString dfn)
               qreal startY = textMatrix.mapRect(m_renderer->boundsOnElement("symbol")).y();
               QTransform matrix;
               matrix.translate(startX,startY);
-              fieldSymbol = new QGraphicsSvgItem();
+              fieldSymbol = new AtlasSvgItem();
               fieldSymbol->setElementId("symbol");
               fieldSymbol->setSharedRenderer(m_renderer);
               fieldSymbol->setTransform(matrix,false);
@@ -329,7 +330,7 @@ void LineardialGadgetWidget::setDialFile(QString dfn)
           }
 
          if (m_renderer->elementExists("foreground")) {
-            foreground = new QGraphicsSvgItem();
+            foreground = new AtlasSvgItem();
             foreground->setSharedRenderer(m_renderer);
             foreground->setElementId("foreground");
             foreground->setParentItem(background);
@@ -350,7 +351,7 @@ void LineardialGadgetWidget::setDialFile(QString dfn)
        qDebug() << "no file ";
        m_renderer->load(QString(":/lineardial/images/empty.svg"));
        l_scene->clear(); // This also deletes all items contained in the scene.
-       background = new QGraphicsSvgItem();
+       background = new AtlasSvgItem();
        background->setSharedRenderer(m_renderer);
        l_scene->addItem(background);
        fieldName = NULL;
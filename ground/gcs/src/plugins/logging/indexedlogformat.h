@@ -0,0 +1,110 @@
+/**
+ ******************************************************************************
+ *
+ * @file       indexedlogformat.h
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2013
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup LoggingGadgetPlugin Logging Gadget Plugin
+ * @{
+ * @brief On-disk layout of the indexed (.tli) log format
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef INDEXEDLOGFORMAT_H
+#define INDEXEDLOGFORMAT_H
+
+#include <QtGlobal>
+
+/*
+ * An indexed log starts exactly like a .tll log: the text header, followed by
+ * one record per UAVTalk packet:
+ *
+ *     quint32 timestamp (ms), qint64 packet size, packet bytes
+ *
+ * After the last record come the indexes and a fixed-size footer, so the file
+ * can be opened by reading the footer and mapping the rest:
+ *
+ *     IndexedLogTimeEntry[timeIndexCount]     one per record, in file order
+ *     IndexedLogObjectEntry[objectIndexCount] sorted by object ID
+ *     quint32[]                               record numbers for each object
+ *     IndexedLogKeyframeEntry[keyframeIndexCount]
+ *     quint32[]                               record numbers for each keyframe
+ *     IndexedLogKeyframeFooter
+ *     IndexedLogFooter
+ *
+ * A keyframe is taken every INDEXEDLOG_KEYFRAME_PERIOD_MS of log time and
+ * lists, for every object instance seen so far, its latest record. Seeking
+ * replays that list and then the records from the keyframe to the requested
+ * time, which restores the full object state without reading the log from
+ * its start. Logs written before keyframes existed have no keyframe footer,
+ * readers find it by its own magic and otherwise ignore it.
+ *
+ * All fields are in host byte order, as in the .tll format. Every table starts
+ * on an 8-byte boundary so that it can be used in place from the mapped file.
+ */
+
+#define INDEXEDLOG_MAGIC "TLLIDX01"
+#define INDEXEDLOG_KEYFRAME_MAGIC "TLLKEY01"
+#define INDEXEDLOG_SUFFIX "tli"
+
+// Records are written as a 4 byte timestamp and an 8 byte size, followed by the packet
+#define INDEXEDLOG_RECORD_HEADER_LENGTH (sizeof(quint32) + sizeof(qint64))
+
+// Offset of the object ID inside a UAVTalk packet: sync(1), type(1), size(2)
+#define INDEXEDLOG_UAVTALK_OBJID_OFFSET 4
+
+// Offset of the instance ID, only present in packets of multi-instance objects
+#define INDEXEDLOG_UAVTALK_INSTID_OFFSET 8
+
+// Log time between two keyframes, in ms
+#define INDEXEDLOG_KEYFRAME_PERIOD_MS 10000
+
+struct IndexedLogTimeEntry {
+    quint32 timestamp; // Record timestamp, in ms
+    quint32 objId;     // UAVObject ID of the packet, or 0 if it could not be read
+    quint64 offset;    // File offset of the record's timestamp field
+};
+
+struct IndexedLogObjectEntry {
+    quint32 objId;
+    quint32 count;      // Number of records for this object
+    quint64 listOffset; // File offset of the object's quint32 record numbers
+};
+
+struct IndexedLogKeyframeEntry {
+    quint32 timestamp;  // Timestamp of the first record after the keyframe, in ms
+    quint32 record;     // Number of the first record after the keyframe
+    quint32 count;      // Number of object instances in the keyframe
+    quint32 reserved;
+    quint64 listOffset; // File offset of the instances' latest record numbers, sorted
+};
+
+struct IndexedLogKeyframeFooter {
+    char magic[8];
+    quint64 keyframeIndexOffset;
+    quint64 keyframeIndexCount;
+};
+
+struct IndexedLogFooter {
+    char magic[8];
+    quint64 timeIndexOffset;
+    quint64 timeIndexCount;
+    quint64 objectIndexOffset;
+    quint64 objectIndexCount;
+};
+
+#endif // INDEXEDLOGFORMAT_H
@@ -1,8 +1,12 @@
 #include "logfile.h"
 #include <QDebug>
 #include <QtGlobal>
+#include <QtEndian>
+#include <QFileInfo>
+#include <QtAlgorithms>
 #include <QTextStream>
  #include <QMessageBox>
+#include <extensionsystem/pluginmanager.h>
 
 // autogenerated version info string. MUST GO BEFORE coreconstants.h INCLUDE
 #include "../../../../../build/ground/gcs/gcsversioninfo.h"
@@ -11,7 +15,17 @@
 
 LogFile::LogFile(QObject *parent) :
     QIODevice(parent),
-    timestampBufferIdx(0)
+    mappedLog(NULL),
+    timeIndex(NULL),
+    objectIndex(NULL),
+    timeIndexCount(0),
+    objectIndexCount(0),
+    keyframeIndex(NULL),
+    keyframeIndexCount(0),
+    mappedSize(0),
+    recordsEnd(0),
+    timestampBufferIdx(0),
+    fastForward(false)
 {
     connect(&timer, SIGNAL(timeout()), this, SLOT(timerFired()));
 }
@@ -57,12 +71,17 @@ bool LogFile::open(OpenMode mode) {
         QTextStream out(&file);
 
         out << "Tau Labs git hash:\n" <<  gitHash << "\n" << uavoHash << "\n##\n";
+        out.flush();
+
+        // Indexed logs get their time and object indexes appended when the file is closed
+        if (QFileInfo(file.fileName()).suffix() == INDEXEDLOG_SUFFIX)
+            indexWriter.begin(&file);
     }
     else if(mode == QIODevice::ReadOnly)
     {
-        file.readLine(); //Read first line of log file. This assumes that the logfile is of the new format.
-        QString logGitHashString=file.readLine().trimmed(); //Read second line of log file. This assumes that the logfile is of the new format.
-        QString logUAVOHashString=file.readLine().trimmed(); //Read third line of log file. This assumes that the logfile is of the new format.
+        QString logGitHashString;
+        QString logUAVOHashString;
+        bool foundSeparator = readHeader(&file, &logGitHashString, &logUAVOHashString);
         QString gitHash = QString::fromLatin1(Core::Constants::GCS_REVISION_STR);
         QString uavoHash = QString::fromLatin1(Core::Constants::UAVOSHA1_STR).replace("\"{ ", "").replace(" }\"", "").replace(",", "").replace("0x", ""); // See comment above for necessity for string replacements
 
@@ -79,24 +98,16 @@ bool LogFile::open(OpenMode mode) {
             msgBox.exec();
         }
 
-        QString tmpLine=file.readLine(); //Look for the header/body separation string.
-        int cnt=0;
-        while (tmpLine!="##\n" && cnt < 10 && !file.atEnd()){
-            tmpLine=file.readLine().trimmed();
-            cnt++;
-        }
-
         //Check if we reached the end of the file before finding the separation string
-        if (cnt >=10 || file.atEnd()){
+        if (!foundSeparator){
             QMessageBox msgBox;
             msgBox.setText("Corrupted file.");
             msgBox.setInformativeText("GCS cannot find the separation byte. GCS will attempt to play the file."); //<--TODO: add hyperlink to webpage with better description.
             msgBox.exec();
-
-            //Since we could not find the file separator, we need to return to the beginning of the file
-            file.seek(0);
         }
 
+        // If the file carries an index, map it so replay never has to scan the log
+        mapIndex();
     }
     else
     {
@@ -117,6 +128,22 @@ void LogFile::close()
 
     if (timer.isActive())
         timer.stop();
+
+    if (indexWriter.isActive() && !indexWriter.finish())
+        qDebug() << "Unable to write the index of " << file.fileName();
+
+    if (mappedLog != NULL) {
+        file.unmap(mappedLog);
+        mappedLog = NULL;
+        timeIndex = NULL;
+        objectIndex = NULL;
+        timeIndexCount = 0;
+        objectIndexCount = 0;
+        keyframeIndex = NULL;
+        keyframeIndexCount = 0;
+        mappedSize = 0;
+    }
+
     file.close();
     QIODevice::close();
 }
@@ -127,6 +154,13 @@ qint64 LogFile::writeData(const char * data, qint64 dataSize) {
 
     quint32 timeStamp = myTime.elapsed();
 
+    if (indexWriter.isActive()) {
+        if (!indexWriter.writeRecord(timeStamp, data, dataSize))
+            return -1;
+        emit bytesWritten(dataSize);
+        return dataSize;
+    }
+
     file.write((char *) &timeStamp,sizeof(timeStamp));
     file.write((char *) &dataSize, sizeof(dataSize));
 
@@ -152,59 +186,56 @@ qint64 LogFile::bytesAvailable() const
 
 void LogFile::timerFired()
 {
-    qint64 dataSize;
-
-    if(file.bytesAvailable() > 4)
-    {
-
-        int time;
-        time = myTime.elapsed();
-
-        //Read packets
-        while ((lastPlayTime + ((time - lastPlayTimeOffset)* playbackSpeed) > (lastTimeStamp-firstTimestamp)))
-        {
-            lastPlayTime += ((time - lastPlayTimeOffset)* playbackSpeed);
-            if(file.bytesAvailable() < 4) {
-                stopReplay();
-                return;
-            }
-
-            file.seek(lastTimeStampPos+sizeof(lastTimeStamp));
-
-            file.read((char *) &dataSize, sizeof(dataSize));
+    quint32 numRecords = recordCount();
+    if (timestampBufferIdx >= numRecords) {
+        stopReplay();
+        return;
+    }
 
-            if (dataSize<1 || dataSize>(1024*1024)) {
-                qDebug() << "Error: Logfile corrupted! Unlikely packet size: " << dataSize << "\n";
-                stopReplay();
-                return;
-            }
-            if(file.bytesAvailable() < dataSize) {
-                stopReplay();
-                return;
+    // Advance the play clock once per tick, so the replay keeps to the log's
+    // timing however many records are due
+    int time = myTime.elapsed();
+    lastPlayTime += (time - lastPlayTimeOffset) * playbackSpeed;
+    lastPlayTimeOffset = time;
+
+    quint32 end = timestampBufferIdx;
+    while (end < numRecords && lastPlayTime > recordTimestamp(end) - firstTimestamp)
+        end++;
+
+    if (end > timestampBufferIdx) {
+        bool success = true;
+        if (fastForward) {
+            // Updates overwritten within the same tick are never seen, so only
+            // the latest one of each object instance is parsed
+            success = appendLatest(QHash<quint64, quint32>(), timestampBufferIdx, end);
+        } else {
+            for (quint32 idx = timestampBufferIdx; success && idx < end; idx++) {
+                QByteArray packet = recordPacket(idx);
+                success = !packet.isEmpty();
+
+                QMutexLocker locker(&mutex);
+                dataBuffer.append(packet);
             }
+        }
 
-            mutex.lock();
-            dataBuffer.append(file.read(dataSize));
-            mutex.unlock();
-            emit readyRead();
-
-            if(file.bytesAvailable() < 4) {
-                stopReplay();
-                return;
-            }
+        if (!success) {
+            stopReplay();
+            return;
+        }
 
-            lastTimeStampPos = timestampPos[timestampBufferIdx];
-            lastTimeStamp = timestampBuffer[timestampBufferIdx];
-            timestampBufferIdx++;
+        // The reader drains the whole buffer, once per tick is enough
+        emit readyRead();
+        timestampBufferIdx = end;
+    }
 
-            lastPlayTimeOffset = time;
-            time = myTime.elapsed();
+    emit replayPosition(lastPlayTime / 1000.0);
 
-        }
-    } else {
+    if (timestampBufferIdx >= numRecords) {
         stopReplay();
+        return;
     }
 
+    lastTimeStamp = recordTimestamp(timestampBufferIdx);
 }
 
 bool LogFile::startReplay() {
@@ -213,15 +244,14 @@ bool LogFile::startReplay() {
     lastPlayTimeOffset = 0;
     lastPlayTime = 0;
     playbackSpeed = 1;
+    timestampBufferIdx = 0;
+    lastTimeStamp = 0;
 
-    //Read all log timestamps into array
+    //Read all log timestamps into array, unless the log already has an index
     timestampBuffer.clear(); //Save beginning of log for later use
     timestampPos.clear();
-    quint64 logFileStartIdx = file.pos();
-    timestampBufferIdx = 0;
-    lastTimeStamp = 0;
 
-    while (!file.atEnd()){
+    while (mappedLog == NULL && !file.atEnd() && (quint64) file.pos() < recordsEnd){
         qint64 dataSize;
 
         //Get time stamp position
@@ -256,7 +286,7 @@ bool LogFile::startReplay() {
     }
 
     //Check if any timestamps were successfully read
-    if (timestampBuffer.size() == 0){
+    if (recordCount() == 0){
         QMessageBox msgBox;
         msgBox.setText("Empty logfile.");
         msgBox.setInformativeText("No log data can be found.");
@@ -267,11 +297,8 @@ bool LogFile::startReplay() {
     }
 
     //Reset to log beginning.
-    file.seek(logFileStartIdx+sizeof(lastTimeStamp));
-    lastTimeStampPos = timestampPos[0];
-    lastTimeStamp = timestampBuffer[0];
-    firstTimestamp = timestampBuffer[0];
-    timestampBufferIdx = 1;
+    lastTimeStamp = recordTimestamp(0);
+    firstTimestamp = lastTimeStamp;
 
     timer.setInterval(10);
     timer.start();
@@ -298,21 +325,594 @@ void LogFile::resumeReplay()
 
 /**
  * @brief LogFile::setReplayTime, sets the playback time
- * @param val, the time in
+ * @param val, the time in seconds from the start of the log
  */
 void LogFile::setReplayTime(double val)
 {
-    quint32 tmpIdx=0;
-    while(timestampBuffer[tmpIdx++] <= val*1000 && tmpIdx <= timestampBufferIdx){
+    quint32 numRecords = recordCount();
+    if (numRecords == 0)
+        return;
+
+    // Timestamps are sorted, so bisect for the first record after the requested time
+    quint32 requestedTime = firstTimestamp + val*1000;
+    quint32 lo = 0;
+    quint32 hi = numRecords;
+    while (lo < hi) {
+        quint32 mid = lo + (hi - lo) / 2;
+        if (recordTimestamp(mid) <= requestedTime)
+            lo = mid + 1;
+        else
+            hi = mid;
     }
 
-    lastTimeStampPos=timestampPos[tmpIdx];
-    lastTimeStamp=timestampBuffer[tmpIdx];
-    timestampBufferIdx=tmpIdx;
+    timestampBufferIdx = qMin(lo, numRecords - 1);
+    lastTimeStamp = recordTimestamp(timestampBufferIdx);
 
     lastPlayTimeOffset = myTime.elapsed();
-    lastPlayTime=lastTimeStamp;
+    lastPlayTime = lastTimeStamp - firstTimestamp;
+
+    // Put every object into the state it had at the new position straight
+    // away, instead of leaving it stale until its next update
+    if (restoreState(timestampBufferIdx))
+        emit readyRead();
+    emit replayPosition(lastPlayTime / 1000.0);
+
+    qDebug() << "Replaying at: " << lastTimeStamp << ", but requested at" << requestedTime;
+}
+
+/**
+ * @brief LogFile::recordCount Number of records in the log being replayed
+ */
+quint32 LogFile::recordCount() const
+{
+    if (mappedLog != NULL)
+        return timeIndexCount;
+
+    return timestampBuffer.size();
+}
+
+/**
+ * @brief LogFile::recordTimestamp Timestamp, in ms, of the record at index idx
+ */
+quint32 LogFile::recordTimestamp(quint32 idx) const
+{
+    if (mappedLog != NULL)
+        return timeIndex[idx].timestamp;
+
+    return timestampBuffer[idx];
+}
+
+/**
+ * @brief LogFile::replayDuration Time between the first and the last record, in seconds
+ */
+double LogFile::replayDuration() const
+{
+    quint32 numRecords = recordCount();
+    if (numRecords == 0)
+        return 0;
+
+    return (recordTimestamp(numRecords - 1) - firstTimestamp) / 1000.0;
+}
+
+/**
+ * @brief LogFile::recordPosition File offset of the record at index idx
+ */
+quint64 LogFile::recordPosition(quint32 idx) const
+{
+    if (mappedLog != NULL)
+        return timeIndex[idx].offset;
+
+    return timestampPos[idx];
+}
+
+/**
+ * @brief LogFile::recordPacket The UAVTalk packet of the record at index idx.
+ * Packets of indexed logs are not copied out of the mapping.
+ * @return the packet, or an empty array if the record is corrupted
+ */
+QByteArray LogFile::recordPacket(quint32 idx)
+{
+    quint64 recordPos = recordPosition(idx);
+    qint64 dataSize;
+
+    if (mappedLog != NULL) {
+        if (recordPos + INDEXEDLOG_RECORD_HEADER_LENGTH > recordsEnd) {
+            qDebug() << "Error: Logfile corrupted! Record outside the log at " << recordPos << "\n";
+            return QByteArray();
+        }
+
+        memcpy(&dataSize, mappedLog + recordPos + sizeof(quint32), sizeof(dataSize));
+
+        if (dataSize<1 || dataSize>(1024*1024) ||
+                recordPos + INDEXEDLOG_RECORD_HEADER_LENGTH + dataSize > recordsEnd) {
+            qDebug() << "Error: Logfile corrupted! Unlikely packet size: " << dataSize << "\n";
+            return QByteArray();
+        }
+
+        return QByteArray::fromRawData((const char *) mappedLog + recordPos + INDEXEDLOG_RECORD_HEADER_LENGTH, dataSize);
+    }
+
+    if (!file.seek(recordPos + sizeof(quint32)) ||
+            file.read((char *) &dataSize, sizeof(dataSize)) != sizeof(dataSize))
+        return QByteArray();
+
+    if (dataSize<1 || dataSize>(1024*1024)) {
+        qDebug() << "Error: Logfile corrupted! Unlikely packet size: " << dataSize << "\n";
+        return QByteArray();
+    }
+    if (file.bytesAvailable() < dataSize)
+        return QByteArray();
+
+    return file.read(dataSize);
+}
+
+/**
+ * @brief LogFile::appendLatest Queues the latest record of every object instance,
+ * in log order
+ * @param latest the latest record of each instance before begin, by instance key
+ * @param begin first record to take into account
+ * @param end record after the last one to take into account
+ * @return false if a record is corrupted
+ */
+bool LogFile::appendLatest(QHash<quint64, quint32> latest, quint32 begin, quint32 end)
+{
+    for (quint32 idx = begin; idx < end; idx++) {
+        QByteArray packet = recordPacket(idx);
+        if (packet.isEmpty())
+            return false;
+
+        latest.insert(instanceKeys.key(packet.constData(), packet.size()), idx);
+    }
+
+    QList<quint32> records = latest.values();
+    qSort(records);
+
+    QMutexLocker locker(&mutex);
+    foreach (quint32 idx, records) {
+        QByteArray packet = recordPacket(idx);
+        if (packet.isEmpty())
+            return false;
+
+        dataBuffer.append(packet);
+    }
+
+    return true;
+}
+
+/**
+ * @brief LogFile::restoreState Queues the packets which bring every object instance
+ * to the state it had just before record idx. Starts from the closest keyframe, so
+ * at most one keyframe period of the log is read.
+ * @return true if the log has keyframes and the state was queued
+ */
+bool LogFile::restoreState(quint32 idx)
+{
+    if (keyframeIndexCount == 0)
+        return false;
+
+    // Bisect for the first keyframe after idx, the one before it is the closest
+    quint32 lo = 0;
+    quint32 hi = keyframeIndexCount;
+    while (lo < hi) {
+        quint32 mid = lo + (hi - lo) / 2;
+        if (keyframeIndex[mid].record <= idx)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    QHash<quint64, quint32> latest;
+    quint32 begin = 0;
+
+    if (lo > 0) {
+        const IndexedLogKeyframeEntry &keyframe = keyframeIndex[lo - 1];
+        if (keyframe.listOffset + (quint64) keyframe.count * sizeof(quint32) > mappedSize)
+            return false;
+
+        const quint32 *records = (const quint32 *) (mappedLog + keyframe.listOffset);
+        for (quint32 i = 0; i < keyframe.count; i++) {
+            if (records[i] >= timeIndexCount)
+                continue;
+
+            QByteArray packet = recordPacket(records[i]);
+            if (!packet.isEmpty())
+                latest.insert(instanceKeys.key(packet.constData(), packet.size()), records[i]);
+        }
+
+        begin = keyframe.record;
+    }
+
+    return appendLatest(latest, begin, idx);
+}
+
+/**
+ * @brief LogFile::mapIndex Checks for an index footer and, if there is one, maps
+ * the log. Logs without a valid footer are replayed by scanning, as before.
+ * @return true if the log is indexed and was mapped
+ */
+bool LogFile::mapIndex()
+{
+    quint64 fileSize = file.size();
+    recordsEnd = fileSize;
+
+    qint64 bodyStart = file.pos();
+    if (fileSize < bodyStart + sizeof(IndexedLogFooter))
+        return false;
+
+    IndexedLogFooter footer;
+    file.seek(fileSize - sizeof(footer));
+    bool haveFooter = file.read((char *) &footer, sizeof(footer)) == sizeof(footer);
+    file.seek(bodyStart);
+
+    if (!haveFooter || memcmp(footer.magic, INDEXEDLOG_MAGIC, sizeof(footer.magic)) != 0)
+        return false;
 
-    qDebug() << "Replaying at: " << lastTimeStamp << ", but requestion at" << val*1000;
+    // Check that the tables lie inside the file before trusting anything in them.
+    // The counts are checked first so that the sizes cannot overflow.
+    if (footer.timeIndexCount > 0xFFFFFFFF ||
+            footer.timeIndexCount > fileSize / sizeof(IndexedLogTimeEntry) ||
+            footer.objectIndexCount > fileSize / sizeof(IndexedLogObjectEntry) ||
+            footer.timeIndexOffset < (quint64) bodyStart || footer.timeIndexOffset > fileSize ||
+            footer.objectIndexOffset > fileSize ||
+            footer.timeIndexCount * sizeof(IndexedLogTimeEntry) > fileSize - footer.timeIndexOffset ||
+            footer.objectIndexCount * sizeof(IndexedLogObjectEntry) > fileSize - footer.objectIndexOffset) {
+        qDebug() << "Logfile index is corrupted, falling back to scanning the log";
+        return false;
+    }
+
+    // Even if the map fails, the scan must not run into the index
+    recordsEnd = footer.timeIndexOffset;
+
+    uchar *map = file.map(0, fileSize);
+    if (map == NULL) {
+        qDebug() << "Unable to map " << file.fileName() << ", falling back to scanning the log";
+        return false;
+    }
+
+    mappedLog = map;
+    mappedSize = fileSize;
+    timeIndex = (const IndexedLogTimeEntry *) (mappedLog + footer.timeIndexOffset);
+    timeIndexCount = footer.timeIndexCount;
+    objectIndex = (const IndexedLogObjectEntry *) (mappedLog + footer.objectIndexOffset);
+    objectIndexCount = footer.objectIndexCount;
+
+    // Keyframes are optional, older indexed logs replay without them
+    IndexedLogKeyframeFooter keyframeFooter;
+    if (fileSize >= bodyStart + sizeof(footer) + sizeof(keyframeFooter)) {
+        memcpy(&keyframeFooter, mappedLog + fileSize - sizeof(footer) - sizeof(keyframeFooter), sizeof(keyframeFooter));
+
+        if (memcmp(keyframeFooter.magic, INDEXEDLOG_KEYFRAME_MAGIC, sizeof(keyframeFooter.magic)) == 0 &&
+                keyframeFooter.keyframeIndexCount <= 0xFFFFFFFF &&
+                keyframeFooter.keyframeIndexCount <= fileSize / sizeof(IndexedLogKeyframeEntry) &&
+                keyframeFooter.keyframeIndexOffset >= recordsEnd && keyframeFooter.keyframeIndexOffset <= fileSize &&
+                keyframeFooter.keyframeIndexCount * sizeof(IndexedLogKeyframeEntry) <= fileSize - keyframeFooter.keyframeIndexOffset) {
+            keyframeIndex = (const IndexedLogKeyframeEntry *) (mappedLog + keyframeFooter.keyframeIndexOffset);
+            keyframeIndexCount = keyframeFooter.keyframeIndexCount;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief LogFile::readHeader Reads the text header at the start of a log
+ * @param file the log, positioned at its start
+ * @param gitHash set to the git hash the log was written with
+ * @param uavoHash set to the UAVO hash the log was written with
+ * @return true if the header/body separator was found. Otherwise the
+ * file is rewound to its start.
+ */
+bool LogFile::readHeader(QFile *file, QString *gitHash, QString *uavoHash)
+{
+    file->readLine(); //Read first line of log file. This assumes that the logfile is of the new format.
+    *gitHash = file->readLine().trimmed(); //Read second line of log file. This assumes that the logfile is of the new format.
+    *uavoHash = file->readLine().trimmed(); //Read third line of log file. This assumes that the logfile is of the new format.
+
+    QString tmpLine=file->readLine(); //Look for the header/body separation string.
+    int cnt=0;
+    while (tmpLine!="##\n" && cnt < 10 && !file->atEnd()){
+        tmpLine=file->readLine().trimmed();
+        cnt++;
+    }
+
+    //Check if we reached the end of the file before finding the separation string
+    if (cnt >=10 || file->atEnd()){
+        //Since we could not find the file separator, we need to return to the beginning of the file
+        file->seek(0);
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief LogFile::convertToIndexed Converts a .tll log into the indexed format.
+ * The records are copied unchanged, so this only has to be done once per log.
+ * @param logFileName the .tll log to read
+ * @param indexedFileName the indexed log to write
+ * @return true if successful
+ */
+bool LogFile::convertToIndexed(QString logFileName, QString indexedFileName)
+{
+    QFile in(logFileName);
+    if (!in.open(QIODevice::ReadOnly))
+        return false;
+
+    // The indexed log is newer than the original, so it would be reused on
+    // the next replay. Only move it into place once it is complete.
+    QFile out(indexedFileName + ".part");
+    if (!out.open(QIODevice::WriteOnly))
+        return false;
+
+    bool converted = writeIndexed(&in, &out);
+    out.close();
+
+    if (converted) {
+        QFile::remove(indexedFileName);
+        converted = out.rename(indexedFileName);
+    }
+    if (!converted)
+        out.remove();
+
+    return converted;
+}
+
+/**
+ * @brief LogFile::writeIndexed Copies the records of a .tll log into an indexed log
+ * @param in the .tll log, at its start
+ * @param out the indexed log, empty
+ * @return true if successful
+ */
+bool LogFile::writeIndexed(QFile *in, QFile *out)
+{
+    // Carry the original header across, so the hashes still describe the data
+    QString gitHash;
+    QString uavoHash;
+    readHeader(in, &gitHash, &uavoHash);
+
+    QTextStream header(out);
+    header << "Tau Labs git hash:\n" <<  gitHash << "\n" << uavoHash << "\n##\n";
+    header.flush();
+
+    IndexedLogWriter writer;
+    if (!writer.begin(out))
+        return false;
+
+    while (in->bytesAvailable() >= (qint64) INDEXEDLOG_RECORD_HEADER_LENGTH) {
+        quint32 timeStamp;
+        qint64 dataSize;
+
+        in->read((char *) &timeStamp, sizeof(timeStamp));
+        in->read((char *) &dataSize, sizeof(dataSize));
+
+        // Resync exactly like the replay scan does
+        if ((dataSize & 0xFFFFFFFFFFFF0000)!=0){
+            in->seek(in->pos() - INDEXEDLOG_RECORD_HEADER_LENGTH + 1);
+            continue;
+        }
+
+        if (in->bytesAvailable() < dataSize)
+            break;
+
+        QByteArray packet = in->read(dataSize);
+        if (!writer.writeRecord(timeStamp, packet.constData(), dataSize))
+            return false;
+    }
+
+    return writer.finish();
+}
+
+
+LogInstanceKeys::LogInstanceKeys() :
+    objManager(NULL)
+{
 }
 
+/**
+ * @brief LogInstanceKeys::key Identifies the object instance a UAVTalk packet updates
+ * @return (objId << 16) | instId, or 0 if the packet is too short to carry an object ID
+ */
+quint64 LogInstanceKeys::key(const char *packet, qint64 size)
+{
+    if (size < (qint64) (INDEXEDLOG_UAVTALK_OBJID_OFFSET + sizeof(quint32)))
+        return 0;
+
+    quint32 objId = qFromLittleEndian<quint32>((const uchar *) packet + INDEXEDLOG_UAVTALK_OBJID_OFFSET);
+
+    QHash<quint32, bool>::const_iterator it = multiInstance.constFind(objId);
+    if (it == multiInstance.constEnd()) {
+        ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
+        if (objManager == NULL && pm != NULL)
+            objManager = pm->getObject<UAVObjectManager>();
+
+        UAVObject *obj = objManager != NULL ? objManager->getObject(objId) : NULL;
+        it = multiInstance.insert(objId, obj != NULL && !obj->isSingleInstance());
+    }
+
+    quint16 instId = 0;
+    if (it.value() && size >= (qint64) (INDEXEDLOG_UAVTALK_INSTID_OFFSET + sizeof(quint16)))
+        instId = qFromLittleEndian<quint16>((const uchar *) packet + INDEXEDLOG_UAVTALK_INSTID_OFFSET);
+
+    return ((quint64) objId << 16) | instId;
+}
+
+
+IndexedLogWriter::IndexedLogWriter() :
+    file(NULL),
+    recordCount(0),
+    nextKeyframeTime(0)
+{
+}
+
+/**
+ * @brief IndexedLogWriter::begin Starts indexing the records written to logFile
+ * @param logFile the log, positioned after its header
+ * @return true if successful
+ */
+bool IndexedLogWriter::begin(QFile *logFile)
+{
+    if (!timeIndexSpool.open())
+        return false;
+    timeIndexSpool.resize(0);
+
+    file = logFile;
+    recordCount = 0;
+    objectRecords.clear();
+    latestRecords.clear();
+    keyframes.clear();
+    keyframeRecords.clear();
+    return true;
+}
+
+/**
+ * @brief IndexedLogWriter::writeRecord Writes one record to the log and indexes it
+ * @return true if successful
+ */
+bool IndexedLogWriter::writeRecord(quint32 timeStamp, const char *data, qint64 dataSize)
+{
+    IndexedLogTimeEntry entry;
+    entry.timestamp = timeStamp;
+    entry.offset = file->pos();
+    entry.objId = 0;
+    if (dataSize >= (qint64) (INDEXEDLOG_UAVTALK_OBJID_OFFSET + sizeof(quint32)))
+        entry.objId = qFromLittleEndian<quint32>((const uchar *) data + INDEXEDLOG_UAVTALK_OBJID_OFFSET);
+
+    // The keyframe of each period goes in front of its first record
+    if (recordCount == 0)
+        nextKeyframeTime = timeStamp + INDEXEDLOG_KEYFRAME_PERIOD_MS;
+    else if (timeStamp >= nextKeyframeTime)
+        addKeyframe(timeStamp);
+
+    if (file->write((const char *) &timeStamp, sizeof(timeStamp)) != sizeof(timeStamp) ||
+            file->write((const char *) &dataSize, sizeof(dataSize)) != sizeof(dataSize) ||
+            file->write(data, dataSize) != dataSize)
+        return false;
+
+    if (timeIndexSpool.write((const char *) &entry, sizeof(entry)) != sizeof(entry))
+        return false;
+
+    objectRecords[entry.objId].append(recordCount);
+
+    quint64 key = instanceKeys.key(data, dataSize);
+    if (key != 0)
+        latestRecords[key] = recordCount;
+
+    recordCount++;
+
+    return true;
+}
+
+/**
+ * @brief IndexedLogWriter::finish Appends the indexes and the footer to the log
+ * @return true if successful
+ */
+bool IndexedLogWriter::finish()
+{
+    bool success = pad();
+
+    // Time index, copied over from the spool
+    quint64 timeIndexOffset = file->pos();
+    timeIndexSpool.seek(0);
+    while (success && !timeIndexSpool.atEnd())
+        success = file->write(timeIndexSpool.read(64 * 1024)) != -1;
+    timeIndexSpool.close();
+
+    // Object table, sorted by ID, followed by each object's record numbers
+    QList<quint32> objIds = objectRecords.keys();
+    qSort(objIds);
+
+    quint64 objectIndexOffset = file->pos();
+    quint64 listOffset = objectIndexOffset + objIds.size() * sizeof(IndexedLogObjectEntry);
+    foreach (quint32 objId, objIds) {
+        IndexedLogObjectEntry entry;
+        entry.objId = objId;
+        entry.count = objectRecords[objId].size();
+        entry.listOffset = listOffset;
+        listOffset += entry.count * sizeof(quint32);
+
+        if (file->write((const char *) &entry, sizeof(entry)) != sizeof(entry))
+            success = false;
+    }
+
+    foreach (quint32 objId, objIds) {
+        const QVector<quint32> &records = objectRecords[objId];
+        qint64 listSize = records.size() * sizeof(quint32);
+        if (file->write((const char *) records.constData(), listSize) != listSize)
+            success = false;
+    }
+
+    success = success && pad();
+
+    // Keyframe table, followed by each keyframe's record numbers
+    quint64 keyframeIndexOffset = file->pos();
+    quint64 keyframeListOffset = keyframeIndexOffset + keyframes.size() * sizeof(IndexedLogKeyframeEntry);
+    foreach (IndexedLogKeyframeEntry entry, keyframes) {
+        entry.listOffset = keyframeListOffset + entry.listOffset * sizeof(quint32);
+        if (file->write((const char *) &entry, sizeof(entry)) != sizeof(entry))
+            success = false;
+    }
+
+    qint64 keyframeListSize = keyframeRecords.size() * sizeof(quint32);
+    if (file->write((const char *) keyframeRecords.constData(), keyframeListSize) != keyframeListSize)
+        success = false;
+
+    success = success && pad();
+
+    IndexedLogKeyframeFooter keyframeFooter;
+    memcpy(keyframeFooter.magic, INDEXEDLOG_KEYFRAME_MAGIC, sizeof(keyframeFooter.magic));
+    keyframeFooter.keyframeIndexOffset = keyframeIndexOffset;
+    keyframeFooter.keyframeIndexCount = keyframes.size();
+    if (file->write((const char *) &keyframeFooter, sizeof(keyframeFooter)) != sizeof(keyframeFooter))
+        success = false;
+
+    IndexedLogFooter footer;
+    memcpy(footer.magic, INDEXEDLOG_MAGIC, sizeof(footer.magic));
+    footer.timeIndexOffset = timeIndexOffset;
+    footer.timeIndexCount = recordCount;
+    footer.objectIndexOffset = objectIndexOffset;
+    footer.objectIndexCount = objIds.size();
+    if (file->write((const char *) &footer, sizeof(footer)) != sizeof(footer))
+        success = false;
+
+    objectRecords.clear();
+    latestRecords.clear();
+    keyframes.clear();
+    keyframeRecords.clear();
+    file = NULL;
+
+    return success;
+}
+
+/**
+ * @brief IndexedLogWriter::addKeyframe Records the latest record of every object
+ * instance, ahead of the record about to be written
+ */
+void IndexedLogWriter::addKeyframe(quint32 timeStamp)
+{
+    IndexedLogKeyframeEntry keyframe;
+    keyframe.timestamp = timeStamp;
+    keyframe.record = recordCount;
+    keyframe.count = latestRecords.size();
+    keyframe.reserved = 0;
+    // Position in keyframeRecords, until finish() knows where the lists go
+    keyframe.listOffset = keyframeRecords.size();
+    keyframes.append(keyframe);
+
+    QList<quint32> records = latestRecords.values();
+    qSort(records);
+    foreach (quint32 record, records)
+        keyframeRecords.append(record);
+
+    nextKeyframeTime = timeStamp + INDEXEDLOG_KEYFRAME_PERIOD_MS;
+}
+
+/**
+ * @brief IndexedLogWriter::pad Pads the log to an 8-byte boundary, so the next table can be used in place
+ */
+bool IndexedLogWriter::pad()
+{
+    static const char zeros[8] = {0};
+    qint64 padding = (8 - (file->pos() % 8)) % 8;
+
+    return file->write(zeros, padding) == padding;
+}
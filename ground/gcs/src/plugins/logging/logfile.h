@@ -7,9 +7,63 @@
 #include <QMutexLocker>
 #include <QDebug>
 #include <QBuffer>
+#include <QHash>
+#include <QTemporaryFile>
 #include "uavobjectmanager.h"
+#include "indexedlogformat.h"
 #include <math.h>
 
+/**
+ * @brief The LogInstanceKeys class tells the object instances of UAVTalk
+ * packets apart, as (objId << 16) | instId. Only multi-instance objects carry
+ * an instance ID, which is looked up once per object in the object manager.
+ * Objects it does not know are treated as single instance.
+ */
+class LogInstanceKeys
+{
+public:
+    LogInstanceKeys();
+
+    quint64 key(const char *packet, qint64 size);
+
+private:
+    UAVObjectManager *objManager;
+    QHash<quint32, bool> multiInstance;
+};
+
+/**
+ * @brief The IndexedLogWriter class builds the trailing indexes of an indexed
+ * log while its records are being written, and appends them on finish().
+ * The time index is spooled to a temporary file so that multi-hour logs do not
+ * have to keep it in memory. Keyframes only hold record numbers, one per object
+ * instance, so they stay small enough to be kept until then.
+ */
+class IndexedLogWriter
+{
+public:
+    IndexedLogWriter();
+
+    bool begin(QFile *logFile);
+    bool writeRecord(quint32 timeStamp, const char *data, qint64 dataSize);
+    bool finish();
+    bool isActive() const { return file != NULL; }
+
+private:
+    QFile *file;
+    QTemporaryFile timeIndexSpool;
+    quint64 recordCount;
+    QHash<quint32, QVector<quint32> > objectRecords;
+
+    LogInstanceKeys instanceKeys;
+    QHash<quint64, quint32> latestRecords;
+    QVector<IndexedLogKeyframeEntry> keyframes;
+    QVector<quint32> keyframeRecords;
+    quint32 nextKeyframeTime;
+
+    void addKeyframe(quint32 timeStamp);
+    bool pad();
+};
+
 class LogFile : public QIODevice
 {
     Q_OBJECT
@@ -26,9 +80,17 @@ public:
     bool startReplay();
     bool stopReplay();
 
+    bool isIndexed() const { return mappedLog != NULL; }
+    quint32 recordCount() const;
+    quint32 recordTimestamp(quint32 idx) const;
+    double replayDuration() const;
+
+    static bool convertToIndexed(QString logFileName, QString indexedFileName);
+
 public slots:
     void setReplaySpeed(double val) { playbackSpeed = val; qDebug() << "New playback speed: " << playbackSpeed; }
     void setReplayTime(double val);
+    void setFastForward(bool enabled) { fastForward = enabled; }
     void pauseReplay();
     void resumeReplay();
 
@@ -39,6 +101,7 @@ signals:
     void readReady();
     void replayStarted();
     void replayFinished();
+    void replayPosition(double seconds);
 
 protected:
     QByteArray dataBuffer;
@@ -46,7 +109,7 @@ protected:
     QTime myTime;
     QFile file;
     quint32 lastTimeStamp;
-    quint32 lastPlayTime;
+    double lastPlayTime;
     QMutex mutex;
 
 
@@ -54,11 +117,32 @@ protected:
     double playbackSpeed;
 
 private:
+    bool mapIndex();
+    quint64 recordPosition(quint32 idx) const;
+    QByteArray recordPacket(quint32 idx);
+    bool appendLatest(QHash<quint64, quint32> latest, quint32 begin, quint32 end);
+    bool restoreState(quint32 idx);
+    static bool readHeader(QFile *file, QString *gitHash, QString *uavoHash);
+    static bool writeIndexed(QFile *in, QFile *out);
+
+    IndexedLogWriter indexWriter;
+    uchar *mappedLog;
+    const IndexedLogTimeEntry *timeIndex;
+    const IndexedLogObjectEntry *objectIndex;
+    quint32 timeIndexCount;
+    quint32 objectIndexCount;
+    const IndexedLogKeyframeEntry *keyframeIndex;
+    quint32 keyframeIndexCount;
+    quint64 mappedSize;
+    quint64 recordsEnd;
+
     QList<quint32> timestampBuffer;
     QList<quint32> timestampPos;
     quint32 timestampBufferIdx;
-    quint32 lastTimeStampPos;
     quint32 firstTimestamp;
+
+    LogInstanceKeys instanceKeys;
+    bool fastForward;
 };
 
 #endif // LOGFILE_H
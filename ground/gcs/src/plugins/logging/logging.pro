@@ -6,6 +6,7 @@ include(../../taulabsgcsplugin.pri)
 include(logging_dependencies.pri)
 HEADERS += loggingplugin.h \
     logfile.h \
+    indexedlogformat.h \
     logginggadgetwidget.h \
     logginggadget.h \
     logginggadgetfactory.h \
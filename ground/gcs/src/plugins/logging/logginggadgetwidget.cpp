@@ -58,6 +58,10 @@ void LoggingGadgetWidget::setPlugin(LoggingPlugin * p)
     connect(m_logging->pauseButton,SIGNAL(clicked()),p->getLogfile(),SLOT(pauseReplay()));
     connect(m_logging->playbackSpeedSpinBox,SIGNAL(valueChanged(double)),p->getLogfile(),SLOT(setReplaySpeed(double)));
     connect(m_logging->jumpToTimeSpinBox,SIGNAL(valueChanged(double)),p->getLogfile(),SLOT(setReplayTime(double)));
+    connect(m_logging->fastForwardCheckBox,SIGNAL(toggled(bool)),p->getLogfile(),SLOT(setFastForward(bool)));
+    connect(m_logging->positionSlider,SIGNAL(sliderMoved(int)),this,SLOT(positionMoved(int)));
+    connect(p->getLogfile(),SIGNAL(replayStarted()),this,SLOT(replayStarted()));
+    connect(p->getLogfile(),SIGNAL(replayPosition(double)),this,SLOT(replayPosition(double)));
 
     void pauseReplay();
     void resumeReplay();
@@ -69,6 +73,34 @@ void LoggingGadgetWidget::stateChanged(QString status)
     m_logging->statusLabel->setText(status);
 }
 
+/**
+ * @brief LoggingGadgetWidget::replayStarted Sizes the position slider to the log
+ */
+void LoggingGadgetWidget::replayStarted()
+{
+    m_logging->positionSlider->setRange(0, ceil(loggingPlugin->getLogfile()->replayDuration()));
+    m_logging->positionSlider->setValue(0);
+}
+
+/**
+ * @brief LoggingGadgetWidget::replayPosition Follows the replay with the slider,
+ * unless the user is dragging it
+ */
+void LoggingGadgetWidget::replayPosition(double seconds)
+{
+    if (!m_logging->positionSlider->isSliderDown())
+        m_logging->positionSlider->setValue(seconds);
+}
+
+/**
+ * @brief LoggingGadgetWidget::positionMoved Seeks while the slider is dragged, the
+ * object state is restored from the log's keyframes so this stays interactive
+ */
+void LoggingGadgetWidget::positionMoved(int seconds)
+{
+    loggingPlugin->getLogfile()->setReplayTime(seconds);
+}
+
 /**
   * @}
   * @}
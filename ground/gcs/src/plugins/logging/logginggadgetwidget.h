@@ -48,6 +48,9 @@ public:
 
 protected slots:
     void stateChanged(QString status);
+    void replayStarted();
+    void replayPosition(double seconds);
+    void positionMoved(int seconds);
 
 signals:
     void pause();
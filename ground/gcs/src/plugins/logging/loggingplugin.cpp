@@ -36,6 +36,8 @@
 #include <QStringList>
 #include <QDir>
 #include <QFileDialog>
+#include <QFileInfo>
+#include <QMessageBox>
 #include <QList>
 #include <QErrorMessage>
 #include <QWriteLocker>
@@ -78,7 +80,7 @@ QIODevice* LoggingConnection::openDevice(IDevice *deviceName)
     if (logFile.isOpen()){
         logFile.close();
     }
-    QString fileName = QFileDialog::getOpenFileName(NULL, tr("Open file"), QString(""), tr("Tau Labs Log (*.tll)"));
+    QString fileName = QFileDialog::getOpenFileName(NULL, tr("Open file"), QString(""), tr("Tau Labs Log (*.tli *.tll)"));
     if (!fileName.isNull()) {
         startReplay(fileName);
     }
@@ -87,6 +89,25 @@ QIODevice* LoggingConnection::openDevice(IDevice *deviceName)
 
 void LoggingConnection::startReplay(QString file)
 {
+    // Old logs have to be scanned from end to end before they can be replayed.
+    // Offer to convert them once to the indexed format, which opens instantly.
+    QFileInfo fileInfo(file);
+    if (fileInfo.suffix() != INDEXEDLOG_SUFFIX) {
+        QString indexedFile = fileInfo.path() + "/" + fileInfo.completeBaseName() + "." + INDEXEDLOG_SUFFIX;
+        QFileInfo indexedFileInfo(indexedFile);
+
+        if (indexedFileInfo.exists() && indexedFileInfo.lastModified() >= fileInfo.lastModified()) {
+            file = indexedFile;
+        } else if (QMessageBox::question(NULL, tr("Convert log file"),
+                                         tr("Convert %1 to the indexed log format? Indexed logs open and seek much faster.").arg(fileInfo.fileName()),
+                                         QMessageBox::Yes | QMessageBox::No) == QMessageBox::Yes) {
+            if (LogFile::convertToIndexed(file, indexedFile))
+                file = indexedFile;
+            else
+                qDebug() << "Unable to convert " << file << ", replaying it as is";
+        }
+    }
+
     logFile.setFileName(file);
     if(logFile.open(QIODevice::ReadOnly)) {
         qDebug() << "Replaying " << file;
@@ -366,8 +387,8 @@ void LoggingPlugin::toggleLogging()
     {
 
         QString fileName = QFileDialog::getSaveFileName(NULL, tr("Start Log"),
-                                    tr("TauLabs-%0.tll").arg(QDateTime::currentDateTime().toString("yyyy-MM-dd_hh-mm-ss")),
-                                    tr("Tau Labs Log (*.tll)"));
+                                    tr("TauLabs-%0.tli").arg(QDateTime::currentDateTime().toString("yyyy-MM-dd_hh-mm-ss")),
+                                    tr("Tau Labs Indexed Log (*.tli);;Tau Labs Log (*.tll)"));
         if (fileName.isEmpty())
             return;
 
@@ -28,7 +28,7 @@
 
 #include "pfdgadgetwidget.h"
 #include <utils/stylehelper.h>
-#include <utils/cachedsvgitem.h>
+#include <utils/atlassvgitem.h>
 #include <iostream>
 #include <QDebug>
 #include <QPainter>
@@ -57,6 +57,7 @@ PFDGadgetWidget::PFDGadgetWidget(QWidget *parent) : QGraphicsView(parent),
     gpsObj(NULL),
     gcsTelemetryObj(NULL),
     gcsBatteryObj(NULL),
+    frameMs(30),
     pfdError(true),
     hqFonts(false),
     beSmooth(false)
@@ -72,19 +73,50 @@ PFDGadgetWidget::PFDGadgetWidget(QWidget *parent) : QGraphicsView(parent),
     //setRenderHints(QPainter::HighQualityAntialiasing);
 
     m_renderer = new QSvgRenderer();
+}
 
-    // This timer mechanism makes needles rotate smoothly
-    connect(&dialTimer, SIGNAL(timeout()), this, SLOT(moveNeedles()));
-    dialTimer.start(30);
+PFDGadgetWidget::~PFDGadgetWidget()
+{
+    if (Core::AnimationClock::instance())
+        Core::AnimationClock::instance()->remove(this);
+}
 
-    connect(&skyDialTimer, SIGNAL(timeout()), this, SLOT(moveSky()));
-    skyDialTimer.start(30);
+/*!
+  \brief Have the elements moved on every frame until they settle
+  */
+void PFDGadgetWidget::startAnimation()
+{
+    if (Core::AnimationClock::instance())
+        Core::AnimationClock::instance()->wake(this);
 }
 
-PFDGadgetWidget::~PFDGadgetWidget()
+/*!
+  \brief Called by the animation clock, makes the elements move smoothly
+
+  Both groups of elements are moved in the same frame and repainted together.
+  */
+bool PFDGadgetWidget::animationStep(qint64 elapsedMs)
 {
-    skyDialTimer.stop();
-    dialTimer.stop();
+    frameMs = elapsedMs;
+
+    bool skyMoving = moveSky();
+    bool needlesMoving = moveNeedles();
+
+    if (skyMoving || needlesMoving)
+        scene()->update(sceneRect());
+
+    return skyMoving || needlesMoving;
+}
+
+/*!
+  \brief Fraction of the distance to the target to move in this frame
+
+  The smoothing was tuned for a 30ms step, this keeps the needles moving at
+  the same speed whatever the frame rate of the animation clock.
+  */
+qreal PFDGadgetWidget::smoothing(qreal perStep) const
+{
+    return Core::IAnimated::smoothingFactor(perStep, frameMs, 30);
 }
 
 void PFDGadgetWidget::setToolTipPrivate()
@@ -286,8 +318,7 @@ void PFDGadgetWidget::updateAttitude(UAVObject *object1) {
         }
         headingTarget = floor(headingTarget*10)/10; // Avoid stupid redraws
 
-        if (!dialTimer.isActive())
-            dialTimer.start(); // Rearm the dial Timer which might be stopped.
+        startAnimation();
 
     } else {
         qDebug() << "Unable to get one of the fields for attitude update";
@@ -317,8 +348,7 @@ void PFDGadgetWidget::updateGroundspeed(UAVObject *object) {
         double val = floor(sqrt(pow(northField->getDouble(),2) + pow(eastField->getDouble(),2))*10)/10;
         groundspeedTarget = 3.6*val*speedScaleHeight/30;
 
-        if (!dialTimer.isActive())
-            dialTimer.start(); // Rearm the dial Timer which might be stopped.
+        startAnimation();
 
     } else {
         qDebug() << "UpdateHeading: Wrong field, maybe an issue with object disconnection ?";
@@ -334,8 +364,7 @@ void PFDGadgetWidget::updateAirspeed(UAVObject *object) {
     if (airspeedField) {
         airspeedTarget = airspeedField->getDouble();
 
-        if (!dialTimer.isActive())
-            dialTimer.start(); // Rearm the dial Timer which might be stopped.
+        startAnimation();
 
     } else {
         qDebug() << "UpdateHeading: Wrong field, maybe an issue with object disconnection ?";
@@ -350,8 +379,7 @@ void PFDGadgetWidget::updateAltitude(UAVObject *object) {
     if (downField) {
         altitudeTarget = -downField->getDouble();
 
-        if (!dialTimer.isActive())
-            dialTimer.start(); // Rearm the dial Timer which might be stopped.
+        startAnimation();
 
     } else {
         qDebug() << "Unable to get field for altitude update.  Obj: " << object->getName();
@@ -421,7 +449,7 @@ void PFDGadgetWidget::setDialFile(QString dfn)
      - Battery stats: battery-txt
  */
          l_scene->clear(); // Deletes all items contained in the scene as well.
-         m_background = new CachedSvgItem();
+         m_background = new AtlasSvgItem();
          // All other items will be clipped to the shape of the background
          m_background->setFlags(QGraphicsItem::ItemClipsChildrenToShape|
                                 QGraphicsItem::ItemClipsToShape);
@@ -429,27 +457,27 @@ void PFDGadgetWidget::setDialFile(QString dfn)
          m_background->setElementId("background");
          l_scene->addItem(m_background);
 
-         m_world = new CachedSvgItem();
+         m_world = new AtlasSvgItem();
          m_world->setParentItem(m_background);
          m_world->setSharedRenderer(m_renderer);
          m_world->setElementId("world");
 
          // red Roll scale: rollscale
-         m_rollscale = new CachedSvgItem();
+         m_rollscale = new AtlasSvgItem();
          m_rollscale->setSharedRenderer(m_renderer);
          m_rollscale->setElementId("rollscale");
          l_scene->addItem(m_rollscale);
 
          // Home point:
-         m_homewaypoint = new CachedSvgItem();
+         m_homewaypoint = new AtlasSvgItem();
          // Next point:
-         m_nextwaypoint = new CachedSvgItem();
+         m_nextwaypoint = new AtlasSvgItem();
          // Home point bearing:
-         m_homepointbearing = new CachedSvgItem();
+         m_homepointbearing = new AtlasSvgItem();
          // Next point bearing:
-         m_nextpointbearing = new CachedSvgItem();
+         m_nextpointbearing = new AtlasSvgItem();
 
-         QGraphicsSvgItem *m_foreground = new CachedSvgItem();
+         QGraphicsSvgItem *m_foreground = new AtlasSvgItem();
          m_foreground->setParentItem(m_background);
          m_foreground->setSharedRenderer(m_renderer);
          m_foreground->setElementId("foreground");
@@ -465,7 +493,7 @@ void PFDGadgetWidget::setDialFile(QString dfn)
          // into a QGraphicsSvgItem which we will display at the same
          // place: we do this so that the heading scale can be clipped to
          // the compass dial region.
-         m_compass = new CachedSvgItem();
+         m_compass = new AtlasSvgItem();
          m_compass->setSharedRenderer(m_renderer);
          m_compass->setElementId("compass");
          m_compass->setFlags(QGraphicsItem::ItemClipsChildrenToShape|
@@ -476,7 +504,7 @@ void PFDGadgetWidget::setDialFile(QString dfn)
          m_compass->setTransform(matrix,false);
 
          // Now place the compass scale inside:
-         m_compassband = new CachedSvgItem();
+         m_compassband = new AtlasSvgItem();
          m_compassband->setSharedRenderer(m_renderer);
          m_compassband->setElementId("compass-band");
          m_compassband->setParentItem(m_compass);
@@ -497,7 +525,7 @@ void PFDGadgetWidget::setDialFile(QString dfn)
          compassMatrix = m_renderer->matrixForElement("speed-bg");
          startX = compassMatrix.mapRect(m_renderer->boundsOnElement("speed-bg")).x();
          startY = compassMatrix.mapRect(m_renderer->boundsOnElement("speed-bg")).y();
-         QGraphicsSvgItem *verticalbg = new CachedSvgItem();
+         QGraphicsSvgItem *verticalbg = new AtlasSvgItem();
          verticalbg->setSharedRenderer(m_renderer);
          verticalbg->setElementId("speed-bg");
          verticalbg->setFlags(QGraphicsItem::ItemClipsChildrenToShape|
@@ -512,7 +540,7 @@ void PFDGadgetWidget::setDialFile(QString dfn)
          m_speedscale = new QGraphicsItemGroup();
          m_speedscale->setParentItem(verticalbg);
 
-         QGraphicsSvgItem *speedscalelines = new CachedSvgItem();
+         QGraphicsSvgItem *speedscalelines = new AtlasSvgItem();
          speedscalelines->setSharedRenderer(m_renderer);
          speedscalelines->setElementId("speed-scale");
          speedScaleHeight = m_renderer->matrixForElement("speed-scale").mapRect(
@@ -558,7 +586,7 @@ void PFDGadgetWidget::setDialFile(QString dfn)
          startX = compassMatrix.mapRect(m_renderer->boundsOnElement("speed-window")).x();
          startY = compassMatrix.mapRect(m_renderer->boundsOnElement("speed-window")).y();
          qreal speedWindowHeight = compassMatrix.mapRect(m_renderer->boundsOnElement("speed-window")).height();
-         QGraphicsSvgItem *speedwindow = new CachedSvgItem();
+         QGraphicsSvgItem *speedwindow = new AtlasSvgItem();
          speedwindow->setSharedRenderer(m_renderer);
          speedwindow->setElementId("speed-window");
          speedwindow->setFlags(QGraphicsItem::ItemClipsChildrenToShape|
@@ -583,7 +611,7 @@ void PFDGadgetWidget::setDialFile(QString dfn)
          compassMatrix = m_renderer->matrixForElement("altitude-bg");
          startX = compassMatrix.mapRect(m_renderer->boundsOnElement("altitude-bg")).x();
          startY = compassMatrix.mapRect(m_renderer->boundsOnElement("altitude-bg")).y();
-         verticalbg = new CachedSvgItem();
+         verticalbg = new AtlasSvgItem();
          verticalbg->setSharedRenderer(m_renderer);
          verticalbg->setElementId("altitude-bg");
          verticalbg->setFlags(QGraphicsItem::ItemClipsChildrenToShape|
@@ -598,7 +626,7 @@ void PFDGadgetWidget::setDialFile(QString dfn)
          m_altitudescale = new QGraphicsItemGroup();
          m_altitudescale->setParentItem(verticalbg);
 
-         QGraphicsSvgItem *altitudescalelines = new CachedSvgItem();
+         QGraphicsSvgItem *altitudescalelines = new AtlasSvgItem();
          altitudescalelines->setSharedRenderer(m_renderer);
          altitudescalelines->setElementId("altitude-scale");
          altitudeScaleHeight = m_renderer->matrixForElement("altitude-scale").mapRect(
@@ -639,7 +667,7 @@ void PFDGadgetWidget::setDialFile(QString dfn)
          startX = compassMatrix.mapRect(m_renderer->boundsOnElement("altitude-window")).x();
          startY = compassMatrix.mapRect(m_renderer->boundsOnElement("altitude-window")).y();
          qreal altitudeWindowHeight = compassMatrix.mapRect(m_renderer->boundsOnElement("altitude-window")).height();
-         QGraphicsSvgItem *altitudewindow = new CachedSvgItem();
+         QGraphicsSvgItem *altitudewindow = new AtlasSvgItem();
          altitudewindow->setSharedRenderer(m_renderer);
          altitudewindow->setElementId("altitude-window");
          altitudewindow->setFlags(QGraphicsItem::ItemClipsChildrenToShape|
@@ -668,7 +696,7 @@ void PFDGadgetWidget::setDialFile(QString dfn)
              compassMatrix = m_renderer->matrixForElement("gcstelemetry-Disconnected");
              startX = compassMatrix.mapRect(m_renderer->boundsOnElement("gcstelemetry-Disconnected")).x();
              startY = compassMatrix.mapRect(m_renderer->boundsOnElement("gcstelemetry-Disconnected")).y();
-             gcsTelemetryArrow = new CachedSvgItem();
+             gcsTelemetryArrow = new AtlasSvgItem();
              gcsTelemetryArrow->setSharedRenderer(m_renderer);
              gcsTelemetryArrow->setElementId("gcstelemetry-Disconnected");
              l_scene->addItem(gcsTelemetryArrow);
@@ -704,7 +732,7 @@ void PFDGadgetWidget::setDialFile(QString dfn)
          compassMatrix = m_renderer->matrixForElement("gcstelemetry-Disconnected");
          startX = compassMatrix.mapRect(m_renderer->boundsOnElement("gcstelemetry-Disconnected")).x();
          startY = compassMatrix.mapRect(m_renderer->boundsOnElement("gcstelemetry-Disconnected")).y();
-         gcsTelemetryArrow = new CachedSvgItem();
+         gcsTelemetryArrow = new AtlasSvgItem();
          gcsTelemetryArrow->setSharedRenderer(m_renderer);
          gcsTelemetryArrow->setElementId("gcstelemetry-Disconnected");
          l_scene->addItem(gcsTelemetryArrow);
@@ -737,7 +765,7 @@ void PFDGadgetWidget::setDialFile(QString dfn)
          compassMatrix = m_renderer->matrixForElement("gcstelemetry-Disconnected");
          startX = compassMatrix.mapRect(m_renderer->boundsOnElement("gcstelemetry-Disconnected")).x();
          startY = compassMatrix.mapRect(m_renderer->boundsOnElement("gcstelemetry-Disconnected")).y();
-         gcsTelemetryArrow = new CachedSvgItem();
+         gcsTelemetryArrow = new AtlasSvgItem();
          gcsTelemetryArrow->setSharedRenderer(m_renderer);
          gcsTelemetryArrow->setElementId("gcstelemetry-Disconnected");
          l_scene->addItem(gcsTelemetryArrow);
@@ -799,14 +827,13 @@ void PFDGadgetWidget::setDialFile(QString dfn)
         groundspeedValue = 0;
         altitudeValue = 0;
         pfdError = false;
-        if (!dialTimer.isActive())
-            dialTimer.start(); // Rearm the dial Timer which might be stopped.
+        startAnimation();
    }
    else
    { qDebug()<<"Error on PFD artwork file.";
        m_renderer->load(QString(":/pfd/images/pfd-default.svg"));
        l_scene->clear(); // This also deletes all items contained in the scene.
-       m_background = new CachedSvgItem();
+       m_background = new AtlasSvgItem();
        m_background->setSharedRenderer(m_renderer);
        l_scene->addItem(m_background);
        pfdError = true;
@@ -845,14 +872,13 @@ void PFDGadgetWidget::moveVerticalScales() {
 
 }
 
-void PFDGadgetWidget::moveSky() {
+bool PFDGadgetWidget::moveSky() {
     int dialCount = 2; // Gets decreased by one for each element
                        // which has finished moving
 //    qDebug() << "MoveSky";
     /// TODO: optimize!!!
     if (pfdError) {
-        //skyDialTimer.stop();
-        return;
+        return false;
     }
 
     // In some instances, it can happen that the rollValue & target are
@@ -861,14 +887,14 @@ void PFDGadgetWidget::moveSky() {
     // The strange check below works, it is a workaround because "isnan(double)"
     // is not supported on every compiler.
     if (rollTarget != rollTarget || pitchTarget != pitchTarget)
-        return;
+        return false;
     //////
     // Roll
     //////
     if (rollValue != rollTarget) {
         double rollDiff;
         if ((abs((rollValue-rollTarget)*10) > 5) && beSmooth ) {
-            rollDiff =(rollTarget - rollValue)/2;
+            rollDiff =(rollTarget - rollValue)*smoothing(0.5);
         } else {
             rollDiff = rollTarget - rollValue;
             dialCount--;
@@ -887,7 +913,7 @@ void PFDGadgetWidget::moveSky() {
         double pitchDiff;
         if ((abs((pitchValue-pitchTarget)*10) > 5) && beSmooth ) {
   //      if (0) {
-            pitchDiff = (pitchTarget - pitchValue)/2;
+            pitchDiff = (pitchTarget - pitchValue)*smoothing(0.5);
         } else {
             pitchDiff = pitchTarget - pitchValue;
             dialCount--;
@@ -901,11 +927,7 @@ void PFDGadgetWidget::moveSky() {
         dialCount--;
     }
 
-    if (dialCount)
-        scene()->update(sceneRect());
-  //  if (!dialCount)
-  //      skyDialTimer.stop();
-
+    return dialCount != 0;
 }
 
 
@@ -913,7 +935,7 @@ void PFDGadgetWidget::moveSky() {
 // Movement is smooth, starts fast and slows down when
 // approaching the target.
 //
-void PFDGadgetWidget::moveNeedles()
+bool PFDGadgetWidget::moveNeedles()
 {
     int dialCount = 3; // Gets decreased by one for each element
                        // which has finished moving
@@ -922,8 +944,7 @@ void PFDGadgetWidget::moveNeedles()
     /// TODO: optimize!!!
 
     if (pfdError) {
-    	dialTimer.stop();
-    	return;
+        return false;
     }
 
     //////
@@ -936,7 +957,7 @@ void PFDGadgetWidget::moveNeedles()
     if (headingValue != headingTarget) {
         double headingDiff;
         if ((abs((headingValue-headingTarget)*10) > 5) && beSmooth ) {
-            headingDiff = (headingTarget - headingValue)/5;
+            headingDiff = (headingTarget - headingValue)*smoothing(0.2);
         } else {
             headingDiff = headingTarget-headingValue;
             dialCount--;
@@ -965,7 +986,7 @@ void PFDGadgetWidget::moveNeedles()
     //////
     if (airspeedValue != airspeedTarget) {
         if ((abs(airspeedValue-airspeedTarget) > speedScaleHeight/100) && beSmooth ) {
-            airspeedValue += (airspeedTarget-airspeedValue)/2;
+            airspeedValue += (airspeedTarget-airspeedValue)*smoothing(0.5);
         } else {
             airspeedValue = airspeedTarget;
             dialCount--;
@@ -1040,7 +1061,7 @@ void PFDGadgetWidget::moveNeedles()
     //////
     if (altitudeValue != altitudeTarget) {
         if ((abs(altitudeValue-altitudeTarget) > altitudeScaleHeight/100) && beSmooth ) {
-            altitudeValue += (altitudeTarget-altitudeValue)/2;
+            altitudeValue += (altitudeTarget-altitudeValue)*smoothing(0.5);
         } else {
             altitudeValue = altitudeTarget;
             dialCount--;
@@ -1078,10 +1099,7 @@ void PFDGadgetWidget::moveNeedles()
         dialCount--;
     }
 
-   if (!dialCount)
-       dialTimer.stop();
-   else
-       scene()->update(sceneRect());
+   return dialCount != 0;
 }
 
 /**
@@ -32,14 +32,14 @@
 #include "extensionsystem/pluginmanager.h"
 #include "uavobjectmanager.h"
 #include "uavobject.h"
+#include <coreplugin/animationclock.h>
 #include <QGraphicsView>
 #include <QtSvg/QSvgRenderer>
 #include <QtSvg/QGraphicsSvgItem>
 
 #include <QFile>
-#include <QTimer>
 
-class PFDGadgetWidget : public QGraphicsView
+class PFDGadgetWidget : public QGraphicsView, public Core::IAnimated
 {
     Q_OBJECT
 
@@ -53,6 +53,7 @@ public:
    void enableOpenGL(bool flag);
    void setHqFonts(bool flag) { hqFonts = flag; }
    void enableSmoothUpdates(bool flag) { beSmooth = flag; }
+   bool animationStep(qint64 elapsedMs);
 
 
 public slots:
@@ -71,11 +72,14 @@ protected:
 
 
 private slots:
-   void moveNeedles();
-   void moveVerticalScales();
-   void moveSky();
    void setToolTipPrivate();
 private:
+   bool moveNeedles();
+   void moveVerticalScales();
+   bool moveSky();
+   void startAnimation();
+   qreal smoothing(qreal perStep) const;
+
    QSvgRenderer *m_renderer;
 
    // Background: background
@@ -139,13 +143,12 @@ private:
    UAVDataObject* gcsTelemetryObj;
    UAVDataObject* gcsBatteryObj;
 
-   // Rotation timer
-   QTimer dialTimer;
-   QTimer skyDialTimer;
-
    QString satString;
    QString batString;
 
+   // Length of the current animation frame
+   qint64 frameMs;
+
    // Flag to check for pfd Error
    bool pfdError;
    // Flag to enable better rendering of fonts in OpenGL
@@ -0,0 +1,192 @@
+/**
+ ******************************************************************************
+ *
+ * @file       plotdecimator.cpp
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2013
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup ScopePlugin Scope Gadget Plugin
+ * @{
+ * @brief The scope Gadget, graphically plots the states of UAVObjects
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "plotdecimator.h"
+
+#include <math.h>
+
+
+/**
+ * @brief PlotDecimator::PlotDecimator Default constructor. Until a resolution
+ * is set, every sample gets its own bucket.
+ */
+PlotDecimator::PlotDecimator() :
+    firstBucket(0),
+    columnWidth(0)
+{
+}
+
+
+/**
+ * @brief PlotDecimator::setResolution Sets the width of one pixel column, in x units
+ * @param xSpan Range of x covered by the plot canvas
+ * @param pixelColumns Width of the plot canvas, in pixels
+ * @return TRUE if the resolution changed and the buckets must be rebuilt
+ */
+bool PlotDecimator::setResolution(double xSpan, int pixelColumns)
+{
+    double newColumnWidth = 0;
+    if (xSpan > 0 && pixelColumns > 0)
+        newColumnWidth = xSpan / pixelColumns;
+
+    if (newColumnWidth == columnWidth)
+        return false;
+
+    columnWidth = newColumnWidth;
+    return true;
+}
+
+
+/**
+ * @brief PlotDecimator::clear Drops all buckets
+ */
+void PlotDecimator::clear()
+{
+    buckets.clear();
+    firstBucket = 0;
+}
+
+
+/**
+ * @brief PlotDecimator::append Adds one sample. Samples must arrive in increasing x order.
+ * @param x
+ * @param y
+ */
+void PlotDecimator::append(double x, double y)
+{
+    qint64 column;
+    if (columnWidth > 0)
+        column = (qint64) floor(x / columnWidth);
+    else
+        column = buckets.size(); // No resolution yet, so don't merge anything
+
+    if (buckets.size() > firstBucket && buckets.last().column == column) {
+        Bucket &bucket = buckets.last();
+        if (y < bucket.yMin) {
+            bucket.yMin = y;
+            bucket.xMin = x;
+        }
+        if (y > bucket.yMax) {
+            bucket.yMax = y;
+            bucket.xMax = x;
+        }
+        return;
+    }
+
+    Bucket bucket;
+    bucket.column = column;
+    bucket.xMin = bucket.xMax = x;
+    bucket.yMin = bucket.yMax = y;
+    buckets.append(bucket);
+}
+
+
+/**
+ * @brief PlotDecimator::removeOlderThan Drops the buckets which lie entirely before xMin
+ * @param xMin
+ */
+void PlotDecimator::removeOlderThan(double xMin)
+{
+    while (firstBucket < buckets.size() &&
+           buckets.at(firstBucket).xMin < xMin && buckets.at(firstBucket).xMax < xMin)
+        firstBucket++;
+
+    // Popping off the front of a QVector is O(n), so only compact once half of it is dead
+    if (firstBucket > 0 && firstBucket >= buckets.size() / 2) {
+        buckets.remove(0, firstBucket);
+        firstBucket = 0;
+    }
+}
+
+
+/**
+ * @brief PlotDecimator::rebuild Recomputes all buckets from the raw sample buffer.
+ * Only needed when the resolution changes.
+ * @param xData
+ * @param yData
+ */
+void PlotDecimator::rebuild(const QVector<double> &xData, const QVector<double> &yData)
+{
+    clear();
+
+    int numSamples = qMin(xData.size(), yData.size());
+    for (int i = 0; i < numSamples; i++)
+        append(xData.at(i), yData.at(i));
+}
+
+
+/**
+ * @brief PlotDecimator::fillSamples Writes out at most two points per bucket, in x order
+ * @param xOut
+ * @param yOut
+ */
+void PlotDecimator::fillSamples(QVector<double> &xOut, QVector<double> &yOut) const
+{
+    xOut.resize(0);
+    yOut.resize(0);
+
+    for (int i = firstBucket; i < buckets.size(); i++) {
+        const Bucket &bucket = buckets.at(i);
+
+        if (bucket.xMin == bucket.xMax) {
+            xOut.append(bucket.xMin);
+            yOut.append(bucket.yMin);
+        } else if (bucket.xMin < bucket.xMax) {
+            xOut.append(bucket.xMin);
+            yOut.append(bucket.yMin);
+            xOut.append(bucket.xMax);
+            yOut.append(bucket.yMax);
+        } else {
+            xOut.append(bucket.xMax);
+            yOut.append(bucket.yMax);
+            xOut.append(bucket.xMin);
+            yOut.append(bucket.yMin);
+        }
+    }
+}
+
+
+/**
+ * @brief PlotDecimator::decimate One-shot decimation of a sample buffer whose x
+ * values are not stable from one frame to the next, e.g. the sequential plot.
+ * @param xIn Raw x values, in increasing order
+ * @param yIn Raw y values
+ * @param xMin Left edge of the plot canvas
+ * @param xMax Right edge of the plot canvas
+ * @param pixelColumns Width of the plot canvas, in pixels
+ * @param xOut Decimated x values
+ * @param yOut Decimated y values
+ */
+void PlotDecimator::decimate(const QVector<double> &xIn, const QVector<double> &yIn,
+                             double xMin, double xMax, int pixelColumns,
+                             QVector<double> &xOut, QVector<double> &yOut)
+{
+    PlotDecimator decimator;
+    decimator.setResolution(xMax - xMin, pixelColumns);
+    decimator.rebuild(xIn, yIn);
+    decimator.fillSamples(xOut, yOut);
+}
@@ -0,0 +1,77 @@
+/**
+ ******************************************************************************
+ *
+ * @file       plotdecimator.h
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2013
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup ScopePlugin Scope Gadget Plugin
+ * @{
+ * @brief The scope Gadget, graphically plots the states of UAVObjects
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef PLOTDECIMATOR_H
+#define PLOTDECIMATOR_H
+
+#include <QVector>
+#include <QtGlobal>
+
+
+/**
+ * @brief The PlotDecimator class Level-of-detail layer between a curve's sample
+ * buffer and Qwt. Samples are binned into buckets one pixel column wide, and
+ * each bucket only remembers its extrema. A curve therefore never hands Qwt
+ * more than two points per pixel column, no matter how fast the data arrives.
+ *
+ * Bucket boundaries are anchored at x = 0 rather than at the start of the
+ * window, so a bucket never has to be recomputed as the window scrolls.
+ */
+class PlotDecimator
+{
+public:
+    PlotDecimator();
+
+    bool setResolution(double xSpan, int pixelColumns);
+    void clear();
+
+    void append(double x, double y);
+    void removeOlderThan(double xMin);
+    void rebuild(const QVector<double> &xData, const QVector<double> &yData);
+    void fillSamples(QVector<double> &xOut, QVector<double> &yOut) const;
+
+    int bucketCount() const {return buckets.size() - firstBucket;}
+
+    static void decimate(const QVector<double> &xIn, const QVector<double> &yIn,
+                         double xMin, double xMax, int pixelColumns,
+                         QVector<double> &xOut, QVector<double> &yOut);
+
+private:
+    struct Bucket {
+        qint64 column;
+        double xMin; //x of the smallest y in the bucket
+        double yMin;
+        double xMax; //x of the largest y in the bucket
+        double yMax;
+    };
+
+    QVector<Bucket> buckets;
+    int firstBucket; //Index of the oldest live bucket. Dead buckets are compacted lazily.
+    double columnWidth;
+};
+
+#endif // PLOTDECIMATOR_H
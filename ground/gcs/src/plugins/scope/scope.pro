@@ -16,6 +16,7 @@ HEADERS += scopeplugin.h \
     scopes3d/scopes3dconfig.h \
     scopesconfig.h \
     plotdata.h \
+    plotdecimator.h \
     scope_global.h
 HEADERS += scopegadgetoptionspage.h
 HEADERS += scopegadgetconfiguration.h
@@ -29,7 +30,8 @@ SOURCES += scopeplugin.cpp \
     scopes2d/scatterplotscopeconfig.cpp \
     scopes3d/spectrogramplotdata.cpp \
     scopes3d/spectrogramscopeconfig.cpp \
-    plotdata.cpp
+    plotdata.cpp \
+    plotdecimator.cpp
 SOURCES += scopegadgetoptionspage.cpp
 SOURCES += scopegadgetconfiguration.cpp
 SOURCES += scopegadget.cpp
@@ -36,6 +36,7 @@
 
 #include "qwt/src/qwt.h"
 #include "qwt/src/qwt_plot_histogram.h"
+#include "qwt/src/qwt_plot_canvas.h"
 
 
 #define MAX_NUMBER_OF_INTERVALS 1000
@@ -53,7 +54,8 @@ HistogramData::HistogramData(QString uavObject, QString uavField, double binWidt
     histogram(0),
     histogramBins(0),
     histogramInterval(0),
-    intervalSeriesData(0)
+    intervalSeriesData(0),
+    plotWidth(0)
 {
     this->binWidth = binWidth;
     this->numberOfBins = numberOfBins;
@@ -75,12 +77,37 @@ HistogramData::HistogramData(QString uavObject, QString uavField, double binWidt
 void HistogramData::plotNewData(PlotData* plot2dData, ScopeConfig *scopeConfig, ScopeGadgetWidget *scopeGadgetWidget)
 {
     Q_UNUSED(plot2dData);
-    Q_UNUSED(scopeGadgetWidget);
     Q_UNUSED(scopeConfig);
 
+    // Only hand the bins over to Qwt when they, or the canvas size, have changed
+    int canvasWidth = scopeGadgetWidget->canvas()->width();
+    if (readAndResetUpdatedFlag() == false && canvasWidth == plotWidth)
+        return;
+    plotWidth = canvasWidth;
+
     //Plot new data
     histogram->setData(intervalSeriesData);
-    intervalSeriesData->setSamples(*histogramBins);
+
+    if (plotWidth > 0 && histogramBins->size() > plotWidth) {
+        // There are more bins than pixel columns. Merge neighboring bins, keeping the tallest
+        // one, so the histogram's outline is unchanged but Qwt draws one bar per column.
+        int binsPerColumn = (int) ceil(histogramBins->size() / (double) plotWidth);
+
+        plotBins.resize(0);
+        for (int i = 0; i < histogramBins->size(); i += binsPerColumn) {
+            int last = qMin(i + binsPerColumn, histogramBins->size()) - 1;
+
+            double value = 0;
+            for (int j = i; j <= last; j++)
+                value = qMax(value, histogramBins->at(j).value);
+
+            plotBins.append(QwtIntervalSample(value, histogramBins->at(i).interval.minValue(),
+                                              histogramBins->at(last).interval.maxValue()));
+        }
+        intervalSeriesData->setSamples(plotBins);
+    } else {
+        intervalSeriesData->setSamples(*histogramBins);
+    }
 }
 
 
@@ -64,6 +64,8 @@ private:
     QVector<QwtIntervalSample> *histogramBins; //Used for histograms
     QVector<QwtInterval> *histogramInterval;
     QwtIntervalSeriesData *intervalSeriesData;
+    QVector<QwtIntervalSample> plotBins; //Bins merged down to at most one per pixel column
+    int plotWidth;
 
     double binWidth;
     uint numberOfBins;
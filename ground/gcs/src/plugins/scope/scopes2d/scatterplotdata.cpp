@@ -37,6 +37,7 @@
 #include "qwt/src/qwt.h"
 #include "qwt/src/qwt_plot.h"
 #include "qwt/src/qwt_plot_curve.h"
+#include "qwt/src/qwt_plot_canvas.h"
 
 
 /**
@@ -47,11 +48,19 @@ void TimeSeriesPlotData::plotNewData(PlotData *plot2dData, ScopeConfig *scopeCon
 {
     Q_UNUSED(plot2dData);
     Q_UNUSED(scopeConfig);
-    Q_UNUSED(scopeGadgetWidget);
+
+    // The buckets are one pixel column wide, so they must be recomputed whenever the canvas
+    // is resized. Otherwise they are maintained incrementally by append() and removeStaleData().
+    if (decimator.setResolution(m_xWindowSize, scopeGadgetWidget->canvas()->width())) {
+        decimator.rebuild(*xData, *yData);
+        setUpdatedFlagToTrue();
+    }
 
     //Plot new data
-    if (readAndResetUpdatedFlag() == true)
-        curve->setSamples(*xData, *yData);
+    if (readAndResetUpdatedFlag() == true) {
+        decimator.fillSamples(xPlotData, yPlotData);
+        curve->setSamples(xPlotData, yPlotData);
+    }
 
     QDateTime NOW = QDateTime::currentDateTime();
     double toTime = NOW.toTime_t();
@@ -69,11 +78,13 @@ void SeriesPlotData::plotNewData(PlotData *plot2dData, ScopeConfig *scopeConfig,
 {
     Q_UNUSED(plot2dData);
     Q_UNUSED(scopeConfig);
-    Q_UNUSED(scopeGadgetWidget);
 
-    //Plot new data
-    if (readAndResetUpdatedFlag() == true)
-        curve->setSamples(*xData, *yData);
+    //Plot new data, with no more than two points per pixel column
+    if (readAndResetUpdatedFlag() == true) {
+        PlotDecimator::decimate(*xData, *yData, 0, m_xWindowSize, scopeGadgetWidget->canvas()->width(),
+                                xPlotData, yPlotData);
+        curve->setSamples(xPlotData, yPlotData);
+    }
 }
 
 
@@ -200,6 +211,7 @@ bool TimeSeriesPlotData::append(UAVObject* obj)
 
             double valueX = NOW.toTime_t() + NOW.time().msec() / 1000.0;
             xData->append(valueX);
+            decimator.append(valueX, yData->last());
 
             //Remove stale data
             removeStaleData();
@@ -233,6 +245,11 @@ void TimeSeriesPlotData::removeStaleData()
         } else
             break;
     }
+
+    if (xData->size() == 0)
+        decimator.clear();
+    else
+        decimator.removeOlderThan(xData->first());
 }
 
 
@@ -29,6 +29,7 @@
 #define SCATTERPLOTDATA_H
 
 #include "scopes2d/plotdata2d.h"
+#include "plotdecimator.h"
 #include "uavobject.h"
 #include "qwt/src/qwt_plot_curve.h"
 
@@ -54,6 +55,9 @@ public:
 
 protected:
     QwtPlotCurve* curve;
+
+    QVector<double> xPlotData; //Decimated copy of xData, which is what Qwt actually draws
+    QVector<double> yPlotData; //Decimated copy of yData
 };
 
 
@@ -104,6 +108,9 @@ public:
     virtual void removeStaleData();
     virtual void plotNewData(PlotData *, ScopeConfig *, ScopeGadgetWidget *);
 
+private:
+    PlotDecimator decimator;
+
 private slots:
     void removeStaleDataTimeout();
 };
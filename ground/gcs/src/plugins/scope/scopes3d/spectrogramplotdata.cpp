@@ -38,6 +38,7 @@
 #include "qwt/src/qwt_color_map.h"
 #include "qwt/src/qwt_matrix_raster_data.h"
 #include "qwt/src/qwt_plot_spectrogram.h"
+#include "qwt/src/qwt_plot_canvas.h"
 #include "qwt/src/qwt_scale_draw.h"
 #include "qwt/src/qwt_scale_widget.h"
 
@@ -110,8 +111,27 @@ void SpectrogramData::plotNewData(PlotData *plot3dData, ScopeConfig *scopeConfig
 
     // Check for new data
     if (readAndResetUpdatedFlag() == true){
-        // Plot new data
-        rasterData->setValueMatrix(*zDataHistory, windowWidth);
+        // Plot new data. If there are more rows of history than pixel rows, merge neighboring
+        // rows, keeping the strongest value in each column, so that peaks are not lost.
+        int canvasHeight = scopeGadgetWidget->canvas()->height();
+        int numRows = zDataHistory->size() / windowWidth;
+        if (canvasHeight > 0 && numRows > canvasHeight) {
+            int rowsPerPixel = (int) ceil(numRows / (double) canvasHeight);
+
+            zPlotData.resize(0);
+            for (int row = 0; row < numRows; row += rowsPerPixel) {
+                int lastRow = qMin(row + rowsPerPixel, numRows);
+                for (unsigned int col = 0; col < windowWidth; col++) {
+                    double value = zDataHistory->at(row * windowWidth + col);
+                    for (int i = row + 1; i < lastRow; i++)
+                        value = qMax(value, zDataHistory->at(i * windowWidth + col));
+                    zPlotData.append(value);
+                }
+            }
+            rasterData->setValueMatrix(zPlotData, windowWidth);
+        } else {
+            rasterData->setValueMatrix(*zDataHistory, windowWidth);
+        }
 
         // Check autoscale. (For some reason, QwtSpectrogram doesn't support autoscale)
         if (zMaximum == 0){
@@ -79,6 +79,7 @@ private:
 
     QwtPlotSpectrogram *spectrogram;
     QwtMatrixRasterData *rasterData;
+    QVector<double> zPlotData; //zDataHistory with rows merged down to at most one per pixel row
 
     double samplingFrequency;
     double timeHorizon;
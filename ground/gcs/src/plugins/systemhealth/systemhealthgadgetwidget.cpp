@@ -27,6 +27,7 @@
 
 #include "systemhealthgadgetwidget.h"
 #include "utils/stylehelper.h"
+#include "utils/atlassvgitem.h"
 #include "extensionsystem/pluginmanager.h"
 #include "uavobjectmanager.h"
 #include "systemalarms.h"
@@ -45,9 +46,9 @@ SystemHealthGadgetWidget::SystemHealthGadgetWidget(QWidget *parent) : QGraphicsV
 
  
     m_renderer = new QSvgRenderer();
-    background = new QGraphicsSvgItem();
-    foreground = new QGraphicsSvgItem();
-    nolink = new QGraphicsSvgItem();
+    background = new AtlasSvgItem();
+    foreground = new AtlasSvgItem();
+    nolink = new AtlasSvgItem();
 
     paint();
 
@@ -108,7 +109,7 @@ void SystemHealthGadgetWidget::updateAlarms(UAVObject* systemAlarm)
             qreal startY = blockMatrix.mapRect(m_renderer->boundsOnElement(element)).y();
             QString element2 = element + "-" + value;
             if (m_renderer->elementExists(element2)) {
-                QGraphicsSvgItem *ind = new QGraphicsSvgItem();
+                QGraphicsSvgItem *ind = new AtlasSvgItem();
                 ind->setSharedRenderer(m_renderer);
                 ind->setElementId(element2);
                 ind->setParentItem(background);
@@ -217,13 +218,8 @@ void SystemHealthGadgetWidget::mousePressEvent ( QMouseEvent * event )
                     // would always call showAllAlarmDescriptions...
                     haveAlarmItem = true;
                     QString itemId = clickedItem->elementId();
-                    if(itemId.contains("OK")){
-                        // No alarm set for this item
-                        showAlarmDescriptionForItemId("AlarmOK", event->globalPos());
-                    }else{
-                        // Warning, error or critical alarm
-                        showAlarmDescriptionForItemId(itemId, event->globalPos());
-                    }
+                    // The OK items share one description, except the CPU one which also shows the profile
+                    showAlarmDescriptionForItemId(itemId, event->globalPos());
                 }
             }
         }
@@ -235,11 +231,71 @@ void SystemHealthGadgetWidget::mousePressEvent ( QMouseEvent * event )
 }
 
 void SystemHealthGadgetWidget::showAlarmDescriptionForItemId(const QString itemId, const QPoint& location){
-    QFile alarmDescription(getAlarmDescriptionFileName(itemId));
+    QString text;
+    // No alarm set for the OK items
+    QFile alarmDescription(getAlarmDescriptionFileName(itemId.contains("OK") ? QString("AlarmOK") : itemId));
     if(alarmDescription.open(QIODevice::ReadOnly | QIODevice::Text)){
         QTextStream textStream(&alarmDescription);
-        QWhatsThis::showText(location, textStream.readAll());
+        text = textStream.readAll();
+    }
+    if(itemId.startsWith("CPUOverload"))
+        text.append(getCpuProfileDescription());
+    if(text.length() > 0)
+        QWhatsThis::showText(location, text);
+}
+
+/**
+ * @brief SystemHealthGadgetWidget::getCpuProfileDescription Formats the last
+ * TaskProfile, TaskLoopProfile and IRQProfile received as an html table
+ * @return an empty string when the firmware does not report a profile, which
+ * is the case unless it was built with DIAG_TASKS
+ */
+QString SystemHealthGadgetWidget::getCpuProfileDescription() {
+    ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
+    UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
+    UAVObject *taskProfile = objManager->getObject(QString("TaskProfile"));
+    UAVObject *loopProfile = objManager->getObject(QString("TaskLoopProfile"));
+    UAVObject *irqProfile = objManager->getObject(QString("IRQProfile"));
+    if(taskProfile == NULL || loopProfile == NULL || irqProfile == NULL)
+        return QString();
+
+    UAVObjectField *runTime = taskProfile->getField("RunTime");
+    UAVObjectField *periodMin = loopProfile->getField("LoopPeriodMin");
+    UAVObjectField *periodMean = loopProfile->getField("LoopPeriodMean");
+    UAVObjectField *periodP99 = loopProfile->getField("LoopPeriodP99");
+    UAVObjectField *periodMax = loopProfile->getField("LoopPeriodMax");
+    UAVObjectField *irqTime = irqProfile->getField("Time");
+
+    // Run times are in hundredths of a percent, loop periods in us
+    QString rows;
+    QStringList tasks = runTime->getElementNames();
+    for(int i = 0; i < tasks.length(); i++){
+        unsigned int time = runTime->getValue(i).toUInt();
+        unsigned int max = periodMax->getValue(i).toUInt();
+        if(time == 0 && max == 0)
+            continue;
+        rows.append(QString("<tr><td>%1</td><td align=\"right\">%2%</td>").arg(tasks[i]).arg(time / 100.0, 0, 'f', 2));
+        if(max > 0)
+            rows.append(QString("<td align=\"right\">%1</td><td align=\"right\">%2</td><td align=\"right\">%3</td><td align=\"right\">%4</td></tr>")
+                        .arg(periodMin->getValue(i).toUInt()).arg(periodMean->getValue(i).toUInt())
+                        .arg(periodP99->getValue(i).toUInt()).arg(max));
+        else
+            rows.append("<td colspan=\"4\"></td></tr>");
+    }
+    QStringList irqs = irqTime->getElementNames();
+    for(int i = 0; i < irqs.length(); i++){
+        unsigned int time = irqTime->getValue(i).toUInt();
+        if(time == 0)
+            continue;
+        rows.append(QString("<tr><td>%1 IRQ</td><td align=\"right\">%2%</td><td colspan=\"4\"></td></tr>").arg(irqs[i]).arg(time / 100.0, 0, 'f', 2));
     }
+    if(rows.isEmpty())
+        return QString();
+
+    return QString("<h2>CPU profile</h2>"
+                   "<table cellspacing=\"4\">"
+                   "<tr><th></th><th>CPU</th><th colspan=\"4\">Loop period (us): min, mean, p99, max</th></tr>"
+                   "%1</table>").arg(rows);
 }
 
 void SystemHealthGadgetWidget::showAllAlarmDescriptions(const QPoint& location){
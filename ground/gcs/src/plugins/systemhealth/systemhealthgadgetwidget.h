@@ -72,5 +72,6 @@ private:
    void showAlarmDescriptionForItemId(const QString itemId, const QPoint& location);
    void showAllAlarmDescriptions(const QPoint &location);
    QString getAlarmDescriptionFileName(const QString itemId);
+   QString getCpuProfileDescription();
 };
 #endif /* SYSTEMHEALTHGADGETWIDGET_H_ */
@@ -28,14 +28,15 @@
 #include "treeitem.h"
 #include "fieldtreeitem.h"
 #include <math.h>
+#include <algorithm>
 
 QTime* HighLightManager::m_currentTime = NULL;
 
 /* Constructor */
-HighLightManager::HighLightManager(long checkingInterval, QTime *currentTime)
+HighLightManager::HighLightManager(QTime *currentTime)
 {
-    // Start the timer and connect it to the callback
-    m_expirationTimer.start(checkingInterval);
+    // The timer is only armed while something is highlighted
+    m_expirationTimer.setSingleShot(true);
     connect(&m_expirationTimer, SIGNAL(timeout()), this, SLOT(checkItemsExpired()));
 
     if (currentTime == NULL)
@@ -52,10 +53,10 @@ bool HighLightManager::add(TreeItem *itemToAdd)
     // Lock to ensure thread safety
     QMutexLocker locker(&m_listMutex);
 
-    // Check so that the item isn't already in the list
-    if(!m_itemsList.contains(itemToAdd))
+    // Check so that the item isn't already in the heap
+    if(!m_items.contains(itemToAdd))
     {
-        m_itemsList.append(itemToAdd);
+        push(itemToAdd, itemToAdd->getHiglightExpires());
         return true;
     }
     return false;
@@ -70,37 +71,69 @@ bool HighLightManager::remove(TreeItem *itemToRemove)
     // Lock to ensure thread safety
     QMutexLocker locker(&m_listMutex);
 
-    // Remove item and return result
-    return m_itemsList.removeOne(itemToRemove);
+    // Remove item and return result. Its heap entry becomes stale.
+    return m_items.remove(itemToRemove) > 0;
 }
 
 /*
- * Callback called periodically by the timer.
- * This method checks for expired highlights and
- * removes them if they are expired.
- * Expired highlights are restored.
+ * Adds a heap entry for an item, and rearms the timer
+ * if it is now the earliest one.
+ */
+void HighLightManager::push(TreeItem *item, QTime expires)
+{
+    Expiry entry;
+    entry.expires = expires;
+    entry.item = item;
+    m_heap.append(entry);
+    std::push_heap(m_heap.begin(), m_heap.end());
+    m_items.insert(item, expires);
+
+    if (m_heap.first().item == item)
+        scheduleTimer();
+}
+
+void HighLightManager::scheduleTimer()
+{
+    if (m_heap.isEmpty()) {
+        m_expirationTimer.stop();
+        return;
+    }
+    m_expirationTimer.start(qMax(0, m_currentTime->msecsTo(m_heap.first().expires)));
+}
+
+/*
+ * Callback called by the timer at the earliest expiry.
+ * Pops every entry that is due. Expired highlights are
+ * restored, and items which were highlighted again since
+ * their entry was pushed get a new entry.
  */
 void HighLightManager::checkItemsExpired()
 {
     // Lock to ensure thread safety
     QMutexLocker locker(&m_listMutex);
 
-    // Get a mutable iterator for the list
-    QMutableLinkedListIterator<TreeItem*> iter(m_itemsList);
-
-    // Loop over all items, check if they expired.
-    while(iter.hasNext())
-    {
-        TreeItem* item = iter.next();
-        if(item->getHiglightExpires() < *m_currentTime)
-        {
+    while (!m_heap.isEmpty() && !(*m_currentTime < m_heap.first().expires)) {
+        Expiry entry = m_heap.first();
+        std::pop_heap(m_heap.begin(), m_heap.end());
+        m_heap.removeLast();
+
+        // Skip entries for items removed or pushed again since
+        QHash<TreeItem*, QTime>::iterator it = m_items.find(entry.item);
+        if (it == m_items.end() || it.value() != entry.expires)
+            continue;
+
+        TreeItem *item = entry.item;
+        if (*m_currentTime < item->getHiglightExpires()) {
+            // Highlighted again in the meantime
+            push(item, item->getHiglightExpires());
+        } else {
             // If expired, call removeHighlight
+            m_items.erase(it);
             item->removeHighlight();
-
-            // Remove from list since it is restored.
-            iter.remove();
         }
     }
+
+    scheduleTimer();
 }
 
 int TreeItem::m_highlightTimeMs = 500;
@@ -191,26 +224,50 @@ void TreeItem::apply() {
  * Called after a value has changed to trigger highlightning of tree item.
  */
 void TreeItem::setHighlight(bool highlight) {
-    m_highlight = highlight;
+    setHighlight(highlight, true);
+}
+
+/*
+ * Highlights the item and its parents. The item whose value changed is
+ * repainted even if it is still highlighted from an earlier change, its
+ * parents only when their highlight starts or ends.
+ */
+void TreeItem::setHighlight(bool highlight, bool valueChanged) {
     m_changed = false;
     if (highlight) {
+        QTime expires;
         // Update the expires timestamp
         if (m_currentTime != NULL)
-            m_highlightExpires = m_currentTime->addMSecs(m_highlightTimeMs);
+            expires = m_currentTime->addMSecs(m_highlightTimeMs);
         else
-            m_highlightExpires = QTime::currentTime().addMSecs(m_highlightTimeMs);
+            expires = QTime::currentTime().addMSecs(m_highlightTimeMs);
+
+        // Another child already highlighted this item, and so its parents,
+        // in this tick of the current time. Nothing more to do.
+        if (m_highlight && m_highlightExpires == expires) {
+            if (valueChanged)
+                emit updateHighlight(this);
+            return;
+        }
+
+        m_highlight = true;
+        m_highlightExpires = expires;
 
         // Add to highlightmanager
-        if(m_highlightManager->add(this))
+        if(m_highlightManager->add(this) || valueChanged)
         {
-            // Only emit signal if it was added
+            // Emit the signal if it was added, or if the value needs repainting
             emit updateHighlight(this);
         }
     }
-    else if(m_highlightManager->remove(this))
+    else
     {
-        // Only emit signal if it was removed
-        emit updateHighlight(this);
+        m_highlight = false;
+        if(m_highlightManager->remove(this))
+        {
+            // Only emit signal if it was removed
+            emit updateHighlight(this);
+        }
     }
 
     // If we have a parent, call recursively to update highlight status of parents.
@@ -218,7 +275,7 @@ void TreeItem::setHighlight(bool highlight) {
     // Only updates that really changes values will trigger highlight of parents.
     if(m_parent)
     {
-        m_parent->setHighlight(highlight);
+        m_parent->setHighlight(highlight, false);
     }
 }
 
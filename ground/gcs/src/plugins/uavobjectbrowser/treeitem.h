@@ -32,8 +32,9 @@
 #include "uavmetaobject.h"
 #include "uavobjectfield.h"
 #include <QtCore/QList>
-#include <QtCore/QLinkedList>
+#include <QtCore/QHash>
 #include <QtCore/QMap>
+#include <QtCore/QVector>
 #include <QtCore/QVariant>
 #include <QtCore/QTime>
 #include <QtCore/QTimer>
@@ -46,23 +47,21 @@ class TreeItem;
 * Small utility class that handles the higlighting of
 * tree grid items.
 * Basicly it maintains all items due to be restored to
-* non highlighted state in a linked list.
-* A timer traverses this list periodically to find out
-* if any of the items should be restored. All items are
-* updated withan expiration timestamp when they expires.
-* An item that is beeing restored is removed from the
-* list and its removeHighlight() method is called. Items
-* that are not expired are left in the list til next time.
+* non highlighted state in a min-heap ordered by the
+* time they were scheduled to expire. A single-shot
+* timer is armed for the earliest expiry only, so an
+* idle tree costs nothing.
 * Items that are updated during the expiration time are
-* left untouched in the list. This reduces unwanted emits
+* left untouched in the heap: when their entry comes up
+* with a later expiry on the item, it is simply pushed
+* back with the new time. This reduces unwanted emits
 * of signals to the repaint/update function.
 */
 class HighLightManager : public QObject
 {
 Q_OBJECT
 public:
-    // Constructor taking the checking interval in ms.
-    HighLightManager(long checkingInterval, QTime *currentTime);
+    HighLightManager(QTime *currentTime);
 
     // This is called when an item has been set to
     // highlighted = true.
@@ -76,13 +75,27 @@ private slots:
     void checkItemsExpired();
 
 private:
-    // The timer checking highlight expiration.
+    struct Expiry {
+        QTime expires;
+        TreeItem *item;
+        // Reversed, so that the std heap functions build a min-heap
+        bool operator<(const Expiry &other) const { return other.expires < expires; }
+    };
+
+    void push(TreeItem *item, QTime expires);
+    void scheduleTimer();
+
+    // The timer firing at the earliest expiration.
     QTimer m_expirationTimer;
 
-    // The list holding all items due to be updated.
-    QLinkedList<TreeItem*> m_itemsList;
+    // Heap of pending expirations. Entries of removed or rescheduled items are
+    // left in place, and skipped when they reach the top.
+    QVector<Expiry> m_heap;
 
-    //Mutex to lock when accessing list.
+    // The items currently highlighted, with the expiry of their live heap entry.
+    QHash<TreeItem*, QTime> m_items;
+
+    //Mutex to lock when accessing the heap.
     QMutex m_listMutex;
 
     // This is the timestamp to compare with
@@ -163,6 +176,8 @@ signals:
 private slots:
 
 private:
+    void setHighlight(bool highlight, bool valueChanged);
+
     QList<TreeItem*> m_children;
     // m_data contains: [0] property name, [1] value, [2] unit
     QList<QVariant> m_data;
@@ -573,10 +573,11 @@ void UAVObjectBrowserWidget::enableUAVOBrowserButtons(bool enableState)
  */
 UAVOBrowserTreeView::UAVOBrowserTreeView(UAVObjectTreeModel *m_model_new, unsigned int updateTimerPeriod) : QTreeView(),
     m_model(m_model_new),
-    m_updateTreeViewFlag(false)
+    m_updatePeriod(updateTimerPeriod)
 {
     // Start timer at 100ms
     m_updateViewTimer.start(updateTimerPeriod);
+    m_model->setUpdatePeriod(updateTimerPeriod);
 
     // Connect the timer
     connect(&m_updateViewTimer, SIGNAL(timeout()), this, SLOT(onTimeout_updateView()));
@@ -597,28 +598,39 @@ void UAVOBrowserTreeView::updateTimerPeriod(unsigned int val)
         }
         m_updateViewTimer.start(val);
     }
+
+    // The model refreshes its items at the same rate as the view repaints them
+    m_updatePeriod = val;
+    if (m_model)
+        m_model->setUpdatePeriod(val);
 }
 
 
 /**
  * @brief UAVOBrowserTreeView::onTimeout_updateView On timeout, emits dataChanged() SIGNAL for
- * all data tree indices that have changed since last timeout.
+ * the changed rows which are on screen. Rows which are collapsed or scrolled out of view
+ * are read from the model anyway when they are next shown.
  */
 void UAVOBrowserTreeView::onTimeout_updateView()
 {
-    if (m_updateTreeViewFlag == true) {
-        QModelIndex topLeftData = m_model->getIndex(0, 0, m_model->getNonSettingsTree());
-        QModelIndex bottomRightData = m_model->getIndex(1, 1, m_model->getNonSettingsTree());
+    if (m_dirtyItems.isEmpty())
+        return;
 
-        QTreeView::dataChanged(topLeftData, bottomRightData);
+    // indexBelow() only walks expanded rows, so this visits exactly the visible ones
+    int bottom = viewport()->rect().bottom();
+    QModelIndex index = indexAt(QPoint(0, 0));
+    while (index.isValid() && visualRect(index).top() <= bottom) {
+        TreeItem *item = static_cast<TreeItem*>(index.internalPointer());
+        if (m_dirtyItems.contains(item))
+            QTreeView::dataChanged(index.sibling(index.row(), 0), index.sibling(index.row(), TreeItem::dataColumn));
+        index = indexBelow(index);
     }
 
-    m_updateTreeViewFlag = false;
+    m_dirtyItems.clear();
 }
 
 /**
- * @brief UAVOBrowserTreeView::updateView Determines if a view updates lies outside the
- * range of updates queued for update
+ * @brief UAVOBrowserTreeView::updateView Queues a model update until the next repaint
  * @param topLeft Top left index from data model update
  * @param bottomRight Bottom right index from data model update
  */
@@ -626,20 +638,8 @@ void UAVOBrowserTreeView::updateView(QModelIndex topLeft, QModelIndex bottomRigh
 {
     Q_UNUSED(bottomRight);
 
-    // First static_cast from *void to a tree item pointer. This is safe because we know all the indices are tree items
-    TreeItem *treeItemPtr = static_cast<TreeItem*>(topLeft.internalPointer());
-
-    // Second, do a dynamic_cast in order to detect if this tree item is a data object
-    DataObjectTreeItem *dataObjectTreeItemPtr = dynamic_cast<DataObjectTreeItem*>(treeItemPtr);
-
-    if (dataObjectTreeItemPtr == NULL) {
-        // Do nothing. These QModelIndices are generated by the highlight manager for individual
-        // UAVO fields, which are both updated when updating that UAVO's branch of the settings or
-        // dynamic data tree.
-        return;
-    }
-
-    m_updateTreeViewFlag = true;
+    // The model only reports single rows. This static_cast is safe because we know all the indices are tree items
+    m_dirtyItems.insert(static_cast<TreeItem*>(topLeft.internalPointer()));
 }
 
 void UAVOBrowserTreeView::dataChanged(const QModelIndex & topLeft, const QModelIndex & bottomRight)
@@ -55,7 +55,12 @@ public:
      */
     virtual void dataChanged(const QModelIndex & topLeft, const QModelIndex & bottomRight);
 
-    void setModel(QAbstractItemModel *model) {m_model = dynamic_cast<UAVObjectTreeModel*>(model); QTreeView::setModel(model);}
+    void setModel(QAbstractItemModel *model) {
+        m_model = dynamic_cast<UAVObjectTreeModel*>(model);
+        if (m_model)
+            m_model->setUpdatePeriod(m_updatePeriod);
+        QTreeView::setModel(model);
+    }
 
 private slots:
     void onTimeout_updateView();
@@ -63,8 +68,10 @@ private slots:
 private:
     UAVObjectTreeModel *m_model;
 
-    bool m_updateTreeViewFlag;
+    // Items reported changed since the last repaint
+    QSet<TreeItem*> m_dirtyItems;
 
+    unsigned int m_updatePeriod;
     QTimer m_updateViewTimer;
 
 };
@@ -58,8 +58,13 @@ UAVObjectTreeModel::UAVObjectTreeModel(QObject *parent, bool categorize, bool us
                                                                                  // out. In any case, never go faster than 10ms.
 
 
-    // Create highlight manager, let it run every 300 ms.
-    m_highlightManager = new HighLightManager(300, &m_currentTime);
+    // Until a view sets its repaint period, only merge updates queued in the same event loop pass
+    m_pendingUpdateTimer.setSingleShot(true);
+    m_pendingUpdateTimer.setInterval(0);
+    connect(&m_pendingUpdateTimer, SIGNAL(timeout()), this, SLOT(processPendingUpdates()));
+
+    // Create highlight manager
+    m_highlightManager = new HighLightManager(&m_currentTime);
     connect(objManager, SIGNAL(newObject(UAVObject*)), this, SLOT(newObject(UAVObject*)));
     connect(objManager, SIGNAL(newInstance(UAVObject*)), this, SLOT(newObject(UAVObject*)));
 
@@ -284,16 +289,9 @@ QModelIndex UAVObjectTreeModel::index(TreeItem *item)
     if (item->parent() == 0)
         return QModelIndex();
 
-    QModelIndex root = index(item->parent());
-
-    for (int i = 0; i < rowCount(root); ++i) {
-        QModelIndex childIndex = index(i, 0, root);
-        TreeItem *child = static_cast<TreeItem*>(childIndex.internalPointer());
-        if (child == item)
-            return childIndex;
-    }
-    Q_ASSERT(false);
-    return QModelIndex();
+    int row = item->row();
+    Q_ASSERT(row >= 0);
+    return createIndex(row, 0, item);
 }
 
 QModelIndex UAVObjectTreeModel::parent(const QModelIndex &index) const
@@ -432,16 +430,34 @@ QVariant UAVObjectTreeModel::headerData(int section, Qt::Orientation orientation
 void UAVObjectTreeModel::highlightUpdatedObject(UAVObject *obj)
 {
     Q_ASSERT(obj);
-    ObjectTreeItem *item = findObjectTreeItem(obj);
-    Q_ASSERT(item);
-    if(!m_onlyHighlightChangedValues){
-        item->setHighlight(true);
-    }
-    item->update();
-    if(!m_onlyHighlightChangedValues){
-        QModelIndex itemIndex = index(item);
-        Q_ASSERT(itemIndex != QModelIndex());
-        emit dataChanged(itemIndex, itemIndex);
+    // The items read the object's latest values when they are refreshed,
+    // so further updates before then need no work of their own
+    m_pendingUpdates.insert(obj);
+    if (!m_pendingUpdateTimer.isActive())
+        m_pendingUpdateTimer.start();
+}
+
+/**
+ * @brief UAVObjectTreeModel::processPendingUpdates Refreshes the items of every
+ * object updated since the last call
+ */
+void UAVObjectTreeModel::processPendingUpdates()
+{
+    QSet<UAVObject*> objects = m_pendingUpdates;
+    m_pendingUpdates.clear();
+
+    foreach (UAVObject *obj, objects) {
+        ObjectTreeItem *item = findObjectTreeItem(obj);
+        Q_ASSERT(item);
+        if(!m_onlyHighlightChangedValues){
+            item->setHighlight(true);
+        }
+        item->update();
+        if(!m_onlyHighlightChangedValues){
+            QModelIndex itemIndex = index(item);
+            Q_ASSERT(itemIndex != QModelIndex());
+            emit dataChanged(itemIndex, itemIndex);
+        }
     }
 }
 
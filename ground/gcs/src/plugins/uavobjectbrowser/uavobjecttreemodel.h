@@ -32,6 +32,7 @@
 #include <QAbstractItemModel>
 #include <QtCore/QMap>
 #include <QtCore/QList>
+#include <QtCore/QSet>
 #include <QtGui/QColor>
 
 class TopTreeItem;
@@ -73,6 +74,7 @@ public:
         TreeItem::setHighlightTime(timeout);
     }
     void setOnlyHighlightChangedValues(bool highlight) {m_onlyHighlightChangedValues = highlight; }
+    void setUpdatePeriod(int period) { m_pendingUpdateTimer.setInterval(period); }
 
     QList<QModelIndex> getMetaDataIndexes();
 
@@ -85,6 +87,7 @@ public slots:
 
 private slots:
     void highlightUpdatedObject(UAVObject *obj);
+    void processPendingUpdates();
     void updateHighlight(TreeItem*);
     void updateCurrentTime();
 
@@ -117,6 +120,11 @@ private:
     QTimer m_currentTimeTimer;
     QTime m_currentTime;
 
+    // Objects updated since the tree was last refreshed. However often an
+    // object arrives, its items are refreshed once per update period.
+    QSet<UAVObject*> m_pendingUpdates;
+    QTimer m_pendingUpdateTimer;
+
     // Highlight manager to handle highlighting of tree items.
     HighLightManager *m_highlightManager;
 };
@@ -199,6 +199,37 @@ bool UAVTalk::objectTransaction(UAVObject* obj, quint8 type, bool allInstances)
     }
 }
 
+/**
+ * Check that a buffer holds one complete, valid packet. This does not need an
+ * object manager, so it can be used to frame packets read back from a log.
+ * \param[in] packet Start of the packet
+ * \param[in] length Number of bytes available at packet
+ * \param[out] type Packet type
+ * \param[out] objId Object ID
+ * \param[out] packetSize Packet length, not counting the checksum
+ * \return True if the sync byte, type, size and checksum are all valid
+ */
+bool UAVTalk::checkPacket(const quint8* packet, qint32 length, quint8* type, quint32* objId, qint32* packetSize)
+{
+    if (length < MIN_HEADER_LENGTH + CHECKSUM_LENGTH)
+        return false;
+
+    if (packet[0] != SYNC_VAL || (packet[1] & TYPE_MASK) != TYPE_VER)
+        return false;
+
+    qint32 size = qFromLittleEndian<quint16>(&packet[2]);
+    if (size < MIN_HEADER_LENGTH || size > MAX_HEADER_LENGTH + MAX_PAYLOAD_LENGTH || size + CHECKSUM_LENGTH > length)
+        return false;
+
+    if (updateCRC(0, packet, size) != packet[size])
+        return false;
+
+    *type = packet[1];
+    *objId = qFromLittleEndian<quint32>(&packet[4]);
+    *packetSize = size;
+    return true;
+}
+
 /**
  * Process a byte from the telemetry stream.
  * \param[in] rxbyte Received byte
@@ -744,6 +775,63 @@ bool UAVTalk::transmitNack(quint32 objId)
  * \return Success (true), Failure (false)
  */
 bool UAVTalk::transmitSingleObject(UAVObject* obj, quint8 type, bool allInstances)
+{
+    qint32 packetLength = buildPacket(obj, type, allInstances, txBuffer);
+    if (packetLength < 0)
+    {
+        return false;
+    }
+
+    // Send buffer, check that the transmit backlog does not grow above limit
+    if (!io.isNull() && io->isWritable() && io->bytesToWrite() < TX_BUFFER_SIZE )
+    {
+        io->write((const char*)txBuffer, packetLength);
+        if(useUDPMirror)
+        {
+            udpSocketRx->writeDatagram((const char*)txBuffer,packetLength,QHostAddress::LocalHost,udpSocketTx->localPort());
+        }
+    }
+    else
+    {
+        ++stats.txErrors;
+        return false;
+    }
+
+    // Update stats
+    ++stats.txObjects;
+    stats.txBytes += packetLength;
+    stats.txObjectBytes += packetLength - CHECKSUM_LENGTH - (obj->isSingleInstance() ? MIN_HEADER_LENGTH : MAX_HEADER_LENGTH);
+
+    // Done
+    return true;
+}
+
+/**
+ * Serialize an object update once, so that the same bytes can be sent over
+ * several links.
+ * \param[in] obj Object handle to pack
+ * \return The TYPE_OBJ packet including its checksum, empty on failure
+ */
+QByteArray UAVTalk::packObject(UAVObject* obj)
+{
+    quint8 buffer[MAX_PACKET_LENGTH];
+    qint32 packetLength = buildPacket(obj, TYPE_OBJ, false, buffer);
+    if (packetLength < 0)
+    {
+        return QByteArray();
+    }
+    return QByteArray((const char*)buffer, packetLength);
+}
+
+/**
+ * Build the packet of an object.
+ * \param[in] obj Object handle to pack
+ * \param[in] type Transaction type
+ * \param[in] allInstances True is all instances of the object are addressed
+ * \param[out] buffer At least MAX_PACKET_LENGTH bytes
+ * \return The packet length including the checksum, -1 on failure
+ */
+qint32 UAVTalk::buildPacket(UAVObject* obj, quint8 type, bool allInstances, quint8* buffer)
 {
     qint32 length;
     qint32 dataOffset;
@@ -753,9 +841,9 @@ bool UAVTalk::transmitSingleObject(UAVObject* obj, quint8 type, bool allInstance
 
     // Setup type and object id fields
     objId = obj->getObjID();
-    txBuffer[0] = SYNC_VAL;
-    txBuffer[1] = type;
-    qToLittleEndian<quint32>(objId, &txBuffer[4]);
+    buffer[0] = SYNC_VAL;
+    buffer[1] = type;
+    qToLittleEndian<quint32>(objId, &buffer[4]);
 
     // Setup instance ID if one is required
     if ( obj->isSingleInstance() )
@@ -767,12 +855,12 @@ bool UAVTalk::transmitSingleObject(UAVObject* obj, quint8 type, bool allInstance
         // Check if all instances are requested
         if (allInstances)
         {
-            qToLittleEndian<quint16>(allInstId, &txBuffer[8]);
+            qToLittleEndian<quint16>(allInstId, &buffer[8]);
         }
         else
         {
             instId = obj->getInstID();
-            qToLittleEndian<quint16>(instId, &txBuffer[8]);
+            qToLittleEndian<quint16>(instId, &buffer[8]);
         }
         dataOffset = 10;
     }
@@ -790,45 +878,24 @@ bool UAVTalk::transmitSingleObject(UAVObject* obj, quint8 type, bool allInstance
     // Check length
     if (length >= MAX_PAYLOAD_LENGTH)
     {
-        return false;
+        return -1;
     }
 
     // Copy data (if any)
     if (length > 0)
     {
-        if ( !obj->pack(&txBuffer[dataOffset]) )
+        if ( !obj->pack(&buffer[dataOffset]) )
         {
-            return false;
+            return -1;
         }
     }
 
-    qToLittleEndian<quint16>(dataOffset + length, &txBuffer[2]);
+    qToLittleEndian<quint16>(dataOffset + length, &buffer[2]);
 
     // Calculate checksum
-    txBuffer[dataOffset+length] = updateCRC(0, txBuffer, dataOffset + length);
+    buffer[dataOffset+length] = updateCRC(0, buffer, dataOffset + length);
 
-    // Send buffer, check that the transmit backlog does not grow above limit
-    if (!io.isNull() && io->isWritable() && io->bytesToWrite() < TX_BUFFER_SIZE )
-    {
-        io->write((const char*)txBuffer, dataOffset+length+CHECKSUM_LENGTH);
-        if(useUDPMirror)
-        {
-            udpSocketRx->writeDatagram((const char*)txBuffer,dataOffset+length+CHECKSUM_LENGTH,QHostAddress::LocalHost,udpSocketTx->localPort());
-        }
-    }
-    else
-    {
-        ++stats.txErrors;
-        return false;
-    }
-
-    // Update stats
-    ++stats.txObjects;
-    stats.txBytes += dataOffset+length+CHECKSUM_LENGTH;
-    stats.txObjectBytes += length;
-
-    // Done
-    return true;
+    return dataOffset + length + CHECKSUM_LENGTH;
 }
 
 /**
@@ -63,19 +63,10 @@ public:
 
     bool processInputByte(quint8 rxbyte);
 
-signals:
-    // The only signals we send to the upper level are when we
-    // either receive an ACK or a NACK for a request.
-    void ackReceived(UAVObject* obj);
-    void nackReceived(UAVObject* obj);
-
-private slots:
-    void processInputStream(void);
-    void dummyUDPRead();
+    static bool checkPacket(const quint8* packet, qint32 length, quint8* type, quint32* objId, qint32* packetSize);
+    static QByteArray packObject(UAVObject* obj);
 
-protected:
-
-    // Constants
+    // Protocol constants, also used to parse packets read back from logs
     static const int TYPE_MASK = 0xF8;
     static const int TYPE_VER = 0x20;
     static const int TYPE_OBJ = (TYPE_VER | 0x00);
@@ -93,6 +84,18 @@ protected:
 
     static const int MAX_PACKET_LENGTH = (MAX_HEADER_LENGTH + MAX_PAYLOAD_LENGTH + CHECKSUM_LENGTH);
 
+signals:
+    // The only signals we send to the upper level are when we
+    // either receive an ACK or a NACK for a request.
+    void ackReceived(UAVObject* obj);
+    void nackReceived(UAVObject* obj);
+
+private slots:
+    void processInputStream(void);
+    void dummyUDPRead();
+
+protected:
+
     static const quint16 ALL_INSTANCES = 0xFFFF;
     static const quint16 OBJID_NOTFOUND = 0x0000;
 
@@ -134,8 +137,9 @@ protected:
     bool transmitNack(quint32 objId);
     bool transmitObject(UAVObject* obj, quint8 type, bool allInstances);
     bool transmitSingleObject(UAVObject* obj, quint8 type, bool allInstances);
-    quint8 updateCRC(quint8 crc, const quint8 data);
-    quint8 updateCRC(quint8 crc, const quint8* data, qint32 length);
+    static qint32 buildPacket(UAVObject* obj, quint8 type, bool allInstances, quint8* buffer);
+    static quint8 updateCRC(quint8 crc, const quint8 data);
+    static quint8 updateCRC(quint8 crc, const quint8* data, qint32 length);
 };
 
 #endif // UAVTALK_H
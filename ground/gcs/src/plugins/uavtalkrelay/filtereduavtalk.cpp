@@ -27,27 +27,108 @@
 #include "filtereduavtalk.h"
 #include "gcstelemetrystats.h"
 
+RelayAccessMap::RelayAccessMap() :
+    defaultRead(false),
+    defaultWrite(false)
+{
+}
+
+/**
+ * @brief RelayAccessMap::RelayAccessMap Compiles the rules of one slave
+ * @param objectIndex the relay's number for each object ID
+ * @param rules access per object ID, objects without a rule get defaultRule
+ * @param defaultRule access to all the other objects
+ */
+RelayAccessMap::RelayAccessMap(const QHash<quint32, int> &objectIndex,
+                               const QHash<quint32, UavTalkRelayComon::accessType> &rules,
+                               UavTalkRelayComon::accessType defaultRule) :
+    readable(objectIndex.size()),
+    writable(objectIndex.size()),
+    defaultRead(defaultRule == UavTalkRelayComon::ReadOnly || defaultRule == UavTalkRelayComon::ReadWrite),
+    defaultWrite(defaultRule == UavTalkRelayComon::WriteOnly || defaultRule == UavTalkRelayComon::ReadWrite)
+{
+    QHash<quint32, int>::const_iterator i;
+    for (i = objectIndex.constBegin(); i != objectIndex.constEnd(); ++i) {
+        UavTalkRelayComon::accessType access = rules.value(i.key(), defaultRule);
+        readable.setBit(i.value(), access == UavTalkRelayComon::ReadOnly || access == UavTalkRelayComon::ReadWrite);
+        writable.setBit(i.value(), access == UavTalkRelayComon::WriteOnly || access == UavTalkRelayComon::ReadWrite);
+    }
+}
+
 //! Construct a filtered uavtalk class
 FilteredUavTalk::FilteredUavTalk(QIODevice *iodev, UAVObjectManager *objMngr,
-                                 QHash<quint32,UavTalkRelayComon::accessType> rules,
-                                 UavTalkRelayComon::accessType defaultRule) :
-    UAVTalk(iodev,objMngr),m_rules(rules),m_defaultRule(defaultRule)
+                                 const QHash<quint32,int> &objectIndex,
+                                 const RelayAccessMap &access) :
+    UAVTalk(iodev,objMngr),m_objectIndex(objectIndex),m_access(access),m_receiving(false),
+    m_queuedBytes(0),m_dropped(0)
 {
+    connect(iodev, SIGNAL(bytesWritten(qint64)), this, SLOT(flushQueue()));
 }
 
 /**
- * @brief FilteredUavTalk::sendObjectSlot Called whenever an object is updated by
- * the local GCS and sends it to the remote GCS is the rules allow it.
- * @param obj The UAVObject to possibly send
+ * @brief FilteredUavTalk::queuePacket Queues an object update for the remote GCS.
+ * An update of the same instance still waiting is replaced, keeping its place.
+ * The packet is shared with the other clients, it is not copied.
+ * @param obj The updated object instance
+ * @param packet The packet, as built by UAVTalk::packObject
  */
-void FilteredUavTalk::sendObjectSlot(UAVObject *obj)
+void FilteredUavTalk::queuePacket(UAVObject *obj, const QByteArray &packet)
 {
-    UavTalkRelayComon::accessType access=m_rules.value(obj->getObjID(),m_defaultRule);
-    if(access==UavTalkRelayComon::WriteOnly || access==UavTalkRelayComon::None)
+    quint64 key = queueKey(obj);
+    QHash<quint64, QByteArray>::iterator pending = m_pending.find(key);
+    if (pending != m_pending.end()) {
+        // The slave only ever needs the latest value
+        m_queuedBytes += packet.size() - pending.value().size();
+        pending.value() = packet;
+        flushQueue();
         return;
-    if(obj==GCSTelemetryStats::GetInstance(objMngr))
-        return;
-    sendObject(obj,false,false);
+    }
+
+    // A slave which cannot keep up with this many objects loses the oldest pending updates
+    while (!m_sendQueue.isEmpty() && m_queuedBytes + packet.size() > MAX_QUEUED_BYTES) {
+        m_queuedBytes -= m_pending.take(m_sendQueue.dequeue()).size();
+        ++m_dropped;
+        ++stats.txErrors;
+    }
+
+    m_sendQueue.enqueue(key);
+    m_pending.insert(key, packet);
+    m_queuedBytes += packet.size();
+    flushQueue();
+}
+
+/**
+ * @brief FilteredUavTalk::flushQueue Moves queued packets to the socket while its
+ * backlog is small. Called again whenever the socket has written some data.
+ */
+void FilteredUavTalk::flushQueue()
+{
+    while (!m_sendQueue.isEmpty() && !io.isNull() && io->isWritable() &&
+           io->bytesToWrite() < MAX_SOCKET_BACKLOG) {
+        QByteArray packet = m_pending.take(m_sendQueue.dequeue());
+        m_queuedBytes -= packet.size();
+        io->write(packet);
+
+        ++stats.txObjects;
+        stats.txBytes += packet.size();
+    }
+}
+
+/**
+ * @brief FilteredUavTalk::updateFromSlave Applies an update received from the slave,
+ * without relaying it back to the slave
+ */
+UAVObject* FilteredUavTalk::updateFromSlave(quint32 objId, quint16 instId, quint8 *data)
+{
+    m_receiving = true;
+    UAVObject* obj = updateObject(objId, instId, data);
+    m_receiving = false;
+
+    UAVObject* tobj = objMngr->getObject(objId);
+    UAVMetaObject * mobj=dynamic_cast<UAVMetaObject*>(tobj);
+    if(mobj)
+        tobj->updated();
+    return obj;
 }
 
 /**
@@ -66,10 +147,10 @@ bool FilteredUavTalk::receiveObject(quint8 type, quint32 objId, quint16 instId,
     UAVObject* obj = NULL;
     bool error = false;
     bool allInstances =  (instId == ALL_INSTANCES);
-    UavTalkRelayComon::accessType access=m_rules.value(objId,m_defaultRule);
+    int index = m_objectIndex.value(objId, -1);
     if (objId == GCSTelemetryStats::OBJID)
         return false;
-    if(access==UavTalkRelayComon::ReadOnly || access==UavTalkRelayComon::None)
+    if(!m_access.canWrite(index))
         return false;
     if (obj == NULL)
         error = true;
@@ -80,14 +161,7 @@ bool FilteredUavTalk::receiveObject(quint8 type, quint32 objId, quint16 instId,
         if (!allInstances)
         {
             // Get object and update its data
-            UAVObject* tobj = objMngr->getObject(objId);
-            bool wasCon=disconnect(tobj, SIGNAL(objectUpdated(UAVObject*)), this, SLOT(sendObjectSlot(UAVObject*)));
-            obj = updateObject(objId, instId, data);
-            if(wasCon)
-                connect(tobj, SIGNAL(objectUpdated(UAVObject*)), this, SLOT(sendObjectSlot(UAVObject*)));
-            UAVMetaObject * mobj=dynamic_cast<UAVMetaObject*>(tobj);
-            if(mobj)
-                tobj->updated();
+            obj = updateFromSlave(objId, instId, data);
             if (obj == NULL)
                 error = true;
         }
@@ -101,14 +175,7 @@ bool FilteredUavTalk::receiveObject(quint8 type, quint32 objId, quint16 instId,
         if (!allInstances)
         {
             // Get object and update its data
-            UAVObject* tobj = objMngr->getObject(objId);
-            bool wasCon=disconnect(tobj, SIGNAL(objectUpdated(UAVObject*)), this, SLOT(sendObjectSlot(UAVObject*)));
-            obj = updateObject(objId, instId, data);
-            if(wasCon)
-                connect(tobj, SIGNAL(objectUpdated(UAVObject*)), this, SLOT(sendObjectSlot(UAVObject*)));
-            UAVMetaObject * mobj=dynamic_cast<UAVMetaObject*>(tobj);
-            if(mobj)
-                tobj->updated();
+            obj = updateFromSlave(objId, instId, data);
             // Transmit ACK
             if ( obj != NULL )
             {
@@ -126,7 +193,7 @@ bool FilteredUavTalk::receiveObject(quint8 type, quint32 objId, quint16 instId,
         break;
     case TYPE_OBJ_REQ:  // We are being asked for an object
         // Get object, if all instances are requested get instance 0 of the object
-        if(access==UavTalkRelayComon::WriteOnly || access==UavTalkRelayComon::None)
+        if(!m_access.canRead(index))
             break;
         if (allInstances)
         {
@@ -29,30 +29,86 @@
 
 #include "../uavtalk/uavtalk.h"
 #include <QHash>
+#include <QBitArray>
+#include <QQueue>
 #include "uavtalkrelay_global.h"
 
+/**
+ * @brief The RelayAccessMap class The access rules of one slave GCS, compiled into
+ * a read and a write bit per object. Objects are numbered densely by the relay, so
+ * a check is a bit test instead of hash lookups. Objects without a number, e.g.
+ * registered after the map was built, get the default rule.
+ */
+class RelayAccessMap
+{
+public:
+    RelayAccessMap();
+    RelayAccessMap(const QHash<quint32, int> &objectIndex,
+                   const QHash<quint32, UavTalkRelayComon::accessType> &rules,
+                   UavTalkRelayComon::accessType defaultRule);
+
+    bool canRead(int index) const { return (index >= 0 && index < readable.size()) ? readable.testBit(index) : defaultRead; }
+    bool canWrite(int index) const { return (index >= 0 && index < writable.size()) ? writable.testBit(index) : defaultWrite; }
+
+private:
+    QBitArray readable;
+    QBitArray writable;
+    bool defaultRead;
+    bool defaultWrite;
+};
+
 /**
  * @brief The FilteredUavTalk class An extension of the UAVTalk class to be run on the master
  * GCS (the one which also has a connection to the UAV) which will relay object updates to
  * a slave GCS subject to certain filtering rules which this class enforces.
+ *
+ * Object updates are packed once by the relay and handed to every client through
+ * queuePacket(). Each client keeps at most one pending update per object instance, a
+ * newer one replaces it in place, so a slow client skips stale values of busy objects
+ * without losing the updates of the others. Only past a byte limit are the oldest
+ * pending updates dropped, instead of growing the socket buffer or holding up the
+ * other clients.
  */
 class UAVTALKRELAY_EXPORT FilteredUavTalk:public UAVTalk
 {
     Q_OBJECT
 public:
-    FilteredUavTalk(QIODevice* iodev, UAVObjectManager* objMngr,QHash<quint32,UavTalkRelayComon::accessType> rules,UavTalkRelayComon::accessType defaultRule);
+    FilteredUavTalk(QIODevice* iodev, UAVObjectManager* objMngr, const QHash<quint32,int> &objectIndex, const RelayAccessMap &access);
 
     //! Called when an uavtalk packet is received from the slave.  Updates master based on filtering rules
     bool receiveObject(quint8 type, quint32 objId, quint16 instId, quint8* data, qint32 length);
 
-public slots:
-    //! Called whenever an object is updated either locally in the master GCS or from the main
-    //! telemetry connection, but NOT as a consquence of the receiveObject method
-    void sendObjectSlot(UAVObject *obj);
+    //! Queues an update of obj packed by UAVTalk::packObject for the slave
+    void queuePacket(UAVObject *obj, const QByteArray &packet);
+
+    const RelayAccessMap &access() const { return m_access; }
+
+    //! True while an update received from the slave is applied, it must not be sent back
+    bool isReceiving() const { return m_receiving; }
+
+    quint32 droppedPackets() const { return m_dropped; }
+
+private slots:
+    void flushQueue();
 
 private:
-    QHash<quint32,UavTalkRelayComon::accessType> m_rules;
-    UavTalkRelayComon::accessType m_defaultRule;
+    static const int MAX_QUEUED_BYTES = 32*1024;
+    static const int MAX_SOCKET_BACKLOG = 8*1024;
+
+    UAVObject* updateFromSlave(quint32 objId, quint16 instId, quint8* data);
+
+    QHash<quint32,int> m_objectIndex;
+    RelayAccessMap m_access;
+    bool m_receiving;
+
+    //! Object ID in the high bits, instance ID in the low 16 bits
+    static quint64 queueKey(UAVObject *obj) { return (quint64(obj->getObjID()) << 16) | obj->getInstID(); }
+
+    //! The pending instances in the order of their first pending update
+    QQueue<quint64> m_sendQueue;
+    QHash<quint64, QByteArray> m_pending;
+    int m_queuedBytes;
+    quint32 m_dropped;
 };
 
 #endif // FILTEREDUAVTALK_H
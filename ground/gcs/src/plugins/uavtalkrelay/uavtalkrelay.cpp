@@ -29,9 +29,18 @@
 #include "QMessageBox"
 #include <QPointer>
 #include "filtereduavtalk.h"
+#include "gcstelemetrystats.h"
 
 UavTalkRelay::UavTalkRelay(UAVObjectManager *ObjMngr, QString IpAdress, quint16 Port,QHash<QString,QHash<quint32,UavTalkRelayComon::accessType> > rules,UavTalkRelayComon::accessType defaultRule):m_IpAddress(IpAdress),m_Port(Port),m_ObjMngr(ObjMngr),m_rules(rules),m_DefaultRule(defaultRule)
 {
+    // Updates are relayed from here for all clients at once
+    QVector< QVector<UAVObject*> > list = m_ObjMngr->getObjects();
+    foreach (const QVector<UAVObject*> &instances, list)
+        foreach (UAVObject *obj, instances)
+            objectAdded(obj);
+    connect(m_ObjMngr, SIGNAL(newObject(UAVObject*)), this, SLOT(objectAdded(UAVObject*)));
+    connect(m_ObjMngr, SIGNAL(newInstance(UAVObject*)), this, SLOT(objectAdded(UAVObject*)));
+
     tcpServer = new QTcpServer(this);
     // if we did not find one, use IPv4 localhost
     if (m_IpAddress.isEmpty())
@@ -79,23 +88,55 @@ void UavTalkRelay::newConnection()
     qDebug()<<clientConnection->peerAddress().toString();
     QHash<quint32,UavTalkRelayComon::accessType> temp= m_rules.value(clientConnection->peerAddress().toString());
     temp.unite(m_rules.value("*"));
-    QPointer<FilteredUavTalk> uav=new FilteredUavTalk(clientConnection,m_ObjMngr,temp,m_DefaultRule);
+    RelayAccessMap access(m_objectIndex,temp,m_DefaultRule);
+    QPointer<FilteredUavTalk> uav=new FilteredUavTalk(clientConnection,m_ObjMngr,m_objectIndex,access);
     uavTalkList.append(uav);
     connect(clientConnection, SIGNAL(disconnected()),
             uav, SLOT(deleteLater()));
-    QVector< QVector<UAVObject*> > list = m_ObjMngr->getObjects();
-    QVector< QVector<UAVObject*> >::const_iterator i;
-    QVector<UAVObject*>::const_iterator j;
-    int objects = 0;
-
-    const QVector< QVector<UAVObject*> >::iterator iEnd = list.end();
-    for (i = list.constBegin(); i != iEnd; ++i)
-    {
-        QVector<UAVObject*>::const_iterator jEnd = (*i).constEnd();
-        for (j = (*i).constBegin(); j != jEnd; ++j)
-        {
-            connect(*j, SIGNAL(objectUpdated(UAVObject*)), uav.data(), SLOT(sendObjectSlot(UAVObject*)));
-            objects++;
+}
+
+/**
+ * @brief UavTalkRelay::objectAdded Numbers a new object and relays its updates
+ */
+void UavTalkRelay::objectAdded(UAVObject *obj)
+{
+    // Instances share the number of their object
+    if (!m_objectIndex.contains(obj->getObjID()))
+        m_objectIndex.insert(obj->getObjID(), m_objectIndex.size());
+    connect(obj, SIGNAL(objectUpdated(UAVObject*)), this, SLOT(objectUpdated(UAVObject*)), Qt::UniqueConnection);
+}
+
+/**
+ * @brief UavTalkRelay::objectUpdated Packs an updated object once and queues the
+ * packet to every client which may read it
+ */
+void UavTalkRelay::objectUpdated(UAVObject *obj)
+{
+    if (obj->getObjID() == GCSTelemetryStats::OBJID)
+        return;
+
+    int index = m_objectIndex.value(obj->getObjID(), -1);
+    QByteArray packet;
+
+    QList< QPointer<FilteredUavTalk> >::iterator i = uavTalkList.begin();
+    while (i != uavTalkList.end()) {
+        FilteredUavTalk *client = i->data();
+        if (client == NULL) {
+            i = uavTalkList.erase(i);
+            continue;
+        }
+        ++i;
+
+        // Updates received from a client are not echoed back to it
+        if (client->isReceiving() || !client->access().canRead(index))
+            continue;
+
+        // Only packed once somebody wants it
+        if (packet.isEmpty()) {
+            packet = UAVTalk::packObject(obj);
+            if (packet.isEmpty())
+                return;
         }
+        client->queuePacket(obj, packet);
     }
 }
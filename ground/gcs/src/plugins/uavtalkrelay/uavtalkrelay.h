@@ -35,6 +35,13 @@
 #include "uavtalkrelay_global.h"
 
 class FilteredUavTalk;
+
+/**
+ * @brief The UavTalkRelay class Serves the local objects to slave GCSs over TCP.
+ * Every object update is packed once and the same bytes are queued to all the
+ * clients allowed to read the object, whose rules are compiled into bitmaps
+ * when they connect.
+ */
 class UavTalkRelay: public QObject
 {
     Q_OBJECT
@@ -48,6 +55,8 @@ public:
     void restartServer();
 private slots:
     void newConnection();
+    void objectAdded(UAVObject *obj);
+    void objectUpdated(UAVObject *obj);
 private:
     QString m_IpAddress;
     quint16 m_Port;
@@ -58,6 +67,8 @@ private:
     QHash<QString,QHash<quint32,UavTalkRelayComon::accessType> > m_rules;
     UavTalkRelayComon::accessType m_DefaultRule;
     QList< QPointer<FilteredUavTalk> > uavTalkList;
+    //! Dense number of each object ID, the bit of the object in the clients' access maps
+    QHash<quint32,int> m_objectIndex;
 };
 
 #endif // UAVTALKRELAY_H
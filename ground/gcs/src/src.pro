@@ -5,3 +5,6 @@ SUBDIRS = \
     libs \
     app \
     plugins
+
+# Headless command line tools, built against the plugin libraries
+unix:!macx:SUBDIRS += tools
@@ -0,0 +1,270 @@
+/**
+ ******************************************************************************
+ *
+ * @file       columnwriter.cpp
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2013
+ * @addtogroup GCSTools GCS Tools
+ * @{
+ * @addtogroup LogDecoder Log decoder
+ * @{
+ * @brief Headless decoder for Tau Labs logs
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "columnwriter.h"
+
+#include <QFile>
+#include <QtEndian>
+
+#include <string.h>
+
+// Buffers are spilled to disk once they grow past this
+#define COLUMNWRITER_FLUSH_THRESHOLD (1024 * 1024)
+
+ColumnWriter::ColumnWriter(const LogObjectSchema *schema, const QDir &outputDir, int part, bool csv, bool binary) :
+    schema(schema),
+    outputDir(outputDir),
+    part(part),
+    csv(csv),
+    binary(binary),
+    rows(0)
+{
+    if (binary) {
+        outputDir.mkpath(schema->name);
+        columnBuffers.resize(schema->columns.size() + 2);
+    }
+}
+
+ColumnWriter::~ColumnWriter()
+{
+    flush();
+}
+
+/**
+ * @brief ColumnWriter::append Decodes one packed object into a row
+ * @param timestamp Log timestamp of the packet, in ms
+ * @param instId Instance ID, 0 for single instance objects
+ * @param data Packed object data, schema->numBytes long
+ */
+void ColumnWriter::append(quint32 timestamp, quint16 instId, const quint8 *data)
+{
+    rows++;
+
+    if (csv) {
+        csvBuffer += QByteArray::number(timestamp);
+        csvBuffer += ',';
+        csvBuffer += QByteArray::number(instId);
+        foreach (const LogColumn &column, schema->columns) {
+            csvBuffer += ',';
+            appendCsvValue(column, data + column.offset);
+        }
+        csvBuffer += '\n';
+    }
+
+    if (binary) {
+        quint8 le[sizeof(quint32)];
+        qToLittleEndian<quint32>(timestamp, le);
+        columnBuffers[0].append((const char *) le, sizeof(quint32));
+        qToLittleEndian<quint16>(instId, le);
+        columnBuffers[1].append((const char *) le, sizeof(quint16));
+
+        // The packed data is already little endian, so values are copied as they are
+        for (int i = 0; i < schema->columns.size(); i++) {
+            const LogColumn &column = schema->columns.at(i);
+            if (column.type == UAVObjectField::BITFIELD)
+                columnBuffers[i + 2].append((char) ((data[column.offset] >> column.bit) & 1));
+            else
+                columnBuffers[i + 2].append((const char *) data + column.offset, column.size);
+        }
+    }
+
+    if (csvBuffer.size() > COLUMNWRITER_FLUSH_THRESHOLD ||
+            (binary && columnBuffers.at(0).size() > COLUMNWRITER_FLUSH_THRESHOLD / 4))
+        flush();
+}
+
+/**
+ * @brief ColumnWriter::appendCsvValue Formats a single value
+ */
+void ColumnWriter::appendCsvValue(const LogColumn &column, const quint8 *value)
+{
+    switch (column.type) {
+    case UAVObjectField::INT8:
+        csvBuffer += QByteArray::number((qint8) value[0]);
+        break;
+    case UAVObjectField::INT16:
+        csvBuffer += QByteArray::number(qFromLittleEndian<qint16>(value));
+        break;
+    case UAVObjectField::INT32:
+        csvBuffer += QByteArray::number(qFromLittleEndian<qint32>(value));
+        break;
+    case UAVObjectField::UINT8:
+        csvBuffer += QByteArray::number(value[0]);
+        break;
+    case UAVObjectField::UINT16:
+        csvBuffer += QByteArray::number(qFromLittleEndian<quint16>(value));
+        break;
+    case UAVObjectField::UINT32:
+        csvBuffer += QByteArray::number(qFromLittleEndian<quint32>(value));
+        break;
+    case UAVObjectField::FLOAT32: {
+        quint32 raw = qFromLittleEndian<quint32>(value);
+        float f;
+        memcpy(&f, &raw, sizeof(f));
+        csvBuffer += QByteArray::number(f, 'g', 9);
+        break;
+    }
+    case UAVObjectField::ENUM:
+        if (value[0] < column.options.size())
+            csvBuffer += column.options.at(value[0]);
+        else
+            csvBuffer += QByteArray::number(value[0]);
+        break;
+    case UAVObjectField::BITFIELD:
+        csvBuffer += ((value[0] >> column.bit) & 1) ? '1' : '0';
+        break;
+    case UAVObjectField::STRING: {
+        // Strings are NUL padded and must not break the CSV quoting
+        QByteArray str((const char *) value, qstrnlen((const char *) value, column.size));
+        str.replace('"', "\"\"");
+        csvBuffer += '"';
+        csvBuffer += str;
+        csvBuffer += '"';
+        break;
+    }
+    }
+}
+
+/**
+ * @brief ColumnWriter::flush Appends the buffered rows to this writer's part files
+ * @return TRUE on success
+ */
+bool ColumnWriter::flush()
+{
+    bool ok = true;
+
+    if (!csvBuffer.isEmpty()) {
+        QFile file(outputDir.filePath(partName(schema->name + ".csv", part)));
+        if (file.open(QIODevice::WriteOnly | QIODevice::Append))
+            ok &= file.write(csvBuffer) == csvBuffer.size();
+        else
+            ok = false;
+        csvBuffer.clear();
+    }
+
+    for (int i = 0; i < columnBuffers.size(); i++) {
+        if (columnBuffers.at(i).isEmpty())
+            continue;
+
+        QString column;
+        if (i == 0)
+            column = "timestamp.u32";
+        else if (i == 1)
+            column = "instance.u16";
+        else
+            column = schema->columns.at(i - 2).name + "." +
+                    LogSchema::typeSuffix(schema->columns.at(i - 2).type, schema->columns.at(i - 2).size);
+
+        QFile file(outputDir.filePath(partName(schema->name + "/" + column, part)));
+        if (file.open(QIODevice::WriteOnly | QIODevice::Append))
+            ok &= file.write(columnBuffers.at(i)) == columnBuffers.at(i).size();
+        else
+            ok = false;
+        columnBuffers[i].clear();
+    }
+
+    return ok;
+}
+
+QString ColumnWriter::partName(const QString &name, int part)
+{
+    return name + ".part" + QString::number(part);
+}
+
+/**
+ * @brief ColumnWriter::appendFile Appends a part file to the output, then deletes it.
+ * Threads which saw no data for an object leave no part, which is not an error.
+ */
+bool ColumnWriter::appendFile(QFile *out, const QString &partPath)
+{
+    QFile in(partPath);
+    if (!in.exists())
+        return true;
+    if (!in.open(QIODevice::ReadOnly))
+        return false;
+
+    char buffer[64 * 1024];
+    qint64 len;
+    while ((len = in.read(buffer, sizeof(buffer))) > 0) {
+        if (out->write(buffer, len) != len)
+            return false;
+    }
+    in.close();
+
+    return in.remove();
+}
+
+/**
+ * @brief ColumnWriter::mergeParts Joins the part files of all decode threads
+ * @param schema Object being merged
+ * @param outputDir Output directory
+ * @param numParts Number of decode threads
+ * @return TRUE on success
+ */
+bool ColumnWriter::mergeParts(const LogObjectSchema *schema, const QDir &outputDir, int numParts, bool csv, bool binary)
+{
+    bool ok = true;
+
+    if (csv) {
+        QFile out(outputDir.filePath(schema->name + ".csv"));
+        if (!out.open(QIODevice::WriteOnly | QIODevice::Truncate))
+            return false;
+
+        QByteArray header = "timestamp,instance";
+        foreach (const LogColumn &column, schema->columns)
+            header += "," + column.name;
+        header += '\n';
+        out.write(header);
+
+        for (int part = 0; part < numParts; part++)
+            ok &= appendFile(&out, outputDir.filePath(partName(schema->name + ".csv", part)));
+    }
+
+    if (binary) {
+        QStringList columns;
+        columns << "timestamp.u32" << "instance.u16";
+        foreach (const LogColumn &column, schema->columns)
+            columns << column.name + "." + LogSchema::typeSuffix(column.type, column.size);
+
+        foreach (const QString &column, columns) {
+            QFile out(outputDir.filePath(schema->name + "/" + column));
+            if (!out.open(QIODevice::WriteOnly | QIODevice::Truncate))
+                return false;
+
+            for (int part = 0; part < numParts; part++)
+                ok &= appendFile(&out, outputDir.filePath(partName(schema->name + "/" + column, part)));
+        }
+
+        QFile list(outputDir.filePath(schema->name + "/columns.txt"));
+        if (list.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+            list.write(columns.join("\n").toLatin1() + "\n");
+        else
+            ok = false;
+    }
+
+    return ok;
+}
@@ -0,0 +1,77 @@
+/**
+ ******************************************************************************
+ *
+ * @file       columnwriter.h
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2013
+ * @addtogroup GCSTools GCS Tools
+ * @{
+ * @addtogroup LogDecoder Log decoder
+ * @{
+ * @brief Headless decoder for Tau Labs logs
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef COLUMNWRITER_H
+#define COLUMNWRITER_H
+
+#include <QByteArray>
+#include <QDir>
+#include <QVector>
+
+#include "logschema.h"
+
+/**
+ * @brief The ColumnWriter class Buffers the decoded rows of one UAVObject for
+ * one decode thread, and spills them to part files numbered after that thread.
+ * Once every thread is done, mergeParts() concatenates the parts in thread
+ * order, which is also time order.
+ *
+ * CSV output is one <Object>.csv file, with enums written as their option
+ * names. Binary output is one <Object>/ directory holding a raw little-endian
+ * file per column, named after the column and its type, e.g. Roll.f32, plus
+ * timestamp.u32, instance.u16 and a columns.txt listing them in order.
+ */
+class ColumnWriter
+{
+public:
+    ColumnWriter(const LogObjectSchema *schema, const QDir &outputDir, int part, bool csv, bool binary);
+    ~ColumnWriter();
+
+    void append(quint32 timestamp, quint16 instId, const quint8 *data);
+    bool flush();
+
+    quint64 rowCount() const { return rows; }
+
+    static bool mergeParts(const LogObjectSchema *schema, const QDir &outputDir, int numParts, bool csv, bool binary);
+
+private:
+    static QString partName(const QString &name, int part);
+    static bool appendFile(QFile *out, const QString &partPath);
+
+    void appendCsvValue(const LogColumn &column, const quint8 *value);
+
+    const LogObjectSchema *schema;
+    QDir outputDir;
+    int part;
+    bool csv;
+    bool binary;
+    quint64 rows;
+
+    QByteArray csvBuffer;
+    QVector<QByteArray> columnBuffers; //!< timestamp, instance, then one per schema column
+};
+
+#endif // COLUMNWRITER_H
@@ -0,0 +1,235 @@
+/**
+ ******************************************************************************
+ *
+ * @file       decodeworker.cpp
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2013
+ * @addtogroup GCSTools GCS Tools
+ * @{
+ * @addtogroup LogDecoder Log decoder
+ * @{
+ * @brief Headless decoder for Tau Labs logs
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "decodeworker.h"
+#include "columnwriter.h"
+#include "uavtalk/uavtalk.h"
+
+#include <QtEndian>
+
+#include <string.h>
+
+DecodeWorker::DecodeWorker(const LogSchema *schema, const QDir &outputDir, int part, bool csv, bool binary,
+                           const uchar *log, qint64 logSize) :
+    schema(schema),
+    outputDir(outputDir),
+    part(part),
+    csv(csv),
+    binary(binary),
+    log(log),
+    logSize(logSize),
+    fromTimestamp(0),
+    toTimestamp(0xFFFFFFFF),
+    start(0),
+    end(0),
+    resync(false),
+    timeIndex(NULL),
+    first(0),
+    last(0),
+    decoded(0),
+    unknown(0),
+    corrupt(0)
+{
+}
+
+DecodeWorker::~DecodeWorker()
+{
+    qDeleteAll(writers);
+}
+
+/**
+ * @brief DecodeWorker::setTimeRange Only decode records whose timestamp is in [from, to]
+ */
+void DecodeWorker::setTimeRange(quint32 from, quint32 to)
+{
+    fromTimestamp = from;
+    toTimestamp = to;
+}
+
+/**
+ * @brief DecodeWorker::setByteRange Decode the records of a .tll log which start in [start, end)
+ * @param resync FALSE if start is known to be a record boundary
+ */
+void DecodeWorker::setByteRange(qint64 start, qint64 end, bool resync)
+{
+    this->start = start;
+    this->end = end;
+    this->resync = resync;
+    timeIndex = NULL;
+}
+
+/**
+ * @brief DecodeWorker::setIndexRange Decode the time index entries [first, last)
+ */
+void DecodeWorker::setIndexRange(const IndexedLogTimeEntry *timeIndex, quint64 first, quint64 last)
+{
+    this->timeIndex = timeIndex;
+    this->first = first;
+    this->last = last;
+}
+
+QSet<quint32> DecodeWorker::objectsSeen() const
+{
+    return QSet<quint32>::fromList(writers.keys());
+}
+
+/**
+ * @brief DecodeWorker::readRecord Checks that a valid log record starts at offset
+ * @param timestamp Record timestamp
+ * @param packet The UAVTalk packet inside the record
+ * @param recordLength Length of the whole record, header included
+ * @return TRUE if a complete record with a valid packet starts at offset
+ */
+bool DecodeWorker::readRecord(const uchar *log, qint64 logSize, qint64 offset,
+                              quint32 *timestamp, const quint8 **packet, qint32 *recordLength)
+{
+    if (offset < 0 || offset + (qint64) INDEXEDLOG_RECORD_HEADER_LENGTH > logSize)
+        return false;
+
+    qint64 size;
+    memcpy(timestamp, log + offset, sizeof(quint32));
+    memcpy(&size, log + offset + sizeof(quint32), sizeof(qint64));
+
+    // Anything longer than a UAVTalk packet is not a record header
+    if (size <= UAVTalk::MIN_HEADER_LENGTH || size > 0xFFFF)
+        return false;
+    if (offset + (qint64) INDEXEDLOG_RECORD_HEADER_LENGTH + size > logSize)
+        return false;
+
+    const quint8 *data = log + offset + INDEXEDLOG_RECORD_HEADER_LENGTH;
+    quint8 type;
+    quint32 objId;
+    qint32 packetSize;
+    if (!UAVTalk::checkPacket(data, size, &type, &objId, &packetSize) || packetSize + 1 != size)
+        return false;
+
+    *packet = data;
+    *recordLength = INDEXEDLOG_RECORD_HEADER_LENGTH + size;
+    return true;
+}
+
+/**
+ * @brief DecodeWorker::findRecordStart Finds the first record boundary at or after offset.
+ * A single match could be a coincidence inside packet data, so the following
+ * record has to be valid too, unless the match is the last record of the log.
+ * @return the record offset, or the log size if there is none
+ */
+qint64 DecodeWorker::findRecordStart(qint64 offset) const
+{
+    quint32 timestamp;
+    const quint8 *packet;
+    qint32 length;
+    qint32 nextLength;
+
+    for (; offset < logSize; offset++) {
+        if (!readRecord(log, logSize, offset, &timestamp, &packet, &length))
+            continue;
+        if (offset + length == logSize ||
+                readRecord(log, logSize, offset + length, &timestamp, &packet, &nextLength))
+            return offset;
+    }
+
+    return logSize;
+}
+
+void DecodeWorker::run()
+{
+    quint32 timestamp;
+    const quint8 *packet;
+    qint32 length;
+
+    if (timeIndex) {
+        for (quint64 i = first; i < last; i++) {
+            const IndexedLogTimeEntry &entry = timeIndex[i];
+            if (entry.timestamp < fromTimestamp || entry.timestamp > toTimestamp)
+                continue;
+
+            if (readRecord(log, logSize, entry.offset, &timestamp, &packet, &length))
+                decodePacket(timestamp, packet, length - INDEXEDLOG_RECORD_HEADER_LENGTH);
+            else
+                corrupt++;
+        }
+    } else {
+        qint64 offset = resync ? findRecordStart(start) : start;
+
+        while (offset < end) {
+            if (!readRecord(log, logSize, offset, &timestamp, &packet, &length)) {
+                corrupt++;
+                offset = findRecordStart(offset + 1);
+                continue;
+            }
+
+            if (timestamp >= fromTimestamp && timestamp <= toTimestamp)
+                decodePacket(timestamp, packet, length - INDEXEDLOG_RECORD_HEADER_LENGTH);
+            offset += length;
+        }
+    }
+
+    foreach (ColumnWriter *writer, writers)
+        writer->flush();
+}
+
+/**
+ * @brief DecodeWorker::decodePacket Hands one object packet to its writer
+ * @param packet A packet already validated by UAVTalk::checkPacket
+ * @param length Packet length, checksum included
+ */
+void DecodeWorker::decodePacket(quint32 timestamp, const quint8 *packet, qint32 length)
+{
+    quint8 type = packet[1];
+    if (type != UAVTalk::TYPE_OBJ && type != UAVTalk::TYPE_OBJ_ACK)
+        return;
+
+    quint32 objId = qFromLittleEndian<quint32>(packet + INDEXEDLOG_UAVTALK_OBJID_OFFSET);
+    const LogObjectSchema *object = schema->find(objId);
+    if (object == NULL) {
+        unknown++;
+        return;
+    }
+
+    qint32 headerLength = UAVTalk::MIN_HEADER_LENGTH;
+    quint16 instId = 0;
+    if (!object->singleInstance) {
+        instId = qFromLittleEndian<quint16>(packet + UAVTalk::MIN_HEADER_LENGTH);
+        headerLength = UAVTalk::MAX_HEADER_LENGTH;
+    }
+
+    // A size mismatch means the log was recorded with different UAVObject definitions
+    if (length != headerLength + (qint32) object->numBytes + UAVTalk::CHECKSUM_LENGTH) {
+        corrupt++;
+        return;
+    }
+
+    ColumnWriter *writer = writers.value(objId);
+    if (writer == NULL) {
+        writer = new ColumnWriter(object, outputDir, part, csv, binary);
+        writers.insert(objId, writer);
+    }
+
+    writer->append(timestamp, instId, packet + headerLength);
+    decoded++;
+}
@@ -0,0 +1,106 @@
+/**
+ ******************************************************************************
+ *
+ * @file       decodeworker.h
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2013
+ * @addtogroup GCSTools GCS Tools
+ * @{
+ * @addtogroup LogDecoder Log decoder
+ * @{
+ * @brief Headless decoder for Tau Labs logs
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef DECODEWORKER_H
+#define DECODEWORKER_H
+
+#include <QDir>
+#include <QHash>
+#include <QSet>
+#include <QThread>
+
+#include "logschema.h"
+#include "logging/indexedlogformat.h"
+
+class ColumnWriter;
+
+/**
+ * @brief The DecodeWorker class Decodes one slice of a memory mapped log.
+ *
+ * For indexed logs the slice is a range of time index entries, so every record
+ * is located directly. For plain .tll logs the slice is a byte range: the
+ * worker resynchronises on the first offset where two consecutive records
+ * parse and checksum correctly, and decodes every record which starts before
+ * the end of its range, so that neighbouring workers never overlap or leave a
+ * gap.
+ */
+class DecodeWorker : public QThread
+{
+    Q_OBJECT
+public:
+    DecodeWorker(const LogSchema *schema, const QDir &outputDir, int part, bool csv, bool binary,
+                 const uchar *log, qint64 logSize);
+    ~DecodeWorker();
+
+    void setTimeRange(quint32 fromTimestamp, quint32 toTimestamp);
+    void setByteRange(qint64 start, qint64 end, bool resync);
+    void setIndexRange(const IndexedLogTimeEntry *timeIndex, quint64 first, quint64 last);
+
+    quint64 decodedCount() const { return decoded; }
+    quint64 unknownCount() const { return unknown; }
+    quint64 corruptCount() const { return corrupt; }
+    QSet<quint32> objectsSeen() const;
+
+    static bool readRecord(const uchar *log, qint64 logSize, qint64 offset,
+                           quint32 *timestamp, const quint8 **packet, qint32 *recordLength);
+
+protected:
+    void run();
+
+private:
+    void decodePacket(quint32 timestamp, const quint8 *packet, qint32 length);
+    qint64 findRecordStart(qint64 offset) const;
+
+    const LogSchema *schema;
+    QDir outputDir;
+    int part;
+    bool csv;
+    bool binary;
+
+    const uchar *log;
+    qint64 logSize;
+
+    quint32 fromTimestamp;
+    quint32 toTimestamp;
+
+    // Byte range, for .tll logs
+    qint64 start;
+    qint64 end;
+    bool resync;
+
+    // Time index range, for .tli logs
+    const IndexedLogTimeEntry *timeIndex;
+    quint64 first;
+    quint64 last;
+
+    QHash<quint32, ColumnWriter *> writers;
+
+    quint64 decoded;
+    quint64 unknown;
+    quint64 corrupt;
+};
+
+#endif // DECODEWORKER_H
@@ -0,0 +1,35 @@
+# Headless decoder that turns Tau Labs logs into per-UAVObject columnar files
+include(../../../gcs.pri)
+
+QT -= gui
+TEMPLATE = app
+TARGET = taulabs-logdecoder
+CONFIG += console
+CONFIG -= app_bundle
+DESTDIR = $$GCS_APP_PATH
+
+# The UAVObjects and UAVTalk libraries are installed as plugins
+PROVIDER = TauLabs
+LIBS += -L$$GCS_PLUGIN_PATH/$$PROVIDER
+INCLUDEPATH *= $$GCS_SOURCE_TREE/src/plugins
+
+include(../../plugins/uavtalk/uavtalk.pri)
+
+linux-* {
+    #do the rpath by hand since it's not possible to use ORIGIN in QMAKE_RPATHDIR
+    QMAKE_RPATHDIR += \$\$ORIGIN/../$$GCS_LIBRARY_BASENAME/taulabs
+    QMAKE_RPATHDIR += \$\$ORIGIN/../$$GCS_LIBRARY_BASENAME/taulabs/plugins/$$PROVIDER
+    GCS_PLUGIN_RPATH = $$join(QMAKE_RPATHDIR, ":")
+
+    QMAKE_LFLAGS += -Wl,-z,origin \'-Wl,-rpath,$${GCS_PLUGIN_RPATH}\'
+    QMAKE_RPATHDIR =
+}
+
+HEADERS += logschema.h \
+    columnwriter.h \
+    decodeworker.h
+
+SOURCES += main.cpp \
+    logschema.cpp \
+    columnwriter.cpp \
+    decodeworker.cpp
@@ -0,0 +1,146 @@
+/**
+ ******************************************************************************
+ *
+ * @file       logschema.cpp
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2013
+ * @addtogroup GCSTools GCS Tools
+ * @{
+ * @addtogroup LogDecoder Log decoder
+ * @{
+ * @brief Headless decoder for Tau Labs logs
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "logschema.h"
+#include "uavobjectmanager.h"
+#include "uavobject.h"
+
+/**
+ * @brief LogSchema::load Flattens every registered object into columns
+ * @param objMngr Object manager holding all the UAVObjects of this GCS build
+ */
+void LogSchema::load(UAVObjectManager *objMngr)
+{
+    objects.clear();
+
+    QVector< QVector<UAVObject*> > list = objMngr->getObjects();
+    foreach (QVector<UAVObject*> instances, list) {
+        if (instances.isEmpty())
+            continue;
+
+        UAVObject *obj = instances.first();
+
+        LogObjectSchema schema;
+        schema.objId = obj->getObjID();
+        schema.name = obj->getName();
+        schema.singleInstance = obj->isSingleInstance();
+        schema.numBytes = obj->getNumBytes();
+
+        // Fields are packed back to back, in declaration order
+        quint32 offset = 0;
+        foreach (UAVObjectField *field, obj->getFields()) {
+            UAVObjectField::FieldType type = field->getType();
+            QStringList elementNames = field->getElementNames();
+            quint32 numElements = field->getNumElements();
+
+            QList<QByteArray> options;
+            if (type == UAVObjectField::ENUM) {
+                foreach (QString option, field->getOptions())
+                    options.append(option.toLatin1());
+            }
+
+            if (type == UAVObjectField::STRING) {
+                // A string is one value, not one column per character
+                LogColumn column;
+                column.name = field->getName().toLatin1();
+                column.type = type;
+                column.offset = offset;
+                column.size = field->getNumBytes();
+                column.bit = 0;
+                schema.columns.append(column);
+            } else {
+                quint32 bytesPerElement = (type == UAVObjectField::BITFIELD) ? 1 : field->getNumBytes() / numElements;
+
+                for (quint32 i = 0; i < numElements; i++) {
+                    LogColumn column;
+                    column.name = field->getName().toLatin1();
+                    if (numElements > 1)
+                        column.name += "." + elementNames.value(i, QString::number(i)).toLatin1();
+                    column.type = type;
+                    column.options = options;
+
+                    if (type == UAVObjectField::BITFIELD) {
+                        column.offset = offset + i / 8;
+                        column.size = 1;
+                        column.bit = i % 8;
+                    } else {
+                        column.offset = offset + i * bytesPerElement;
+                        column.size = bytesPerElement;
+                        column.bit = 0;
+                    }
+                    schema.columns.append(column);
+                }
+            }
+
+            offset += field->getNumBytes();
+        }
+
+        objects.insert(schema.objId, schema);
+    }
+}
+
+/**
+ * @brief LogSchema::find Looks up an object's layout
+ * @param objId the UAVObject ID
+ * @return the layout, or NULL if this build does not know the object
+ */
+const LogObjectSchema *LogSchema::find(quint32 objId) const
+{
+    QHash<quint32, LogObjectSchema>::const_iterator it = objects.constFind(objId);
+    if (it == objects.constEnd())
+        return NULL;
+
+    return &it.value();
+}
+
+/**
+ * @brief LogSchema::typeSuffix File suffix of a binary column, which tells readers how to interpret it
+ */
+QByteArray LogSchema::typeSuffix(UAVObjectField::FieldType type, quint32 size)
+{
+    switch (type) {
+    case UAVObjectField::INT8:
+        return "i8";
+    case UAVObjectField::INT16:
+        return "i16";
+    case UAVObjectField::INT32:
+        return "i32";
+    case UAVObjectField::UINT16:
+        return "u16";
+    case UAVObjectField::UINT32:
+        return "u32";
+    case UAVObjectField::FLOAT32:
+        return "f32";
+    case UAVObjectField::STRING:
+        return "s" + QByteArray::number(size);
+    case UAVObjectField::UINT8:
+    case UAVObjectField::ENUM:
+    case UAVObjectField::BITFIELD:
+    default:
+        return "u8";
+    }
+}
@@ -0,0 +1,82 @@
+/**
+ ******************************************************************************
+ *
+ * @file       logschema.h
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2013
+ * @addtogroup GCSTools GCS Tools
+ * @{
+ * @addtogroup LogDecoder Log decoder
+ * @{
+ * @brief Headless decoder for Tau Labs logs
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef LOGSCHEMA_H
+#define LOGSCHEMA_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QVector>
+
+#include "uavobjectfield.h"
+
+class UAVObjectManager;
+
+/**
+ * @brief One output column: a single element of a UAVObject field
+ */
+struct LogColumn {
+    QByteArray name;               //!< "Field" or "Field.Element"
+    UAVObjectField::FieldType type;
+    quint32 offset;                //!< Byte offset inside the packed object
+    quint32 size;                  //!< Bytes per value. For strings, the whole field.
+    quint8 bit;                    //!< Bit number, for bitfield elements
+    QList<QByteArray> options;     //!< Option names, for enum elements
+};
+
+/**
+ * @brief Layout of one packed UAVObject, flattened into columns
+ */
+struct LogObjectSchema {
+    quint32 objId;
+    QString name;
+    bool singleInstance;
+    quint32 numBytes;
+    QVector<LogColumn> columns;
+};
+
+/**
+ * @brief The LogSchema class Column layouts of every known UAVObject, keyed by
+ * object ID. It is built once from a UAVObjectManager, and is then read-only so
+ * the decode threads can share it without locking.
+ */
+class LogSchema
+{
+public:
+    void load(UAVObjectManager *objMngr);
+
+    const LogObjectSchema *find(quint32 objId) const;
+    QList<quint32> objectIds() const { return objects.keys(); }
+
+    static QByteArray typeSuffix(UAVObjectField::FieldType type, quint32 size);
+
+private:
+    QHash<quint32, LogObjectSchema> objects;
+};
+
+#endif // LOGSCHEMA_H
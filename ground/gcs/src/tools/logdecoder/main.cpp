@@ -0,0 +1,265 @@
+/**
+ ******************************************************************************
+ *
+ * @file       main.cpp
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2013
+ * @addtogroup GCSTools GCS Tools
+ * @{
+ * @addtogroup LogDecoder Log decoder
+ * @{
+ * @brief Headless decoder for Tau Labs logs
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QSet>
+#include <QStringList>
+#include <QTextStream>
+
+#include <string.h>
+
+#include "uavobjectmanager.h"
+#include "uavobjectsinit.h"
+#include "logschema.h"
+#include "columnwriter.h"
+#include "decodeworker.h"
+
+static const char *usage =
+        "Usage: taulabs-logdecoder [options] <log.tll|log.tli>\n"
+        "\n"
+        "Decodes every UAVObject in a Tau Labs log into one file per object.\n"
+        "\n"
+        "  --output=<dir>             output directory (default: <log name>_decoded)\n"
+        "  --format=csv|binary|both   CSV tables, raw little-endian columns, or both (default: csv)\n"
+        "  --threads=<n>              number of decode threads (default: one per core)\n"
+        "  --from=<s> --to=<s>        only decode this window, in seconds from the start of the log\n";
+
+/**
+ * @brief findBody Skips the text header written in front of the records
+ * @return offset of the first record, 0 for logs written before the header existed
+ */
+static qint64 findBody(const uchar *log, qint64 size)
+{
+    static const char separator[] = "\n##\n";
+    qint64 searchLength = qMin<qint64>(size, 4096);
+
+    for (qint64 i = 0; i + (qint64) strlen(separator) <= searchLength; i++) {
+        if (memcmp(log + i, separator, strlen(separator)) == 0)
+            return i + strlen(separator);
+    }
+
+    return 0;
+}
+
+/**
+ * @brief lowerBound First time index entry with a timestamp of at least t
+ */
+static quint64 lowerBound(const IndexedLogTimeEntry *timeIndex, quint64 count, quint32 t)
+{
+    quint64 low = 0;
+    quint64 high = count;
+    while (low < high) {
+        quint64 mid = low + (high - low) / 2;
+        if (timeIndex[mid].timestamp < t)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return low;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QTextStream err(stderr);
+    QTextStream out(stdout);
+
+    QString logFileName;
+    QString outputPath;
+    QString format = "csv";
+    int numThreads = QThread::idealThreadCount();
+    double fromSeconds = -1;
+    double toSeconds = -1;
+
+    QStringList args = app.arguments();
+    args.removeFirst();
+    foreach (const QString &arg, args) {
+        if (arg.startsWith("--output="))
+            outputPath = arg.mid(strlen("--output="));
+        else if (arg.startsWith("--format="))
+            format = arg.mid(strlen("--format="));
+        else if (arg.startsWith("--threads="))
+            numThreads = arg.mid(strlen("--threads=")).toInt();
+        else if (arg.startsWith("--from="))
+            fromSeconds = arg.mid(strlen("--from=")).toDouble();
+        else if (arg.startsWith("--to="))
+            toSeconds = arg.mid(strlen("--to=")).toDouble();
+        else if (!arg.startsWith("--") && logFileName.isEmpty())
+            logFileName = arg;
+        else {
+            err << usage;
+            return 1;
+        }
+    }
+
+    bool csv = (format == "csv" || format == "both");
+    bool binary = (format == "binary" || format == "both");
+    if (logFileName.isEmpty() || (!csv && !binary)) {
+        err << usage;
+        return 1;
+    }
+    if (numThreads < 1)
+        numThreads = 1;
+
+    QFile logFile(logFileName);
+    if (!logFile.open(QIODevice::ReadOnly)) {
+        err << "Unable to open " << logFileName << ": " << logFile.errorString() << "\n";
+        return 1;
+    }
+
+    // The whole log is mapped once and shared read-only by all the workers
+    qint64 logSize = logFile.size();
+    const uchar *log = logFile.map(0, logSize);
+    if (log == NULL) {
+        err << "Unable to map " << logFileName << ": " << logFile.errorString() << "\n";
+        return 1;
+    }
+
+    if (outputPath.isEmpty())
+        outputPath = QFileInfo(logFileName).completeBaseName() + "_decoded";
+    QDir outputDir;
+    if (!outputDir.mkpath(outputPath)) {
+        err << "Unable to create " << outputPath << "\n";
+        return 1;
+    }
+    outputDir.setPath(outputPath);
+
+    // Object layouts come from the UAVObjects this tool was built with
+    UAVObjectManager objMngr;
+    UAVObjectsInitialize(&objMngr);
+    LogSchema schema;
+    schema.load(&objMngr);
+
+    qint64 body = findBody(log, logSize);
+    qint64 recordsEnd = logSize;
+
+    // Indexed logs end with a footer pointing at the time index
+    const IndexedLogTimeEntry *timeIndex = NULL;
+    quint64 timeIndexCount = 0;
+    if (logSize >= (qint64) sizeof(IndexedLogFooter)) {
+        IndexedLogFooter footer;
+        memcpy(&footer, log + logSize - sizeof(footer), sizeof(footer));
+        if (memcmp(footer.magic, INDEXEDLOG_MAGIC, sizeof(footer.magic)) == 0) {
+            // The index must lie between the records and the footer
+            quint64 indexSpace = logSize - sizeof(footer);
+            if (footer.timeIndexOffset < (quint64) body || footer.timeIndexOffset > indexSpace ||
+                    footer.timeIndexCount > (indexSpace - footer.timeIndexOffset) / sizeof(IndexedLogTimeEntry)) {
+                err << "The index of " << logFileName << " is corrupted\n";
+                return 1;
+            }
+
+            timeIndex = reinterpret_cast<const IndexedLogTimeEntry *>(log + footer.timeIndexOffset);
+            timeIndexCount = footer.timeIndexCount;
+            recordsEnd = footer.timeIndexOffset;
+        }
+    }
+
+    // The time window is relative to the first record
+    quint32 firstTimestamp = 0;
+    if (timeIndex && timeIndexCount > 0) {
+        firstTimestamp = timeIndex[0].timestamp;
+    } else {
+        const quint8 *packet;
+        qint32 length;
+        DecodeWorker::readRecord(log, recordsEnd, body, &firstTimestamp, &packet, &length);
+    }
+    quint32 fromTimestamp = 0;
+    quint32 toTimestamp = 0xFFFFFFFF;
+    if (fromSeconds >= 0)
+        fromTimestamp = firstTimestamp + (quint32) (fromSeconds * 1000);
+    if (toSeconds >= 0)
+        toTimestamp = firstTimestamp + (quint32) (toSeconds * 1000);
+
+    QElapsedTimer timer;
+    timer.start();
+
+    QList<DecodeWorker *> workers;
+    if (timeIndex) {
+        // Split the requested window into equal record counts
+        quint64 first = lowerBound(timeIndex, timeIndexCount, fromTimestamp);
+        quint64 last = (toTimestamp == 0xFFFFFFFF) ? timeIndexCount :
+                lowerBound(timeIndex, timeIndexCount, toTimestamp + 1);
+        quint64 count = (last > first) ? last - first : 0;
+
+        for (int i = 0; i < numThreads; i++) {
+            DecodeWorker *worker = new DecodeWorker(&schema, outputDir, i, csv, binary, log, recordsEnd);
+            worker->setTimeRange(fromTimestamp, toTimestamp);
+            worker->setIndexRange(timeIndex, first + count * i / numThreads, first + count * (i + 1) / numThreads);
+            workers.append(worker);
+        }
+    } else {
+        // Split into equal byte ranges, each worker finds its own first record
+        qint64 length = recordsEnd - body;
+        for (int i = 0; i < numThreads; i++) {
+            DecodeWorker *worker = new DecodeWorker(&schema, outputDir, i, csv, binary, log, recordsEnd);
+            worker->setTimeRange(fromTimestamp, toTimestamp);
+            worker->setByteRange(body + length * i / numThreads, body + length * (i + 1) / numThreads, i > 0);
+            workers.append(worker);
+        }
+    }
+
+    foreach (DecodeWorker *worker, workers)
+        worker->start();
+
+    quint64 decoded = 0;
+    quint64 unknown = 0;
+    quint64 corrupt = 0;
+    QSet<quint32> objIds;
+    foreach (DecodeWorker *worker, workers) {
+        worker->wait();
+        decoded += worker->decodedCount();
+        unknown += worker->unknownCount();
+        corrupt += worker->corruptCount();
+        objIds += worker->objectsSeen();
+    }
+    // Deleting the workers flushes whatever their writers still buffer
+    qDeleteAll(workers);
+
+    bool ok = true;
+    foreach (quint32 objId, objIds)
+        ok &= ColumnWriter::mergeParts(schema.find(objId), outputDir, numThreads, csv, binary);
+
+    logFile.unmap(const_cast<uchar *>(log));
+
+    out << "Decoded " << decoded << " packets of " << objIds.size() << " objects into "
+        << outputDir.absolutePath() << " in " << timer.elapsed() << " ms using " << numThreads << " threads\n";
+    if (unknown > 0)
+        out << unknown << " packets were for objects unknown to this build\n";
+    if (corrupt > 0)
+        out << corrupt << " records were corrupt or did not match this build's object definitions\n";
+
+    if (!ok) {
+        err << "Failed to write some of the output files\n";
+        return 1;
+    }
+
+    return 0;
+}
@@ -46,10 +46,17 @@ bool UAVObjectGeneratorFlight::generate(UAVObjectParser* parser,QString template
     flightMakeTemplate = readFile( flightCodePath.absoluteFilePath("Makefiletemplate.inc") );
 
     if ( flightCodeTemplate.isNull() || flightIncludeTemplate.isNull() || flightInitTemplate.isNull()) {
-            cerr << "Error: Could not open flight template files." << endl;
+            generatorLog() << "Error: Could not open flight template files." << endl;
             return false;
         }
 
+    cache.open("flight", outputpath);
+    cache.addTemplate(flightCodePath.absoluteFilePath("uavobjecttemplate.c"), flightCodeTemplate);
+    cache.addTemplate(flightCodePath.absoluteFilePath("inc/uavobjecttemplate.h"), flightIncludeTemplate);
+    cache.addInput(flightCodePath.absoluteFilePath("uavobjectsinittemplate.c"));
+    cache.addInput(flightCodePath.absoluteFilePath("inc/uavobjectsinittemplate.h"));
+    cache.addInput(flightCodePath.absoluteFilePath("Makefiletemplate.inc"));
+
     sizeCalc = 0;
     for (int objidx = 0; objidx < parser->getNumObjects(); ++objidx) {
         ObjectInfo* info=parser->getObjectByIndex(objidx);
@@ -71,7 +78,7 @@ bool UAVObjectGeneratorFlight::generate(UAVObjectParser* parser,QString template
     bool res = writeFileIfDiffrent( flightOutputPath.absolutePath() + "/uavobjectsinit.c",
                      flightInitTemplate );
     if (!res) {
-        cout << "Error: Could not write flight object init file" << endl;
+        generatorLog() << "Error: Could not write flight object init file" << endl;
         return false;
     }
 
@@ -80,7 +87,7 @@ bool UAVObjectGeneratorFlight::generate(UAVObjectParser* parser,QString template
     res = writeFileIfDiffrent( flightOutputPath.absolutePath() + "/uavobjectsinit.h",
                      flightInitIncludeTemplate );
     if (!res) {
-        cout << "Error: Could not write flight object init header file" << endl;
+        generatorLog() << "Error: Could not write flight object init header file" << endl;
         return false;
     }
 
@@ -90,7 +97,12 @@ bool UAVObjectGeneratorFlight::generate(UAVObjectParser* parser,QString template
     res = writeFileIfDiffrent( flightOutputPath.absolutePath() + "/Makefile.inc",
                      flightMakeTemplate );
     if (!res) {
-        cout << "Error: Could not write flight Makefile" << endl;
+        generatorLog() << "Error: Could not write flight Makefile" << endl;
+        return false;
+    }
+
+    if (!cache.save(parser)) {
+        generatorLog() << "Error: Could not write flight generator cache" << endl;
         return false;
     }
 
@@ -106,6 +118,12 @@ bool UAVObjectGeneratorFlight::process_object(ObjectInfo* info)
     if (info == NULL)
         return false;
 
+    QStringList outputs;
+    outputs << flightOutputPath.absolutePath() + "/" + info->namelc + ".c";
+    outputs << flightOutputPath.absolutePath() + "/" + info->namelc + ".h";
+    if (cache.isUpToDate(info, outputs))
+        return true;
+
     // Prepare output strings
     QString outInclude = flightIncludeTemplate;
     QString outCode = flightCodeTemplate;
@@ -345,16 +363,18 @@ bool UAVObjectGeneratorFlight::process_object(ObjectInfo* info)
     // Write the flight code
     bool res = writeFileIfDiffrent( flightOutputPath.absolutePath() + "/" + info->namelc + ".c", outCode );
     if (!res) {
-        cout << "Error: Could not write flight code files" << endl;
+        generatorLog() << "Error: Could not write flight code files" << endl;
         return false;
     }
 
     res = writeFileIfDiffrent( flightOutputPath.absolutePath() + "/" + info->namelc + ".h", outInclude );
     if (!res) {
-        cout << "Error: Could not write flight include files" << endl;
+        generatorLog() << "Error: Could not write flight include files" << endl;
         return false;
     }
 
+    cache.generated(info);
+
     return true;
 }
 
@@ -41,6 +41,7 @@ public:
 private:
     bool process_object(ObjectInfo* info);
 
+    GeneratorCache cache;
 };
 
 #endif
@@ -44,10 +44,15 @@ bool UAVObjectGeneratorGCS::generate(UAVObjectParser* parser,QString templatepat
     QString gcsInitTemplate = readFile( gcsCodePath.absoluteFilePath("uavobjectsinittemplate.cpp") );
 
     if (gcsCodeTemplate.isEmpty() || gcsIncludeTemplate.isEmpty() || gcsInitTemplate.isEmpty()) {
-        std::cerr << "Problem reading gcs code templates" << endl;
+        generatorLog() << "Problem reading gcs code templates" << endl;
         return false;
     }
 
+    cache.open("gcs", outputpath);
+    cache.addTemplate(gcsCodePath.absoluteFilePath("uavobjecttemplate.cpp"), gcsCodeTemplate);
+    cache.addTemplate(gcsCodePath.absoluteFilePath("uavobjecttemplate.h"), gcsIncludeTemplate);
+    cache.addInput(gcsCodePath.absoluteFilePath("uavobjectsinittemplate.cpp"));
+
     QString objInc;
     QString gcsObjInit;
 
@@ -64,7 +69,12 @@ bool UAVObjectGeneratorGCS::generate(UAVObjectParser* parser,QString templatepat
     gcsInitTemplate.replace( QString("$(OBJINIT)"), gcsObjInit);
     bool res = writeFileIfDiffrent( gcsOutputPath.absolutePath() + "/uavobjectsinit.cpp", gcsInitTemplate );
     if (!res) {
-        cout << "Error: Could not write output files" << endl;
+        generatorLog() << "Error: Could not write output files" << endl;
+        return false;
+    }
+
+    if (!cache.save(parser)) {
+        generatorLog() << "Error: Could not write gcs generator cache" << endl;
         return false;
     }
 
@@ -79,6 +89,12 @@ bool UAVObjectGeneratorGCS::process_object(ObjectInfo* info)
     if (info == NULL)
         return false;
 
+    QStringList outputs;
+    outputs << gcsOutputPath.absolutePath() + "/" + info->namelc + ".cpp";
+    outputs << gcsOutputPath.absolutePath() + "/" + info->namelc + ".h";
+    if (cache.isUpToDate(info, outputs))
+        return true;
+
     // Prepare output strings
     QString outInclude = gcsIncludeTemplate;
     QString outCode = gcsCodeTemplate;
@@ -401,14 +417,16 @@ bool UAVObjectGeneratorGCS::process_object(ObjectInfo* info)
     // Write the GCS code
     bool res = writeFileIfDiffrent( gcsOutputPath.absolutePath() + "/" + info->namelc + ".cpp", outCode );
     if (!res) {
-        cout << "Error: Could not write gcs output files" << endl;
+        generatorLog() << "Error: Could not write gcs output files" << endl;
         return false;
     }
     res = writeFileIfDiffrent( gcsOutputPath.absolutePath() + "/" + info->namelc + ".h", outInclude );
     if (!res) {
-        cout << "Error: Could not write gcs output files" << endl;
+        generatorLog() << "Error: Could not write gcs output files" << endl;
         return false;
     }
 
+    cache.generated(info);
+
     return true;
 }
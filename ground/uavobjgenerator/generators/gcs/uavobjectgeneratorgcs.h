@@ -43,6 +43,7 @@ private:
     QStringList fieldTypeStrCPP,fieldTypeStrCPPClass;
     QDir gcsCodePath;
     QDir gcsOutputPath;
+    GeneratorCache cache;
 };
 
 #endif
@@ -0,0 +1,227 @@
+/**
+ ******************************************************************************
+ *
+ * @file       generator_cache.cpp
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2013
+ * @brief      Skips objects whose generated code cannot have changed
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "generator_cache.h"
+#include "generator_io.h"
+
+#include <QCryptographicHash>
+#include <QFileInfo>
+
+QString GeneratorCache::xmlPath;
+QByteArray GeneratorCache::generatorHash;
+bool GeneratorCache::force = false;
+bool GeneratorCache::allObjects = true;
+
+/**
+ * Set up all caches. This is only called from main before the generators
+ * are started, after that the settings are only read.
+ * @param xmlPath the directory of the definitions as given to the generator
+ * @param generatorHash hash of the generator binary, a new generator
+ * generates every object again
+ * @param force generate every object whatever the cache says
+ * @param allObjects whether all the definitions were parsed, only then are
+ * the outputs of objects which are not among them removed
+ */
+void GeneratorCache::configure(const QString &xmlPath, const QByteArray &generatorHash, bool force, bool allObjects)
+{
+    GeneratorCache::xmlPath = xmlPath;
+    GeneratorCache::generatorHash = generatorHash;
+    GeneratorCache::force = force;
+    GeneratorCache::allObjects = allObjects;
+}
+
+/**
+ * Load the hashes of the last run of a language
+ */
+void GeneratorCache::open(const QString &language, const QString &outputPath)
+{
+    this->language = language;
+    this->outputPath = QDir(outputPath);
+    templates.clear();
+    templatesHash.clear();
+    previous.clear();
+    current.clear();
+    previousOutputs.clear();
+    currentOutputs.clear();
+
+    // One object per line: name, hash and the generated files, tab separated
+    QString hashes = readFile(this->outputPath.absoluteFilePath(language + ".hashes"), false);
+    foreach (QString line, hashes.split('\n', QString::SkipEmptyParts)) {
+        QStringList entry = line.split('\t');
+        if (entry.length() < 2)
+            continue;
+        previous.insert(entry[0], QByteArray::fromHex(entry[1].toLatin1()));
+        previousOutputs.insert(entry[0], entry.mid(2));
+    }
+}
+
+/**
+ * Add a template every object of the language is generated from
+ */
+void GeneratorCache::addTemplate(const QString &path, const QString &contents)
+{
+    addInput(path);
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(templatesHash);
+    hash.addData(path.toUtf8());
+    hash.addData(contents.toUtf8());
+    templatesHash = hash.result();
+}
+
+/**
+ * Add a file the aggregate outputs of the language are generated from. It
+ * does not affect the code of the objects, make just runs the generator when
+ * it changes.
+ */
+void GeneratorCache::addInput(const QString &path)
+{
+    if (!templates.contains(path))
+        templates << path;
+}
+
+/**
+ * Check whether the code of an object has to be generated again
+ * @param info the object
+ * @param outputs the files generated for it, they must all still exist
+ * @return true if it was generated from the same definition, templates and
+ * generator as the last time
+ */
+bool GeneratorCache::isUpToDate(ObjectInfo *info, const QStringList &outputs)
+{
+    QByteArray hash = objectHash(info);
+    currentOutputs.insert(info->name, outputs);
+
+    // Whatever happens next the old hash no longer describes the outputs
+    previousOutputs.remove(info->name);
+    QByteArray last = previous.take(info->name);
+    if (force || last != hash)
+        return false;
+
+    foreach (QString output, outputs) {
+        if (!QFileInfo(output).exists())
+            return false;
+    }
+
+    current.insert(info->name, hash);
+    return true;
+}
+
+/**
+ * Record that the code of an object was written
+ */
+void GeneratorCache::generated(ObjectInfo *info)
+{
+    current.insert(info->name, objectHash(info));
+}
+
+/**
+ * Save the hashes and the dependency manifest of the language. When all the
+ * definitions were parsed, the files generated for objects which no longer
+ * exist are removed.
+ * @param parser the parsed definitions
+ * @return true if both were written
+ */
+bool GeneratorCache::save(UAVObjectParser *parser)
+{
+    QHash<QString, QByteArray> all = current;
+    QHash<QString, QStringList> allOutputs = currentOutputs;
+
+    QStringList kept;
+    foreach (QStringList outputs, currentOutputs)
+        kept << outputs;
+
+    QHashIterator<QString, QByteArray> it(previous);
+    while (it.hasNext()) {
+        it.next();
+        QStringList outputs = previousOutputs.value(it.key());
+        if (allObjects) {
+            foreach (QString output, outputs) {
+                if (!kept.contains(output) && QFile::remove(output))
+                    generatorLog() << "Removed " << output.toStdString() << std::endl;
+            }
+        } else {
+            // Objects which were not asked for this time keep their hashes
+            all.insert(it.key(), it.value());
+            allOutputs.insert(it.key(), outputs);
+        }
+    }
+
+    QStringList names = all.keys();
+    names.sort();
+
+    QString hashes;
+    foreach (QString name, names) {
+        QStringList entry;
+        entry << name << QString::fromLatin1(all.value(name).toHex()) << allOutputs.value(name);
+        hashes.append(entry.join("\t") + "\n");
+    }
+
+    // The stamp is touched by make once the generator has run
+    QString manifest = "# Generated by uavobjgenerator, the inputs of the " + language + " code\n";
+    manifest.append("$(UAVOBJ_OUT_DIR)/" + language + ".stamp:");
+
+    QStringList inputs;
+    for (int objidx = 0; objidx < parser->getNumObjects(); ++objidx) {
+        QString xml = xmlPath + parser->getObjectByIndex(objidx)->filename;
+        if (!inputs.contains(xml))
+            inputs << xml;
+    }
+    inputs << templates;
+
+    foreach (QString input, inputs)
+        manifest.append(" \\\n  " + makePath(input));
+    manifest.append("\n");
+
+    // Removed definitions must not stop make, they just trigger a new run
+    foreach (QString input, inputs)
+        manifest.append("\n" + makePath(input) + ":\n");
+
+    return writeFile(outputPath.absoluteFilePath(language + ".hashes"), hashes) &&
+           writeFileIfDiffrent(outputPath.absoluteFilePath(language + ".d"), manifest);
+}
+
+/**
+ * Hash of everything the code of an object is generated from
+ */
+QByteArray GeneratorCache::objectHash(ObjectInfo *info)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(generatorHash);
+    hash.addData(templatesHash);
+    hash.addData(info->xmlHash);
+    return hash.result();
+}
+
+/**
+ * Escape a path for a make rule
+ */
+QString GeneratorCache::makePath(const QString &path)
+{
+    QString escaped = path;
+    escaped.replace(" ", "\\ ");
+    return escaped;
+}
@@ -0,0 +1,82 @@
+/**
+ ******************************************************************************
+ *
+ * @file       generator_cache.h
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2013
+ * @brief      Skips objects whose generated code cannot have changed
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef GENERATORCACHE_H
+#define GENERATORCACHE_H
+
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include <QHash>
+#include <QDir>
+
+#include "../uavobjectparser.h"
+
+/**
+ * Remembers what the code of every object of one language was generated
+ * from: the object definition, the templates of the language and the
+ * generator itself. An object for which none of them changed since the last
+ * run is not generated again.
+ *
+ * The hashes are kept in <language>.hashes in the output directory, with the
+ * files generated for each object so that they can be removed once the
+ * object is gone. Next to it <language>.d lists the definitions and
+ * templates for make, so that the generator is not run at all while they are
+ * unchanged.
+ */
+class GeneratorCache
+{
+public:
+    //! Set up all caches, must be called before any generator runs
+    static void configure(const QString &xmlPath, const QByteArray &generatorHash, bool force, bool allObjects);
+
+    void open(const QString &language, const QString &outputPath);
+    void addTemplate(const QString &path, const QString &contents);
+    void addInput(const QString &path);
+    bool isUpToDate(ObjectInfo *info, const QStringList &outputs);
+    void generated(ObjectInfo *info);
+    bool save(UAVObjectParser *parser);
+
+private:
+    QByteArray objectHash(ObjectInfo *info);
+    static QString makePath(const QString &path);
+
+    static QString xmlPath;
+    static QByteArray generatorHash;
+    static bool force;
+    static bool allObjects;
+
+    QString language;
+    QDir outputPath;
+    QStringList templates;
+    QByteArray templatesHash;
+    QHash<QString, QByteArray> previous;
+    QHash<QString, QByteArray> current;
+    QHash<QString, QStringList> previousOutputs;
+    QHash<QString, QStringList> currentOutputs;
+};
+
+#endif
@@ -72,6 +72,8 @@ void replaceCommonTags(QString& out, ObjectInfo* info)
     // Replace $(ISSETTINGS) tag
     out.replace(QString("$(ISSETTINGS)"), boolTo01String( info->isSettings ));
     out.replace(QString("$(ISSETTINGSTF)"), boolToTRUEFALSEString( info->isSettings ));    
+    // Replace $(EMITONCHANGE) tag
+    out.replace(QString("$(EMITONCHANGE)"), boolTo01String( info->isEmitOnChange ));
     // Replace $(NUMBTES) tag
     out.replace(QString("$(NUMBYTES)"), QString().setNum(info->numBytes));
     // Replace $(GCSACCESS) tag
@@ -26,8 +26,43 @@
 
 #include "generator_io.h"
 
+#include <QCoreApplication>
+#include <QThread>
+#include <QThreadStorage>
+#include <sstream>
+
 using namespace std;
 
+static QThreadStorage<ostringstream *> generatorLogs;
+
+/**
+ * Stream for the messages of the generators. The languages are generated in
+ * parallel, so the messages of a generator thread are kept until main prints
+ * them with takeGeneratorLog. The main thread writes straight to cout.
+ */
+ostream& generatorLog()
+{
+    if (QThread::currentThread() == QCoreApplication::instance()->thread())
+        return cout;
+
+    if (!generatorLogs.hasLocalData())
+        generatorLogs.setLocalData(new ostringstream());
+    return *generatorLogs.localData();
+}
+
+/**
+ * Get and clear the messages logged by this thread
+ */
+string takeGeneratorLog()
+{
+    if (!generatorLogs.hasLocalData())
+        return string();
+
+    string log = generatorLogs.localData()->str();
+    generatorLogs.localData()->str(string());
+    return log;
+}
+
 /**
  * Read a file and return its contents as a string
  */
@@ -36,7 +71,7 @@ QString readFile(QString name,bool do_warn)
     QFile file(name);
     if (!file.open(QFile::ReadOnly))   {
         if (do_warn)
-            std::cout << "Warning: Could not open " << name.toStdString() << endl;
+            generatorLog() << "Warning: Could not open " << name.toStdString() << endl;
         return QString();
     }
 
@@ -33,10 +33,13 @@
 #include <QTextStream>
 #include <QDir>
 #include <iostream>
+#include <string>
 
-QString readFile(QString name);
+QString readFile(QString name, bool do_warn);
 QString readFile(QString name);
 bool writeFile(QString name, QString& str);
 bool writeFileIfDiffrent(QString name, QString& str);
+std::ostream& generatorLog();
+std::string takeGeneratorLog();
 
 #endif
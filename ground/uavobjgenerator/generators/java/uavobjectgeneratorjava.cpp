@@ -43,10 +43,14 @@ bool UAVObjectGeneratorJava::generate(UAVObjectParser* parser,QString templatepa
     QString javaInitTemplate = readFile( javaCodePath.absoluteFilePath("uavobjectsinittemplate.java") );
 
     if (javaCodeTemplate.isEmpty() || javaInitTemplate.isEmpty()) {
-        std::cerr << "Problem reading java code templates" << endl;
+        generatorLog() << "Problem reading java code templates" << endl;
         return false;
     }
 
+    cache.open("java", outputpath);
+    cache.addTemplate(javaCodePath.absoluteFilePath("uavobjecttemplate.java"), javaCodeTemplate);
+    cache.addInput(javaCodePath.absoluteFilePath("uavobjectsinittemplate.java"));
+
     QString objInc;
     QString javaObjInit;
 
@@ -63,7 +67,12 @@ bool UAVObjectGeneratorJava::generate(UAVObjectParser* parser,QString templatepa
     javaInitTemplate.replace( QString("$(OBJINIT)"), javaObjInit);
     bool res = writeFileIfDiffrent( javaOutputPath.absolutePath() + "/UAVObjectsInitialize.java", javaInitTemplate );
     if (!res) {
-        cout << "Error: Could not write output files" << endl;
+        generatorLog() << "Error: Could not write output files" << endl;
+        return false;
+    }
+
+    if (!cache.save(parser)) {
+        generatorLog() << "Error: Could not write java generator cache" << endl;
         return false;
     }
 
@@ -79,6 +88,11 @@ bool UAVObjectGeneratorJava::process_object(ObjectInfo* info)
     if (info == NULL)
         return false;
 
+    QStringList outputs;
+    outputs << javaOutputPath.absolutePath() + "/" + info->name + ".java";
+    if (cache.isUpToDate(info, outputs))
+        return true;
+
     // Prepare output strings
     QString outInclude = javaIncludeTemplate;
     QString outCode = javaCodeTemplate;
@@ -260,10 +274,12 @@ bool UAVObjectGeneratorJava::process_object(ObjectInfo* info)
     // Write the java code
     bool res = writeFileIfDiffrent( javaOutputPath.absolutePath() + "/" + info->name + ".java", outCode );
     if (!res) {
-        cout << "Error: Could not write gcs output files" << endl;
+        generatorLog() << "Error: Could not write gcs output files" << endl;
         return false;
     }
 
+    cache.generated(info);
+
     return true;
 }
 
@@ -44,6 +44,7 @@ private:
     QStringList fieldTypeStrCPP,fieldTypeStrCPPClass;
     QDir javaCodePath;
     QDir javaOutputPath;
+    GeneratorCache cache;
  };
 
 #endif
@@ -46,7 +46,7 @@ bool UAVObjectGeneratorMatlab::generate(UAVObjectParser* parser,QString template
     QString matlabCodeTemplate = readFile( matlabTemplatePath.absoluteFilePath( "uavobjecttemplate.m") );
 
     if (matlabCodeTemplate.isEmpty() ) {
-        std::cerr << "Problem reading matlab templates" << endl;
+        generatorLog() << "Problem reading matlab templates" << endl;
         return false;
     }
 
@@ -66,7 +66,7 @@ bool UAVObjectGeneratorMatlab::generate(UAVObjectParser* parser,QString template
 
     bool res = writeFile( matlabOutputPath.absolutePath() + "/LogConvert.m.pass1", matlabCodeTemplate );
     if (!res) {
-        cout << "Error: Could not write output files" << endl;
+        generatorLog() << "Error: Could not write output files" << endl;
         return false;
     }
 
@@ -34,9 +34,11 @@ bool UAVObjectGeneratorPython::generate(UAVObjectParser* parser,QString template
     pythonOutputPath.mkpath(pythonOutputPath.absolutePath());
     pythonCodeTemplate = readFile( pythonCodePath.absoluteFilePath("uavobjecttemplate.pyt") );
     if (pythonCodeTemplate.isEmpty()) {
-        std::cerr << "Problem reading python templates" << endl;
+        generatorLog() << "Problem reading python templates" << endl;
         return false;
     }
+    cache.open("python", outputpath);
+    cache.addTemplate(pythonCodePath.absoluteFilePath("uavobjecttemplate.pyt"), pythonCodeTemplate);
 
     // Process each object
     for (int objidx = 0; objidx < parser->getNumObjects(); ++objidx) {
@@ -44,6 +46,11 @@ bool UAVObjectGeneratorPython::generate(UAVObjectParser* parser,QString template
         process_object(info);
     }
 
+    if (!cache.save(parser)) {
+        generatorLog() << "Error: Could not write python generator cache" << endl;
+        return false;
+    }
+
     return true; // if we come here everything should be fine
 }
 
@@ -55,6 +62,11 @@ bool UAVObjectGeneratorPython::process_object(ObjectInfo* info)
     if (info == NULL)
         return false;
 
+    QStringList outputs;
+    outputs << pythonOutputPath.absolutePath() + "/" + info->namelc + ".py";
+    if (cache.isUpToDate(info, outputs))
+        return true;
+
     // Prepare output strings
     QString outCode = pythonCodeTemplate;
 
@@ -62,7 +74,9 @@ bool UAVObjectGeneratorPython::process_object(ObjectInfo* info)
     replaceCommonTags(outCode, info);
 
     // Replace the ($DATAFIELDS) tag
+    // Fields are packed in this order, so each one starts where the last ended
     QString datafields;
+    int offset = 0;
     for (int n = 0; n < info->fields.length(); ++n)
     {
         // Class header
@@ -97,7 +111,8 @@ bool UAVObjectGeneratorPython::process_object(ObjectInfo* info)
         }
         // Constructor
         datafields.append(QString("\tdef __init__(self):\n"));
-        datafields.append(QString("\t\tUAVObjectField.__init__(self, %1, %2)\n\n").arg(info->fields[n]->type).arg(info->fields[n]->numElements));
+        datafields.append(QString("\t\tUAVObjectField.__init__(self, %1, %2, %3)\n\n").arg(info->fields[n]->type).arg(info->fields[n]->numElements).arg(offset));
+        offset += info->fields[n]->numBytes * info->fields[n]->numElements;
     }
     outCode.replace(QString("$(DATAFIELDS)"), datafields);
 
@@ -113,10 +128,12 @@ bool UAVObjectGeneratorPython::process_object(ObjectInfo* info)
     // Write the Python code
     bool res = writeFileIfDiffrent( pythonOutputPath.absolutePath() + "/" + info->namelc + ".py", outCode );
     if (!res) {
-        cout << "Error: Could not write Python output files" << endl;
+        generatorLog() << "Error: Could not write Python output files" << endl;
         return false;
     }
 
+    cache.generated(info);
+
     return true;
 }
 
@@ -40,6 +40,7 @@ private:
     QString pythonCodeTemplate;
     QDir pythonCodePath;
     QDir pythonOutputPath;
+    GeneratorCache cache;
 };
 
 #endif
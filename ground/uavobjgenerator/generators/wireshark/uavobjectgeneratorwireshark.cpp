@@ -44,10 +44,14 @@ bool UAVObjectGeneratorWireshark::generate(UAVObjectParser* parser,QString templ
     wiresharkMakeTemplate = readFile( wiresharkCodePath.absoluteFilePath("op-uavobjects/Makefile.common-template") );
 
     if ( wiresharkCodeTemplate.isNull() || wiresharkMakeTemplate.isNull()) {
-      cerr << "Error: Could not open wireshark template files." << endl;
+      generatorLog() << "Error: Could not open wireshark template files." << endl;
       return false;
     }
 
+    cache.open("wireshark", outputpath);
+    cache.addTemplate(wiresharkCodePath.absoluteFilePath("op-uavobjects/packet-op-uavobjects-template.c"), wiresharkCodeTemplate);
+    cache.addInput(wiresharkCodePath.absoluteFilePath("op-uavobjects/Makefile.common-template"));
+
     /* Copy static files for wireshark plugins root directory into output directory */
     QStringList topstaticfiles;
     topstaticfiles << "Custom.m4" << "Custom.make" << "Custom.nmake";
@@ -96,7 +100,12 @@ bool UAVObjectGeneratorWireshark::generate(UAVObjectParser* parser,QString templ
     bool res = writeFileIfDiffrent( uavobjectsOutputPath.absolutePath() + "/Makefile.common",
                      wiresharkMakeTemplate );
     if (!res) {
-      cout << "Error: Could not write wireshark Makefile" << endl;
+      generatorLog() << "Error: Could not write wireshark Makefile" << endl;
+      return false;
+    }
+
+    if (!cache.save(parser)) {
+      generatorLog() << "Error: Could not write wireshark generator cache" << endl;
       return false;
     }
 
@@ -112,6 +121,11 @@ bool UAVObjectGeneratorWireshark::process_object(ObjectInfo* info, QDir outputpa
     if (info == NULL)
         return false;
 
+    QStringList outputs;
+    outputs << outputpath.absolutePath() + "/packet-op-uavobjects-" + info->namelc + ".c";
+    if (cache.isUpToDate(info, outputs))
+        return true;
+
     // Prepare output strings
     QString outCode = wiresharkCodeTemplate;
 
@@ -280,10 +294,12 @@ bool UAVObjectGeneratorWireshark::process_object(ObjectInfo* info, QDir outputpa
     // Write the flight code
     bool res = writeFileIfDiffrent( outputpath.absolutePath() + "/packet-op-uavobjects-" + info->namelc + ".c", outCode );
     if (!res) {
-        cout << "Error: Could not write wireshark code files" << endl;
+        generatorLog() << "Error: Could not write wireshark code files" << endl;
         return false;
     }
 
+    cache.generated(info);
+
     return true;
 }
 
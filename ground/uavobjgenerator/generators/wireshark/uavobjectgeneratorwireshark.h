@@ -42,6 +42,7 @@ public:
 private:
     bool process_object(ObjectInfo* info, QDir outputpath);
 
+    GeneratorCache cache;
 };
 
 #endif
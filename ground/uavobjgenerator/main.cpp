@@ -27,6 +27,9 @@
 #include <QFile>
 #include <QString>
 #include <QStringList>
+#include <QCryptographicHash>
+#include <QtConcurrentRun>
+#include <QFuture>
 #include <iostream>
 
 #include "generators/java/uavobjectgeneratorjava.h"
@@ -38,15 +41,38 @@
 
 #define RETURN_ERR_USAGE 1
 #define RETURN_ERR_XML 2
+#define RETURN_ERR_GENERATE 3
 #define RETURN_OK 0
 
 using namespace std;
 
+/**
+ * What one language generator returned and printed
+ */
+struct GeneratorRun {
+    GeneratorRun() : generated(false) {}
+    bool generated;
+    string log;
+};
+
+/**
+ * Run a language generator on a thread of the pool, keeping its messages so
+ * that main can print them once all the languages are done
+ */
+template <class Generator>
+static GeneratorRun runGenerator(Generator* generator, UAVObjectParser* parser, QString templatepath, QString outputpath)
+{
+    GeneratorRun run;
+    run.generated = generator->generate(parser, templatepath, outputpath);
+    run.log = takeGeneratorLog();
+    return run;
+}
+
 /**
  * print usage info
  */
 void usage() {
-    cout << "Usage: uavobjectgenerator [-gcs] [-flight] [-java] [-python] [-matlab] [-wireshark] [-none] [-v] xml_path template_base [UAVObj1] ... [UAVObjN]" << endl;
+    cout << "Usage: uavobjectgenerator [-gcs] [-flight] [-java] [-python] [-matlab] [-wireshark] [-none] [-force] [-v] xml_path template_base [UAVObj1] ... [UAVObjN]" << endl;
     cout << "Languages: "<< endl;
     cout << "\t-gcs           build groundstation code" << endl;
     cout << "\t-flight        build flight code" << endl;
@@ -57,6 +83,7 @@ void usage() {
     cout << "\tIf no language is specified ( and not -none ) -> all are built." << endl;
     cout << "Misc: "<< endl;
     cout << "\t-none          build no language - just parse xml's" << endl;
+    cout << "\t-force         generate all objects again, even those which did not change" << endl;
     cout << "\t-h             this help" << endl;
     cout << "\t-v             verbose" << endl;
     cout << "\tinput_path     path to UAVObject definition (.xml) files." << endl;
@@ -107,6 +134,7 @@ int main(int argc, char *argv[])
     bool do_matlab=(arguments_stringlist.removeAll("-matlab")>0);
     bool do_wireshark=(arguments_stringlist.removeAll("-wireshark")>0);
     bool do_none=(arguments_stringlist.removeAll("-none")>0); //
+    bool do_force=(arguments_stringlist.removeAll("-force")>0);
 
     bool do_all=((do_gcs||do_flight||do_java||do_python||do_matlab)==false);
     bool do_allObjects=true;
@@ -201,48 +229,75 @@ int main(int argc, char *argv[])
     if (do_none)
       return RETURN_OK;     
 
+    // objects generated by another build of the generator are generated again
+    QByteArray generatorHash;
+    QFile generatorFile(QCoreApplication::applicationFilePath());
+    if (generatorFile.open(QFile::ReadOnly)) {
+        generatorHash = QCryptographicHash::hash(generatorFile.readAll(), QCryptographicHash::Sha1);
+        generatorFile.close();
+    } else {
+        do_force = true;
+    }
+    GeneratorCache::configure(inputpath, generatorHash, do_force, do_allObjects);
+
+    // the languages only read the parsed objects and write to their own
+    // directories, so they are generated in parallel
+    UAVObjectGeneratorFlight flightgen;
+    UAVObjectGeneratorGCS gcsgen;
+    UAVObjectGeneratorJava javagen;
+    UAVObjectGeneratorPython pygen;
+    UAVObjectGeneratorMatlab matlabgen;
+    UAVObjectGeneratorWireshark wiresharkgen;
+    QList< QFuture<GeneratorRun> > generators;
+
     // generate flight code if wanted
     if (do_flight|do_all) {
         cout << "generating flight code" << endl ;
-        UAVObjectGeneratorFlight flightgen;
-        flightgen.generate(parser,templatepath,outputpath);
+        generators << QtConcurrent::run(&runGenerator<UAVObjectGeneratorFlight>, &flightgen, parser, templatepath, outputpath);
     }
 
     // generate gcs code if wanted
     if (do_gcs|do_all) {
         cout << "generating gcs code" << endl ;
-        UAVObjectGeneratorGCS gcsgen;
-        gcsgen.generate(parser,templatepath,outputpath);
+        generators << QtConcurrent::run(&runGenerator<UAVObjectGeneratorGCS>, &gcsgen, parser, templatepath, outputpath);
     }
 
     // generate java code if wanted
     if (do_java|do_all) {
         cout << "generating java code" << endl ;
-        UAVObjectGeneratorJava javagen;
-        javagen.generate(parser,templatepath,outputpath);
+        generators << QtConcurrent::run(&runGenerator<UAVObjectGeneratorJava>, &javagen, parser, templatepath, outputpath);
     }
 
     // generate python code if wanted
     if (do_python|do_all) {
         cout << "generating python code" << endl ;
-        UAVObjectGeneratorPython pygen;
-        pygen.generate(parser,templatepath,outputpath);
+        generators << QtConcurrent::run(&runGenerator<UAVObjectGeneratorPython>, &pygen, parser, templatepath, outputpath);
     }
 
     // generate matlab code if wanted
     if (do_matlab|do_all) {
         cout << "generating matlab code" << endl ;
-        UAVObjectGeneratorMatlab matlabgen;
-        matlabgen.generate(parser,templatepath,outputpath);
+        generators << QtConcurrent::run(&runGenerator<UAVObjectGeneratorMatlab>, &matlabgen, parser, templatepath, outputpath);
     }
 
     // generate wireshark plugin if wanted
     if (do_wireshark|do_all) {
         cout << "generating wireshark code" << endl ;
-        UAVObjectGeneratorWireshark wiresharkgen;
-        wiresharkgen.generate(parser,templatepath,outputpath);
+        generators << QtConcurrent::run(&runGenerator<UAVObjectGeneratorWireshark>, &wiresharkgen, parser, templatepath, outputpath);
     }
 
+    // wait for all of them, a failed language must not leave the others half written
+    bool generated = true;
+    for (int n = 0; n < generators.length(); ++n) {
+        GeneratorRun run = generators[n].result();
+        cout << run.log;
+        if (!run.generated)
+            generated = false;
+    }
+
+    if (!generated)
+        return RETURN_ERR_GENERATE;
+
     return RETURN_OK;
 }
 
@@ -137,6 +137,7 @@ QString UAVObjectParser::parseXML(QString& xml, QString& filename)
         ObjectInfo* info = new ObjectInfo;
 
         info->filename=filename;
+        info->xmlHash=QCryptographicHash::hash(xml.toUtf8(), QCryptographicHash::Sha1);
         // Process object attributes
         QString status = processObjectAttributes(node, info);
         if (!status.isNull())
@@ -610,6 +611,15 @@ QString UAVObjectParser::processObjectAttributes(QDomNode& node, ObjectInfo* inf
     if ( info->isSettings && !info->isSingleInst )
         return QString("Object: Settings objects can not have multiple instances");
 
+    // Get emitonchange attribute if present, it does not change the object ID
+    attr = attributes.namedItem("emitonchange");
+    if ( attr.isNull() || attr.nodeValue().compare(QString("false")) == 0 )
+        info->isEmitOnChange = false;
+    else if ( attr.nodeValue().compare(QString("true")) == 0 )
+        info->isEmitOnChange = true;
+    else
+        return QString("Object:emitonchange attribute value is invalid");
+
     // Done
     return QString();
 }
@@ -34,6 +34,7 @@
 #include <QDomElement>
 #include <QDomNode>
 #include <QByteArray>
+#include <QCryptographicHash>
 
 // Types
 typedef enum {
@@ -81,9 +82,11 @@ typedef struct  {
     QString name;
     QString namelc; /** name in lowercase */
     QString filename;
+    QByteArray xmlHash; /** Hash of the definition, used to skip unchanged objects */
     quint32 id;
     bool isSingleInst;
     bool isSettings;
+    bool isEmitOnChange; /** Only emit update events when the data actually changes */
     AccessMode gcsAccess;
     AccessMode flightAccess;
     bool flightTelemetryAcked;
@@ -16,6 +16,7 @@ TEMPLATE = app
 SOURCES += main.cpp \
     uavobjectparser.cpp \
     generators/generator_io.cpp \
+    generators/generator_cache.cpp \
     generators/java/uavobjectgeneratorjava.cpp \
     generators/flight/uavobjectgeneratorflight.cpp \
     generators/gcs/uavobjectgeneratorgcs.cpp \
@@ -25,6 +26,7 @@ SOURCES += main.cpp \
     generators/generator_common.cpp
 HEADERS += uavobjectparser.h \
     generators/generator_io.h \
+    generators/generator_cache.h \
     generators/java/uavobjectgeneratorjava.h \
     generators/gcs/uavobjectgeneratorgcs.h \
     generators/matlab/uavobjectgeneratormatlab.h \
@@ -0,0 +1,182 @@
+#!/usr/bin/env python
+#
+# Lockstep driver for the HITL sensor bridge of the POSIX simulator.
+#
+# Plays the part of the physics engine: every step it sends a sensor packet
+# to the simulated Sensors module over UDP, waits for the actuator answer
+# with the same sequence number and only then integrates the next step. The
+# vehicle model is deliberately trivial (the attitude follows ActuatorDesired
+# as a rate command, the position is held) since the point is the protocol
+# and the loop latency, which are reported at the end.
+#
+# Example:
+#   make sim_posix_revolution
+#   python make/scripts/hitl_bridge_lockstep.py --launch --steps=5000
+#
+# The simulator only opens the bridge when SIM_HITL_BRIDGE is set in its
+# environment, --launch does it.
+#
+# The packet layouts must match shared/api/hitl_bridge.h.
+#
+# (c) 2013, Tau Labs, http://taulabs.org
+# See also: The GNU Public License (GPL) Version 3
+#
+
+from __future__ import print_function
+
+import math
+import optparse
+import os
+import socket
+import struct
+import subprocess
+import sys
+import tempfile
+import time
+
+HITL_BRIDGE_PORT = 9004
+SENSORS_MAGIC = 0x53424c48
+ACTUATORS_MAGIC = 0x41424c48
+
+LOCKSTEP = 0x01
+HAS_MAG = 0x02
+HAS_BARO = 0x04
+HAS_GPS = 0x08
+
+# struct hitl_bridge_sensors and struct hitl_bridge_actuators, packed
+SENSORS = struct.Struct("<IIII3f3f3fffiif3f")
+ACTUATORS = struct.Struct("<IIII4f10h")
+assert SENSORS.size == 84 and ACTUATORS.size == 52
+
+GRAVITY = 9.81
+BE = (21000.0, 1300.0, 43000.0)   # earth field in nT, roughly mid latitudes
+MAX_RATE = (150.0, 150.0, 100.0)  # deg/s for a full ActuatorDesired deflection
+
+def rotation(roll, pitch, yaw):
+    """ Rbe for the roll, pitch and yaw in degrees """
+    r, p, y = [math.radians(a) for a in (roll, pitch, yaw)]
+    cr, sr, cp, sp, cy, sy = math.cos(r), math.sin(r), math.cos(p), math.sin(p), math.cos(y), math.sin(y)
+    return ((cp * cy, cp * sy, -sp),
+            (sr * sp * cy - cr * sy, sr * sp * sy + cr * cy, sr * cp),
+            (cr * sp * cy + sr * sy, cr * sp * sy - sr * cy, cr * cp))
+
+def body(R, v):
+    return [R[i][0] * v[0] + R[i][1] * v[1] + R[i][2] * v[2] for i in range(3)]
+
+def percentile(values, p):
+    if not values:
+        return float("nan")
+    values = sorted(values)
+    return values[min(len(values) - 1, int(p / 100.0 * len(values)))]
+
+def main():
+    root = os.path.normpath(os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", ".."))
+
+    parser = optparse.OptionParser(usage="%prog [options]")
+    parser.add_option("--host", default="127.0.0.1", help="address of the simulator [%default]")
+    parser.add_option("--port-offset", type="int", default=0, dest="port_offset",
+                      help="SIM_PORT_OFFSET of the simulator [%default]")
+    parser.add_option("--steps", type="int", default=2000, help="physics steps [%default]")
+    parser.add_option("--dt", type="float", default=0.002, help="physics step, s [%default]")
+    parser.add_option("--timeout", type="float", default=0.1,
+                      help="time to wait for an answer before counting it lost, s [%default]")
+    parser.add_option("--free-running", action="store_false", dest="lockstep", default=True,
+                      help="do not ask the firmware to wait for the control loop")
+    parser.add_option("--launch", action="store_true",
+                      help="start the simulator binary instead of using a running one")
+    parser.add_option("--sim", default=os.path.join(root, "build", "sim_posix_revolution", "sim_posix_revolution.elf"),
+                      help="simulator binary for --launch [%default]")
+    (options, args) = parser.parse_args()
+
+    sim = None
+    if options.launch:
+        if not os.path.exists(options.sim):
+            parser.error("%s not found, build it with 'make sim_posix_revolution'" % options.sim)
+        env = dict(os.environ)
+        env["SIM_PORT_OFFSET"] = str(options.port_offset)
+        env["SIM_HITL_BRIDGE"] = "1"
+        workdir = tempfile.mkdtemp(prefix="hitlbridge_")
+        log = open(os.path.join(workdir, "sim.log"), "w")
+        sim = subprocess.Popen([os.path.abspath(options.sim)], cwd=workdir, env=env,
+                               stdout=log, stderr=subprocess.STDOUT)
+        time.sleep(2)
+
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.settimeout(options.timeout)
+    address = (options.host, HITL_BRIDGE_PORT + options.port_offset)
+
+    flags = HAS_MAG | HAS_BARO | HAS_GPS | (LOCKSTEP if options.lockstep else 0)
+    attitude = [0.0, 0.0, 0.0]
+    rates = [0.0, 0.0, 0.0]
+    latencies = []
+    firmware = []
+    lost = mismatched = stale = 0
+
+    try:
+        for seq in range(1, options.steps + 1):
+            R = rotation(*attitude)
+            accel = body(R, (0.0, 0.0, -GRAVITY))
+            mag = body(R, BE)
+            packet = SENSORS.pack(SENSORS_MAGIC, seq, flags, int(seq * options.dt * 1e6) & 0xffffffff,
+                                  rates[0], rates[1], rates[2],
+                                  accel[0], accel[1], accel[2],
+                                  mag[0], mag[1], mag[2],
+                                  0.0, 0.0,
+                                  0, 0, 0.0,
+                                  0.0, 0.0, 0.0)
+
+            sent = time.time()
+            sock.sendto(packet, address)
+
+            # Wait for the answer to this step, dropping late answers to earlier ones
+            answer = None
+            while answer is None:
+                try:
+                    data = sock.recv(ACTUATORS.size + 1)
+                except socket.timeout:
+                    break
+                if len(data) != ACTUATORS.size:
+                    continue
+                fields = ACTUATORS.unpack(data)
+                if fields[0] != ACTUATORS_MAGIC:
+                    continue
+                if fields[1] == seq:
+                    answer = fields
+                elif fields[1] > seq:
+                    mismatched += 1
+
+            if answer is None:
+                lost += 1
+                continue
+
+            latencies.append((time.time() - sent) * 1000.0)
+            firmware.append(answer[2] / 1000.0)
+            if not answer[3]:
+                stale += 1
+
+            # Only now step the physics, with the controls of this step
+            desired = answer[4:8]
+            for i in range(3):
+                rates[i] = max(-1.0, min(1.0, desired[i])) * MAX_RATE[i]
+                attitude[i] += rates[i] * options.dt
+            attitude[2] = (attitude[2] + 180.0) % 360.0 - 180.0
+    except KeyboardInterrupt:
+        pass
+    finally:
+        if sim is not None:
+            sim.terminate()
+            sim.wait()
+
+    answered = len(latencies)
+    print("%u steps, %u answered, %u lost, %u out of order, %u without a control loop update" %
+          (options.steps, answered, lost, mismatched, stale))
+    if answered:
+        print("loop latency ms: mean %.3f  p50 %.3f  p99 %.3f  max %.3f" %
+              (sum(latencies) / answered, percentile(latencies, 50), percentile(latencies, 99), max(latencies)))
+        print("in the firmware ms: mean %.3f  max %.3f" % (sum(firmware) / answered, max(firmware)))
+        print("final attitude: roll %.1f pitch %.1f yaw %.1f" % tuple(attitude))
+
+    return 0 if answered and not mismatched else 1
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,590 @@
+#!/usr/bin/env python
+#
+# Monte-Carlo batch runner for the POSIX simulator.
+#
+# Launches many isolated sim_posix_revolution processes in parallel. Each one
+# gets its own working directory (and so its own flash image) and its own
+# telemetry port, through SIM_PORT_OFFSET. For every run the parameters listed
+# in the scenario are drawn at random and written to the settings objects over
+# UAVTalk, the scripted stick inputs are played through GCSReceiver, and the
+# tracking errors are measured on the telemetry stream. One line per run is
+# written to a CSV report.
+#
+# Example:
+#   make sim_posix_revolution
+#   python make/scripts/sim_montecarlo.py --runs=1000 \
+#       --scenario=make/scripts/sim_montecarlo_attitude.json
+#
+# The scenario is a JSON file:
+#   duration    seconds of simulated flight per run
+#   settings    {object: {field: value}} written identically for all runs
+#   parameters  [{object, field, element, uniform: [lo, hi] | gauss: [mean, sd]}]
+#               drawn for each run
+#   commands    [{time, object, field, value}] sent when the simulated flight
+#               time reaches time (s)
+#   rates       {object: period (ms)} telemetry rates the metrics need
+#   metrics     [{name, desired, actual, from, to, angle}] where desired and
+#               actual are Object.Field[.Element] or a number; the RMS and
+#               the maximum of desired - actual over [from, to] are reported
+#
+# A value is a number, an enum option name, a list with one value per
+# element, or a dictionary keyed by element name.
+#
+# (c) 2013, Tau Labs, http://taulabs.org
+# See also: The GNU Public License (GPL) Version 3
+#
+
+from __future__ import print_function
+
+import csv
+import glob
+import json
+import math
+import multiprocessing
+import optparse
+import os
+import random
+import shutil
+import signal
+import socket
+import struct
+import subprocess
+import sys
+import tempfile
+import time
+import xml.dom.minidom
+
+# Must match the order of the uavobjgenerator field types
+FIELD_TYPES = ["int8", "int16", "int32", "uint8", "uint16", "uint32", "float", "enum"]
+FIELD_FORMATS = ["b", "h", "i", "B", "H", "I", "f", "B"]
+FIELD_SIZES = [1, 2, 4, 1, 2, 4, 4, 1]
+
+UAVTALK_SYNC = 0x3C
+UAVTALK_TYPE_OBJ = 0x20
+UAVTALK_TYPE_OBJ_REQ = 0x21
+UAVTALK_TYPE_OBJ_ACK = 0x22
+UAVTALK_TYPE_ACK = 0x23
+UAVTALK_TYPE_NACK = 0x24
+UAVTALK_TIMESTAMPED = 0x80
+UAVTALK_HEADER_LENGTH = 8
+
+UPDATEMODE_PERIODIC = 1
+TELEMETRY_UPDATE_MODE_SHIFT = 4
+
+TELEMETRY_PORT = 9000
+PORTS_PER_SIM = 10
+
+class Field:
+    def __init__(self, name, type, elements, options):
+        self.name = name
+        self.type = type
+        self.elements = elements
+        self.options = options
+
+class ObjectDefinition:
+    """Layout of one UAVObject, parsed from its XML definition the way the
+    uavobjgenerator does it: fields sorted by size and the same ID hash."""
+
+    def __init__(self, node):
+        self.name = node.getAttribute("name")
+        self.settings = node.getAttribute("settings") == "true"
+        self.single = node.getAttribute("singleinstance") == "true"
+        self.fields = []
+
+        for f in node.getElementsByTagName("field"):
+            name = f.getAttribute("name")
+            parent = f.getAttribute("cloneof")
+            if parent:
+                p = self.field(parent)
+                self.fields.append(Field(name, p.type, p.elements, p.options))
+                continue
+
+            type = FIELD_TYPES.index(f.getAttribute("type"))
+            elements = self._list(f, "elementnames", "elementname")
+            if not elements:
+                elements = [str(n) for n in range(int(f.getAttribute("elements")))]
+            options = []
+            if FIELD_TYPES[type] == "enum":
+                options = self._list(f, "options", "option")
+            self.fields.append(Field(name, type, elements, options))
+
+        # Python sorts are stable, as is the generator's qStableSort
+        self.fields.sort(key=lambda f: -FIELD_SIZES[f.type])
+
+        self.id = self._hash()
+        self.format = "<" + "".join(["%u%s" % (len(f.elements), FIELD_FORMATS[f.type]) for f in self.fields])
+        self.size = struct.calcsize(self.format)
+
+    @staticmethod
+    def _list(node, attribute, child):
+        if node.hasAttribute(attribute):
+            return [s.strip() for s in node.getAttribute(attribute).split(",") if s.strip()]
+        values = []
+        for l in node.getElementsByTagName(attribute):
+            for e in l.getElementsByTagName(child):
+                values.append(e.firstChild.nodeValue)
+        return values
+
+    def _hash(self):
+        def update(value, hash):
+            return (hash ^ ((hash << 5) + (hash >> 2) + value)) & 0xFFFFFFFF
+        def update_str(value, hash):
+            for c in bytearray(value.encode("latin-1")):
+                # QByteArray holds signed chars
+                hash = update(c if c < 128 else c + 0xFFFFFF00, hash)
+            return hash
+
+        hash = update_str(self.name, 0)
+        hash = update(int(self.settings), hash)
+        hash = update(int(self.single), hash)
+        for f in self.fields:
+            hash = update_str(f.name, hash)
+            hash = update(len(f.elements), hash)
+            hash = update(f.type, hash)
+            for o in f.options:
+                hash = update_str(o, hash)
+        return hash & 0xFFFFFFFE
+
+    def field(self, name):
+        for f in self.fields:
+            if f.name == name:
+                return f
+        raise KeyError("%s has no field %s" % (self.name, name))
+
+    def unpack(self, data):
+        """Returns {field name: [element values]}"""
+        values = struct.unpack(self.format, data[:self.size])
+        result = {}
+        for f in self.fields:
+            result[f.name] = list(values[:len(f.elements)])
+            values = values[len(f.elements):]
+        return result
+
+    def pack(self, fields):
+        values = []
+        for f in self.fields:
+            values += fields[f.name]
+        return struct.pack(self.format, *values)
+
+    def encode(self, fields, field_name, value):
+        """Stores a scenario value into the unpacked fields"""
+        f = self.field(field_name)
+
+        def convert(v):
+            if f.options and not isinstance(v, (int, float)):
+                return f.options.index(v)
+            if FIELD_TYPES[f.type] == "float":
+                return float(v)
+            return int(round(v))
+
+        if isinstance(value, dict):
+            for element, v in value.items():
+                fields[f.name][f.elements.index(element)] = convert(v)
+        elif isinstance(value, list):
+            fields[f.name] = [convert(v) for v in value]
+        else:
+            fields[f.name] = [convert(value)] * len(f.elements)
+
+def load_definitions(path):
+    definitions = {}
+    for filename in glob.glob(os.path.join(path, "*.xml")):
+        doc = xml.dom.minidom.parse(filename)
+        for node in doc.getElementsByTagName("object"):
+            d = ObjectDefinition(node)
+            definitions[d.name] = d
+    return definitions
+
+def crc8(data):
+    crc = 0
+    for b in bytearray(data):
+        crc ^= b
+        for i in range(8):
+            crc = ((crc << 1) ^ 0x07) & 0xFF if crc & 0x80 else (crc << 1) & 0xFF
+    return crc
+
+class Link:
+    """Minimal UAVTalk connection to the telemetry port of one simulator"""
+
+    def __init__(self, port, timeout):
+        deadline = time.time() + timeout
+        while True:
+            try:
+                self.sock = socket.create_connection(("127.0.0.1", port), 1)
+                break
+            except socket.error:
+                if time.time() > deadline:
+                    raise
+                time.sleep(0.1)
+        self.sock.settimeout(0.1)
+        self.buffer = bytearray()
+
+    def close(self):
+        self.sock.close()
+
+    def send(self, type, objid, data=b""):
+        packet = struct.pack("<BBHI", UAVTALK_SYNC, type, UAVTALK_HEADER_LENGTH + len(data), objid) + data
+        self.sock.sendall(packet + struct.pack("B", crc8(packet)))
+
+    def receive(self):
+        """Returns the next (type, objid, payload) or None on a timeout.
+        Only single instance objects are handled."""
+        while True:
+            while len(self.buffer) >= UAVTALK_HEADER_LENGTH + 1:
+                if self.buffer[0] != UAVTALK_SYNC:
+                    del self.buffer[0]
+                    continue
+                type, length, objid = struct.unpack("<xBHI", bytes(self.buffer[:UAVTALK_HEADER_LENGTH]))
+                if length < UAVTALK_HEADER_LENGTH or length > 1024:
+                    del self.buffer[0]
+                    continue
+                if len(self.buffer) < length + 1:
+                    break
+                packet = bytes(self.buffer[:length])
+                checksum = self.buffer[length]
+                if crc8(packet) != checksum:
+                    del self.buffer[0]
+                    continue
+                del self.buffer[:length + 1]
+                payload = packet[UAVTALK_HEADER_LENGTH:]
+                if type & UAVTALK_TIMESTAMPED:
+                    payload = payload[2:]
+                return (type & ~UAVTALK_TIMESTAMPED, objid, payload)
+
+            try:
+                data = self.sock.recv(4096)
+            except socket.timeout:
+                return None
+            if not data:
+                raise IOError("simulator closed the connection")
+            self.buffer += data
+
+class Flight:
+    """One simulated flight: settings, scripted inputs and error metrics"""
+
+    def __init__(self, link, definitions, handler):
+        self.link = link
+        self.defs = definitions
+        self.byid = dict((d.id, d) for d in definitions.values())
+        self.handler = handler
+        self.latest = {}
+        self.commands = {}
+
+    def wait_for(self, predicate, timeout):
+        deadline = time.time() + timeout
+        while time.time() < deadline:
+            packet = self.link.receive()
+            if packet is None:
+                continue
+            type, objid, payload = packet
+            d = self.byid.get(objid)
+            if d is not None and type in (UAVTALK_TYPE_OBJ, UAVTALK_TYPE_OBJ_ACK) and len(payload) >= d.size:
+                self.latest[d.name] = d.unpack(payload)
+                self.handler(d.name)
+            if predicate(type, objid, payload):
+                return payload
+        return None
+
+    def connect(self):
+        gcs = self.defs["GCSTelemetryStats"]
+        flight = self.defs["FlightTelemetryStats"]
+        status = flight.field("Status").options
+
+        fields = dict((f.name, [0] * len(f.elements)) for f in gcs.fields)
+        for request in ["HandshakeReq", "Connected"]:
+            gcs.encode(fields, "Status", request)
+            self.link.send(UAVTALK_TYPE_OBJ, gcs.id, gcs.pack(fields))
+            expected = "HandshakeAck" if request == "HandshakeReq" else "Connected"
+            if self.wait_for(lambda t, i, p: i == flight.id and
+                             flight.unpack(p)["Status"][0] == status.index(expected), 10) is None:
+                raise IOError("telemetry handshake failed")
+        self.keepalive = gcs.pack(fields)
+        self.keepalive_id = gcs.id
+        self.last_keepalive = time.time()
+
+    def poll(self):
+        if time.time() - self.last_keepalive > 1:
+            self.link.send(UAVTALK_TYPE_OBJ, self.keepalive_id, self.keepalive)
+            self.last_keepalive = time.time()
+        # Receivers fail safe when their inputs go stale, so commands are repeated
+        for objid, data in self.commands.items():
+            self.link.send(UAVTALK_TYPE_OBJ, objid, data)
+        self.wait_for(lambda t, i, p: True, 0.1)
+
+    def read(self, objid, size):
+        for retry in range(5):
+            self.link.send(UAVTALK_TYPE_OBJ_REQ, objid)
+            payload = self.wait_for(lambda t, i, p: i == objid and t in (UAVTALK_TYPE_OBJ, UAVTALK_TYPE_OBJ_ACK) and
+                                    len(p) >= size, 1)
+            if payload is not None:
+                return payload[:size]
+        raise IOError("no reply to the request for object 0x%08X" % objid)
+
+    def write(self, objid, data):
+        for retry in range(5):
+            self.link.send(UAVTALK_TYPE_OBJ_ACK, objid, data)
+            if self.wait_for(lambda t, i, p: i == objid and t == UAVTALK_TYPE_ACK, 1) is not None:
+                return
+        raise IOError("object 0x%08X was not acknowledged" % objid)
+
+    def set(self, name, values, acked=True):
+        """Read-modify-write of some fields of an object"""
+        d = self.defs[name]
+        fields = d.unpack(self.read(d.id, d.size))
+        for field, value in values.items():
+            d.encode(fields, field, value)
+        if acked:
+            self.write(d.id, d.pack(fields))
+        else:
+            self.commands[d.id] = d.pack(fields)
+            self.link.send(UAVTALK_TYPE_OBJ, d.id, self.commands[d.id])
+        self.latest[name] = fields
+
+    def set_rate(self, name, period):
+        """Makes the flight send an object periodically"""
+        metaid = self.defs[name].id + 1
+        flags, telemetry, gcs, logging = struct.unpack("<BHHH", self.read(metaid, 7))
+        flags &= ~(0x3 << TELEMETRY_UPDATE_MODE_SHIFT)
+        flags |= UPDATEMODE_PERIODIC << TELEMETRY_UPDATE_MODE_SHIFT
+        self.write(metaid, struct.pack("<BHHH", flags, period, gcs, logging))
+
+    def value(self, reference):
+        """Current value of Object.Field[.Element], or None before the first update"""
+        if isinstance(reference, (int, float)):
+            return reference
+        parts = reference.split(".")
+        fields = self.latest.get(parts[0])
+        if fields is None:
+            return None
+        d = self.defs[parts[0]]
+        f = d.field(parts[1])
+        element = f.elements.index(parts[2]) if len(parts) > 2 else 0
+        return fields[f.name][element]
+
+class Metric:
+    def __init__(self, spec):
+        self.spec = spec
+        self.object = str(spec["actual"]).split(".")[0]
+        self.sum = 0.0
+        self.max = 0.0
+        self.count = 0
+
+    def sample(self, flight, t):
+        if t < self.spec.get("from", 0) or t > self.spec.get("to", float("inf")):
+            return
+        desired = flight.value(self.spec["desired"])
+        actual = flight.value(self.spec["actual"])
+        if desired is None or actual is None:
+            return
+        error = desired - actual
+        if self.spec.get("angle", False):
+            error = (error + 180) % 360 - 180
+        self.sum += error * error
+        self.max = max(self.max, abs(error))
+        self.count += 1
+
+    def rms(self):
+        return math.sqrt(self.sum / self.count) if self.count else float("nan")
+
+def draw_parameters(scenario, seed):
+    rng = random.Random(seed)
+    drawn = []
+    for p in scenario.get("parameters", []):
+        if "uniform" in p:
+            value = rng.uniform(*p["uniform"])
+        else:
+            value = rng.gauss(*p["gauss"])
+        drawn.append((p, value))
+    return drawn
+
+def parameter_name(p):
+    return ".".join([p["object"], p["field"]] + ([p["element"]] if "element" in p else []))
+
+def run_flight(options, scenario, definitions, run, port_offset):
+    seed = options.seed + run
+    parameters = draw_parameters(scenario, seed)
+    result = {"run": run, "seed": seed, "status": "ok"}
+    for p, value in parameters:
+        result[parameter_name(p)] = value
+
+    workdir = tempfile.mkdtemp(prefix="montecarlo%u_" % run)
+    if options.flash:
+        shutil.copy(options.flash, os.path.join(workdir, "theflash.bin"))
+
+    env = dict(os.environ)
+    env["SIM_PORT_OFFSET"] = str(port_offset)
+    if options.virtual_time:
+        env["SIM_VIRTUAL_TIME"] = "1"
+    log = open(os.path.join(workdir, "sim.log"), "w")
+    sim = subprocess.Popen([os.path.abspath(options.sim)], cwd=workdir, env=env,
+                           stdout=log, stderr=subprocess.STDOUT)
+
+    link = None
+    metrics = [Metric(m) for m in scenario.get("metrics", [])]
+    try:
+        link = Link(TELEMETRY_PORT + port_offset, 10)
+        clock = {"t": 0.0}
+        start = None
+
+        def updated(name):
+            if name == "SystemStats":
+                clock["t"] = flight.value("SystemStats.FlightTime") / 1000.0
+            for m in metrics:
+                if start is not None and m.object == name:
+                    m.sample(flight, clock["t"] - start)
+
+        flight = Flight(link, definitions, updated)
+        flight.connect()
+
+        # Fixed settings, then this run's draw on top of them
+        settings = {}
+        for name, values in scenario.get("settings", {}).items():
+            settings.setdefault(name, {}).update(values)
+        for p, value in parameters:
+            values = settings.setdefault(p["object"], {})
+            if "element" in p:
+                current = values.get(p["field"])
+                if not isinstance(current, dict):
+                    current = {}
+                current[p["element"]] = value
+                values[p["field"]] = current
+            else:
+                values[p["field"]] = value
+        if "SimulationSettings" in definitions:
+            settings.setdefault("SimulationSettings", {}).setdefault("Seed", seed)
+        for name, values in sorted(settings.items()):
+            flight.set(name, values)
+
+        rates = {"SystemStats": 100}
+        rates.update(scenario.get("rates", {}))
+        for name, period in sorted(rates.items()):
+            flight.set_rate(name, period)
+
+        # Flight times in the scenario count from here
+        commands = sorted(scenario.get("commands", []), key=lambda c: c["time"])
+        start = clock["t"]
+        deadline = time.time() + options.timeout
+        while clock["t"] - start < scenario["duration"]:
+            if time.time() > deadline:
+                raise IOError("timed out after %u s" % options.timeout)
+            if sim.poll() is not None:
+                raise IOError("simulator exited with %d" % sim.returncode)
+            while commands and commands[0]["time"] <= clock["t"] - start:
+                c = commands.pop(0)
+                flight.set(c["object"], {c["field"]: c["value"]}, acked=False)
+            flight.poll()
+    except Exception as e:
+        result["status"] = str(e)
+    finally:
+        if link is not None:
+            link.close()
+        if sim.poll() is None:
+            sim.send_signal(signal.SIGINT)
+            for i in range(20):
+                if sim.poll() is not None:
+                    break
+                time.sleep(0.1)
+            if sim.poll() is None:
+                sim.kill()
+                sim.wait()
+        log.close()
+        if options.keep:
+            result["workdir"] = workdir
+        else:
+            shutil.rmtree(workdir, ignore_errors=True)
+
+    cost = 0.0
+    for m in metrics:
+        result[m.spec["name"] + "_rms"] = m.rms()
+        result[m.spec["name"] + "_max"] = m.max
+        cost += m.rms() * m.spec.get("weight", 1.0)
+    result["cost"] = cost
+    if result["status"] == "ok" and math.isnan(cost):
+        result["status"] = "no samples"
+    return result
+
+# Each worker process owns one port offset for all of its runs
+worker_port_offset = None
+worker_definitions = None
+
+def init_worker(counter, uavobjects):
+    global worker_port_offset, worker_definitions
+    with counter.get_lock():
+        counter.value += 1
+        worker_port_offset = counter.value * PORTS_PER_SIM
+    worker_definitions = load_definitions(uavobjects)
+    signal.signal(signal.SIGINT, signal.SIG_IGN)
+
+def run_worker(args):
+    options, scenario, run = args
+    return run_flight(options, scenario, worker_definitions, run, worker_port_offset)
+
+def main():
+    root = os.path.normpath(os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", ".."))
+
+    parser = optparse.OptionParser(usage="%prog --scenario=<file.json> [options]")
+    parser.add_option("--scenario", help="scenario JSON file")
+    parser.add_option("--runs", type="int", default=100, help="number of flights [%default]")
+    parser.add_option("--jobs", type="int", default=multiprocessing.cpu_count(),
+                      help="simulators run in parallel [%default]")
+    parser.add_option("--seed", type="int", default=1, help="seed of the first run [%default]")
+    parser.add_option("--sim", default=os.path.join(root, "build", "sim_posix_revolution", "sim_posix_revolution.elf"),
+                      help="simulator binary [%default]")
+    parser.add_option("--uavobjects", default=os.path.join(root, "shared", "uavobjectdefinition"),
+                      help="UAVObject definitions the simulator was built with [%default]")
+    parser.add_option("--flash", help="flash image copied into each run, e.g. with a saved airframe")
+    parser.add_option("--output", default="montecarlo.csv", help="CSV report [%default]")
+    parser.add_option("--timeout", type="int", default=600, help="wall time limit of one run, s [%default]")
+    parser.add_option("--virtual-time", action="store_true", dest="virtual_time",
+                      help="run the simulators on their virtual clock")
+    parser.add_option("--keep", action="store_true", help="keep the run directories and simulator logs")
+    (options, args) = parser.parse_args()
+
+    if not options.scenario:
+        parser.error("a scenario is required")
+    if not os.path.exists(options.sim):
+        parser.error("%s not found, build it with 'make sim_posix_revolution'" % options.sim)
+
+    with open(options.scenario) as f:
+        scenario = json.load(f)
+
+    counter = multiprocessing.Value("i", 0)
+    pool = multiprocessing.Pool(options.jobs, init_worker, (counter, options.uavobjects))
+    jobs = [(options, scenario, run) for run in range(options.runs)]
+
+    results = []
+    started = time.time()
+    try:
+        for result in pool.imap_unordered(run_worker, jobs):
+            results.append(result)
+            print("run %u/%u: %s, cost %.4g" % (len(results), options.runs, result["status"], result["cost"]))
+    except KeyboardInterrupt:
+        pool.terminate()
+        print("interrupted, writing the %u finished runs" % len(results))
+    else:
+        pool.close()
+    pool.join()
+
+    results.sort(key=lambda r: r["run"])
+    columns = ["run", "seed", "status", "cost"]
+    columns += [parameter_name(p) for p in scenario.get("parameters", [])]
+    for m in scenario.get("metrics", []):
+        columns += [m["name"] + "_rms", m["name"] + "_max"]
+    if options.keep:
+        columns.append("workdir")
+    with open(options.output, "w") as f:
+        writer = csv.DictWriter(f, columns, extrasaction="ignore")
+        writer.writerow(dict((c, c) for c in columns))
+        writer.writerows(results)
+
+    ok = [r for r in results if r["status"] == "ok"]
+    print("%u of %u runs completed in %.0f s, report written to %s" %
+          (len(ok), len(results), time.time() - started, options.output))
+    for r in sorted(ok, key=lambda r: r["cost"])[:5]:
+        print("  run %u, cost %.4g: %s" % (r["run"], r["cost"],
+              ", ".join(["%s=%.4g" % (parameter_name(p), r[parameter_name(p)])
+                         for p in scenario.get("parameters", [])])))
+
+    return 0 if ok else 1
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,127 @@
+/**
+ ******************************************************************************
+ * @file       hitl_bridge.h
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2013
+ * @addtogroup Shared code
+ * @{
+ * @addtogroup HITL bridge
+ * @{
+ * @brief Binary packets exchanged between a simulator and the simulated
+ * sensors of the POSIX firmware.
+ *
+ * The simulator sends one @ref hitl_bridge_sensors packet per physics step
+ * straight to the firmware over UDP, bypassing the GCS telemetry link. The
+ * firmware writes the sensor objects from it and answers with a
+ * @ref hitl_bridge_actuators packet carrying the same sequence number. With
+ * @ref HITL_BRIDGE_LOCKSTEP set the answer is only sent once the control loop
+ * has produced the actuator values for that step, so a simulator which waits
+ * for it before stepping runs in lockstep with the firmware.
+ *
+ * Both packets are sent as they are laid out in memory, little endian.
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef HITL_BRIDGE_H_
+#define HITL_BRIDGE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//! UDP port the firmware listens on, moved by SIM_PORT_OFFSET like the others
+#define HITL_BRIDGE_PORT             9004
+
+#define HITL_BRIDGE_SENSORS_MAGIC    0x53424c48 //!< "HLBS"
+#define HITL_BRIDGE_ACTUATORS_MAGIC  0x41424c48 //!< "HLBA"
+
+//! Number of ActuatorCommand channels returned
+#define HITL_BRIDGE_CHANNELS         10
+
+//! Time the firmware waits for the control loop in lockstep before answering anyway
+#define HITL_BRIDGE_LOCKSTEP_TIMEOUT_MS 50
+
+//! Without packets for this long the firmware goes back to its own model
+#define HITL_BRIDGE_TIMEOUT_MS       500
+
+enum hitl_bridge_flags {
+	HITL_BRIDGE_LOCKSTEP     = 0x01, //!< Answer only after the control loop ran
+	HITL_BRIDGE_HAS_MAG      = 0x02, //!< mag is valid
+	HITL_BRIDGE_HAS_BARO     = 0x04, //!< baro_altitude is valid
+	HITL_BRIDGE_HAS_GPS      = 0x08, //!< latitude, longitude, altitude and velocity are valid
+	HITL_BRIDGE_HAS_AIRSPEED = 0x10, //!< airspeed is valid
+};
+
+struct hitl_bridge_sensors {
+	uint32_t magic;            //!< HITL_BRIDGE_SENSORS_MAGIC
+	uint32_t seq;              //!< Incremented by the simulator every step
+	uint32_t flags;            //!< Set of @ref hitl_bridge_flags
+	uint32_t sim_time_us;      //!< Simulation time, wraps
+	float gyro[3];             //!< Body rates in deg/s
+	float accel[3];            //!< Body accelerations in m/s^2
+	float mag[3];              //!< Body magnetic field, in the units of HomeLocation.Be
+	float baro_altitude;       //!< Barometric altitude in m
+	float airspeed;            //!< Calibrated airspeed in m/s
+	int32_t latitude;          //!< Latitude in deg * 1e7
+	int32_t longitude;         //!< Longitude in deg * 1e7
+	float altitude;            //!< Altitude above mean sea level in m
+	float velocity[3];         //!< Velocity in NED, m/s
+} __attribute__((packed));
+
+struct hitl_bridge_actuators {
+	uint32_t magic;            //!< HITL_BRIDGE_ACTUATORS_MAGIC
+	uint32_t seq;              //!< seq of the sensor packet that was answered
+	uint32_t firmware_us;      //!< Time spent in the firmware between the two packets
+	uint32_t fresh;            //!< Non zero if the actuators were updated for this step
+	float desired[4];          //!< ActuatorDesired roll, pitch, yaw, throttle
+	int16_t channel[HITL_BRIDGE_CHANNELS]; //!< ActuatorCommand in us
+} __attribute__((packed));
+
+/**
+ * Check a received datagram holds a sensor packet
+ */
+static inline const struct hitl_bridge_sensors * hitl_bridge_sensors_check(const void *data, size_t len)
+{
+	const struct hitl_bridge_sensors *s = (const struct hitl_bridge_sensors *) data;
+	if (len != sizeof(*s) || s->magic != HITL_BRIDGE_SENSORS_MAGIC)
+		return NULL;
+	return s;
+}
+
+/**
+ * Check a received datagram holds an actuator packet
+ */
+static inline const struct hitl_bridge_actuators * hitl_bridge_actuators_check(const void *data, size_t len)
+{
+	const struct hitl_bridge_actuators *a = (const struct hitl_bridge_actuators *) data;
+	if (len != sizeof(*a) || a->magic != HITL_BRIDGE_ACTUATORS_MAGIC)
+		return NULL;
+	return a;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HITL_BRIDGE_H_ */
+
+/**
+ * @}
+ * @}
+ */
@@ -0,0 +1,308 @@
+/**
+ ******************************************************************************
+ * @file       path_fillet.h
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2013
+ * @addtogroup Shared code
+ * @{
+ * @addtogroup Path fillet
+ * @{
+ * @brief Rounds the corners of a waypoint path with circular fillets.
+ *
+ * The waypoints are connected with straight lines and arcs so that the
+ * vehicle dynamics, i.e. Dubin's cart constraints, are taken into account.
+ * Before a corner is flown the path looks ahead at the next waypoint and
+ * adds fillets which align the vehicle with it. Obstacles are not taken into
+ * account.
+ *
+ * Every point carries the curvature of the segment which ends at it, so a
+ * path is processed one waypoint at a time with only the last point written
+ * and the next waypoint in memory. The same code serves the path planner
+ * gadget of the GCS and the on-board path storage.
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef PATH_FILLET_H_
+#define PATH_FILLET_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <math.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//! Most points a single waypoint is replaced by
+#define PATH_FILLET_MAX_POINTS 5
+
+#define PATH_FILLET_PI     3.14159265358979323846f
+#define PATH_FILLET_SQRT3  1.73205080756887729353f
+
+//! Distance taken off the fillet radius so that no two points overlap, in m
+#define PATH_FILLET_MARGIN 0.1f
+
+struct path_fillet_point {
+	float position[3];   //!< NED, m
+	float velocity;      //!< Velocity when reaching the point, m/s
+	float curvature;     //!< 1/radius of the arc ending at the point, positive clockwise, 0 for a line
+};
+
+enum path_fillet_arc_center {
+	PATH_FILLET_CENTER_FOUND,
+	PATH_FILLET_COINCIDENT_POINTS,
+	PATH_FILLET_INSUFFICIENT_RADIUS,
+};
+
+/**
+ * Circular modulus, the equivalent angle between -pi and pi
+ * @param[in] err angle in radians
+ */
+static inline float path_fillet_circular_modulus(float err)
+{
+	float val = fmodf(err + PATH_FILLET_PI, 2 * PATH_FILLET_PI);
+
+	// fmodf keeps the sign of negative values, shift them back into range
+	if (val < 0)
+		val += PATH_FILLET_PI;
+	else
+		val -= PATH_FILLET_PI;
+
+	return val;
+}
+
+/**
+ * Angle between two 2D vectors. The tangent, unlike the sine or cosine on
+ * their own, is unique over the whole circle, so it is computed from the
+ * cross product |a||b| sin(theta) and the dot product |a||b| cos(theta).
+ * @returns the angle from a to b in radians, positive clockwise in NED
+ */
+static inline float path_fillet_angle_between(const float a[2], const float b[2])
+{
+	return atan2f(a[0] * b[1] - a[1] * b[0], a[0] * b[0] + a[1] * b[1]);
+}
+
+/**
+ * Center of an arc of the given radius through two points, the intersection
+ * of the two circles of that radius around them. Inspired by
+ * http://www.mathworks.com/matlabcentral/newsreader/view_thread/255121
+ * @param[in] start_point start of the arc, North-East
+ * @param[in] end_point end of the arc, North-East
+ * @param[in] radius radius of the arc
+ * @param[out] center the center, North-East
+ * @param[in] clockwise true if the arc turns clockwise
+ * @param[in] minor true for the minor arc, false for the major one
+ */
+static inline enum path_fillet_arc_center path_fillet_find_arc_center(const float start_point[2],
+		const float end_point[2], float radius, float center[2], bool clockwise, bool minor)
+{
+	// Coincident points do not define a circle
+	if (fabsf(start_point[0] - end_point[0]) < 1e-6f && fabsf(start_point[1] - end_point[1]) < 1e-6f) {
+		center[0] = NAN;
+		center[1] = NAN;
+		return PATH_FILLET_COINCIDENT_POINTS;
+	}
+
+	// Center between start and end
+	float m_n = (start_point[0] + end_point[0]) / 2;
+	float m_e = (start_point[1] + end_point[1]) / 2;
+
+	// Normal to the line between start and end
+	float p_n, p_e;
+	if (clockwise == minor) {
+		p_n = -(end_point[1] - start_point[1]);
+		p_e =  (end_point[0] - start_point[0]);
+	} else {
+		p_n =  (end_point[1] - start_point[1]);
+		p_e = -(end_point[0] - start_point[0]);
+	}
+
+	// How far to go along the perpendicular bisector, allowing 1% for roundoff
+	float d2 = radius * radius / (p_n * p_n + p_e * p_e) - 0.25f;
+	if (d2 < 0) {
+		if (d2 > -(radius * 0.01f) * (radius * 0.01f)) {
+			d2 = 0;
+		} else {
+			center[0] = NAN;
+			center[1] = NAN;
+			return PATH_FILLET_INSUFFICIENT_RADIUS;
+		}
+	}
+
+	float d = sqrtf(d2);
+
+	if (fabsf(p_n) < 1e-3f && fabsf(p_e) < 1e-3f) {
+		center[0] = m_n;
+		center[1] = m_e;
+	} else {
+		center[0] = m_n + p_n * d;
+		center[1] = m_e + p_e * d;
+	}
+
+	return PATH_FILLET_CENTER_FOUND;
+}
+
+static inline void path_fillet_set(struct path_fillet_point *out, float north, float east,
+		const struct path_fillet_point *current, float curvature)
+{
+	out->position[0] = north;
+	out->position[1] = east;
+	out->position[2] = current->position[2];
+	out->velocity = current->velocity;
+	out->curvature = curvature;
+}
+
+/**
+ * Replace one waypoint by the points which round its corner
+ * @param[in] radius fillet radius in m, 0 keeps the waypoint as it is
+ * @param[in] prev last point of the path so far, NULL for the first waypoint
+ * @param[in] current the waypoint
+ * @param[in] next the waypoint after it, NULL for the last one. It is taken
+ * as reached with a straight line.
+ * @param[out] out the points replacing current
+ * @returns the number of points written to out, 1 to PATH_FILLET_MAX_POINTS
+ */
+static inline int path_fillet_waypoint(float radius, const struct path_fillet_point *prev,
+		const struct path_fillet_point *current, const struct path_fillet_point *next,
+		struct path_fillet_point out[PATH_FILLET_MAX_POINTS])
+{
+	// There is no corner at the ends of the path
+	if (prev == NULL || next == NULL || radius <= 0) {
+		out[0] = *current;
+		return 1;
+	}
+
+	// Tangents into and out of the waypoint
+	float q_current[2] = {current->position[0] - prev->position[0], current->position[1] - prev->position[1]};
+	float q_future[2] = {next->position[0] - current->position[0], next->position[1] - current->position[1]};
+
+	if (current->curvature != 0) {
+		// Arriving on an arc, its tangent is perpendicular to the radius at the waypoint
+		bool clockwise = current->curvature > 0;
+		int8_t lambda = clockwise ? 1 : -1;
+		float center[2];
+
+		if (path_fillet_find_arc_center(prev->position, current->position, 1.0f / fabsf(current->curvature),
+				center, clockwise, true) == PATH_FILLET_CENTER_FOUND) {
+			q_current[0] = -lambda * (current->position[1] - center[1]);
+			q_current[1] = lambda * (current->position[0] - center[0]);
+		}
+	}
+
+	float q_current_mag = sqrtf(q_current[0] * q_current[0] + q_current[1] * q_current[1]);
+	float q_future_mag = sqrtf(q_future[0] * q_future[0] + q_future[1] * q_future[1]);
+
+	if (q_current_mag > 0) {
+		q_current[0] /= q_current_mag;
+		q_current[1] /= q_current_mag;
+	}
+	if (q_future_mag > 0) {
+		q_future[0] /= q_future_mag;
+		q_future[1] /= q_future_mag;
+	}
+
+	// Heading change at the waypoint and the angle between the two tangents
+	float theta = path_fillet_angle_between(q_current, q_future);
+	float rho = path_fillet_circular_modulus(theta - PATH_FILLET_PI);
+	float rho2 = rho / 2.0f;
+	float sign = theta < 0 ? -1 : 1;
+
+	const float *pos = current->position;
+
+	if (fabsf(rho) < PATH_FILLET_PI / 3.0f) {
+		// Acute corners are flown around the outside. The triangle between
+		// the centers of the three arcs is a 1-2-sqrt(3) one.
+		float R = radius;
+		if (q_current_mag > 0 && q_current_mag < R * PATH_FILLET_SQRT3)
+			R = q_current_mag / PATH_FILLET_SQRT3 - PATH_FILLET_MARGIN;
+		if (q_future_mag > 0 && q_future_mag < R * PATH_FILLET_SQRT3)
+			R = q_future_mag / PATH_FILLET_SQRT3 - PATH_FILLET_MARGIN;
+		if (R <= 0) {
+			out[0] = *current;
+			return 1;
+		}
+
+		float f1[2] = {pos[0] - R * q_current[0] * PATH_FILLET_SQRT3, pos[1] - R * q_current[1] * PATH_FILLET_SQRT3};
+		float f2[2] = {pos[0] + R * q_future[0] * PATH_FILLET_SQRT3, pos[1] + R * q_future[1] * PATH_FILLET_SQRT3};
+
+		float gamma = atan2f(q_current[1], q_current[0]);
+
+		// Angles from the horizontal to the centers of the fillets at f1 and f2
+		float eta, sigma;
+		if (theta > 0) {
+			eta = gamma - PATH_FILLET_PI / 2.0f;
+			sigma = gamma + theta - PATH_FILLET_PI / 2.0f;
+		} else {
+			eta = gamma + PATH_FILLET_PI / 2.0f;
+			sigma = gamma + theta + PATH_FILLET_PI / 2.0f;
+		}
+
+		// The segment up to the first fillet
+		path_fillet_set(&out[0], f1[0], f1[1], current, current->curvature);
+
+		// Into the circle
+		path_fillet_set(&out[1], (pos[0] + f1[0] + R * cosf(eta)) / 2, (pos[1] + f1[1] + R * sinf(eta)) / 2,
+				current, -sign / R);
+
+		// Halfway around the circle
+		path_fillet_set(&out[2], pos[0] + R * cosf(gamma), pos[1] + R * sinf(gamma), current, sign / R);
+
+		// From the circle onto the fillet back to the path
+		path_fillet_set(&out[3], (pos[0] + f2[0] + R * cosf(sigma)) / 2, (pos[1] + f2[1] + R * sinf(sigma)) / 2,
+				current, sign / R);
+
+		// Back on the path
+		path_fillet_set(&out[4], f2[0], f2[1], current, -sign / R);
+
+		return 5;
+	} else if (theta != 0) {
+		// A single arc tangent to both segments
+		float R = radius;
+		float tan_rho2 = fabsf(tanf(rho2));
+
+		if (q_current_mag > 0 && q_current_mag < R / tan_rho2)
+			R = fminf(R, q_current_mag * tan_rho2 - PATH_FILLET_MARGIN);
+		if (q_future_mag > 0 && q_future_mag < R / tan_rho2)
+			R = fminf(R, q_future_mag * tan_rho2 - PATH_FILLET_MARGIN);
+		if (R <= 0) {
+			out[0] = *current;
+			return 1;
+		}
+
+		path_fillet_set(&out[0], pos[0] - R / tan_rho2 * q_current[0], pos[1] - R / tan_rho2 * q_current[1],
+				current, current->curvature);
+		path_fillet_set(&out[1], pos[0] + R / tan_rho2 * q_future[0], pos[1] + R / tan_rho2 * q_future[1],
+				current, sign / R);
+
+		return 2;
+	}
+
+	// The two tangents are colinear
+	out[0] = *current;
+	return 1;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PATH_FILLET_H_ */
+
+/**
+ * @}
+ * @}
+ */
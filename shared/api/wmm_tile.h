@@ -0,0 +1,204 @@
+/**
+ ******************************************************************************
+ * @file       wmm_tile.h
+ * @author     Tau Labs, http://taulabs.org, Copyright (C) 2013
+ * @addtogroup Shared code
+ * @{
+ * @addtogroup WMM tile
+ * @{
+ * @brief Bilinear interpolation of the magnetic field over a lat/lon tile.
+ *
+ * The field is evaluated with the full spherical harmonic model only at the
+ * four corners of the grid cell the vehicle is in, and interpolated inside
+ * it. The corners are recomputed when the vehicle leaves the cell or its
+ * altitude moves further than a threshold from the one they were computed
+ * at. Corners shared with the previous cell are kept. The model itself is
+ * supplied as a callback so the same code serves the flight WMM and the GCS
+ * double precision one.
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef WMM_TILE_H_
+#define WMM_TILE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Evaluates the model at one point
+ * @param[in] ctx opaque pointer passed through from wmm_tile_get
+ * @param[in] lat latitude in degrees
+ * @param[in] lon longitude in degrees
+ * @param[in] alt altitude in m
+ * @param[out] B the field in NED
+ * @returns 0 if successful, < 0 otherwise
+ */
+typedef int (*wmm_tile_eval_t)(void *ctx, float lat, float lon, float alt, float B[3]);
+
+//! Corners are kept this far from the poles, where the model is singular
+#define WMM_TILE_MAX_LAT 89.9f
+
+struct wmm_tile {
+	float step;            //!< Size of a cell in degrees
+	float alt_threshold;   //!< Altitude change in m which forces a recompute
+	bool valid;            //!< Whether the corners hold data
+	int32_t row;           //!< Cell index from the south pole
+	int32_t col;           //!< Cell index from the antimeridian
+	float alt;             //!< Altitude the corners were computed at
+	float B[2][2][3];      //!< Corners as [north][east][axis]
+	uint32_t evaluations;  //!< Number of model evaluations, for profiling
+};
+
+/**
+ * Set up an empty tile
+ * @param[in] step size of a cell in degrees, should divide 180
+ * @param[in] alt_threshold altitude change in m which forces a recompute
+ */
+static inline void wmm_tile_init(struct wmm_tile *tile, float step, float alt_threshold)
+{
+	tile->step = step;
+	tile->alt_threshold = alt_threshold;
+	tile->valid = false;
+	tile->row = 0;
+	tile->col = 0;
+	tile->alt = 0;
+	tile->evaluations = 0;
+}
+
+/**
+ * Force the next lookup to recompute all the corners, e.g. when the date
+ * the model is evaluated at changes
+ */
+static inline void wmm_tile_invalidate(struct wmm_tile *tile)
+{
+	tile->valid = false;
+}
+
+/**
+ * Latitude of the southern edge of a row of cells, clamped short of the poles
+ */
+static inline float wmm_tile_row_lat(const struct wmm_tile *tile, int32_t row)
+{
+	float lat = row * tile->step - 90.0f;
+	if (lat > WMM_TILE_MAX_LAT) lat = WMM_TILE_MAX_LAT;
+	if (lat < -WMM_TILE_MAX_LAT) lat = -WMM_TILE_MAX_LAT;
+	return lat;
+}
+
+/**
+ * Get the interpolated field at a point
+ * @param[in] eval the model
+ * @param[in] ctx passed to the model
+ * @param[in] lat latitude in degrees, -90 to 90
+ * @param[in] lon longitude in degrees, -180 to 180
+ * @param[in] alt altitude in m
+ * @param[out] B the field in NED, in the units of the model
+ * @returns 0 if successful, < 0 if the model failed in which case the tile
+ * is left as it was
+ */
+static inline int wmm_tile_get(struct wmm_tile *tile, wmm_tile_eval_t eval, void *ctx,
+		float lat, float lon, float alt, float B[3])
+{
+	const int32_t rows = (int32_t) (180.0f / tile->step + 0.5f);
+	const int32_t cols = (int32_t) (360.0f / tile->step + 0.5f);
+
+	int32_t row = (int32_t) floorf((lat + 90.0f) / tile->step);
+	int32_t col = (int32_t) floorf((lon + 180.0f) / tile->step);
+
+	// Keep the top edge inside the last cell
+	if (row < 0) row = 0;
+	if (row > rows - 1) row = rows - 1;
+	if (col < 0) col = 0;
+	if (col > cols - 1) col = cols - 1;
+
+	bool same_alt = tile->valid && fabsf(alt - tile->alt) <= tile->alt_threshold;
+
+	if (!same_alt || row != tile->row || col != tile->col) {
+		float corners[2][2][3];
+		bool have[2][2] = {{false, false}, {false, false}};
+
+		// Keep the corners this cell shares with the previous one
+		if (same_alt) {
+			for (int32_t i = 0; i < 2; i++) {
+				for (int32_t j = 0; j < 2; j++) {
+					int32_t oi = row + i - tile->row;
+					int32_t oj = col + j - tile->col;
+					if (oi < 0 || oi > 1 || oj < 0 || oj > 1)
+						continue;
+					for (int32_t k = 0; k < 3; k++)
+						corners[i][j][k] = tile->B[oi][oj][k];
+					have[i][j] = true;
+				}
+			}
+		}
+
+		float corner_alt = same_alt ? tile->alt : alt;
+
+		// Latitude outermost so a model that caches per latitude state
+		// sees both corners of a row together
+		for (int32_t i = 0; i < 2; i++) {
+			float corner_lat = wmm_tile_row_lat(tile, row + i);
+			for (int32_t j = 0; j < 2; j++) {
+				if (have[i][j])
+					continue;
+				float corner_lon = (col + j) * tile->step - 180.0f;
+				if (eval(ctx, corner_lat, corner_lon, corner_alt, corners[i][j]) < 0)
+					return -1;
+				tile->evaluations++;
+			}
+		}
+
+		for (int32_t i = 0; i < 2; i++)
+			for (int32_t j = 0; j < 2; j++)
+				for (int32_t k = 0; k < 3; k++)
+					tile->B[i][j][k] = corners[i][j][k];
+
+		tile->row = row;
+		tile->col = col;
+		tile->alt = corner_alt;
+		tile->valid = true;
+	}
+
+	// The polar cells extrapolate slightly past the clamped corners
+	float south_lat = wmm_tile_row_lat(tile, row);
+	float u = (lat - south_lat) / (wmm_tile_row_lat(tile, row + 1) - south_lat);
+	float v = (lon + 180.0f) / tile->step - col;
+
+	for (int32_t k = 0; k < 3; k++) {
+		float south = tile->B[0][0][k] + v * (tile->B[0][1][k] - tile->B[0][0][k]);
+		float north = tile->B[1][0][k] + v * (tile->B[1][1][k] - tile->B[1][0][k]);
+		B[k] = south + u * (north - south);
+	}
+
+	return 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WMM_TILE_H_ */
+
+/**
+ * @}
+ * @}
+ */